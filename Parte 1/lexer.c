@@ -10,6 +10,7 @@
  *   - Reconhecimento baseado em diagramas de transição (autômatos)
  *   - Tabela de símbolos com técnica "maximal munch"
  *   - Detecção de erros léxicos com linha e coluna
+ *   - Listas de tokens em TSV, JSON Lines ou binário (--format)
  * 
  * ============================================================================
  */
@@ -21,6 +22,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <errno.h>
+#include <unistd.h>
 
 /* ============================================================================
  * CONSTANTES
@@ -410,29 +413,307 @@ const char* token_type_to_string(TokenType type) {
     }
 }
 
+/* ============================================================================
+ * SAÍDA EM FORMATOS DE MÁQUINA (--format)
+ * ----------------------------------------------------------------------------
+ * Listas de tokens para outros programas, sem o cabeçalho nem a tabela de
+ * símbolos da saída normal. Um registro por token, incluindo o EOF no fim
+ * da lista ou o ERRO que a interrompe:
+ *   tsv    linha, coluna, tipo e lexema separados por TAB; no lexema, TAB,
+ *          quebras de linha e '\' são escritos como \t, \n, \r e \\
+ *   jsonl  um objeto {"line","col","type","lexeme"} por linha
+ *   bin    "LSITOK01" seguido de registros com prefixo de tamanho: tipo
+ *          (1 byte, valor de TokenType), linha, coluna e tamanho do lexema
+ *          (4 bytes cada, little-endian) e os bytes do lexema
+ *
+ * Os registros são montados em um buffer de OUTPUT_BUFFER_SIZE bytes,
+ * esvaziado com write(), e os números são convertidos para texto aqui
+ * mesmo, sem printf, para que a escrita não fique mais lenta que a
+ * própria análise léxica.
+ * ============================================================================ */
+
+#define OUTPUT_BUFFER_SIZE (1 << 20)
+#define BINARY_MAGIC "LSITOK01"
+
+typedef enum {
+    FORMAT_TEXT,            /* Saída normal, com a tabela de símbolos */
+    FORMAT_TSV,
+    FORMAT_JSONL,
+    FORMAT_BIN
+} OutputFormat;
+
+static char* outputBuffer;
+static size_t outputUsed;
+static int outputFailed;    /* errno de um write() que falhou, ou 0 */
+
+/* Pares de dígitos "00" a "99", para converter dois dígitos por vez */
+static const char digitPairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static const char hexDigits[] = "0123456789abcdef";
+
+/* Nome e tamanho do nome de cada tipo, calculados uma vez por dump_tokens() */
+static const char* typeNames[TOKEN_ERROR + 1];
+static unsigned char typeNameLengths[TOKEN_ERROR + 1];
+
+static void output_flush(void) {
+    size_t done = 0;
+    while (done < outputUsed && !outputFailed) {
+        ssize_t n = write(STDOUT_FILENO, outputBuffer + done, outputUsed - done);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            outputFailed = n < 0 ? errno : EIO;
+            break;
+        }
+        done += (size_t)n;
+    }
+    outputUsed = 0;
+}
+
+/*
+ * Garante espaço para size bytes no buffer, esvaziando-o se preciso.
+ * Retorna o ponto de escrita; quem escreve atualiza outputUsed.
+ */
+static inline char* output_reserve(size_t size) {
+    if (outputUsed + size > OUTPUT_BUFFER_SIZE) {
+        output_flush();
+    }
+    return outputBuffer + outputUsed;
+}
+
+/*
+ * Escreve value em decimal a partir de out e retorna o fim.
+ */
+static inline char* write_uint(char* out, unsigned int value) {
+    int digits = 1;
+    for (unsigned int v = value; v >= 10; v /= 10) {
+        digits++;
+    }
+    char* end = out + digits;
+    char* p = end;
+    while (value >= 100) {
+        unsigned int pair = (value % 100) * 2;
+        value /= 100;
+        *--p = digitPairs[pair + 1];
+        *--p = digitPairs[pair];
+    }
+    if (value >= 10) {
+        *--p = digitPairs[value * 2 + 1];
+        *--p = digitPairs[value * 2];
+    } else {
+        *--p = (char)('0' + value);
+    }
+    return end;
+}
+
+static inline char* write_u32_le(char* out, unsigned int value) {
+    out[0] = (char)(value & 0xFF);
+    out[1] = (char)((value >> 8) & 0xFF);
+    out[2] = (char)((value >> 16) & 0xFF);
+    out[3] = (char)((value >> 24) & 0xFF);
+    return out + 4;
+}
+
+static inline char* write_text(char* out, const char* text, size_t length) {
+    memcpy(out, text, length);
+    return out + length;
+}
+
+static char* write_tsv_lexeme(char* out, const char* lexeme, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        char c = lexeme[i];
+        switch (c) {
+            case '\t': *out++ = '\\'; *out++ = 't'; break;
+            case '\n': *out++ = '\\'; *out++ = 'n'; break;
+            case '\r': *out++ = '\\'; *out++ = 'r'; break;
+            case '\\': *out++ = '\\'; *out++ = '\\'; break;
+            default:   *out++ = c; break;
+        }
+    }
+    return out;
+}
+
+/*
+ * Bytes de controle e acima de 127 (um caractere inválido pode ser metade
+ * de um caractere UTF-8) saem como \u00XX, para que cada linha seja JSON
+ * válido.
+ */
+static char* write_json_lexeme(char* out, const char* lexeme, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = (unsigned char)lexeme[i];
+        if (c == '"' || c == '\\') {
+            *out++ = '\\';
+            *out++ = (char)c;
+        } else if (c < 0x20 || c >= 0x7F) {
+            out = write_text(out, "\\u00", 4);
+            *out++ = hexDigits[c >> 4];
+            *out++ = hexDigits[c & 0xF];
+        } else {
+            *out++ = (char)c;
+        }
+    }
+    return out;
+}
+
+/*
+ * Escreve o registro de um token no formato escolhido.
+ */
+static void emit_token(OutputFormat format, const Token* token) {
+    const char* typeName = typeNames[token->type];
+    size_t typeLength = typeNameLengths[token->type];
+    size_t length = strlen(token->lexeme);
+
+    /* Pior caso: lexema todo escapado como \u00XX, mais números e nomes */
+    char* out = output_reserve(64 + typeLength + 6 * length);
+    char* start = out;
+
+    switch (format) {
+        case FORMAT_TSV:
+            out = write_uint(out, (unsigned int)token->line);
+            *out++ = '\t';
+            out = write_uint(out, (unsigned int)token->col);
+            *out++ = '\t';
+            out = write_text(out, typeName, typeLength);
+            *out++ = '\t';
+            out = write_tsv_lexeme(out, token->lexeme, length);
+            *out++ = '\n';
+            break;
+        case FORMAT_JSONL:
+            out = write_text(out, "{\"line\":", 8);
+            out = write_uint(out, (unsigned int)token->line);
+            out = write_text(out, ",\"col\":", 7);
+            out = write_uint(out, (unsigned int)token->col);
+            out = write_text(out, ",\"type\":\"", 9);
+            out = write_text(out, typeName, typeLength);
+            out = write_text(out, "\",\"lexeme\":\"", 12);
+            out = write_json_lexeme(out, token->lexeme, length);
+            out = write_text(out, "\"}\n", 3);
+            break;
+        case FORMAT_BIN:
+            *out++ = (char)token->type;
+            out = write_u32_le(out, (unsigned int)token->line);
+            out = write_u32_le(out, (unsigned int)token->col);
+            out = write_u32_le(out, (unsigned int)length);
+            out = write_text(out, token->lexeme, length);
+            break;
+        case FORMAT_TEXT:
+            break;
+    }
+    outputUsed += (size_t)(out - start);
+}
+
+/*
+ * dump_tokens(format)
+ *
+ * Analisa a entrada inteira escrevendo um registro por token. Erros léxicos
+ * também são reportados na saída de erro, como na saída normal. Retorna o
+ * código de saída do programa.
+ */
+static int dump_tokens(OutputFormat format) {
+    outputBuffer = (char*)malloc(OUTPUT_BUFFER_SIZE);
+    if (!outputBuffer) {
+        fprintf(stderr, "Erro fatal: Memória insuficiente para o buffer de saída.\n");
+        return 1;
+    }
+    outputUsed = 0;
+    outputFailed = 0;
+    for (int type = 0; type <= TOKEN_ERROR; type++) {
+        typeNames[type] = token_type_to_string((TokenType)type);
+        typeNameLengths[type] = (unsigned char)strlen(typeNames[type]);
+    }
+
+    if (format == FORMAT_BIN) {
+        char* out = output_reserve(sizeof(BINARY_MAGIC) - 1);
+        outputUsed += (size_t)(write_text(out, BINARY_MAGIC, sizeof(BINARY_MAGIC) - 1) - out);
+    }
+
+    Token token;
+    int hasError = 0;
+    do {
+        token = getToken();
+        emit_token(format, &token);
+
+        if (token.type == TOKEN_ERROR) {
+            fprintf(stderr, "Linha %d, Coluna %d: %s\n",
+                    token.line, token.col, token.lexeme);
+            hasError = 1;
+        }
+        /* Números e mensagens de erro são cópias; os demais lexemas são da tabela ou constantes */
+        if (token.type == TOKEN_NUM || token.type == TOKEN_ERROR) {
+            free(token.lexeme);
+        }
+    } while (!hasError && token.type != TOKEN_EOF);
+
+    output_flush();
+    free(outputBuffer);
+    outputBuffer = NULL;
+
+    if (outputFailed) {
+        fprintf(stderr, "Erro ao escrever a saída: %s\n", strerror(outputFailed));
+        return 1;
+    }
+    return hasError;
+}
+
 /* ============================================================================
  * FUNÇÃO PRINCIPAL
  * ============================================================================ */
 
 int main(int argc, char* argv[]) {
+    OutputFormat format = FORMAT_TEXT;
+    const char* path = NULL;
+
     /* Verifica argumentos */
-    if (argc != 2) {
-        fprintf(stderr, "Uso: %s <arquivo.lsi>\n", argv[0]);
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--format=", 9) == 0) {
+            const char* name = argv[i] + 9;
+            if (strcmp(name, "tsv") == 0) {
+                format = FORMAT_TSV;
+            } else if (strcmp(name, "jsonl") == 0) {
+                format = FORMAT_JSONL;
+            } else if (strcmp(name, "bin") == 0) {
+                format = FORMAT_BIN;
+            } else {
+                fprintf(stderr, "Formato desconhecido: '%s' (use tsv, jsonl ou bin)\n", name);
+                return 1;
+            }
+        } else if (path == NULL) {
+            path = argv[i];
+        } else {
+            path = NULL;        /* Mais de um arquivo */
+            break;
+        }
+    }
+    if (path == NULL) {
+        fprintf(stderr, "Uso: %s [--format=tsv|jsonl|bin] <arquivo.lsi>\n", argv[0]);
         fprintf(stderr, "Exemplo: %s programa.lsi\n", argv[0]);
         return 1;
     }
 
     /* Abre o arquivo de entrada */
-    inputFile = fopen(argv[1], "r");
+    inputFile = fopen(path, "r");
     if (!inputFile) {
         perror("Erro ao abrir arquivo");
         return 1;
     }
 
+    if (format != FORMAT_TEXT) {
+        symtable_init();
+        advance();
+        int status = dump_tokens(format);
+        fclose(inputFile);
+        symtable_free();
+        return status;
+    }
+
     printf("============================================================\n");
     printf("       ANALISADOR LÉXICO - LINGUAGEM LSI-2025-2             \n");
     printf("============================================================\n");
-    printf("Arquivo: %s\n", argv[1]);
+    printf("Arquivo: %s\n", path);
     printf("============================================================\n\n");
 
     /* Inicializa tabela de símbolos e lê primeiro caractere */
@@ -10,6 +10,7 @@
 #ifndef LEXER_H
 #define LEXER_H
 
+/* Os valores são gravados no formato binário (--format=bin): só acrescentar no fim */
 typedef enum {
     TOKEN_INT,      // int
     TOKEN_IF,       // if
@@ -0,0 +1,532 @@
+/*
+ * ============================================================================
+ * ÁRVORE SINTÁTICA ABSTRATA PARA A LINGUAGEM LSI-2025-2
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * Este módulo implementa:
+ *   - Alocação de nós em arena (blocos grandes, liberados de uma só vez)
+ *   - Construtores de nós e listas de filhos
+ *   - Tabela de funções e conjunto de variáveis locais, usados pelos backends
+ *   - Impressão da árvore para fins de debug
+ *
+ * ============================================================================
+ */
+
+#include "ast.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ============================================================================
+ * ARENA DE ALOCAÇÃO
+ * ============================================================================
+ *
+ * Os nós de um programa têm todos o mesmo tempo de vida, então são
+ * alocados sequencialmente em blocos de ARENA_BLOCK_SIZE bytes. O primeiro
+ * bloco é mantido entre execuções de ast_reset() para que análises
+ * repetidas não voltem ao malloc.
+ */
+
+#define ARENA_BLOCK_SIZE (64 * 1024)
+
+typedef struct ArenaBlock {
+    struct ArenaBlock* next;
+    size_t used;
+    size_t size;
+    char data[];
+} ArenaBlock;
+
+static __thread ArenaBlock* arena_head = NULL;
+static __thread size_t arena_bytes = 0;     /* Blocos da thread, com cabeçalho */
+
+/*
+ * arena_alloc(size)
+ *
+ * Reserva size bytes alinhados a 8 no bloco corrente, abrindo um novo
+ * bloco quando não há espaço.
+ */
+static void* arena_alloc(size_t size) {
+    size = (size + 7) & ~(size_t)7;
+
+    if (arena_head == NULL || arena_head->used + size > arena_head->size) {
+        size_t block_size = size > ARENA_BLOCK_SIZE ? size : ARENA_BLOCK_SIZE;
+        ArenaBlock* block = (ArenaBlock*)malloc(sizeof(ArenaBlock) + block_size);
+        if (block == NULL) {
+            fprintf(stderr, "Erro fatal: Memória insuficiente para a árvore sintática.\n");
+            exit(1);
+        }
+        block->next = arena_head;
+        block->used = 0;
+        block->size = block_size;
+        arena_head = block;
+        arena_bytes += sizeof(ArenaBlock) + block_size;
+    }
+
+    void* ptr = arena_head->data + arena_head->used;
+    arena_head->used += size;
+    return ptr;
+}
+
+/*
+ * ast_reset()
+ *
+ * Libera todos os nós alocados. Mantém apenas o bloco mais antigo,
+ * esvaziado, para reaproveitamento.
+ */
+void ast_reset(void) {
+    while (arena_head != NULL && arena_head->next != NULL) {
+        ArenaBlock* next = arena_head->next;
+        arena_bytes -= sizeof(ArenaBlock) + arena_head->size;
+        free(arena_head);
+        arena_head = next;
+    }
+    if (arena_head != NULL) {
+        arena_head->used = 0;
+    }
+}
+
+/*
+ * ast_memory_used()
+ *
+ * Bytes dos blocos da arena da thread atual.
+ */
+size_t ast_memory_used(void) {
+    return arena_bytes;
+}
+
+/* ============================================================================
+ * CONSTRUTORES
+ * ============================================================================ */
+
+/*
+ * ast_new(kind, name, line, col)
+ *
+ * Cria um nó sem filhos na posição indicada.
+ */
+AstNode* ast_new(AstKind kind, const char* name, int line, int col) {
+    AstNode* node = (AstNode*)arena_alloc(sizeof(AstNode));
+    memset(node, 0, sizeof(AstNode));
+    node->kind = kind;
+    node->name = name;
+    node->line = line;
+    node->col = col;
+    return node;
+}
+
+/*
+ * ast_alloc_list(count)
+ *
+ * Aloca um vetor de count ponteiros para nós na arena.
+ */
+AstNode** ast_alloc_list(int count) {
+    if (count == 0) {
+        return NULL;
+    }
+    return (AstNode**)arena_alloc(sizeof(AstNode*) * (size_t)count);
+}
+
+/* ============================================================================
+ * TABELA DE FUNÇÕES
+ * ============================================================================ */
+
+static int compare_fdef_names(const void* a, const void* b) {
+    const AstNode* fa = *(const AstNode* const*)a;
+    const AstNode* fb = *(const AstNode* const*)b;
+    return strcmp(fa->name, fb->name);
+}
+
+/*
+ * ast_function_table_build(program, table)
+ *
+ * Ordena as funções do programa por nome. Retorna NULL em caso de sucesso
+ * ou a segunda definição de um nome repetido.
+ */
+const AstNode* ast_function_table_build(const AstNode* program, AstFunctionTable* table) {
+    table->count = 0;
+    table->fdefs = (const AstNode**)malloc(sizeof(AstNode*) * (size_t)(program->kid_count + 1));
+
+    for (int i = 0; i < program->kid_count; i++) {
+        if (program->kids[i]->kind == AST_FDEF) {
+            table->fdefs[table->count++] = program->kids[i];
+        }
+    }
+    qsort(table->fdefs, (size_t)table->count, sizeof(AstNode*), compare_fdef_names);
+
+    for (int i = 1; i < table->count; i++) {
+        if (strcmp(table->fdefs[i - 1]->name, table->fdefs[i]->name) == 0) {
+            const AstNode* a = table->fdefs[i - 1];
+            const AstNode* b = table->fdefs[i];
+            return (a->line > b->line || (a->line == b->line && a->col > b->col)) ? a : b;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * ast_function_index(table, name)
+ *
+ * Busca binária por nome. Retorna a posição da função em table->fdefs
+ * ou -1 se ela não existe.
+ */
+int ast_function_index(const AstFunctionTable* table, const char* name) {
+    int lo = 0;
+    int hi = table->count - 1;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        int cmp = strcmp(name, table->fdefs[mid]->name);
+        if (cmp == 0) {
+            return mid;
+        }
+        if (cmp < 0) {
+            hi = mid - 1;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return -1;
+}
+
+/*
+ * ast_function_lookup(table, name)
+ *
+ * Retorna a definição da função ou NULL se ela não existe.
+ */
+const AstNode* ast_function_lookup(const AstFunctionTable* table, const char* name) {
+    int index = ast_function_index(table, name);
+    return index >= 0 ? table->fdefs[index] : NULL;
+}
+
+void ast_function_table_free(AstFunctionTable* table) {
+    free(table->fdefs);
+    table->fdefs = NULL;
+    table->count = 0;
+}
+
+/*
+ * ast_entry_function(program)
+ *
+ * Escolhe o ponto de entrada: a função "principal", senão "main", senão
+ * a última função definida. Retorna NULL se o programa não tem funções.
+ */
+const AstNode* ast_entry_function(const AstNode* program) {
+    const AstNode* last = NULL;
+    const AstNode* main_fn = NULL;
+
+    for (int i = 0; i < program->kid_count; i++) {
+        const AstNode* node = program->kids[i];
+        if (node->kind != AST_FDEF) {
+            continue;
+        }
+        if (strcmp(node->name, "principal") == 0) {
+            return node;
+        }
+        if (main_fn == NULL && strcmp(node->name, "main") == 0) {
+            main_fn = node;
+        }
+        last = node;
+    }
+    return main_fn != NULL ? main_fn : last;
+}
+
+/* ============================================================================
+ * VARIÁVEIS LOCAIS
+ * ============================================================================ */
+
+static unsigned int hash_name(const char* str) {
+    unsigned int hash_value = 2166136261u;
+    while (*str) {
+        hash_value = (hash_value ^ (unsigned char)*str++) * 16777619u;
+    }
+    return hash_value;
+}
+
+static unsigned int hash_node(const AstNode* node) {
+    uint64_t key = (uint64_t)(uintptr_t)node * 0x9e3779b97f4a7c15ULL;
+    return (unsigned int)(key >> 32);
+}
+
+static void* locals_calloc(size_t count, size_t size) {
+    void* memory = calloc(count ? count : 1, size);
+    if (memory == NULL) {
+        fprintf(stderr, "Erro fatal: Memória insuficiente para as variáveis locais.\n");
+        exit(1);
+    }
+    return memory;
+}
+
+/*
+ * Estado de ast_locals_build(). Como em sema.c, as ligações formam uma
+ * pilha e cada nome aponta a visível, que guarda a que ela sombreia. As
+ * tabelas hash são dimensionadas antes do percurso pelo número de nós com
+ * nome, de modo que as posições não mudam.
+ */
+typedef struct {
+    const char* name;       /* NULL: posição livre */
+    int head;               /* Ligação visível: índice + 1, ou 0 */
+    int implicit;           /* Variável do nome sem declaração: índice + 1, ou 0 */
+    int vars;               /* Variáveis com este nome até agora */
+} LocalName;
+
+typedef struct {
+    int name;               /* Posição em names */
+    int var;
+    int previous;           /* Ligação sombreada: índice + 1, ou 0 */
+} LocalBinding;
+
+typedef struct {
+    AstLocals* locals;
+    LocalName* names;
+    unsigned int name_mask;
+    LocalBinding* bindings;
+    int binding_count;
+} LocalsBuilder;
+
+/* Nós que ast_locals_var() resolve */
+static int count_named(const AstNode* node) {
+    int count = node->kind == AST_ID || node->kind == AST_ASSIGN;
+    for (int i = 0; i < node->kid_count; i++) {
+        count += count_named(node->kids[i]);
+    }
+    return count;
+}
+
+static int name_entry(LocalsBuilder* builder, const char* name) {
+    unsigned int slot = hash_name(name) & builder->name_mask;
+    while (builder->names[slot].name != NULL && strcmp(builder->names[slot].name, name) != 0) {
+        slot = (slot + 1) & builder->name_mask;
+    }
+    builder->names[slot].name = name;
+    return (int)slot;
+}
+
+static int new_var(LocalsBuilder* builder, LocalName* entry) {
+    AstLocals* locals = builder->locals;
+    locals->names[locals->count] = entry->name;
+    locals->ordinals[locals->count] = entry->vars++;
+    return locals->count++;
+}
+
+static void map_node(LocalsBuilder* builder, const AstNode* node, int var) {
+    AstLocals* locals = builder->locals;
+    unsigned int mask = (unsigned int)(locals->node_slot_count - 1);
+    unsigned int slot = hash_node(node) & mask;
+    while (locals->nodes[slot] != NULL) {
+        slot = (slot + 1) & mask;
+    }
+    locals->nodes[slot] = node;
+    locals->node_vars[slot] = var;
+    locals->node_count++;
+}
+
+/*
+ * declare(builder, id, scope_start)
+ *
+ * Cria a variável da declaração id no escopo cujas ligações começam em
+ * scope_start. Uma segunda declaração do nome no mesmo escopo (erro para
+ * --semantica) reaproveita a variável da primeira.
+ */
+static void declare(LocalsBuilder* builder, const AstNode* id, int scope_start) {
+    int name = name_entry(builder, id->name);
+    LocalName* entry = &builder->names[name];
+    if (entry->head > scope_start) {
+        map_node(builder, id, builder->bindings[entry->head - 1].var);
+        return;
+    }
+    int var = new_var(builder, entry);
+    builder->bindings[builder->binding_count] = (LocalBinding){name, var, entry->head};
+    entry->head = ++builder->binding_count;
+    map_node(builder, id, var);
+}
+
+static void close_scope(LocalsBuilder* builder, int scope_start) {
+    while (builder->binding_count > scope_start) {
+        const LocalBinding* binding = &builder->bindings[--builder->binding_count];
+        builder->names[binding->name].head = binding->previous;
+    }
+}
+
+/* Liga o uso do nome à declaração visível, ou à variável sem declaração */
+static void use(LocalsBuilder* builder, const AstNode* node) {
+    LocalName* entry = &builder->names[name_entry(builder, node->name)];
+    if (entry->head > 0) {
+        map_node(builder, node, builder->bindings[entry->head - 1].var);
+        return;
+    }
+    if (entry->implicit == 0) {
+        entry->implicit = new_var(builder, entry) + 1;
+    }
+    map_node(builder, node, entry->implicit - 1);
+}
+
+/*
+ * resolve(builder, node, scope_start)
+ *
+ * Percorre node na ordem de check_node() em sema.c: declarações valem
+ * para os comandos seguintes do escopo, e cada AST_BLOCK e cada ramo de
+ * AST_IF abrem um escopo.
+ */
+static void resolve(LocalsBuilder* builder, const AstNode* node, int scope_start) {
+    switch (node->kind) {
+        case AST_VARDECL:
+            for (int i = 0; i < node->kid_count; i++) {
+                declare(builder, node->kids[i], scope_start);
+            }
+            return;
+
+        case AST_BLOCK: {
+            int inner_start = builder->binding_count;
+            for (int i = 0; i < node->kid_count; i++) {
+                resolve(builder, node->kids[i], inner_start);
+            }
+            close_scope(builder, inner_start);
+            return;
+        }
+
+        case AST_IF:
+            resolve(builder, node->kids[0], scope_start);
+            for (int i = 1; i < node->kid_count; i++) {
+                int inner_start = builder->binding_count;
+                resolve(builder, node->kids[i], inner_start);
+                close_scope(builder, inner_start);
+            }
+            return;
+
+        case AST_ASSIGN:
+            resolve(builder, node->kids[0], scope_start);
+            use(builder, node);
+            return;
+
+        case AST_ID:
+            use(builder, node);
+            return;
+
+        default:
+            break;
+    }
+    /* O nome de AST_FCALL é de função; os argumentos são AST_ID */
+    for (int i = 0; i < node->kid_count; i++) {
+        resolve(builder, node->kids[i], scope_start);
+    }
+}
+
+/*
+ * ast_locals_build(fdef, locals)
+ *
+ * Monta as variáveis locais da função (ou do programa, para programas
+ * formados por um único comando) e liga cada nó com nome à sua variável.
+ */
+void ast_locals_build(const AstNode* fdef, AstLocals* locals) {
+    memset(locals, 0, sizeof(AstLocals));
+    int named = fdef->param_count;
+    for (int i = 0; i < fdef->kid_count; i++) {
+        named += count_named(fdef->kids[i]);
+    }
+
+    /* Cada nó com nome cria no máximo uma variável, um nome e uma ligação */
+    locals->capacity = named;
+    locals->names = (const char**)locals_calloc((size_t)named, sizeof(char*));
+    locals->ordinals = (int*)locals_calloc((size_t)named, sizeof(int));
+    locals->node_slot_count = 16;
+    while (locals->node_slot_count < 2 * named) {
+        locals->node_slot_count *= 2;
+    }
+    locals->nodes = (const AstNode**)locals_calloc((size_t)locals->node_slot_count,
+                                                   sizeof(AstNode*));
+    locals->node_vars = (int*)locals_calloc((size_t)locals->node_slot_count, sizeof(int));
+
+    LocalsBuilder builder = {locals, NULL, (unsigned int)(locals->node_slot_count - 1), NULL, 0};
+    builder.names = (LocalName*)locals_calloc((size_t)locals->node_slot_count, sizeof(LocalName));
+    builder.bindings = (LocalBinding*)locals_calloc((size_t)named, sizeof(LocalBinding));
+
+    /* Os parâmetros e os comandos do corpo formam um único escopo */
+    for (int i = 0; i < fdef->param_count; i++) {
+        declare(&builder, fdef->params[i], 0);
+    }
+    for (int i = 0; i < fdef->kid_count; i++) {
+        resolve(&builder, fdef->kids[i], 0);
+    }
+
+    free(builder.names);
+    free(builder.bindings);
+}
+
+int ast_locals_var(const AstLocals* locals, const AstNode* node) {
+    if (locals->node_slot_count == 0) {
+        return -1;
+    }
+    unsigned int mask = (unsigned int)(locals->node_slot_count - 1);
+    unsigned int slot = hash_node(node) & mask;
+    while (locals->nodes[slot] != NULL) {
+        if (locals->nodes[slot] == node) {
+            return locals->node_vars[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+    return -1;
+}
+
+void ast_locals_free(AstLocals* locals) {
+    free(locals->names);
+    free(locals->ordinals);
+    free(locals->nodes);
+    free(locals->node_vars);
+    memset(locals, 0, sizeof(AstLocals));
+}
+
+/* ============================================================================
+ * IMPRESSÃO PARA DEBUG
+ * ============================================================================ */
+
+/*
+ * ast_kind_to_string(kind)
+ *
+ * Converte um tipo de nó em sua representação textual.
+ */
+const char* ast_kind_to_string(AstKind kind) {
+    switch (kind) {
+        case AST_PROGRAM: return "PROGRAM";
+        case AST_FDEF: return "FDEF";
+        case AST_VARDECL: return "VARDECL";
+        case AST_ASSIGN: return "ASSIGN";
+        case AST_FCALL: return "FCALL";
+        case AST_PRINT: return "PRINT";
+        case AST_RETURN: return "RETURN";
+        case AST_IF: return "IF";
+        case AST_BLOCK: return "BLOCK";
+        case AST_EMPTY: return "EMPTY";
+        case AST_BINOP: return "BINOP";
+        case AST_NUM: return "NUM";
+        case AST_ID: return "ID";
+        case AST_MARK: return "MARK";
+        default: return "UNKNOWN";
+    }
+}
+
+/*
+ * ast_print(node, depth)
+ *
+ * Imprime a árvore em pré-ordem, um nó por linha, indentado pela
+ * profundidade.
+ */
+void ast_print(const AstNode* node, int depth) {
+    printf("%*s%s", depth * 2, "", ast_kind_to_string(node->kind));
+    if (node->kind == AST_BINOP) {
+        printf(" %s", token_type_to_string(node->op));
+    }
+    if (node->name != NULL) {
+        printf(" '%s'", node->name);
+    }
+    printf(" [%d:%d]\n", node->line, node->col);
+
+    for (int i = 0; i < node->param_count; i++) {
+        printf("%*sparam", (depth + 1) * 2, "");
+        printf(" '%s' [%d:%d]\n", node->params[i]->name,
+               node->params[i]->line, node->params[i]->col);
+    }
+    for (int i = 0; i < node->kid_count; i++) {
+        ast_print(node->kids[i], depth + 1);
+    }
+}
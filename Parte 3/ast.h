@@ -0,0 +1,117 @@
+/*
+ * ============================================================================
+ * HEADER DA ÁRVORE SINTÁTICA ABSTRATA PARA A LINGUAGEM LSI-2025-2
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * Os nós são alocados em uma arena liberada de uma só vez por ast_reset().
+ *
+ * Organização dos filhos (kids) por tipo de nó:
+ *   AST_PROGRAM  kids = funções (AST_FDEF) ou um único comando
+ *   AST_FDEF     name e value = nome, params = AST_ID dos parâmetros, kids = corpo
+ *   AST_VARDECL  kids = AST_ID das variáveis declaradas
+ *   AST_ASSIGN   name e value = variável de destino, kids[0] = expressão ou AST_FCALL
+ *   AST_FCALL    name e value = função chamada, kids = AST_ID dos argumentos
+ *   AST_PRINT    kids[0] = expressão
+ *   AST_RETURN   kids[0] = AST_ID retornado (opcional)
+ *   AST_IF       kids[0] = condição, kids[1] = then, kids[2] = else (opcional)
+ *   AST_BLOCK    kids = comandos
+ *   AST_EMPTY    sem filhos (comando ";")
+ *   AST_BINOP    op = operador, kids[0] = esquerda, kids[1] = direita
+ *   AST_NUM      name = dígitos, value = valor do literal
+ *   AST_ID       name = identificador, value = número do símbolo
+ *
+ * O número do símbolo (Token.value) identifica o nome: é o mesmo para
+ * nomes iguais, inclusive em arquivos diferentes analisados no mesmo
+ * processo.
+ *
+ * */
+
+#ifndef AST_H
+#define AST_H
+
+#include "lexer.h"
+
+typedef enum {
+    AST_PROGRAM,
+    AST_FDEF,
+    AST_VARDECL,
+    AST_ASSIGN,
+    AST_FCALL,
+    AST_PRINT,
+    AST_RETURN,
+    AST_IF,
+    AST_BLOCK,
+    AST_EMPTY,
+    AST_BINOP,
+    AST_NUM,
+    AST_ID,
+    AST_MARK        /* Marcador interno da pilha semântica */
+} AstKind;
+
+typedef struct AstNode {
+    AstKind kind;
+    TokenType op;
+    const char* name;
+    int line;
+    int col;
+    struct AstNode** kids;
+    int kid_count;
+    struct AstNode** params;
+    int param_count;
+    int64_t value;
+} AstNode;
+
+/*
+ * Tabela de funções de um programa, ordenada por nome para busca binária.
+ */
+typedef struct {
+    const AstNode** fdefs;
+    int count;
+} AstFunctionTable;
+
+/*
+ * Variáveis locais de uma função: parâmetros primeiro, na ordem da
+ * declaração, e depois uma variável por declaração int, na ordem em que
+ * aparecem. Os escopos são os de sema.c (o corpo da função, cada
+ * AST_BLOCK e cada ramo de AST_IF), de modo que uma declaração interna
+ * que sombreia um nome externo é outra variável. Um nome usado sem
+ * declaração visível (erro para --semantica) vira uma única variável da
+ * função inteira, criada no primeiro uso.
+ */
+typedef struct {
+    const char** names;     /* Por variável */
+    int* ordinals;          /* Por variável: quantas anteriores têm o mesmo nome */
+    int count;
+    int capacity;
+    const AstNode** nodes;  /* Tabela hash aberta por nó: AST_ID ou AST_ASSIGN */
+    int* node_vars;         /* Variável de nodes[i] */
+    int node_count;
+    int node_slot_count;
+} AstLocals;
+
+AstNode* ast_new(AstKind kind, const char* name, int line, int col);
+AstNode** ast_alloc_list(int count);
+void ast_reset(void);
+size_t ast_memory_used(void);
+void ast_print(const AstNode* node, int depth);
+const char* ast_kind_to_string(AstKind kind);
+
+const AstNode* ast_function_table_build(const AstNode* program, AstFunctionTable* table);
+const AstNode* ast_function_lookup(const AstFunctionTable* table, const char* name);
+int ast_function_index(const AstFunctionTable* table, const char* name);
+void ast_function_table_free(AstFunctionTable* table);
+const AstNode* ast_entry_function(const AstNode* program);
+
+void ast_locals_build(const AstNode* fdef, AstLocals* locals);
+void ast_locals_free(AstLocals* locals);
+
+/*
+ * Variável lida ou atribuída por node (AST_ID de expressão, argumento,
+ * retorno, parâmetro ou declaração, ou AST_ASSIGN), ou -1 se o nó não é
+ * da função.
+ */
+int ast_locals_var(const AstLocals* locals, const AstNode* node);
+
+#endif
@@ -0,0 +1,450 @@
+/*
+ * ============================================================================
+ * ÁRVORE SINTÁTICA EM FORMATO BINÁRIO
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * Grava e lê o formato descrito em astbin.h:
+ *   - A gravação percorre a árvore em pré-ordem uma única vez, numerando
+ *     os nós na ordem de visita; os filhos de um nó ocupam posições
+ *     consecutivas de links, reservadas antes de visitá-los, e o fim do
+ *     trecho de cada nó é calculado na volta da recursão
+ *   - Os textos (nomes e dígitos) passam por uma tabela hash aberta e são
+ *     gravados uma vez só
+ *   - O arquivo vai para um temporário que rename() torna visível de uma
+ *     só vez, como no índice de referências cruzadas
+ *   - A leitura é um mmap seguido da conferência do cabeçalho: o custo não
+ *     depende do tamanho da árvore, e só as páginas dos nós efetivamente
+ *     visitados são lidas do disco
+ *
+ * Um arquivo fica desatualizado quando a gramática muda (o cabeçalho
+ * guarda o SHA-256 de parser_grammar_version()) ou quando o fonte muda. A
+ * data de modificação evita reler o fonte no caso comum; se ela mudou mas
+ * o tamanho não, o SHA-256 do conteúdo decide, de modo que um "touch" não
+ * invalida o arquivo.
+ *
+ * ============================================================================
+ */
+
+#define _GNU_SOURCE
+
+#include "astbin.h"
+#include "parser.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* ============================================================================
+ * FONTE E GRAMÁTICA
+ * ============================================================================ */
+
+static void grammar_digest(char digest[32]) {
+    Sha256 ctx;
+    const char* version = parser_grammar_version();
+    sha256_init(&ctx);
+    sha256_update(&ctx, version, strlen(version));
+    sha256_final(&ctx, (unsigned char*)digest);
+}
+
+/*
+ * hash_file(path, digest)
+ *
+ * SHA-256 do conteúdo do arquivo. Retorna 0 em caso de sucesso.
+ */
+static int hash_file(const char* path, unsigned char digest[SHA256_DIGEST_SIZE]) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        return -1;
+    }
+    Sha256 ctx;
+    sha256_init(&ctx);
+    char chunk[65536];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        sha256_update(&ctx, chunk, n);
+    }
+    int failed = ferror(file);
+    fclose(file);
+    sha256_final(&ctx, digest);
+    return failed ? -1 : 0;
+}
+
+static int stat_source(const char* path, int64_t* size, int64_t* mtime_ns) {
+    struct stat st;
+    if (stat(path, &st) != 0 || !S_ISREG(st.st_mode)) {
+        return -1;
+    }
+    *size = (int64_t)st.st_size;
+    *mtime_ns = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+    return 0;
+}
+
+int astbin_source_info(const char* source_path, AstBinSource* source) {
+    memset(source, 0, sizeof(*source));
+    if (stat_source(source_path, &source->size, &source->mtime_ns) != 0) {
+        return -1;
+    }
+    return hash_file(source_path, source->sha256);
+}
+
+/* ============================================================================
+ * GRAVAÇÃO
+ * ============================================================================ */
+
+typedef struct {
+    AstBinNode* nodes;
+    size_t node_count;
+    size_t node_capacity;
+    uint32_t* links;
+    size_t link_count;
+    size_t link_capacity;
+    char* strings;
+    size_t string_size;
+    size_t string_capacity;
+    uint32_t* slots;            /* Tabela hash aberta: deslocamento + 1, ou 0 se vazio */
+    size_t slot_count;
+    size_t text_count;
+} Writer;
+
+static void* grow(void* data, size_t* capacity, size_t needed, size_t item_size) {
+    if (needed <= *capacity) {
+        return data;
+    }
+    size_t new_capacity = *capacity ? *capacity : 1024;
+    while (new_capacity < needed) {
+        new_capacity *= 2;
+    }
+    data = realloc(data, new_capacity * item_size);
+    if (data == NULL) {
+        fprintf(stderr, "Erro fatal: Memória insuficiente para gravar a árvore.\n");
+        exit(1);
+    }
+    *capacity = new_capacity;
+    return data;
+}
+
+static unsigned int hash_text(const char* str) {
+    unsigned int hash_value = 2166136261u;
+    while (*str) {
+        hash_value = (hash_value ^ (unsigned char)*str++) * 16777619u;
+    }
+    return hash_value;
+}
+
+static void slot_insert(Writer* w, uint32_t offset) {
+    size_t mask = w->slot_count - 1;
+    size_t slot = hash_text(w->strings + offset) & mask;
+    while (w->slots[slot] != 0) {
+        slot = (slot + 1) & mask;
+    }
+    w->slots[slot] = offset + 1;
+}
+
+/*
+ * writer_text(w, text)
+ *
+ * Deslocamento do texto na seção de textos, acrescentando-o na primeira
+ * vez. A tabela hash fica no máximo meio cheia.
+ */
+static uint32_t writer_text(Writer* w, const char* text) {
+    if (text == NULL) {
+        return ASTBIN_NONE;
+    }
+    if (w->slot_count > 0) {
+        size_t mask = w->slot_count - 1;
+        size_t slot = hash_text(text) & mask;
+        while (w->slots[slot] != 0) {
+            uint32_t offset = w->slots[slot] - 1;
+            if (strcmp(w->strings + offset, text) == 0) {
+                return offset;
+            }
+            slot = (slot + 1) & mask;
+        }
+    }
+
+    size_t length = strlen(text) + 1;
+    w->strings = (char*)grow(w->strings, &w->string_capacity, w->string_size + length, 1);
+    uint32_t offset = (uint32_t)w->string_size;
+    memcpy(w->strings + offset, text, length);
+    w->string_size += length;
+    w->text_count++;
+
+    if (w->text_count * 2 > w->slot_count) {
+        w->slot_count = w->slot_count ? w->slot_count * 2 : 1024;
+        free(w->slots);
+        w->slots = (uint32_t*)calloc(w->slot_count, sizeof(uint32_t));
+        for (size_t pos = 0; pos < w->string_size; pos += strlen(w->strings + pos) + 1) {
+            slot_insert(w, (uint32_t)pos);
+        }
+    } else {
+        slot_insert(w, offset);
+    }
+    return offset;
+}
+
+/*
+ * token_length(node)
+ *
+ * Comprimento do token na posição do nó.
+ */
+static uint32_t token_length(const AstNode* node) {
+    switch (node->kind) {
+        case AST_ID:
+        case AST_NUM:
+        case AST_ASSIGN:
+        case AST_FCALL:
+            return node->name != NULL ? (uint32_t)strlen(node->name) : 0;
+        case AST_BINOP:
+            return (node->op == TOKEN_LTE || node->op == TOKEN_GTE ||
+                    node->op == TOKEN_EQ || node->op == TOKEN_NEQ) ? 2 : 1;
+        case AST_FDEF: return 3;
+        case AST_VARDECL: return 3;
+        case AST_PRINT: return 5;
+        case AST_RETURN: return 6;
+        case AST_IF: return 2;
+        case AST_BLOCK: return 1;
+        case AST_EMPTY: return 1;
+        default: return 0;
+    }
+}
+
+/*
+ * emit_node(w, node, parent)
+ *
+ * Grava o nó e sua subárvore em pré-ordem. Retorna o índice do nó.
+ */
+static uint32_t emit_node(Writer* w, const AstNode* node, uint32_t parent) {
+    uint32_t id = (uint32_t)w->node_count;
+    w->nodes = (AstBinNode*)grow(w->nodes, &w->node_capacity, w->node_count + 1, sizeof(AstBinNode));
+    w->node_count++;
+
+    uint32_t count = (uint32_t)(node->param_count + node->kid_count);
+    uint32_t links = (uint32_t)w->link_count;
+    w->links = (uint32_t*)grow(w->links, &w->link_capacity, w->link_count + count, sizeof(uint32_t));
+    w->link_count += count;
+
+    uint32_t end_line = (uint32_t)node->line;
+    uint32_t end_col = (uint32_t)node->col + token_length(node);
+    for (uint32_t i = 0; i < count; i++) {
+        const AstNode* child = i < (uint32_t)node->param_count
+                                   ? node->params[i] : node->kids[i - node->param_count];
+        uint32_t child_id = emit_node(w, child, id);
+        const AstBinNode* bin = &w->nodes[child_id];
+        w->links[links + i] = child_id;
+        if (bin->end_line > end_line || (bin->end_line == end_line && bin->end_col > end_col)) {
+            end_line = bin->end_line;
+            end_col = bin->end_col;
+        }
+    }
+
+    AstBinNode* out = &w->nodes[id];
+    memset(out, 0, sizeof(*out));
+    out->kind = (uint8_t)node->kind;
+    out->op = (uint8_t)node->op;
+    out->name = writer_text(w, node->name);
+    out->parent = parent;
+    out->links = links;
+    out->param_count = (uint32_t)node->param_count;
+    out->kid_count = (uint32_t)node->kid_count;
+    out->line = (uint32_t)node->line;
+    out->col = (uint32_t)node->col;
+    out->end_line = end_line;
+    out->end_col = end_col;
+    out->value = node->kind == AST_NUM ? node->value : 0;
+    return id;
+}
+
+/*
+ * astbin_write(path, program, source)
+ *
+ * Os erros de escrita são impressos em stderr.
+ */
+int astbin_write(const char* path, const AstNode* program, const AstBinSource* source) {
+    Writer w = {0};
+    emit_node(&w, program, ASTBIN_NONE);
+
+    int status = -1;
+    if (w.node_count >= ASTBIN_NONE || w.link_count >= ASTBIN_NONE ||
+        w.string_size >= ASTBIN_NONE) {
+        fprintf(stderr, "Erro ao gravar a árvore '%s': árvore grande demais\n", path);
+        goto done;
+    }
+
+    AstBinHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ASTBIN_MAGIC, 8);
+    header.version = ASTBIN_VERSION;
+    header.node_size = sizeof(AstBinNode);
+    grammar_digest(header.grammar);
+    memcpy(header.source_sha256, source->sha256, SHA256_DIGEST_SIZE);
+    header.source_size = source->size;
+    header.source_mtime_ns = source->mtime_ns;
+    header.node_count = (uint32_t)w.node_count;
+    header.link_count = (uint32_t)w.link_count;
+    header.string_size = (uint32_t)w.string_size;
+
+    size_t tmp_size = strlen(path) + 32;
+    char* tmp = (char*)malloc(tmp_size);
+    snprintf(tmp, tmp_size, "%s.tmp.%d", path, (int)getpid());
+    FILE* out = fopen(tmp, "wb");
+    if (out != NULL) {
+        fwrite(&header, sizeof(header), 1, out);
+        fwrite(w.nodes, sizeof(AstBinNode), w.node_count, out);
+        fwrite(w.links, sizeof(uint32_t), w.link_count, out);
+        fwrite(w.strings, 1, w.string_size, out);
+        int failed = ferror(out);
+        if (fclose(out) == 0 && !failed && rename(tmp, path) == 0) {
+            status = 0;
+        } else {
+            remove(tmp);
+        }
+    }
+    if (status != 0) {
+        fprintf(stderr, "Erro ao gravar a árvore '%s': %s\n", path, strerror(errno));
+    }
+    free(tmp);
+
+done:
+    free(w.nodes);
+    free(w.links);
+    free(w.strings);
+    free(w.slots);
+    return status;
+}
+
+/* ============================================================================
+ * LEITURA
+ * ============================================================================ */
+
+/*
+ * source_is_current(header, source_path)
+ *
+ * Confere se o fonte ainda é o que foi analisado.
+ */
+static int source_is_current(const AstBinHeader* header, const char* source_path) {
+    int64_t size;
+    int64_t mtime_ns;
+    if (stat_source(source_path, &size, &mtime_ns) != 0 || size != header->source_size) {
+        return 0;
+    }
+    if (mtime_ns == header->source_mtime_ns) {
+        return 1;
+    }
+    unsigned char digest[SHA256_DIGEST_SIZE];
+    return hash_file(source_path, digest) == 0 &&
+           memcmp(digest, header->source_sha256, SHA256_DIGEST_SIZE) == 0;
+}
+
+/*
+ * astbin_open(file, path, source_path)
+ *
+ * Retorna ASTBIN_OK, ASTBIN_INVALID ou ASTBIN_STALE; nos dois últimos
+ * casos nada fica mapeado.
+ */
+int astbin_open(AstBinFile* file, const char* path, const char* source_path) {
+    memset(file, 0, sizeof(*file));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return ASTBIN_INVALID;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(AstBinHeader)) {
+        close(fd);
+        return ASTBIN_INVALID;
+    }
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return ASTBIN_INVALID;
+    }
+    file->data = data;
+    file->size = (size_t)st.st_size;
+
+    const AstBinHeader* header = (const AstBinHeader*)data;
+    size_t expected = sizeof(AstBinHeader) +
+                      (size_t)header->node_count * sizeof(AstBinNode) +
+                      (size_t)header->link_count * sizeof(uint32_t) +
+                      header->string_size;
+    if (memcmp(header->magic, ASTBIN_MAGIC, 8) != 0 || header->version != ASTBIN_VERSION ||
+        header->node_size != sizeof(AstBinNode) || header->node_count == 0 ||
+        expected != file->size ||
+        (header->string_size > 0 && ((const char*)data)[file->size - 1] != '\0')) {
+        astbin_close(file);
+        return ASTBIN_INVALID;
+    }
+
+    char grammar[32];
+    grammar_digest(grammar);
+    if (memcmp(header->grammar, grammar, sizeof(grammar)) != 0 ||
+        (source_path != NULL && !source_is_current(header, source_path))) {
+        astbin_close(file);
+        return ASTBIN_STALE;
+    }
+
+    file->header = header;
+    file->nodes = (const AstBinNode*)(header + 1);
+    file->links = (const uint32_t*)(file->nodes + header->node_count);
+    file->strings = (const char*)(file->links + header->link_count);
+    return ASTBIN_OK;
+}
+
+void astbin_close(AstBinFile* file) {
+    if (file->data != NULL) {
+        munmap(file->data, file->size);
+    }
+    memset(file, 0, sizeof(*file));
+}
+
+int astbin_verify(const AstBinFile* file) {
+    const AstBinHeader* header = file->header;
+    if (file->nodes[0].kind != AST_PROGRAM || file->nodes[0].parent != ASTBIN_NONE) {
+        return -1;
+    }
+    for (uint32_t i = 0; i < header->node_count; i++) {
+        const AstBinNode* node = &file->nodes[i];
+        uint64_t last = (uint64_t)node->links + node->param_count + node->kid_count;
+        if (node->kind >= AST_MARK || last > header->link_count ||
+            (node->name != ASTBIN_NONE && node->name >= header->string_size)) {
+            return -1;
+        }
+        for (uint64_t k = node->links; k < last; k++) {
+            uint32_t child = file->links[k];
+            if (child <= i || child >= header->node_count || file->nodes[child].parent != i) {
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+/*
+ * astbin_print(file, index, depth)
+ *
+ * Mesma saída de ast_print() para a árvore original.
+ */
+void astbin_print(const AstBinFile* file, uint32_t index, int depth) {
+    const AstBinNode* node = astbin_node(file, index);
+    printf("%*s%s", depth * 2, "", ast_kind_to_string((AstKind)node->kind));
+    if (node->kind == AST_BINOP) {
+        printf(" %s", token_type_to_string((TokenType)node->op));
+    }
+    if (node->name != ASTBIN_NONE) {
+        printf(" '%s'", astbin_name(file, node));
+    }
+    printf(" [%u:%u]\n", node->line, node->col);
+
+    for (uint32_t i = 0; i < node->param_count; i++) {
+        const AstBinNode* param = astbin_param(file, node, i);
+        printf("%*sparam", (depth + 1) * 2, "");
+        printf(" '%s' [%u:%u]\n", astbin_name(file, param), param->line, param->col);
+    }
+    for (uint32_t i = 0; i < node->kid_count; i++) {
+        astbin_print(file, file->links[node->links + node->param_count + i], depth + 1);
+    }
+}
@@ -0,0 +1,157 @@
+/*
+ * ============================================================================
+ * HEADER DA ÁRVORE SINTÁTICA EM FORMATO BINÁRIO
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * Grava a árvore de um programa em um arquivo sem ponteiros, que outros
+ * processos abrem com mmap e percorrem diretamente, sem reconstruir os
+ * AstNode e sem alocar memória. Todas as referências são índices ou
+ * deslocamentos relativos ao início de cada seção.
+ *
+ * Formato (inteiros na ordem da máquina):
+ *   AstBinHeader
+ *   AstBinNode[node_count]   em pré-ordem; o nó 0 é AST_PROGRAM
+ *   uint32_t[link_count]     filhos de cada nó: parâmetros e depois kids
+ *   textos terminados por '\0', sem repetição
+ *
+ * Como os textos não se repetem, o deslocamento do nome identifica o
+ * símbolo dentro do arquivo (os números de AstNode.value valem só no
+ * processo que analisou). O cabeçalho guarda o tamanho, a data de
+ * modificação e o SHA-256 do fonte, para que arquivos desatualizados
+ * sejam recusados.
+ *
+ * */
+
+#ifndef ASTBIN_H
+#define ASTBIN_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ast.h"
+#include "sha256.h"
+
+#define ASTBIN_MAGIC "LSIAST01"
+#define ASTBIN_VERSION 1
+#define ASTBIN_NONE UINT32_MAX
+
+/* Resultados de astbin_open() */
+#define ASTBIN_OK 0
+#define ASTBIN_INVALID 1        /* Não existe, não é um arquivo de árvore ou está truncado */
+#define ASTBIN_STALE 2          /* Outra gramática, ou o fonte mudou */
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t node_size;         /* sizeof(AstBinNode) */
+    char grammar[32];           /* SHA-256 de parser_grammar_version() */
+    unsigned char source_sha256[SHA256_DIGEST_SIZE];
+    int64_t source_size;
+    int64_t source_mtime_ns;
+    uint32_t node_count;
+    uint32_t link_count;
+    uint32_t string_size;
+    uint32_t reserved;
+} AstBinHeader;
+
+/*
+ * Um nó. O trecho do fonte coberto vai de (line, col) até (end_line,
+ * end_col), exclusivo, que é o fim do último token da subárvore; em
+ * AST_BINOP, (line, col) é o operador e o trecho começa no operando
+ * esquerdo (astbin_span_start()). Delimitadores que não geram nós, como
+ * ")" e "}", não entram no trecho.
+ */
+typedef struct {
+    uint8_t kind;               /* AstKind */
+    uint8_t op;                 /* TokenType de AST_BINOP */
+    uint16_t reserved;
+    uint32_t name;              /* Deslocamento nos textos, ou ASTBIN_NONE */
+    uint32_t parent;            /* ASTBIN_NONE na raiz */
+    uint32_t links;             /* Primeiro filho em links */
+    uint32_t param_count;
+    uint32_t kid_count;
+    uint32_t line;
+    uint32_t col;
+    uint32_t end_line;
+    uint32_t end_col;
+    int64_t value;              /* Valor de AST_NUM; 0 nos demais */
+} AstBinNode;
+
+typedef struct {
+    int64_t size;
+    int64_t mtime_ns;
+    unsigned char sha256[SHA256_DIGEST_SIZE];
+} AstBinSource;
+
+typedef struct {
+    void* data;
+    size_t size;
+    const AstBinHeader* header;
+    const AstBinNode* nodes;
+    const uint32_t* links;
+    const char* strings;
+} AstBinFile;
+
+/*
+ * Lê tamanho, data de modificação e SHA-256 do fonte. Deve ser chamada
+ * antes de analisá-lo, para que uma mudança durante a análise torne o
+ * arquivo gravado desatualizado em vez de escondê-la. Retorna 0 em caso
+ * de sucesso.
+ */
+int astbin_source_info(const char* source_path, AstBinSource* source);
+
+/*
+ * Grava a árvore em path, por meio de um temporário renomeado no final.
+ * Retorna 0 em caso de sucesso.
+ */
+int astbin_write(const char* path, const AstNode* program, const AstBinSource* source);
+
+/*
+ * Mapeia o arquivo e confere cabeçalho, tamanhos e versão da gramática.
+ * Com source_path, confere também que o fonte é o mesmo: tamanho e data
+ * iguais bastam; se só a data mudou, o SHA-256 do conteúdo decide. Os
+ * nós não são percorridos (veja astbin_verify()).
+ */
+int astbin_open(AstBinFile* file, const char* path, const char* source_path);
+void astbin_close(AstBinFile* file);
+
+/*
+ * Confere todos os nós: tipos, nomes e filhos dentro dos limites, cada
+ * filho depois do pai na pré-ordem e apontando de volta para ele. Depois
+ * disso, percorrer a árvore pelos filhos sempre termina. Para arquivos
+ * de origem não confiável. Retorna 0 se a árvore é válida.
+ */
+int astbin_verify(const AstBinFile* file);
+
+/* Imprime a subárvore no mesmo formato de ast_print() */
+void astbin_print(const AstBinFile* file, uint32_t index, int depth);
+
+static inline const AstBinNode* astbin_node(const AstBinFile* file, uint32_t index) {
+    return &file->nodes[index];
+}
+
+static inline const AstBinNode* astbin_kid(const AstBinFile* file, const AstBinNode* node, uint32_t i) {
+    return &file->nodes[file->links[node->links + node->param_count + i]];
+}
+
+static inline const AstBinNode* astbin_param(const AstBinFile* file, const AstBinNode* node, uint32_t i) {
+    return &file->nodes[file->links[node->links + i]];
+}
+
+/* Nome do nó, ou NULL */
+static inline const char* astbin_name(const AstBinFile* file, const AstBinNode* node) {
+    return node->name == ASTBIN_NONE ? NULL : file->strings + node->name;
+}
+
+/* Início do trecho do fonte coberto pelo nó */
+static inline void astbin_span_start(const AstBinFile* file, const AstBinNode* node,
+                                     uint32_t* line, uint32_t* col) {
+    while (node->kind == AST_BINOP && node->kid_count > 0) {
+        node = astbin_kid(file, node, 0);
+    }
+    *line = node->line;
+    *col = node->col;
+}
+
+#endif
@@ -0,0 +1,466 @@
+/*
+ * ============================================================================
+ * GRAFO DE CHAMADAS PARA A LINGUAGEM LSI-2025-2
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * As chamadas (AST_FCALL) são resolvidas pela tabela de funções ordenada
+ * por nome; um nome definido mais de uma vez resolve para uma só das
+ * definições, como nos demais módulos. Os componentes são encontrados pelo
+ * algoritmo de Tarjan, com pilha explícita para que cadeias longas de
+ * chamadas não esgotem a pilha do processo.
+ *
+ * ============================================================================
+ */
+
+#include "callgraph.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * checked_alloc(size)
+ *
+ * calloc que encerra o processo se a memória acabar.
+ */
+static void* checked_alloc(size_t size) {
+    void* memory = calloc(1, size ? size : 1);
+    if (memory == NULL) {
+        fprintf(stderr, "Erro fatal: Memória insuficiente para o grafo de chamadas.\n");
+        exit(1);
+    }
+    return memory;
+}
+
+/* ============================================================================
+ * ARESTAS
+ * ============================================================================ */
+
+typedef struct {
+    CallGraph* graph;
+    AstFunctionTable table;
+    int* index_of_sorted;       /* Posição em table.fdefs -> número da função */
+    int* last_caller;           /* Por função: último chamador registrado + 1 */
+    int capacity;
+} EdgeBuilder;
+
+static void add_callee(EdgeBuilder* builder, int caller, int callee) {
+    CallGraph* graph = builder->graph;
+    if (builder->last_caller[callee] == caller + 1) {
+        return;                 /* Aresta repetida */
+    }
+    builder->last_caller[callee] = caller + 1;
+
+    if (graph->call_count == builder->capacity) {
+        builder->capacity = builder->capacity ? builder->capacity * 2 : 64;
+        graph->callees = (int*)realloc(graph->callees, sizeof(int) * (size_t)builder->capacity);
+        if (graph->callees == NULL) {
+            fprintf(stderr, "Erro fatal: Memória insuficiente para o grafo de chamadas.\n");
+            exit(1);
+        }
+    }
+    graph->callees[graph->call_count++] = callee;
+    if (callee != caller) {
+        graph->caller_count[callee]++;
+    }
+}
+
+/*
+ * collect_calls(builder, caller, stmt)
+ *
+ * Registra as funções chamadas no comando. Uma chamada só aparece como
+ * lado direito de uma atribuição, então as expressões não são visitadas.
+ */
+static void collect_calls(EdgeBuilder* builder, int caller, const AstNode* stmt) {
+    switch (stmt->kind) {
+        case AST_ASSIGN:
+            if (stmt->kids[0]->kind == AST_FCALL) {
+                int sorted = ast_function_index(&builder->table, stmt->kids[0]->name);
+                if (sorted < 0) {
+                    builder->graph->unresolved_calls++;
+                } else {
+                    add_callee(builder, caller, builder->index_of_sorted[sorted]);
+                }
+            }
+            return;
+
+        case AST_IF:
+        case AST_BLOCK:
+            for (int i = stmt->kind == AST_IF ? 1 : 0; i < stmt->kid_count; i++) {
+                collect_calls(builder, caller, stmt->kids[i]);
+            }
+            return;
+
+        default:
+            return;
+    }
+}
+
+/* ============================================================================
+ * COMPONENTES FORTEMENTE CONEXOS (TARJAN)
+ * ============================================================================ */
+
+static int compare_ints(const void* a, const void* b) {
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+/*
+ * find_components(graph)
+ *
+ * Tarjan emite cada componente depois de todos os que ele alcança, o que
+ * já é a ordem das chamadas para os chamadores. Os membros de cada
+ * componente ficam na ordem do programa.
+ */
+static void find_components(CallGraph* graph) {
+    int n = graph->count;
+    int* index = (int*)checked_alloc(sizeof(int) * (size_t)n);     /* Ordem de visita + 1 */
+    int* low = (int*)checked_alloc(sizeof(int) * (size_t)n);
+    char* on_stack = (char*)checked_alloc((size_t)n);
+    int* stack = (int*)checked_alloc(sizeof(int) * (size_t)n);      /* Pilha de Tarjan */
+    int* call_stack = (int*)checked_alloc(sizeof(int) * (size_t)n); /* Pilha da busca */
+    int* next_edge = (int*)checked_alloc(sizeof(int) * (size_t)n);
+    int stack_top = 0;
+    int counter = 0;
+    int placed = 0;
+
+    graph->scc_of = (int*)checked_alloc(sizeof(int) * (size_t)n);
+    graph->scc_members = (int*)checked_alloc(sizeof(int) * (size_t)n);
+    graph->scc_start = (int*)checked_alloc(sizeof(int) * (size_t)(n + 1));
+    graph->recursive = (char*)checked_alloc((size_t)(n ? n : 1));
+
+    for (int root = 0; root < n; root++) {
+        if (index[root] != 0) {
+            continue;
+        }
+        int depth = 0;
+        call_stack[depth++] = root;
+        index[root] = low[root] = ++counter;
+        next_edge[root] = graph->call_start[root];
+        stack[stack_top++] = root;
+        on_stack[root] = 1;
+
+        while (depth > 0) {
+            int f = call_stack[depth - 1];
+            if (next_edge[f] < graph->call_start[f + 1]) {
+                int g = graph->callees[next_edge[f]++];
+                if (index[g] == 0) {
+                    index[g] = low[g] = ++counter;
+                    next_edge[g] = graph->call_start[g];
+                    stack[stack_top++] = g;
+                    on_stack[g] = 1;
+                    call_stack[depth++] = g;
+                } else if (on_stack[g] && index[g] < low[f]) {
+                    low[f] = index[g];
+                }
+                continue;
+            }
+
+            depth--;
+            if (depth > 0 && low[f] < low[call_stack[depth - 1]]) {
+                low[call_stack[depth - 1]] = low[f];
+            }
+            if (low[f] != index[f]) {
+                continue;
+            }
+
+            /* f é a raiz de um componente: desempilha seus membros */
+            int scc = graph->scc_count++;
+            graph->scc_start[scc] = placed;
+            int member;
+            do {
+                member = stack[--stack_top];
+                on_stack[member] = 0;
+                graph->scc_of[member] = scc;
+                graph->scc_members[placed++] = member;
+            } while (member != f);
+            graph->recursive[scc] = placed - graph->scc_start[scc] > 1;
+            qsort(graph->scc_members + graph->scc_start[scc],
+                  (size_t)(placed - graph->scc_start[scc]), sizeof(int), compare_ints);
+        }
+    }
+    graph->scc_start[graph->scc_count] = placed;
+
+    /* Componentes de um só membro são recursivos se a função chama a si mesma */
+    for (int f = 0; f < n; f++) {
+        for (int e = graph->call_start[f]; e < graph->call_start[f + 1]; e++) {
+            if (graph->callees[e] == f) {
+                graph->recursive[graph->scc_of[f]] = 1;
+            }
+        }
+    }
+
+    free(index);
+    free(low);
+    free(on_stack);
+    free(stack);
+    free(call_stack);
+    free(next_edge);
+}
+
+/*
+ * mark_reachable(graph)
+ *
+ * Marca as funções alcançáveis a partir do ponto de entrada.
+ */
+static void mark_reachable(CallGraph* graph) {
+    graph->reachable = (char*)checked_alloc((size_t)(graph->count ? graph->count : 1));
+    if (graph->entry < 0) {
+        return;
+    }
+    int* pending = (int*)checked_alloc(sizeof(int) * (size_t)graph->count);
+    int top = 0;
+    pending[top++] = graph->entry;
+    graph->reachable[graph->entry] = 1;
+    while (top > 0) {
+        int f = pending[--top];
+        for (int e = graph->call_start[f]; e < graph->call_start[f + 1]; e++) {
+            int g = graph->callees[e];
+            if (!graph->reachable[g]) {
+                graph->reachable[g] = 1;
+                pending[top++] = g;
+            }
+        }
+    }
+    free(pending);
+}
+
+/*
+ * callgraph_build(program, graph)
+ *
+ * Numera as funções, resolve as chamadas de cada corpo e calcula os
+ * componentes e as funções alcançáveis.
+ */
+void callgraph_build(const AstNode* program, CallGraph* graph) {
+    memset(graph, 0, sizeof(CallGraph));
+    graph->entry = -1;
+
+    graph->fdefs = (const AstNode**)checked_alloc(sizeof(AstNode*) *
+                                                  (size_t)(program->kid_count + 1));
+    for (int i = 0; i < program->kid_count; i++) {
+        if (program->kids[i]->kind == AST_FDEF) {
+            graph->fdefs[graph->count++] = program->kids[i];
+        }
+    }
+
+    int n = graph->count;
+    EdgeBuilder builder = {graph, {NULL, 0}, NULL, NULL, 0};
+    ast_function_table_build(program, &builder.table);
+    builder.index_of_sorted = (int*)checked_alloc(sizeof(int) * (size_t)(n ? n : 1));
+    builder.last_caller = (int*)checked_alloc(sizeof(int) * (size_t)(n ? n : 1));
+    for (int i = 0; i < n; i++) {
+        builder.index_of_sorted[i] = -1;
+    }
+    const AstNode* entry = ast_entry_function(program);
+    for (int f = n - 1; f >= 0; f--) {      /* De trás para a frente: a primeira definição vence */
+        builder.index_of_sorted[ast_function_index(&builder.table, graph->fdefs[f]->name)] = f;
+        if (graph->fdefs[f] == entry) {
+            graph->entry = f;
+        }
+    }
+
+    graph->call_start = (int*)checked_alloc(sizeof(int) * (size_t)(n + 1));
+    graph->caller_count = (int*)checked_alloc(sizeof(int) * (size_t)(n ? n : 1));
+    for (int f = 0; f < n; f++) {
+        graph->call_start[f] = graph->call_count;
+        for (int i = 0; i < graph->fdefs[f]->kid_count; i++) {
+            collect_calls(&builder, f, graph->fdefs[f]->kids[i]);
+        }
+    }
+    graph->call_start[n] = graph->call_count;
+
+    ast_function_table_free(&builder.table);
+    free(builder.index_of_sorted);
+    free(builder.last_caller);
+
+    find_components(graph);
+    mark_reachable(graph);
+}
+
+void callgraph_free(CallGraph* graph) {
+    free(graph->fdefs);
+    free(graph->call_start);
+    free(graph->callees);
+    free(graph->scc_of);
+    free(graph->scc_start);
+    free(graph->scc_members);
+    free(graph->recursive);
+    free(graph->reachable);
+    free(graph->caller_count);
+    memset(graph, 0, sizeof(CallGraph));
+}
+
+/* ============================================================================
+ * ESCALONAMENTO DAS ANÁLISES
+ * ============================================================================ */
+
+/*
+ * Estado compartilhado pelas threads. Um componente fica pronto quando
+ * pending chega a zero, isto é, quando terminaram todos os componentes
+ * que ele chama; os chamadores de cada componente ficam em caller_list.
+ */
+typedef struct {
+    const CallGraph* graph;
+    CallGraphTask task;
+    void* context;
+    int* pending;
+    int* caller_start;
+    int* caller_list;
+    int* ready;                 /* Fila de componentes prontos */
+    int ready_head;
+    int ready_tail;
+    int done;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+} Schedule;
+
+/*
+ * build_dependencies(schedule)
+ *
+ * Conta, para cada componente, os componentes distintos que ele chama e
+ * lista, para cada um, os componentes que o chamam.
+ */
+static void build_dependencies(Schedule* schedule) {
+    const CallGraph* graph = schedule->graph;
+    int sccs = graph->scc_count;
+    int* seen = (int*)checked_alloc(sizeof(int) * (size_t)(sccs ? sccs : 1));  /* Chamador + 1 */
+    int* edges = (int*)checked_alloc(sizeof(int) * (size_t)(graph->call_count ? graph->call_count : 1));
+    int* edge_from = (int*)checked_alloc(sizeof(int) * (size_t)(graph->call_count ? graph->call_count : 1));
+    int edge_count = 0;
+
+    schedule->pending = (int*)checked_alloc(sizeof(int) * (size_t)(sccs ? sccs : 1));
+    schedule->caller_start = (int*)checked_alloc(sizeof(int) * (size_t)(sccs + 1));
+
+    for (int c = 0; c < sccs; c++) {
+        for (int m = graph->scc_start[c]; m < graph->scc_start[c + 1]; m++) {
+            int f = graph->scc_members[m];
+            for (int e = graph->call_start[f]; e < graph->call_start[f + 1]; e++) {
+                int callee = graph->scc_of[graph->callees[e]];
+                if (callee == c || seen[callee] == c + 1) {
+                    continue;
+                }
+                seen[callee] = c + 1;
+                schedule->pending[c]++;
+                schedule->caller_start[callee + 1]++;
+                edge_from[edge_count] = c;
+                edges[edge_count++] = callee;
+            }
+        }
+    }
+    for (int c = 0; c < sccs; c++) {
+        schedule->caller_start[c + 1] += schedule->caller_start[c];
+    }
+
+    int* fill = (int*)checked_alloc(sizeof(int) * (size_t)(sccs ? sccs : 1));
+    schedule->caller_list = (int*)checked_alloc(sizeof(int) * (size_t)(edge_count ? edge_count : 1));
+    for (int i = 0; i < edge_count; i++) {
+        int callee = edges[i];
+        schedule->caller_list[schedule->caller_start[callee] + fill[callee]++] = edge_from[i];
+    }
+
+    free(seen);
+    free(edges);
+    free(edge_from);
+    free(fill);
+}
+
+/*
+ * schedule_worker(arg)
+ *
+ * Retira componentes prontos da fila até que todos tenham terminado.
+ * Ao terminar um componente, libera os chamadores que só esperavam por
+ * ele.
+ */
+static void* schedule_worker(void* arg) {
+    Schedule* schedule = (Schedule*)arg;
+    int total = schedule->graph->scc_count;
+
+    pthread_mutex_lock(&schedule->lock);
+    for (;;) {
+        while (schedule->ready_head == schedule->ready_tail && schedule->done < total) {
+            pthread_cond_wait(&schedule->wake, &schedule->lock);
+        }
+        if (schedule->ready_head == schedule->ready_tail) {
+            break;
+        }
+        int scc = schedule->ready[schedule->ready_head++];
+        pthread_mutex_unlock(&schedule->lock);
+
+        schedule->task(schedule->graph, scc, schedule->context);
+
+        pthread_mutex_lock(&schedule->lock);
+        schedule->done++;
+        int released = 0;
+        for (int i = schedule->caller_start[scc]; i < schedule->caller_start[scc + 1]; i++) {
+            int caller = schedule->caller_list[i];
+            if (--schedule->pending[caller] == 0) {
+                schedule->ready[schedule->ready_tail++] = caller;
+                released++;
+            }
+        }
+        if (schedule->done == total) {
+            pthread_cond_broadcast(&schedule->wake);
+        } else if (released > 1) {
+            pthread_cond_broadcast(&schedule->wake);
+        } else if (released == 1) {
+            pthread_cond_signal(&schedule->wake);
+        }
+    }
+    pthread_mutex_unlock(&schedule->lock);
+    return NULL;
+}
+
+/*
+ * callgraph_schedule(graph, thread_count, task, context)
+ *
+ * Com uma thread, a própria numeração dos componentes já é uma ordem
+ * válida. Com mais, os componentes sem dependências pendentes ficam numa
+ * fila única protegida por um mutex; cada componente entra nela uma só
+ * vez, de modo que a fila é um vetor sem reaproveitamento de posições.
+ */
+void callgraph_schedule(const CallGraph* graph, int thread_count,
+                        CallGraphTask task, void* context) {
+    if (thread_count <= 1 || graph->scc_count <= 1) {
+        for (int c = 0; c < graph->scc_count; c++) {
+            task(graph, c, context);
+        }
+        return;
+    }
+
+    Schedule schedule;
+    memset(&schedule, 0, sizeof(Schedule));
+    schedule.graph = graph;
+    schedule.task = task;
+    schedule.context = context;
+    build_dependencies(&schedule);
+    schedule.ready = (int*)checked_alloc(sizeof(int) * (size_t)graph->scc_count);
+    for (int c = 0; c < graph->scc_count; c++) {
+        if (schedule.pending[c] == 0) {
+            schedule.ready[schedule.ready_tail++] = c;
+        }
+    }
+    pthread_mutex_init(&schedule.lock, NULL);
+    pthread_cond_init(&schedule.wake, NULL);
+
+    pthread_t* threads = (pthread_t*)checked_alloc(sizeof(pthread_t) * (size_t)thread_count);
+    for (int i = 0; i < thread_count; i++) {
+        if (pthread_create(&threads[i], NULL, schedule_worker, &schedule) != 0) {
+            fprintf(stderr, "Erro fatal: Não foi possível criar as threads de análise.\n");
+            exit(1);
+        }
+    }
+    for (int i = 0; i < thread_count; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    pthread_mutex_destroy(&schedule.lock);
+    pthread_cond_destroy(&schedule.wake);
+    free(threads);
+    free(schedule.ready);
+    free(schedule.pending);
+    free(schedule.caller_start);
+    free(schedule.caller_list);
+}
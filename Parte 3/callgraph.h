@@ -0,0 +1,57 @@
+/*
+ * ============================================================================
+ * HEADER DO GRAFO DE CHAMADAS PARA A LINGUAGEM LSI-2025-2
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * As funções são numeradas na ordem em que aparecem no programa. Os
+ * componentes fortemente conexos (funções mutuamente recursivas) são
+ * numerados das chamadas para os chamadores: um componente só chama
+ * componentes de número menor ou a si mesmo.
+ *
+ * callgraph_schedule() executa uma tarefa por componente num conjunto de
+ * threads, começando um componente só depois de terminados todos os que
+ * ele chama, de modo que os resumos das funções chamadas estão prontos
+ * quando o chamador é analisado.
+ *
+ * */
+
+#ifndef CALLGRAPH_H
+#define CALLGRAPH_H
+
+#include "ast.h"
+
+typedef struct {
+    const AstNode** fdefs;      /* Funções na ordem do programa */
+    int count;
+    int* call_start;            /* Chamadas de f: callees[call_start[f] .. call_start[f + 1]) */
+    int* callees;               /* Sem repetição, na ordem da primeira chamada */
+    int call_count;             /* Arestas distintas */
+    int unresolved_calls;       /* Chamadas a funções não definidas (ignoradas) */
+    int* scc_of;                /* Por função: componente */
+    int* scc_start;             /* Membros de c: scc_members[scc_start[c] .. scc_start[c + 1]) */
+    int* scc_members;
+    int scc_count;
+    char* recursive;            /* Por componente: mais de um membro ou chamada a si mesmo */
+    int entry;                  /* Função de ast_entry_function(), ou -1 */
+    char* reachable;            /* Por função: alcançável a partir de entry */
+    int* caller_count;          /* Por função: chamadores distintos (além dela mesma) */
+} CallGraph;
+
+/* Tarefa de um componente; context é o mesmo para todas as chamadas */
+typedef void (*CallGraphTask)(const CallGraph* graph, int scc, void* context);
+
+/* Monta o grafo do programa (vazio para programas de um único comando) */
+void callgraph_build(const AstNode* program, CallGraph* graph);
+void callgraph_free(CallGraph* graph);
+
+/*
+ * Executa task uma vez por componente com thread_count threads (ou na
+ * thread atual, se thread_count <= 1), em uma ordem compatível com as
+ * chamadas. Retorna depois que todas as tarefas terminaram.
+ */
+void callgraph_schedule(const CallGraph* graph, int thread_count,
+                        CallGraphTask task, void* context);
+
+#endif
@@ -0,0 +1,400 @@
+/*
+ * ============================================================================
+ * GERADOR DE CÓDIGO C PARA A LINGUAGEM LSI-2025-2
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * Este módulo traduz a árvore sintática para uma unidade de tradução C
+ * autocontida, pronta para ser compilada com "gcc -O2":
+ *   - Uma função C por FDEF (prefixo lsi_f_), com parâmetros e locais int64_t
+ *   - Variáveis locais promovidas ao escopo da função e iniciadas com 0
+ *   - print mapeado para um escritor com buffer (uma chamada write por 64 KiB)
+ *   - Aritmética com wraparound em 64 bits e divisão por zero verificada
+ *   - Uma função main que chama o ponto de entrada do programa
+ *
+ * O ponto de entrada é a função "principal", senão "main", senão a última
+ * função definida. Seus parâmetros são lidos da linha de comando do
+ * executável gerado (ausentes valem 0). Programas formados por um único
+ * comando são traduzidos para a função lsi_programa.
+ *
+ * ============================================================================
+ */
+
+#include "codegen_c.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ============================================================================
+ * CONTEXTO DA TRADUÇÃO
+ * ============================================================================ */
+
+typedef struct {
+    FILE* out;
+    AstFunctionTable functions;
+    AstLocals locals;       /* Da função em tradução */
+    int failed;
+} CodegenC;
+
+/*
+ * codegen_error(ctx, node, message)
+ *
+ * Reporta um programa que não pode ser traduzido. Apenas o primeiro erro
+ * é mostrado.
+ */
+static void codegen_error(CodegenC* ctx, const AstNode* node, const char* message) {
+    if (ctx->failed) {
+        return;
+    }
+    fprintf(stderr, "\n--- Erro de Geração de Código ---\n");
+    fprintf(stderr, "%s na linha %d, coluna %d\n", message, node->line, node->col);
+    ctx->failed = 1;
+}
+
+/* ============================================================================
+ * RUNTIME EMBUTIDO NO CÓDIGO GERADO
+ * ============================================================================ */
+
+static const char* runtime_source =
+    "#include <stdint.h>\n"
+    "#include <stdio.h>\n"
+    "#include <stdlib.h>\n"
+    "#include <unistd.h>\n"
+    "\n"
+    "#define LSI_UNUSED __attribute__((unused))\n"
+    "\n"
+    "static char lsi_out[1 << 16];\n"
+    "static size_t lsi_out_len = 0;\n"
+    "\n"
+    "static void lsi_flush(void) {\n"
+    "    size_t done = 0;\n"
+    "    while (done < lsi_out_len) {\n"
+    "        ssize_t n = write(1, lsi_out + done, lsi_out_len - done);\n"
+    "        if (n <= 0) {\n"
+    "            break;\n"
+    "        }\n"
+    "        done += (size_t)n;\n"
+    "    }\n"
+    "    lsi_out_len = 0;\n"
+    "}\n"
+    "\n"
+    "static void lsi_print(int64_t value) {\n"
+    "    char digits[24];\n"
+    "    int n = 0;\n"
+    "    uint64_t u = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;\n"
+    "    if (lsi_out_len + 24 > sizeof(lsi_out)) {\n"
+    "        lsi_flush();\n"
+    "    }\n"
+    "    do {\n"
+    "        digits[n++] = (char)('0' + u % 10);\n"
+    "        u /= 10;\n"
+    "    } while (u != 0);\n"
+    "    if (value < 0) {\n"
+    "        lsi_out[lsi_out_len++] = '-';\n"
+    "    }\n"
+    "    while (n > 0) {\n"
+    "        lsi_out[lsi_out_len++] = digits[--n];\n"
+    "    }\n"
+    "    lsi_out[lsi_out_len++] = '\\n';\n"
+    "}\n"
+    "\n"
+    "static inline int64_t lsi_add(int64_t a, int64_t b) {\n"
+    "    return (int64_t)((uint64_t)a + (uint64_t)b);\n"
+    "}\n"
+    "\n"
+    "static inline int64_t lsi_sub(int64_t a, int64_t b) {\n"
+    "    return (int64_t)((uint64_t)a - (uint64_t)b);\n"
+    "}\n"
+    "\n"
+    "static inline int64_t lsi_mul(int64_t a, int64_t b) {\n"
+    "    return (int64_t)((uint64_t)a * (uint64_t)b);\n"
+    "}\n"
+    "\n"
+    "LSI_UNUSED static int64_t lsi_div(int64_t a, int64_t b, int line, int col) {\n"
+    "    if (b == 0) {\n"
+    "        lsi_flush();\n"
+    "        fprintf(stderr, \"Erro de execução: divisão por zero na linha %d, coluna %d\\n\",\n"
+    "                line, col);\n"
+    "        exit(1);\n"
+    "    }\n"
+    "    if (b == -1) {\n"
+    "        return lsi_sub(0, a);\n"
+    "    }\n"
+    "    return a / b;\n"
+    "}\n";
+
+/* ============================================================================
+ * EXPRESSÕES
+ * ============================================================================ */
+
+/*
+ * emit_var_name(ctx, var)
+ *
+ * A primeira variável de um nome é v_<nome>; as que a sombreiam em blocos
+ * internos são v<n>_<nome>, que não colidem com nenhum v_<nome>.
+ */
+static void emit_var_name(CodegenC* ctx, int var) {
+    if (ctx->locals.ordinals[var] == 0) {
+        fprintf(ctx->out, "v_%s", ctx->locals.names[var]);
+    } else {
+        fprintf(ctx->out, "v%d_%s", ctx->locals.ordinals[var], ctx->locals.names[var]);
+    }
+}
+
+static void emit_var(CodegenC* ctx, const AstNode* node) {
+    emit_var_name(ctx, ast_locals_var(&ctx->locals, node));
+}
+
+static void emit_expr(CodegenC* ctx, const AstNode* node) {
+    switch (node->kind) {
+        case AST_NUM:
+            fprintf(ctx->out, "INT64_C(%lld)", (long long)node->value);
+            break;
+        case AST_ID:
+            emit_var(ctx, node);
+            break;
+        case AST_BINOP: {
+            const char* helper = NULL;
+            const char* relop = NULL;
+            switch (node->op) {
+                case TOKEN_PLUS: helper = "lsi_add"; break;
+                case TOKEN_MINUS: helper = "lsi_sub"; break;
+                case TOKEN_MULT: helper = "lsi_mul"; break;
+                case TOKEN_DIV: helper = "lsi_div"; break;
+                case TOKEN_LT: relop = "<"; break;
+                case TOKEN_LTE: relop = "<="; break;
+                case TOKEN_GT: relop = ">"; break;
+                case TOKEN_GTE: relop = ">="; break;
+                case TOKEN_EQ: relop = "=="; break;
+                case TOKEN_NEQ: relop = "!="; break;
+                default: break;
+            }
+            if (helper != NULL) {
+                fprintf(ctx->out, "%s(", helper);
+                emit_expr(ctx, node->kids[0]);
+                fprintf(ctx->out, ", ");
+                emit_expr(ctx, node->kids[1]);
+                if (node->op == TOKEN_DIV) {
+                    fprintf(ctx->out, ", %d, %d", node->line, node->col);
+                }
+                fprintf(ctx->out, ")");
+            } else {
+                fprintf(ctx->out, "(int64_t)(");
+                emit_expr(ctx, node->kids[0]);
+                fprintf(ctx->out, " %s ", relop);
+                emit_expr(ctx, node->kids[1]);
+                fprintf(ctx->out, ")");
+            }
+            break;
+        }
+        default:
+            codegen_error(ctx, node, "Expressão não suportada");
+            break;
+    }
+}
+
+/* ============================================================================
+ * COMANDOS
+ * ============================================================================ */
+
+static void emit_indent(CodegenC* ctx, int depth) {
+    fprintf(ctx->out, "%*s", depth * 4, "");
+}
+
+/*
+ * emit_call(ctx, call)
+ *
+ * Emite uma chamada, verificando antes se a função existe e se o número
+ * de argumentos coincide com o de parâmetros.
+ */
+static void emit_call(CodegenC* ctx, const AstNode* call) {
+    const AstNode* callee = ast_function_lookup(&ctx->functions, call->name);
+    if (callee == NULL) {
+        codegen_error(ctx, call, "Chamada a função não definida");
+        return;
+    }
+    if (callee->param_count != call->kid_count) {
+        codegen_error(ctx, call, "Número de argumentos diferente do número de parâmetros");
+        return;
+    }
+
+    fprintf(ctx->out, "lsi_f_%s(", call->name);
+    for (int i = 0; i < call->kid_count; i++) {
+        fprintf(ctx->out, "%s", i > 0 ? ", " : "");
+        emit_var(ctx, call->kids[i]);
+    }
+    fprintf(ctx->out, ")");
+}
+
+static void emit_stmt(CodegenC* ctx, const AstNode* node, int depth) {
+    switch (node->kind) {
+        case AST_VARDECL:
+        case AST_EMPTY:
+            /* Locais já foram declarados no início da função */
+            break;
+        case AST_ASSIGN:
+            emit_indent(ctx, depth);
+            emit_var(ctx, node);
+            fprintf(ctx->out, " = ");
+            if (node->kids[0]->kind == AST_FCALL) {
+                emit_call(ctx, node->kids[0]);
+            } else {
+                emit_expr(ctx, node->kids[0]);
+            }
+            fprintf(ctx->out, ";\n");
+            break;
+        case AST_PRINT:
+            emit_indent(ctx, depth);
+            fprintf(ctx->out, "lsi_print(");
+            emit_expr(ctx, node->kids[0]);
+            fprintf(ctx->out, ");\n");
+            break;
+        case AST_RETURN:
+            emit_indent(ctx, depth);
+            if (node->kid_count > 0) {
+                fprintf(ctx->out, "return ");
+                emit_var(ctx, node->kids[0]);
+                fprintf(ctx->out, ";\n");
+            } else {
+                fprintf(ctx->out, "return 0;\n");
+            }
+            break;
+        case AST_IF:
+            emit_indent(ctx, depth);
+            fprintf(ctx->out, "if (");
+            emit_expr(ctx, node->kids[0]);
+            fprintf(ctx->out, ") {\n");
+            emit_stmt(ctx, node->kids[1], depth + 1);
+            emit_indent(ctx, depth);
+            if (node->kid_count > 2) {
+                fprintf(ctx->out, "} else {\n");
+                emit_stmt(ctx, node->kids[2], depth + 1);
+                emit_indent(ctx, depth);
+            }
+            fprintf(ctx->out, "}\n");
+            break;
+        case AST_BLOCK:
+            emit_indent(ctx, depth);
+            fprintf(ctx->out, "{\n");
+            for (int i = 0; i < node->kid_count; i++) {
+                emit_stmt(ctx, node->kids[i], depth + 1);
+            }
+            emit_indent(ctx, depth);
+            fprintf(ctx->out, "}\n");
+            break;
+        default:
+            codegen_error(ctx, node, "Comando não suportado");
+            break;
+    }
+}
+
+/* ============================================================================
+ * FUNÇÕES
+ * ============================================================================ */
+
+static void emit_signature(CodegenC* ctx, const AstNode* fdef) {
+    fprintf(ctx->out, "LSI_UNUSED static int64_t lsi_f_%s(", fdef->name);
+    if (fdef->param_count == 0) {
+        fprintf(ctx->out, "void");
+    }
+    for (int i = 0; i < fdef->param_count; i++) {
+        fprintf(ctx->out, "%sint64_t v_%s", i > 0 ? ", " : "", fdef->params[i]->name);
+    }
+    fprintf(ctx->out, ")");
+}
+
+/*
+ * emit_body(ctx, node)
+ *
+ * Emite o corpo de uma função (ou do programa de um único comando),
+ * declarando antes todas as variáveis locais que não são parâmetros.
+ */
+static void emit_body(CodegenC* ctx, const AstNode* node) {
+    ast_locals_build(node, &ctx->locals);
+
+    fprintf(ctx->out, " {\n");
+    for (int i = node->param_count; i < ctx->locals.count; i++) {
+        fprintf(ctx->out, "    LSI_UNUSED int64_t ");
+        emit_var_name(ctx, i);
+        fprintf(ctx->out, " = 0;\n");
+    }
+    for (int i = 0; i < node->kid_count; i++) {
+        emit_stmt(ctx, node->kids[i], 1);
+    }
+    fprintf(ctx->out, "    return 0;\n}\n\n");
+
+    ast_locals_free(&ctx->locals);
+}
+
+/*
+ * emit_driver(ctx, program)
+ *
+ * Emite a função main do executável: lê os argumentos do ponto de entrada
+ * da linha de comando, executa o programa e descarrega a saída.
+ */
+static void emit_driver(CodegenC* ctx, const AstNode* program) {
+    const AstNode* entry = ast_entry_function(program);
+
+    fprintf(ctx->out, "int main(int argc, char** argv) {\n");
+    if (entry == NULL) {
+        fprintf(ctx->out, "    (void)argc;\n    (void)argv;\n");
+        fprintf(ctx->out, "    lsi_programa();\n");
+    } else {
+        for (int i = 0; i < entry->param_count; i++) {
+            fprintf(ctx->out, "    int64_t a%d = argc > %d ? strtoll(argv[%d], NULL, 10) : 0;\n",
+                    i, i + 1, i + 1);
+        }
+        if (entry->param_count == 0) {
+            fprintf(ctx->out, "    (void)argc;\n    (void)argv;\n");
+        }
+        fprintf(ctx->out, "    lsi_f_%s(", entry->name);
+        for (int i = 0; i < entry->param_count; i++) {
+            fprintf(ctx->out, "%sa%d", i > 0 ? ", " : "", i);
+        }
+        fprintf(ctx->out, ");\n");
+    }
+    fprintf(ctx->out, "    lsi_flush();\n    return 0;\n}\n");
+}
+
+/*
+ * codegen_c_emit(out, program, source_name)
+ *
+ * Emite runtime, protótipos, funções e driver, nesta ordem.
+ */
+int codegen_c_emit(FILE* out, const AstNode* program, const char* source_name) {
+    CodegenC ctx;
+    ctx.out = out;
+    ctx.failed = 0;
+
+    const AstNode* duplicate = ast_function_table_build(program, &ctx.functions);
+    if (duplicate != NULL) {
+        codegen_error(&ctx, duplicate, "Função definida mais de uma vez");
+        ast_function_table_free(&ctx.functions);
+        return 1;
+    }
+
+    fprintf(out, "/* Gerado a partir de %s pelo analisador LSI-2025-2 (--emit-c) */\n\n",
+            source_name);
+    fputs(runtime_source, out);
+    fprintf(out, "\n");
+
+    if (ctx.functions.count == 0) {
+        fprintf(out, "static int64_t lsi_programa(void)");
+        emit_body(&ctx, program);
+    } else {
+        for (int i = 0; i < program->kid_count; i++) {
+            emit_signature(&ctx, program->kids[i]);
+            fprintf(out, ";\n");
+        }
+        fprintf(out, "\n");
+        for (int i = 0; i < program->kid_count; i++) {
+            emit_signature(&ctx, program->kids[i]);
+            emit_body(&ctx, program->kids[i]);
+        }
+    }
+    emit_driver(&ctx, program);
+
+    ast_function_table_free(&ctx.functions);
+    return ctx.failed;
+}
@@ -0,0 +1,23 @@
+/*
+ * ============================================================================
+ * HEADER DO GERADOR DE CÓDIGO C PARA A LINGUAGEM LSI-2025-2
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * */
+
+#ifndef CODEGEN_C_H
+#define CODEGEN_C_H
+
+#include <stdio.h>
+#include "ast.h"
+
+/*
+ * Traduz o programa para uma unidade de tradução C autocontida.
+ * Retorna 0 em caso de sucesso ou 1 se o programa não pode ser traduzido
+ * (o motivo é reportado em stderr).
+ */
+int codegen_c_emit(FILE* out, const AstNode* program, const char* source_name);
+
+#endif
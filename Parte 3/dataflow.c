@@ -0,0 +1,530 @@
+/*
+ * ============================================================================
+ * GRAFO DE FLUXO DE CONTROLE E ANÁLISE DE FLUXO DE DADOS
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * Os blocos básicos só terminam em if e return: um if fecha o bloco
+ * corrente depois da condição e abre blocos para then, else e para a
+ * junção; um return liga o bloco à saída, e os comandos depois dele vão
+ * para um bloco novo, inalcançável. Como a linguagem não tem laços, o
+ * grafo é acíclico, mas o resolvedor não depende disso.
+ *
+ * ============================================================================
+ */
+
+#include "dataflow.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * checked_alloc(size)
+ *
+ * calloc que encerra o processo se a memória acabar.
+ */
+static void* checked_alloc(size_t size) {
+    void* memory = calloc(1, size ? size : 1);
+    if (memory == NULL) {
+        fprintf(stderr, "Erro fatal: Memória insuficiente para a análise de fluxo de dados.\n");
+        exit(1);
+    }
+    return memory;
+}
+
+/* ============================================================================
+ * CONSTRUÇÃO DO GRAFO
+ * ============================================================================ */
+
+static int new_block(Cfg* cfg) {
+    if (cfg->block_count == cfg->block_capacity) {
+        cfg->block_capacity = cfg->block_capacity ? cfg->block_capacity * 2 : 16;
+        cfg->blocks = (CfgBlock*)realloc(cfg->blocks,
+                                         sizeof(CfgBlock) * (size_t)cfg->block_capacity);
+        if (cfg->blocks == NULL) {
+            fprintf(stderr, "Erro fatal: Memória insuficiente para a análise de fluxo de dados.\n");
+            exit(1);
+        }
+    }
+    memset(&cfg->blocks[cfg->block_count], 0, sizeof(CfgBlock));
+    return cfg->block_count++;
+}
+
+static void add_edge(Cfg* cfg, int from, int to) {
+    CfgBlock* block = &cfg->blocks[from];
+    block->succ[block->succ_count++] = to;
+}
+
+/*
+ * add_event(cfg, block, kind, node)
+ *
+ * Registra no fim do bloco um evento sobre a variável de node, segundo os
+ * escopos de ast_locals_build(): uma declaração interna que sombreia um
+ * nome externo é outra variável.
+ */
+static void add_event(Cfg* cfg, int index, CfgEventKind kind, const AstNode* node) {
+    CfgBlock* block = &cfg->blocks[index];
+    if (block->event_count == block->event_capacity) {
+        block->event_capacity = block->event_capacity ? block->event_capacity * 2 : 8;
+        block->events = (CfgEvent*)realloc(block->events,
+                                           sizeof(CfgEvent) * (size_t)block->event_capacity);
+        if (block->events == NULL) {
+            fprintf(stderr, "Erro fatal: Memória insuficiente para a análise de fluxo de dados.\n");
+            exit(1);
+        }
+    }
+    block->events[block->event_count++] =
+        (CfgEvent){kind, ast_locals_var(&cfg->locals, node), node};
+}
+
+/*
+ * add_uses(cfg, block, expr)
+ *
+ * Registra as leituras de variáveis da expressão, da esquerda para a
+ * direita. Os argumentos de AST_FCALL são AST_ID.
+ */
+static void add_uses(Cfg* cfg, int block, const AstNode* expr) {
+    if (expr->kind == AST_ID) {
+        add_event(cfg, block, CFG_USE, expr);
+        return;
+    }
+    for (int i = 0; i < expr->kid_count; i++) {
+        add_uses(cfg, block, expr->kids[i]);
+    }
+}
+
+/*
+ * build_statement(cfg, block, stmt)
+ *
+ * Acrescenta o comando ao bloco e retorna o bloco em que a execução
+ * continua, ou -1 se nenhum caminho passa do comando (return em todos os
+ * ramos).
+ */
+static int build_statement(Cfg* cfg, int block, const AstNode* stmt) {
+    if (block < 0) {
+        block = new_block(cfg);     /* Código depois de return */
+    }
+
+    switch (stmt->kind) {
+        case AST_VARDECL:
+            for (int i = 0; i < stmt->kid_count; i++) {
+                add_event(cfg, block, CFG_DECL, stmt->kids[i]);
+            }
+            return block;
+
+        case AST_ASSIGN:
+            add_uses(cfg, block, stmt->kids[0]);
+            add_event(cfg, block, CFG_DEF, stmt);
+            return block;
+
+        case AST_RETURN:
+            if (stmt->kid_count > 0) {
+                add_uses(cfg, block, stmt->kids[0]);
+            }
+            add_edge(cfg, block, cfg->exit);
+            return -1;
+
+        case AST_IF: {
+            add_uses(cfg, block, stmt->kids[0]);
+
+            int then_block = new_block(cfg);
+            add_edge(cfg, block, then_block);
+            int then_end = build_statement(cfg, then_block, stmt->kids[1]);
+
+            int else_end = block;
+            if (stmt->kid_count > 2) {
+                int else_block = new_block(cfg);
+                add_edge(cfg, block, else_block);
+                else_end = build_statement(cfg, else_block, stmt->kids[2]);
+            }
+
+            if (then_end < 0 && else_end < 0) {
+                return -1;
+            }
+            int join = new_block(cfg);
+            if (then_end >= 0) {
+                add_edge(cfg, then_end, join);
+            }
+            if (else_end >= 0) {
+                add_edge(cfg, else_end, join);
+            }
+            return join;
+        }
+
+        case AST_BLOCK:
+            for (int i = 0; i < stmt->kid_count; i++) {
+                block = build_statement(cfg, block, stmt->kids[i]);
+            }
+            return block;
+
+        case AST_EMPTY:
+            return block;
+
+        default:
+            add_uses(cfg, block, stmt);
+            return block;
+    }
+}
+
+/*
+ * order_blocks(cfg)
+ *
+ * Marca os blocos alcançáveis e os ordena em pós-ordem reversa, por busca
+ * em profundidade com pilha explícita (o aninhamento de if não tem limite).
+ */
+static void order_blocks(Cfg* cfg) {
+    int* stack = (int*)checked_alloc(sizeof(int) * (size_t)cfg->block_count);
+    int* next_succ = (int*)checked_alloc(sizeof(int) * (size_t)cfg->block_count);
+    int* postorder = (int*)checked_alloc(sizeof(int) * (size_t)cfg->block_count);
+    int depth = 0;
+    int count = 0;
+
+    stack[depth++] = cfg->entry;
+    cfg->blocks[cfg->entry].reachable = 1;
+    while (depth > 0) {
+        int b = stack[depth - 1];
+        CfgBlock* block = &cfg->blocks[b];
+        if (next_succ[b] < block->succ_count) {
+            int s = block->succ[next_succ[b]++];
+            if (!cfg->blocks[s].reachable) {
+                cfg->blocks[s].reachable = 1;
+                stack[depth++] = s;
+            }
+        } else {
+            postorder[count++] = b;
+            depth--;
+        }
+    }
+
+    cfg->order = (int*)checked_alloc(sizeof(int) * (size_t)cfg->block_count);
+    for (int i = 0; i < count; i++) {
+        cfg->order[i] = postorder[count - 1 - i];
+    }
+    cfg->order_count = count;
+    free(stack);
+    free(next_succ);
+    free(postorder);
+}
+
+/*
+ * build_predecessors(cfg)
+ *
+ * Lista, para cada bloco, os predecessores alcançáveis, em formato
+ * compacto (um único vetor indexado por pred_start).
+ */
+static void build_predecessors(Cfg* cfg) {
+    cfg->pred_start = (int*)checked_alloc(sizeof(int) * (size_t)(cfg->block_count + 1));
+    for (int b = 0; b < cfg->block_count; b++) {
+        if (!cfg->blocks[b].reachable) {
+            continue;
+        }
+        for (int i = 0; i < cfg->blocks[b].succ_count; i++) {
+            cfg->pred_start[cfg->blocks[b].succ[i] + 1]++;
+        }
+    }
+    for (int b = 0; b < cfg->block_count; b++) {
+        cfg->pred_start[b + 1] += cfg->pred_start[b];
+    }
+
+    int* fill = (int*)checked_alloc(sizeof(int) * (size_t)cfg->block_count);
+    cfg->pred_list = (int*)checked_alloc(sizeof(int) * (size_t)cfg->pred_start[cfg->block_count]);
+    for (int b = 0; b < cfg->block_count; b++) {
+        if (!cfg->blocks[b].reachable) {
+            continue;
+        }
+        for (int i = 0; i < cfg->blocks[b].succ_count; i++) {
+            int s = cfg->blocks[b].succ[i];
+            cfg->pred_list[cfg->pred_start[s] + fill[s]++] = b;
+        }
+    }
+    free(fill);
+}
+
+/*
+ * compute_spans(cfg)
+ *
+ * Posição de cada bloco em order e, para cada variável, as posições do
+ * primeiro e do último bloco alcançável em que ela aparece.
+ */
+static void compute_spans(Cfg* cfg) {
+    int count = cfg->locals.count;
+    cfg->position = (int*)checked_alloc(sizeof(int) * (size_t)cfg->block_count);
+    cfg->span_first = (int*)checked_alloc(sizeof(int) * (size_t)(count ? count : 1));
+    cfg->span_last = (int*)checked_alloc(sizeof(int) * (size_t)(count ? count : 1));
+
+    for (int b = 0; b < cfg->block_count; b++) {
+        cfg->position[b] = -1;
+    }
+    for (int i = 0; i < count; i++) {
+        cfg->span_first[i] = cfg->order_count;
+        cfg->span_last[i] = -1;
+    }
+    for (int pos = 0; pos < cfg->order_count; pos++) {
+        const CfgBlock* block = &cfg->blocks[cfg->order[pos]];
+        cfg->position[cfg->order[pos]] = pos;
+        for (int e = 0; e < block->event_count; e++) {
+            int local = block->events[e].local;
+            if (cfg->span_first[local] > pos) {
+                cfg->span_first[local] = pos;
+            }
+            cfg->span_last[local] = pos;
+        }
+    }
+}
+
+/*
+ * cfg_build(fdef, cfg)
+ *
+ * Monta o grafo do corpo da função. Os parâmetros não geram eventos: as
+ * análises os tratam como inicializados na entrada.
+ */
+void cfg_build(const AstNode* fdef, Cfg* cfg) {
+    memset(cfg, 0, sizeof(Cfg));
+    ast_locals_build(fdef, &cfg->locals);
+    cfg->entry = new_block(cfg);
+    cfg->exit = new_block(cfg);
+
+    int block = cfg->entry;
+    for (int i = 0; i < fdef->kid_count; i++) {
+        block = build_statement(cfg, block, fdef->kids[i]);
+    }
+    if (block >= 0) {
+        add_edge(cfg, block, cfg->exit);
+    }
+
+    order_blocks(cfg);
+    build_predecessors(cfg);
+    compute_spans(cfg);
+}
+
+void cfg_free(Cfg* cfg) {
+    for (int b = 0; b < cfg->block_count; b++) {
+        free(cfg->blocks[b].events);
+    }
+    free(cfg->blocks);
+    free(cfg->pred_start);
+    free(cfg->pred_list);
+    free(cfg->order);
+    free(cfg->position);
+    free(cfg->span_first);
+    free(cfg->span_last);
+    ast_locals_free(&cfg->locals);
+    memset(cfg, 0, sizeof(Cfg));
+}
+
+/* ============================================================================
+ * RESOLUÇÃO POR LISTA DE TRABALHO
+ * ============================================================================ */
+
+/*
+ * dataflow_slice_words(cfg)
+ *
+ * Uma fatia tem ao menos uma palavra, mesmo que o número de blocos sozinho
+ * já exceda o limite de memória.
+ */
+int dataflow_slice_words(const Cfg* cfg) {
+    int needed = (cfg->locals.count + 63) / 64;
+    size_t per_word = (size_t)(cfg->order_count ? cfg->order_count : 1) * 4 * sizeof(uint64_t);
+    size_t fit = DATAFLOW_MEMORY_BUDGET / per_word;
+    if (fit > DATAFLOW_SLICE_MAX_WORDS) {
+        fit = DATAFLOW_SLICE_MAX_WORDS;
+    }
+    if (fit > (size_t)needed) {
+        fit = (size_t)needed;
+    }
+    return fit > 0 ? (int)fit : 1;
+}
+
+void dataflow_problem_init(DataflowProblem* problem, const Cfg* cfg,
+                           DataflowDirection direction, int words) {
+    size_t all = (size_t)words * (size_t)(cfg->order_count ? cfg->order_count : 1) *
+                 sizeof(uint64_t);
+
+    memset(problem, 0, sizeof(DataflowProblem));
+    problem->cfg = cfg;
+    problem->direction = direction;
+    problem->words = words;
+    problem->gen = (uint64_t*)checked_alloc(all);
+    problem->kill = (uint64_t*)checked_alloc(all);
+    problem->in = (uint64_t*)checked_alloc(all);
+    problem->out = (uint64_t*)checked_alloc(all);
+    problem->boundary = (uint64_t*)checked_alloc((size_t)words * sizeof(uint64_t));
+}
+
+/*
+ * dataflow_problem_slice(problem, first)
+ *
+ * Os vetores são reaproveitados de uma fatia para a outra, e só a parte
+ * da janela é limpa.
+ */
+int dataflow_problem_slice(DataflowProblem* problem, int first) {
+    const Cfg* cfg = problem->cfg;
+    int last = first + problem->words * 64;
+    if (last > cfg->locals.count) {
+        last = cfg->locals.count;
+    }
+
+    problem->first = first;
+    problem->lo = cfg->order_count;
+    problem->hi = -1;
+    for (int i = first; i < last; i++) {
+        if (cfg->span_first[i] < problem->lo) {
+            problem->lo = cfg->span_first[i];
+        }
+        if (cfg->span_last[i] > problem->hi) {
+            problem->hi = cfg->span_last[i];
+        }
+    }
+    memset(problem->boundary, 0, sizeof(uint64_t) * (size_t)problem->words);
+    if (problem->lo > problem->hi) {
+        return 0;
+    }
+
+    size_t used = (size_t)(problem->hi - problem->lo + 1) * (size_t)problem->words *
+                  sizeof(uint64_t);
+    memset(problem->gen, 0, used);
+    memset(problem->kill, 0, used);
+    memset(problem->in, 0, used);
+    memset(problem->out, 0, used);
+    return 1;
+}
+
+/*
+ * transfer(problem, block)
+ *
+ * Aplica gen ∪ (entrada − kill) e retorna 1 se a saída do bloco mudou.
+ */
+static int transfer(DataflowProblem* problem, int block) {
+    int words = problem->words;
+    int forward = problem->direction == DATAFLOW_FORWARD;
+    const uint64_t* gen = dataflow_set(problem, problem->gen, block);
+    const uint64_t* kill = dataflow_set(problem, problem->kill, block);
+    const uint64_t* source = dataflow_set(problem, forward ? problem->in : problem->out, block);
+    uint64_t* target = dataflow_set(problem, forward ? problem->out : problem->in, block);
+    uint64_t changed = 0;
+
+    for (int w = 0; w < words; w++) {
+        uint64_t value = gen[w] | (source[w] & ~kill[w]);
+        changed |= value ^ target[w];
+        target[w] = value;
+    }
+    return changed != 0;
+}
+
+/*
+ * meet_neighbor(problem, meet, neighbor)
+ *
+ * Une a meet a contribuição de um vizinho: o conjunto dele, se está na
+ * janela, ou o contorno, se está fora.
+ */
+static void meet_neighbor(DataflowProblem* problem, uint64_t* meet, int neighbor) {
+    int pos = problem->cfg->position[neighbor];
+    const uint64_t* other;
+    if (pos < problem->lo || pos > problem->hi) {
+        other = problem->boundary;
+    } else {
+        int forward = problem->direction == DATAFLOW_FORWARD;
+        other = dataflow_set(problem, forward ? problem->out : problem->in, neighbor);
+    }
+    for (int w = 0; w < problem->words; w++) {
+        meet[w] |= other[w];
+    }
+}
+
+/*
+ * enqueue(queue, queued, capacity, tail, pos)
+ *
+ * Acrescenta a posição à fila circular, se ainda não está nela.
+ */
+static void enqueue(int* queue, char* queued, int capacity, int* tail, int pos) {
+    if (!queued[pos]) {
+        queued[pos] = 1;
+        queue[*tail] = pos;
+        *tail = (*tail + 1) % capacity;
+    }
+}
+
+/*
+ * dataflow_solve(problem)
+ *
+ * Calcula o ponto fixo na janela da fatia. A lista de trabalho começa com
+ * os blocos da janela em pós-ordem reversa (para frente) ou pós-ordem
+ * (para trás), de modo que, no grafo acíclico, cada bloco é processado
+ * uma só vez e o custo é O(blocos da janela × palavras).
+ */
+void dataflow_solve(DataflowProblem* problem) {
+    const Cfg* cfg = problem->cfg;
+    int words = problem->words;
+    int forward = problem->direction == DATAFLOW_FORWARD;
+    int lo = problem->lo;
+    int span = problem->hi - lo + 1;
+    if (span <= 0) {
+        return;
+    }
+
+    int capacity = span + 1;
+    int* queue = (int*)checked_alloc(sizeof(int) * (size_t)capacity);
+    char* queued = (char*)checked_alloc((size_t)span);
+    int head = 0;
+    int tail = 0;
+    for (int i = 0; i < span; i++) {
+        enqueue(queue, queued, capacity, &tail, forward ? i : span - 1 - i);
+    }
+
+    while (head != tail) {
+        int pos = queue[head];
+        head = (head + 1) % capacity;
+        queued[pos] = 0;
+        int b = cfg->order[lo + pos];
+
+        /* Junção: união dos vizinhos na direção oposta à do fluxo */
+        uint64_t* meet = dataflow_set(problem, forward ? problem->in : problem->out, b);
+        if (b == (forward ? cfg->entry : cfg->exit)) {
+            memcpy(meet, problem->boundary, sizeof(uint64_t) * (size_t)words);
+        } else if (forward) {
+            memset(meet, 0, sizeof(uint64_t) * (size_t)words);
+            for (int p = cfg->pred_start[b]; p < cfg->pred_start[b + 1]; p++) {
+                meet_neighbor(problem, meet, cfg->pred_list[p]);
+            }
+        } else {
+            memset(meet, 0, sizeof(uint64_t) * (size_t)words);
+            for (int i = 0; i < cfg->blocks[b].succ_count; i++) {
+                meet_neighbor(problem, meet, cfg->blocks[b].succ[i]);
+            }
+        }
+
+        if (!transfer(problem, b)) {
+            continue;
+        }
+
+        /* A saída mudou: os vizinhos da janela na direção do fluxo voltam à lista */
+        if (forward) {
+            for (int i = 0; i < cfg->blocks[b].succ_count; i++) {
+                int next = cfg->position[cfg->blocks[b].succ[i]] - lo;
+                if (next < span) {
+                    enqueue(queue, queued, capacity, &tail, next);
+                }
+            }
+        } else {
+            for (int p = cfg->pred_start[b]; p < cfg->pred_start[b + 1]; p++) {
+                int next = cfg->position[cfg->pred_list[p]] - lo;
+                if (next >= 0) {
+                    enqueue(queue, queued, capacity, &tail, next);
+                }
+            }
+        }
+    }
+
+    free(queue);
+    free(queued);
+}
+
+void dataflow_problem_free(DataflowProblem* problem) {
+    free(problem->gen);
+    free(problem->kill);
+    free(problem->in);
+    free(problem->out);
+    free(problem->boundary);
+    memset(problem, 0, sizeof(DataflowProblem));
+}
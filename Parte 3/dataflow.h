@@ -0,0 +1,162 @@
+/*
+ * ============================================================================
+ * HEADER DO GRAFO DE FLUXO DE CONTROLE E DA ANÁLISE DE FLUXO DE DADOS
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * Um Cfg descreve uma função como blocos básicos; cada bloco guarda, em
+ * ordem de execução, os eventos que interessam às análises: leitura,
+ * atribuição ou declaração de uma variável local (índice em AstLocals).
+ *
+ * Um DataflowProblem é resolvido sobre o Cfg com conjuntos de bits densos
+ * sobre as variáveis locais: o cliente preenche gen e kill de cada bloco e
+ * o valor de contorno, e dataflow_solve() calcula in e out por lista de
+ * trabalho, com união como junção.
+ *
+ * Com um conjunto por bloco e um bit por variável, uma função com dezenas
+ * de milhares de variáveis e de if ocuparia gigabytes, e o custo seria
+ * quadrático mesmo quando cada variável só aparece num trecho pequeno.
+ * Como as variáveis são independentes entre si nos problemas de bits, o
+ * problema é resolvido por fatias de até 64 * dataflow_slice_words()
+ * variáveis consecutivas, e cada fatia só na janela de blocos (em
+ * pós-ordem reversa) entre o primeiro e o último evento de suas
+ * variáveis. Fora da janela nenhum bloco gera ou mata bits da fatia e,
+ * como o grafo é acíclico, o que chega à janela vindo de fora é o próprio
+ * contorno. Como
+ * as variáveis são numeradas na ordem em que aparecem, variáveis de uma
+ * fatia costumam estar próximas no texto, e o custo total fica perto de
+ * linear no tamanho da função.
+ *
+ * */
+
+#ifndef DATAFLOW_H
+#define DATAFLOW_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ast.h"
+
+/* ============================================================================
+ * GRAFO DE FLUXO DE CONTROLE
+ * ============================================================================ */
+
+typedef enum {
+    CFG_USE,                /* Leitura da variável */
+    CFG_DEF,                /* Atribuição (AST_ASSIGN) */
+    CFG_DECL                /* Declaração int (AST_ID de AST_VARDECL) */
+} CfgEventKind;
+
+typedef struct {
+    CfgEventKind kind;
+    int local;              /* Índice em Cfg.locals */
+    const AstNode* node;    /* Posição para diagnósticos */
+} CfgEvent;
+
+typedef struct {
+    CfgEvent* events;
+    int event_count;
+    int event_capacity;
+    int succ[2];            /* Um if tem dois sucessores; os demais, no máximo um */
+    int succ_count;
+    int reachable;          /* Alcançável a partir da entrada */
+} CfgBlock;
+
+typedef struct {
+    CfgBlock* blocks;
+    int block_count;
+    int block_capacity;
+    int entry;
+    int exit;               /* Sem eventos; destino de return e do fim do corpo */
+    int* pred_start;        /* Predecessores de b: pred_list[pred_start[b] .. pred_start[b + 1]) */
+    int* pred_list;
+    int* order;             /* Blocos alcançáveis em pós-ordem reversa */
+    int order_count;
+    int* position;          /* Por bloco: posição em order, ou -1 se inalcançável */
+    int* span_first;        /* Por variável: primeira posição com evento dela, ou order_count */
+    int* span_last;         /* Por variável: última posição com evento dela, ou -1 */
+    AstLocals locals;
+} Cfg;
+
+/* Monta o grafo de uma AST_FDEF (ou de um programa de um único comando) */
+void cfg_build(const AstNode* fdef, Cfg* cfg);
+void cfg_free(Cfg* cfg);
+
+/* ============================================================================
+ * CONJUNTOS DE BITS E RESOLUÇÃO
+ * ============================================================================ */
+
+typedef enum {
+    DATAFLOW_FORWARD,       /* in[b] = junção dos out dos predecessores */
+    DATAFLOW_BACKWARD       /* out[b] = junção dos in dos sucessores */
+} DataflowDirection;
+
+/* Limite da memória dos quatro vetores de conjuntos de uma fatia */
+#define DATAFLOW_MEMORY_BUDGET (32u << 20)
+
+/* Fatias maiores diluem o custo fixo por bloco, mas alargam as janelas */
+#define DATAFLOW_SLICE_MAX_WORDS 8
+
+/*
+ * Cada vetor guarda um conjunto de words palavras por bloco da janela
+ * lo .. hi (posições em Cfg.order), sobre as variáveis first ..
+ * first + 64 * words - 1. O conjunto de um bloco da janela é obtido com
+ * dataflow_set() e o bit de uma variável com dataflow_bit(). A função de
+ * transferência é gen ∪ (entrada − kill), com entrada = in (para frente)
+ * ou out (para trás).
+ */
+typedef struct {
+    const Cfg* cfg;
+    DataflowDirection direction;
+    int first;
+    int words;
+    int lo;
+    int hi;
+    uint64_t* gen;
+    uint64_t* kill;
+    uint64_t* in;
+    uint64_t* out;
+    uint64_t* boundary;     /* in da entrada (para frente) ou out da saída (para trás) */
+} DataflowProblem;
+
+static inline uint64_t* dataflow_set(const DataflowProblem* problem, uint64_t* sets, int block) {
+    int offset = problem->cfg->position[block] - problem->lo;
+    return sets + (size_t)offset * (size_t)problem->words;
+}
+
+/* Bit da variável local na fatia, ou -1 se ela está fora da fatia */
+static inline int dataflow_bit(const DataflowProblem* problem, int local) {
+    int bit = local - problem->first;
+    return bit >= 0 && bit < problem->words * 64 ? bit : -1;
+}
+
+static inline void bitset_add(uint64_t* set, int bit) {
+    set[bit >> 6] |= 1ull << (bit & 63);
+}
+
+static inline void bitset_remove(uint64_t* set, int bit) {
+    set[bit >> 6] &= ~(1ull << (bit & 63));
+}
+
+static inline int bitset_contains(const uint64_t* set, int bit) {
+    return (set[bit >> 6] >> (bit & 63)) & 1;
+}
+
+/* Palavras por fatia: no máximo DATAFLOW_SLICE_MAX_WORDS e dentro de DATAFLOW_MEMORY_BUDGET */
+int dataflow_slice_words(const Cfg* cfg);
+
+/* Aloca os conjuntos para fatias de words palavras */
+void dataflow_problem_init(DataflowProblem* problem, const Cfg* cfg,
+                           DataflowDirection direction, int words);
+
+/*
+ * Passa a cobrir as variáveis a partir de first, calcula a janela e
+ * esvazia os conjuntos e o contorno. Retorna 0 se nenhuma variável da
+ * fatia aparece em bloco alcançável (não há o que resolver).
+ */
+int dataflow_problem_slice(DataflowProblem* problem, int first);
+
+void dataflow_solve(DataflowProblem* problem);
+void dataflow_problem_free(DataflowProblem* problem);
+
+#endif
@@ -0,0 +1,256 @@
+/*
+ * ============================================================================
+ * DIAGNÓSTICOS DO ANALISADOR LSI-2025-2
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * Este módulo implementa:
+ *   - Registro de erros com tipo, linha, coluna e mensagem formatada
+ *   - Listas de diagnósticos de tamanho variável
+ *   - Buffer de texto com escrita de strings em JSON e leitura de arquivos
+ *
+ * ============================================================================
+ */
+
+#include "diagnostic.h"
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ============================================================================
+ * DIAGNÓSTICO INDIVIDUAL
+ * ============================================================================ */
+
+/*
+ * diagnostic_set(diag, kind, line, col, format, ...)
+ *
+ * Preenche um diagnóstico. A mensagem é truncada em DIAGNOSTIC_TEXT_SIZE.
+ */
+void diagnostic_set(Diagnostic* diag, DiagnosticKind kind, int64_t line, int64_t col,
+                    const char* format, ...) {
+    va_list args;
+    diag->kind = kind;
+    diag->line = line;
+    diag->col = col;
+    va_start(args, format);
+    vsnprintf(diag->text, DIAGNOSTIC_TEXT_SIZE, format, args);
+    va_end(args);
+}
+
+/*
+ * diagnostic_print(out, diag)
+ *
+ * Imprime o diagnóstico no formato da linha de comando: erros de análise
+ * são precedidos por uma linha em branco, erros fatais não.
+ */
+void diagnostic_print(FILE* out, const Diagnostic* diag) {
+    fprintf(out, diag->kind == DIAG_FATAL ? "%s\n" : "\n%s\n", diag->text);
+}
+
+/*
+ * diagnostic_kind_to_string(kind)
+ *
+ * Nome do tipo de diagnóstico usado nas respostas em JSON.
+ */
+const char* diagnostic_kind_to_string(DiagnosticKind kind) {
+    switch (kind) {
+        case DIAG_LEXICAL: return "lexical";
+        case DIAG_SYNTAX: return "syntax";
+        case DIAG_SEMANTIC: return "semantic";
+        case DIAG_FATAL: return "fatal";
+        case DIAG_WARNING: return "warning";
+        case DIAG_LIMIT: return "limit";
+        default: return "unknown";
+    }
+}
+
+/* ============================================================================
+ * LISTA DE DIAGNÓSTICOS
+ * ============================================================================ */
+
+/*
+ * diagnostic_list_add(list)
+ *
+ * Reserva um diagnóstico no fim da lista e retorna-o para preenchimento.
+ */
+Diagnostic* diagnostic_list_add(DiagnosticList* list) {
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : 8;
+        list->items = (Diagnostic*)realloc(list->items,
+                                           sizeof(Diagnostic) * (size_t)list->capacity);
+        if (list->items == NULL) {
+            fprintf(stderr, "Erro fatal: Memória insuficiente para os diagnósticos.\n");
+            exit(1);
+        }
+    }
+    return &list->items[list->count++];
+}
+
+void diagnostic_list_clear(DiagnosticList* list) {
+    list->count = 0;
+}
+
+void diagnostic_list_free(DiagnosticList* list) {
+    free(list->items);
+    memset(list, 0, sizeof(DiagnosticList));
+}
+
+/* ============================================================================
+ * BUFFER DE TEXTO E JSON
+ * ============================================================================ */
+
+/*
+ * text_reserve(buffer, extra)
+ *
+ * Garante espaço para mais extra bytes e o terminador.
+ */
+static void text_reserve(TextBuffer* buffer, size_t extra) {
+    if (buffer->length + extra + 1 <= buffer->capacity) {
+        return;
+    }
+    size_t capacity = buffer->capacity ? buffer->capacity : 256;
+    while (buffer->length + extra + 1 > capacity) {
+        capacity *= 2;
+    }
+    buffer->data = (char*)realloc(buffer->data, capacity);
+    if (buffer->data == NULL) {
+        fprintf(stderr, "Erro fatal: Memória insuficiente para o buffer de texto.\n");
+        exit(1);
+    }
+    buffer->capacity = capacity;
+}
+
+void text_append(TextBuffer* buffer, const char* data, size_t length) {
+    text_reserve(buffer, length);
+    memcpy(buffer->data + buffer->length, data, length);
+    buffer->length += length;
+    buffer->data[buffer->length] = '\0';
+}
+
+void text_printf(TextBuffer* buffer, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int needed = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+
+    text_reserve(buffer, (size_t)needed);
+    va_start(args, format);
+    vsnprintf(buffer->data + buffer->length, (size_t)needed + 1, format, args);
+    va_end(args);
+    buffer->length += (size_t)needed;
+}
+
+/*
+ * utf8_sequence_length(p)
+ *
+ * Tamanho da sequência UTF-8 bem formada que começa em p (2 a 4 bytes),
+ * ou 0 se p não começa uma: byte de continuação solto, sequência
+ * truncada, forma longa demais, surrogate ou código acima de U+10FFFF.
+ */
+static int utf8_sequence_length(const unsigned char* p) {
+    int length;
+    unsigned char min = 0x80, max = 0xBF;   /* Faixa do segundo byte */
+    if (p[0] >= 0xC2 && p[0] <= 0xDF) {
+        length = 2;
+    } else if (p[0] >= 0xE0 && p[0] <= 0xEF) {
+        length = 3;
+        if (p[0] == 0xE0) {
+            min = 0xA0;
+        } else if (p[0] == 0xED) {
+            max = 0x9F;
+        }
+    } else if (p[0] >= 0xF0 && p[0] <= 0xF4) {
+        length = 4;
+        if (p[0] == 0xF0) {
+            min = 0x90;
+        } else if (p[0] == 0xF4) {
+            max = 0x8F;
+        }
+    } else {
+        return 0;
+    }
+    if (p[1] < min || p[1] > max) {
+        return 0;
+    }
+    for (int i = 2; i < length; i++) {
+        if ((p[i] & 0xC0) != 0x80) {
+            return 0;
+        }
+    }
+    return length;
+}
+
+/*
+ * text_append_json_string(buffer, str)
+ *
+ * Escreve str entre aspas, escapando aspas, barras e caracteres de
+ * controle. Sequências UTF-8 bem formadas são copiadas; os demais bytes
+ * acima de 127 (por exemplo, metade de um caractere cortado pelo lexer)
+ * saem como \u00XX, como no dump JSON da Parte 1.
+ */
+void text_append_json_string(TextBuffer* buffer, const char* str) {
+    static const char hex[] = "0123456789abcdef";
+    text_append(buffer, "\"", 1);
+    for (const unsigned char* p = (const unsigned char*)str; *p; p++) {
+        char escaped[6] = {'\\', 'u', '0', '0', hex[*p >> 4], hex[*p & 15]};
+        if (*p == '"' || *p == '\\') {
+            escaped[1] = (char)*p;
+            text_append(buffer, escaped, 2);
+        } else if (*p == '\n') {
+            text_append(buffer, "\\n", 2);
+        } else if (*p < 0x20 || *p == 0x7F) {
+            text_append(buffer, escaped, 6);
+        } else if (*p < 0x80) {
+            text_append(buffer, (const char*)p, 1);
+        } else {
+            int length = utf8_sequence_length(p);
+            if (length == 0) {
+                text_append(buffer, escaped, 6);
+            } else {
+                text_append(buffer, (const char*)p, (size_t)length);
+                p += length - 1;
+            }
+        }
+    }
+    text_append(buffer, "\"", 1);
+}
+
+void text_free(TextBuffer* buffer) {
+    free(buffer->data);
+    memset(buffer, 0, sizeof(TextBuffer));
+}
+
+/*
+ * text_read_file(buffer, path)
+ *
+ * Acrescenta o arquivo inteiro ao buffer. Retorna 0 em caso de sucesso e
+ * -1 (com errno) se o arquivo não abre ou a leitura falha.
+ */
+int text_read_file(TextBuffer* buffer, const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        return -1;
+    }
+    char chunk[65536];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        text_append(buffer, chunk, n);
+    }
+    int failed = ferror(file);
+    fclose(file);
+    return failed ? -1 : 0;
+}
+
+/*
+ * diagnostic_append_json(buffer, diag)
+ *
+ * Escreve o diagnóstico como um objeto JSON em uma única linha.
+ */
+void diagnostic_append_json(TextBuffer* buffer, const Diagnostic* diag) {
+    text_printf(buffer, "{\"kind\":\"%s\",\"line\":%" PRId64 ",\"col\":%" PRId64 ",\"message\":",
+                diagnostic_kind_to_string(diag->kind), diag->line, diag->col);
+    text_append_json_string(buffer, diag->text);
+    text_append(buffer, "}", 1);
+}
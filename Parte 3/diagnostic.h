@@ -0,0 +1,71 @@
+/*
+ * ============================================================================
+ * HEADER DOS DIAGNÓSTICOS DO ANALISADOR LSI-2025-2
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * Erros e avisos são registrados em vez de impressos, para que o mesmo
+ * analisador sirva à linha de comando (texto em stderr) e ao servidor
+ * (respostas em JSON).
+ *
+ * */
+
+#ifndef DIAGNOSTIC_H
+#define DIAGNOSTIC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define DIAGNOSTIC_TEXT_SIZE 512
+
+typedef enum {
+    DIAG_LEXICAL,           /* Caractere inválido na entrada */
+    DIAG_SYNTAX,            /* Entrada fora da gramática */
+    DIAG_SEMANTIC,          /* Programa bem formado, mas inconsistente */
+    DIAG_FATAL,             /* Limite interno excedido */
+    DIAG_WARNING,           /* Programa válido, mas provavelmente com defeito */
+    DIAG_LIMIT              /* Orçamento da análise esgotado (ParseLimits) */
+} DiagnosticKind;
+
+typedef struct {
+    DiagnosticKind kind;
+    int64_t line;           /* De 64 bits, como as posições do lexer */
+    int64_t col;
+    char text[DIAGNOSTIC_TEXT_SIZE];   /* Mensagem completa, como impressa */
+} Diagnostic;
+
+typedef struct {
+    Diagnostic* items;
+    int count;
+    int capacity;
+} DiagnosticList;
+
+/* Texto de tamanho variável, usado para montar respostas */
+typedef struct {
+    char* data;
+    size_t length;
+    size_t capacity;
+} TextBuffer;
+
+void diagnostic_set(Diagnostic* diag, DiagnosticKind kind, int64_t line, int64_t col,
+                    const char* format, ...) __attribute__((format(printf, 5, 6)));
+void diagnostic_print(FILE* out, const Diagnostic* diag);
+const char* diagnostic_kind_to_string(DiagnosticKind kind);
+
+Diagnostic* diagnostic_list_add(DiagnosticList* list);
+void diagnostic_list_clear(DiagnosticList* list);
+void diagnostic_list_free(DiagnosticList* list);
+
+void text_append(TextBuffer* buffer, const char* data, size_t length);
+void text_printf(TextBuffer* buffer, const char* format, ...)
+    __attribute__((format(printf, 2, 3)));
+void text_append_json_string(TextBuffer* buffer, const char* str);
+void text_free(TextBuffer* buffer);
+int text_read_file(TextBuffer* buffer, const char* path);
+
+/* Acrescenta {"kind":...,"line":...,"col":...,"message":...} ao buffer */
+void diagnostic_append_json(TextBuffer* buffer, const Diagnostic* diag);
+
+#endif
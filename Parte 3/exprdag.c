@@ -0,0 +1,431 @@
+/*
+ * ============================================================================
+ * DAG DE EXPRESSÕES COM ELIMINAÇÃO DE SUBEXPRESSÕES COMUNS
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * Numeração de valores sobre a árvore, em uma passada em ordem por
+ * função:
+ *   - Literais e operações entram em uma tabela hash aberta indexada por
+ *     (tipo, operador, operandos, valor); encontrar a chave devolve o nó
+ *     existente em vez de criar outro
+ *   - Cada variável local aponta o nó do seu valor atual (value_of); uma
+ *     atribuição a aponta para o valor da expressão (ou para um DAG_CALL
+ *     novo), o que invalida as subexpressões sobre o valor antigo sem
+ *     percorrer nada: as chaves novas usam outro operando
+ *   - Um nó é "disponível" enquanto foi calculado em todo caminho até o
+ *     ponto atual. O que um ramo de if torna disponível, e o que ele muda
+ *     em value_of, é desfeito ao sair do ramo por dois registros de
+ *     desfazer; depois do if, continua disponível o que os dois ramos
+ *     calcularam, e uma variável com valores diferentes nos dois caminhos
+ *     passa a apontar um DAG_MERGE
+ *
+ * Como as chamadas recebem cópias dos argumentos e a linguagem não tem
+ * variáveis globais, só atribuições mudam os valores de uma função.
+ * Declarações int não mudam nada: nos geradores de código a variável é
+ * da função inteira, e a declaração não a reinicia.
+ *
+ * ============================================================================
+ */
+
+#include "exprdag.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    int local;
+    int value;              /* Em var_log, o valor anterior; em pending, o de saída do ramo */
+} VarChange;
+
+typedef struct {
+    ExprDag* dag;
+    int* slots;             /* Tabela hash aberta: índice + 1, ou 0 se vazio */
+    int slot_count;
+    int* value_of;          /* Por variável local: nó do valor atual */
+    int* stamp;             /* Por variável local: marca de uso temporário */
+    int* scratch;           /* Por variável local: valor guardado junto com stamp */
+    int stamp_counter;
+    char* available;        /* Por nó */
+    int available_capacity;
+    int* available_log;     /* Nós tornados disponíveis, para desfazer ao sair de um ramo */
+    int available_count;
+    int available_log_capacity;
+    VarChange* var_log;     /* Atribuições, para desfazer ao sair de um ramo */
+    int var_count;
+    int var_capacity;
+    VarChange* pending;     /* Valores de cada ramo até a junção, empilhados pelos if */
+    int pending_count;
+    int pending_capacity;
+    int* carried;           /* Nós calculados no then, candidatos a disponíveis depois do if */
+    int carried_count;
+    int carried_capacity;
+} DagBuilder;
+
+/*
+ * grow(array, capacity, needed, element)
+ *
+ * Garante espaço para needed elementos, dobrando a capacidade. Encerra o
+ * processo se a memória acabar.
+ */
+static void grow(void** array, int* capacity, int needed, size_t element) {
+    if (needed <= *capacity) {
+        return;
+    }
+    int new_capacity = *capacity ? *capacity : 16;
+    while (new_capacity < needed) {
+        new_capacity *= 2;
+    }
+    void* memory = realloc(*array, element * (size_t)new_capacity);
+    if (memory == NULL) {
+        fprintf(stderr, "Erro fatal: Memória insuficiente para o DAG de expressões.\n");
+        exit(1);
+    }
+    *array = memory;
+    *capacity = new_capacity;
+}
+
+static void* checked_calloc(size_t count, size_t size) {
+    void* memory = calloc(count ? count : 1, size);
+    if (memory == NULL) {
+        fprintf(stderr, "Erro fatal: Memória insuficiente para o DAG de expressões.\n");
+        exit(1);
+    }
+    return memory;
+}
+
+/* ============================================================================
+ * NÓS E TABELA HASH
+ * ============================================================================ */
+
+static inline unsigned int hash_node(const DagNode* node) {
+    uint64_t h = ((uint64_t)node->kind << 8 | node->op) * 0x9E3779B97F4A7C15ull;
+    h ^= (uint64_t)(uint32_t)node->a + 0x7F4A7C15ull + (h << 6) + (h >> 2);
+    h ^= (uint64_t)(uint32_t)node->b + 0x7F4A7C15ull + (h << 6) + (h >> 2);
+    h ^= (uint64_t)node->value * 0xC2B2AE3D27D4EB4Full;
+    return (unsigned int)(h ^ (h >> 29));
+}
+
+static inline int same_node(const DagNode* x, const DagNode* y) {
+    return x->kind == y->kind && x->op == y->op && x->a == y->a && x->b == y->b &&
+           x->value == y->value;
+}
+
+/*
+ * append_node(builder, node)
+ *
+ * Acrescenta o nó ao vetor, sem passar pela tabela hash.
+ */
+static int append_node(DagBuilder* builder, DagNode node) {
+    ExprDag* dag = builder->dag;
+    grow((void**)&dag->nodes, &dag->node_capacity, dag->node_count + 1, sizeof(DagNode));
+    if (dag->node_count == builder->available_capacity) {
+        int old = builder->available_capacity;
+        grow((void**)&builder->available, &builder->available_capacity,
+             dag->node_count + 1, 1);
+        memset(builder->available + old, 0, (size_t)(builder->available_capacity - old));
+    }
+    dag->nodes[dag->node_count] = node;
+    return dag->node_count++;
+}
+
+static void rehash(DagBuilder* builder) {
+    ExprDag* dag = builder->dag;
+    builder->slot_count = builder->slot_count ? builder->slot_count * 2 : 64;
+    free(builder->slots);
+    builder->slots = (int*)checked_calloc((size_t)builder->slot_count, sizeof(int));
+    unsigned int mask = (unsigned int)(builder->slot_count - 1);
+    for (int i = 0; i < dag->node_count; i++) {
+        if (dag->nodes[i].kind != DAG_CONST && dag->nodes[i].kind != DAG_BINOP) {
+            continue;
+        }
+        unsigned int slot = hash_node(&dag->nodes[i]) & mask;
+        while (builder->slots[slot] != 0) {
+            slot = (slot + 1) & mask;
+        }
+        builder->slots[slot] = i + 1;
+    }
+}
+
+/*
+ * intern_node(builder, node, created)
+ *
+ * Retorna o nó igual a node, criando-o se ainda não existe (*created = 1).
+ */
+static int intern_node(DagBuilder* builder, DagNode node, int* created) {
+    ExprDag* dag = builder->dag;
+    if ((dag->node_count + 1) * 2 > builder->slot_count) {
+        rehash(builder);
+    }
+    unsigned int mask = (unsigned int)(builder->slot_count - 1);
+    unsigned int slot = hash_node(&node) & mask;
+    while (builder->slots[slot] != 0) {
+        int index = builder->slots[slot] - 1;
+        if (same_node(&dag->nodes[index], &node)) {
+            *created = 0;
+            return index;
+        }
+        slot = (slot + 1) & mask;
+    }
+    *created = 1;
+    int index = append_node(builder, node);
+    builder->slots[slot] = index + 1;
+    return index;
+}
+
+/* ============================================================================
+ * VALORES DAS VARIÁVEIS E REGISTROS DE DESFAZER
+ * ============================================================================ */
+
+static void set_value(DagBuilder* builder, int local, int value) {
+    grow((void**)&builder->var_log, &builder->var_capacity, builder->var_count + 1,
+         sizeof(VarChange));
+    builder->var_log[builder->var_count++] = (VarChange){local, builder->value_of[local]};
+    builder->value_of[local] = value;
+}
+
+static void make_available(DagBuilder* builder, int node) {
+    if (builder->available[node]) {
+        return;
+    }
+    builder->available[node] = 1;
+    grow((void**)&builder->available_log, &builder->available_log_capacity,
+         builder->available_count + 1, sizeof(int));
+    builder->available_log[builder->available_count++] = node;
+}
+
+/*
+ * leave_branch(builder, var_mark, available_mark)
+ *
+ * Desfaz o ramo que começou nas marcas dadas e empilha em pending, uma
+ * vez por variável, o valor com que cada variável atribuída saiu dele.
+ * O registro é percorrido de trás para a frente: a primeira ocorrência de
+ * uma variável é a última atribuição do ramo.
+ */
+static void leave_branch(DagBuilder* builder, int var_mark, int available_mark) {
+    int mark = ++builder->stamp_counter;
+    for (int i = builder->var_count - 1; i >= var_mark; i--) {
+        int local = builder->var_log[i].local;
+        if (builder->stamp[local] != mark) {
+            builder->stamp[local] = mark;
+            grow((void**)&builder->pending, &builder->pending_capacity,
+                 builder->pending_count + 1, sizeof(VarChange));
+            builder->pending[builder->pending_count++] =
+                (VarChange){local, builder->value_of[local]};
+        }
+        builder->value_of[local] = builder->var_log[i].value;
+    }
+    builder->var_count = var_mark;
+
+    while (builder->available_count > available_mark) {
+        builder->available[builder->available_log[--builder->available_count]] = 0;
+    }
+}
+
+/*
+ * merge_value(builder, then_value, else_value)
+ *
+ * Valor de uma variável depois do if: o mesmo nó, se os dois caminhos
+ * concordam, ou um DAG_MERGE novo.
+ */
+static int merge_value(DagBuilder* builder, int then_value, int else_value) {
+    if (then_value == else_value) {
+        return then_value;
+    }
+    return append_node(builder, (DagNode){DAG_MERGE, 0, 0, then_value, else_value, 0});
+}
+
+/* ============================================================================
+ * EXPRESSÕES E COMANDOS
+ * ============================================================================ */
+
+static void add_root(DagBuilder* builder, const AstNode* expr, int value) {
+    ExprDag* dag = builder->dag;
+    grow((void**)&dag->roots, &dag->root_capacity, dag->root_count + 1, sizeof(DagRoot));
+    dag->roots[dag->root_count++] = (DagRoot){expr, value};
+}
+
+static inline int is_commutative(TokenType op) {
+    return op == TOKEN_PLUS || op == TOKEN_MULT || op == TOKEN_EQ || op == TOKEN_NEQ;
+}
+
+/*
+ * lower_expr(builder, expr)
+ *
+ * Retorna o nó do valor da expressão. Uma operação encontrada já
+ * disponível é contada como eliminada.
+ */
+static int lower_expr(DagBuilder* builder, const AstNode* expr) {
+    ExprDag* dag = builder->dag;
+    int created;
+    dag->expr_nodes++;
+
+    if (expr->kind == AST_ID) {
+        return builder->value_of[ast_locals_var(&dag->locals, expr)];
+    }
+    if (expr->kind == AST_NUM) {
+        return intern_node(builder, (DagNode){DAG_CONST, 0, 0, 0, 0, expr->value}, &created);
+    }
+
+    int left = lower_expr(builder, expr->kids[0]);
+    int right = lower_expr(builder, expr->kids[1]);
+    if (is_commutative(expr->op) && right < left) {
+        int swap = left;
+        left = right;
+        right = swap;
+    }
+    int node = intern_node(builder, (DagNode){DAG_BINOP, (uint8_t)expr->op, 0, left, right, 0},
+                           &created);
+    dag->operations++;
+    dag->binop_nodes += created;
+    dag->eliminated += !created && builder->available[node];
+    make_available(builder, node);
+    return node;
+}
+
+static void lower_stmt(DagBuilder* builder, const AstNode* stmt);
+
+/*
+ * lower_if(builder, stmt)
+ *
+ * A condição vale para os dois ramos. Cada ramo é desfeito ao terminar, e
+ * os valores com que saiu ficam em pending; no fim, as variáveis
+ * atribuídas em algum ramo recebem o valor da junção. Os nós que o then
+ * tornou disponíveis são guardados em carried, e os que ainda estão
+ * disponíveis no fim do else valem depois do if.
+ */
+static void lower_if(DagBuilder* builder, const AstNode* stmt) {
+    add_root(builder, stmt->kids[0], lower_expr(builder, stmt->kids[0]));
+
+    int var_mark = builder->var_count;
+    int available_mark = builder->available_count;
+    int then_start = builder->pending_count;
+    int carried_start = builder->carried_count;
+    lower_stmt(builder, stmt->kids[1]);
+    if (stmt->kid_count > 2 && builder->available_count > available_mark) {
+        int count = builder->available_count - available_mark;
+        grow((void**)&builder->carried, &builder->carried_capacity,
+             builder->carried_count + count, sizeof(int));
+        memcpy(builder->carried + builder->carried_count,
+               builder->available_log + available_mark, sizeof(int) * (size_t)count);
+        builder->carried_count += count;
+    }
+    leave_branch(builder, var_mark, available_mark);
+
+    int else_start = builder->pending_count;
+    if (stmt->kid_count > 2) {
+        lower_stmt(builder, stmt->kids[2]);
+        int kept = carried_start;
+        for (int i = carried_start; i < builder->carried_count; i++) {
+            if (builder->available[builder->carried[i]]) {
+                builder->carried[kept++] = builder->carried[i];
+            }
+        }
+        builder->carried_count = kept;
+        leave_branch(builder, var_mark, available_mark);
+        for (int i = carried_start; i < builder->carried_count; i++) {
+            make_available(builder, builder->carried[i]);
+        }
+        builder->carried_count = carried_start;
+    }
+    int end = builder->pending_count;
+
+    /* value_of voltou ao valor de antes do if, que é o do caminho sem o ramo */
+    int mark = ++builder->stamp_counter;
+    for (int i = else_start; i < end; i++) {
+        builder->stamp[builder->pending[i].local] = mark;
+        builder->scratch[builder->pending[i].local] = builder->pending[i].value;
+    }
+    for (int i = then_start; i < else_start; i++) {
+        int local = builder->pending[i].local;
+        int else_value = builder->stamp[local] == mark ? builder->scratch[local]
+                                                       : builder->value_of[local];
+        builder->stamp[local] = 0;
+        set_value(builder, local, merge_value(builder, builder->pending[i].value, else_value));
+    }
+    for (int i = else_start; i < end; i++) {
+        int local = builder->pending[i].local;
+        if (builder->stamp[local] == mark) {
+            set_value(builder, local, merge_value(builder, builder->value_of[local],
+                                                  builder->pending[i].value));
+        }
+    }
+    builder->pending_count = then_start;
+}
+
+static void lower_stmt(DagBuilder* builder, const AstNode* stmt) {
+    ExprDag* dag = builder->dag;
+    switch (stmt->kind) {
+        case AST_ASSIGN: {
+            int value;
+            if (stmt->kids[0]->kind == AST_FCALL) {
+                value = append_node(builder, (DagNode){DAG_CALL, 0, 0, -1, -1, 0});
+            } else {
+                value = lower_expr(builder, stmt->kids[0]);
+            }
+            add_root(builder, stmt->kids[0], value);
+            set_value(builder, ast_locals_var(&dag->locals, stmt), value);
+            break;
+        }
+        case AST_PRINT:
+            add_root(builder, stmt->kids[0], lower_expr(builder, stmt->kids[0]));
+            break;
+        case AST_RETURN:
+            if (stmt->kid_count > 0) {
+                add_root(builder, stmt->kids[0], lower_expr(builder, stmt->kids[0]));
+            }
+            break;
+        case AST_IF:
+            lower_if(builder, stmt);
+            break;
+        case AST_BLOCK:
+            for (int i = 0; i < stmt->kid_count; i++) {
+                lower_stmt(builder, stmt->kids[i]);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+/* ============================================================================
+ * INTERFACE
+ * ============================================================================ */
+
+void exprdag_build(const AstNode* fdef, ExprDag* dag) {
+    memset(dag, 0, sizeof(ExprDag));
+    ast_locals_build(fdef, &dag->locals);
+
+    DagBuilder builder;
+    memset(&builder, 0, sizeof(builder));
+    builder.dag = dag;
+    size_t locals = (size_t)dag->locals.count;
+    builder.value_of = (int*)checked_calloc(locals, sizeof(int));
+    builder.stamp = (int*)checked_calloc(locals, sizeof(int));
+    builder.scratch = (int*)checked_calloc(locals, sizeof(int));
+
+    for (int i = 0; i < dag->locals.count; i++) {
+        builder.value_of[i] = append_node(&builder, (DagNode){DAG_INPUT, 0, 0, i, -1, 0});
+    }
+    for (int i = 0; i < fdef->kid_count; i++) {
+        lower_stmt(&builder, fdef->kids[i]);
+    }
+
+    free(builder.slots);
+    free(builder.value_of);
+    free(builder.stamp);
+    free(builder.scratch);
+    free(builder.available);
+    free(builder.available_log);
+    free(builder.var_log);
+    free(builder.pending);
+    free(builder.carried);
+}
+
+void exprdag_free(ExprDag* dag) {
+    free(dag->nodes);
+    free(dag->roots);
+    ast_locals_free(&dag->locals);
+    memset(dag, 0, sizeof(ExprDag));
+}
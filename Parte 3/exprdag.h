@@ -0,0 +1,79 @@
+/*
+ * ============================================================================
+ * HEADER DO DAG DE EXPRESSÕES COM ELIMINAÇÃO DE SUBEXPRESSÕES COMUNS
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * As expressões de uma função (NUMEXPR, TERM e FACTOR, já como AST_BINOP,
+ * AST_NUM e AST_ID) são reescritas como um DAG em que cada valor distinto
+ * é um único nó: dois AST_BINOP com o mesmo operador sobre os mesmos
+ * valores dão o mesmo DagNode (hash-consing). As variáveis não são nós:
+ * cada uma aponta o nó do seu valor atual, e uma atribuição só muda esse
+ * apontamento, de modo que expressões sobre o valor anterior deixam de
+ * coincidir com as novas.
+ *
+ * Os nós ficam em um vetor, e os operandos são índices nele, sempre
+ * menores que o do próprio nó.
+ *
+ * */
+
+#ifndef EXPRDAG_H
+#define EXPRDAG_H
+
+#include <stdint.h>
+#include "ast.h"
+
+typedef enum {
+    DAG_CONST,              /* value = literal */
+    DAG_INPUT,              /* Valor de entrada da variável local a: parâmetro ou 0 */
+    DAG_CALL,               /* Resultado de uma chamada; cada uma é um nó distinto */
+    DAG_MERGE,              /* Junção depois de um if: a pelo then, b pelo outro caminho */
+    DAG_BINOP               /* op aplicado a a e b */
+} DagKind;
+
+typedef struct {
+    uint8_t kind;           /* DagKind */
+    uint8_t op;             /* TokenType de DAG_BINOP */
+    uint16_t reserved;
+    int32_t a;
+    int32_t b;
+    int64_t value;
+} DagNode;
+
+/*
+ * Valor de cada expressão da função, na ordem do programa: a expressão ou
+ * AST_FCALL de AST_ASSIGN, a de AST_PRINT, a condição de AST_IF e o
+ * AST_ID de AST_RETURN.
+ */
+typedef struct {
+    const AstNode* expr;
+    int value;              /* Índice em ExprDag.nodes */
+} DagRoot;
+
+typedef struct {
+    DagNode* nodes;
+    int node_count;
+    int node_capacity;
+    DagRoot* roots;
+    int root_count;
+    int root_capacity;
+    int operations;         /* AST_BINOP das expressões */
+    int eliminated;         /* Operações cujo valor já foi calculado em todo caminho até elas */
+    int binop_nodes;        /* Nós DAG_BINOP */
+    int expr_nodes;         /* AST_BINOP, AST_NUM e AST_ID das expressões */
+    AstLocals locals;
+} ExprDag;
+
+/*
+ * Monta o DAG de uma AST_FDEF (ou de um programa de um único comando).
+ * Uma operação é redundante quando o mesmo valor foi calculado antes em
+ * todo caminho até ela: antes no mesmo bloco, antes de um if, na sua
+ * condição ou nos dois ramos, mas não em um só deles. Operações iguais
+ * em ramos diferentes compartilham o nó sem contar como eliminadas. + e
+ * * e os operadores == e != são comutativos.
+ */
+void exprdag_build(const AstNode* fdef, ExprDag* dag);
+void exprdag_free(ExprDag* dag);
+
+#endif
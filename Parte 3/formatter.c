@@ -0,0 +1,332 @@
+/*
+ * ============================================================================
+ * FORMATADOR DE CÓDIGO-FONTE LSI-2025-2
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * Reescreve um programa no formato canônico direto a partir dos tokens de
+ * getToken(), sem montar a árvore sintática nem cadeias intermediárias:
+ *   - Um comando por linha, indentado com quatro espaços por nível de
+ *     chaves; "{" fecha a linha que o abre e "}" fica em linha própria,
+ *     seguida de " else {" quando há else
+ *   - Uma linha em branco entre funções
+ *   - Operadores e "=" entre espaços, espaço depois de "," e das
+ *     palavras-chave, nenhum dentro de parênteses nem antes de "(" em
+ *     chamadas e definições
+ *
+ * Na gramática, if e else sempre têm chaves e ";" só aparece no fim de
+ * um comando, de modo que a profundidade de chaves e os ";" bastam para
+ * decidir quebras de linha e indentação. A gramática completa não é
+ * verificada (para isso há a validação normal); só erros léxicos e chaves
+ * ou parênteses desbalanceados interrompem a formatação.
+ *
+ * O lexer roda sem a tabela de símbolos (lexer_set_symbol_table()), e os
+ * lexemas são copiados do seu buffer de entrada para um buffer de saída de
+ * FORMAT_BUFFER_SIZE bytes, esvaziado com um único write() por vez. Como a
+ * saída depende só da sequência de tokens, e reformatá-la produz a mesma
+ * sequência, a formatação é idempotente.
+ *
+ * ============================================================================
+ */
+
+#include "formatter.h"
+#include "lexer.h"
+#include <errno.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+extern Token getToken(void);
+extern void lexer_reset(FILE* input);
+
+#define INDENT_WIDTH 4
+
+static const char spaces[] = "                                                                ";
+
+typedef struct {
+    char* data;
+    size_t used;
+    int fd;
+    int failed;             /* errno de um write() que falhou, ou 0 */
+} OutputBuffer;
+
+/* ============================================================================
+ * BUFFER DE SAÍDA
+ * ============================================================================ */
+
+static void output_flush(OutputBuffer* out) {
+    size_t done = 0;
+    while (done < out->used && !out->failed) {
+        ssize_t n = write(out->fd, out->data + done, out->used - done);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            out->failed = n < 0 ? errno : EIO;
+            break;
+        }
+        done += (size_t)n;
+    }
+    out->used = 0;
+}
+
+static inline void output_append(OutputBuffer* out, const char* data, size_t length) {
+    if (out->used + length > FORMAT_BUFFER_SIZE) {
+        output_flush(out);
+        if (length > FORMAT_BUFFER_SIZE) {      /* Lexema maior que o buffer inteiro */
+            while (length > 0) {
+                size_t part = length < FORMAT_BUFFER_SIZE ? length : FORMAT_BUFFER_SIZE;
+                memcpy(out->data, data, part);
+                out->used = part;
+                output_flush(out);
+                data += part;
+                length -= part;
+            }
+            return;
+        }
+    }
+    memcpy(out->data + out->used, data, length);
+    out->used += length;
+}
+
+static inline void output_char(OutputBuffer* out, char c) {
+    if (out->used == FORMAT_BUFFER_SIZE) {
+        output_flush(out);
+    }
+    out->data[out->used++] = c;
+}
+
+static void output_indent(OutputBuffer* out, int depth) {
+    size_t width = (size_t)depth * INDENT_WIDTH;
+    while (width > 0) {
+        size_t part = width < sizeof(spaces) - 1 ? width : sizeof(spaces) - 1;
+        output_append(out, spaces, part);
+        width -= part;
+    }
+}
+
+/* ============================================================================
+ * TOKENS
+ * ============================================================================ */
+
+/* Texto dos tokens de lexema fixo, indexado por TokenType */
+static const char* const fixed_text[] = {
+    [TOKEN_INT] = "int", [TOKEN_IF] = "if", [TOKEN_ELSE] = "else", [TOKEN_DEF] = "def",
+    [TOKEN_PRINT] = "print", [TOKEN_RETURN] = "return",
+    [TOKEN_LT] = "<", [TOKEN_LTE] = "<=", [TOKEN_GT] = ">", [TOKEN_GTE] = ">=",
+    [TOKEN_EQ] = "==", [TOKEN_NEQ] = "!=", [TOKEN_PLUS] = "+", [TOKEN_MINUS] = "-",
+    [TOKEN_MULT] = "*", [TOKEN_DIV] = "/", [TOKEN_ASSIGN] = "=",
+    [TOKEN_LPAREN] = "(", [TOKEN_RPAREN] = ")", [TOKEN_LBRACE] = "{", [TOKEN_RBRACE] = "}",
+    [TOKEN_COMMA] = ",", [TOKEN_SEMICOLON] = ";", [TOKEN_EOF] = "EOF"
+};
+
+static const unsigned char fixed_length[] = {
+    [TOKEN_INT] = 3, [TOKEN_IF] = 2, [TOKEN_ELSE] = 4, [TOKEN_DEF] = 3,
+    [TOKEN_PRINT] = 5, [TOKEN_RETURN] = 6,
+    [TOKEN_LT] = 1, [TOKEN_LTE] = 2, [TOKEN_GT] = 1, [TOKEN_GTE] = 2,
+    [TOKEN_EQ] = 2, [TOKEN_NEQ] = 2, [TOKEN_PLUS] = 1, [TOKEN_MINUS] = 1,
+    [TOKEN_MULT] = 1, [TOKEN_DIV] = 1, [TOKEN_ASSIGN] = 1,
+    [TOKEN_LPAREN] = 1, [TOKEN_RPAREN] = 1, [TOKEN_LBRACE] = 1, [TOKEN_RBRACE] = 1,
+    [TOKEN_COMMA] = 1, [TOKEN_SEMICOLON] = 1, [TOKEN_EOF] = 3
+};
+
+/*
+ * lexeme_length(token)
+ *
+ * Sem a tabela de símbolos, identificadores e números podem apontar para
+ * o buffer do lexer sem terminador; terminam no primeiro caractere que não
+ * continua o token.
+ */
+static inline size_t lexeme_length(const Token* token) {
+    const char* p = token->lexeme;
+    if (token->type == TOKEN_NUM) {
+        while (*p >= '0' && *p <= '9') {
+            p++;
+        }
+        return (size_t)(p - token->lexeme);
+    }
+    if (token->type == TOKEN_ID) {
+        while ((*p >= 'a' && *p <= 'z') || (*p >= 'A' && *p <= 'Z') ||
+               (*p >= '0' && *p <= '9') || *p == '_') {
+            p++;
+        }
+        return (size_t)(p - token->lexeme);
+    }
+    return token->type == TOKEN_ERROR ? strlen(p) : fixed_length[token->type];
+}
+
+/*
+ * needs_space(previous, current)
+ *
+ * Espaço entre dois tokens da mesma linha.
+ */
+static inline int needs_space(TokenType previous, TokenType current) {
+    if (current == TOKEN_RPAREN || current == TOKEN_COMMA || current == TOKEN_SEMICOLON) {
+        return 0;
+    }
+    if (previous == TOKEN_LPAREN) {
+        return 0;
+    }
+    return !(current == TOKEN_LPAREN && previous == TOKEN_ID);
+}
+
+/*
+ * format_error(diag, kind, token, expected)
+ *
+ * Preenche o diagnóstico no estilo dos erros do analisador sintático.
+ * expected é o token que faltou, ou TOKEN_ERROR se o token atual não era
+ * esperado.
+ */
+static void format_error(Diagnostic* diag, const Token* token, TokenType expected) {
+    int64_t line, col;
+    lexer_position(token->offset, &line, &col);
+    if (token->type == TOKEN_ERROR) {
+        diagnostic_set(diag, DIAG_LEXICAL, line, col,
+                       "--- Erro Sintático ---\n"
+                       "Token inesperado: '%s' (%s)\n"
+                       "Localização: linha %" PRId64 ", coluna %" PRId64,
+                       token->lexeme, token_type_to_string(token->type), line, col);
+        return;
+    }
+    size_t length = lexeme_length(token);
+    if (expected != TOKEN_ERROR) {
+        diagnostic_set(diag, DIAG_SYNTAX, line, col,
+                       "--- Erro Sintático ---\n"
+                       "Esperado: %s\n"
+                       "Encontrado: '%.*s' (%s) na linha %" PRId64 ", coluna %" PRId64,
+                       token_type_to_string(expected),
+                       length > 40 ? 40 : (int)length, token->lexeme,
+                       token_type_to_string(token->type), line, col);
+        return;
+    }
+    diagnostic_set(diag, DIAG_SYNTAX, line, col,
+                   "--- Erro Sintático ---\n"
+                   "Token inesperado: '%.*s' (%s)\n"
+                   "Localização: linha %" PRId64 ", coluna %" PRId64,
+                   length > 40 ? 40 : (int)length, token->lexeme,
+                   token_type_to_string(token->type), line, col);
+}
+
+/* ============================================================================
+ * FORMATAÇÃO
+ * ============================================================================ */
+
+/*
+ * format_file(input, output, diag)
+ *
+ * line_open indica que a linha corrente já tem algum token. Depois de "}"
+ * a linha fica aberta até o próximo token, que decide entre " else" na
+ * mesma linha ou uma quebra (e uma linha em branco, se a "}" fechou uma
+ * função).
+ */
+int format_file(FILE* input, int output, Diagnostic* diag) {
+    OutputBuffer out = {0};
+    out.data = (char*)malloc(FORMAT_BUFFER_SIZE);
+    out.fd = output;
+    if (out.data == NULL) {
+        fprintf(stderr, "Erro fatal: Memória insuficiente para o buffer de saída.\n");
+        exit(1);
+    }
+
+    lexer_set_symbol_table(0);
+    lexer_reset(input);
+
+    int depth = 0;
+    int parens = 0;
+    int line_open = 0;
+    int status = 0;
+    TokenType previous = TOKEN_EOF;
+
+    for (;;) {
+        Token token = getToken();
+        TokenType type = token.type;
+
+        if (type == TOKEN_ERROR) {
+            format_error(diag, &token, TOKEN_ERROR);
+            status = 1;
+            break;
+        }
+        if (type == TOKEN_EOF) {
+            if (depth > 0 || parens > 0) {
+                format_error(diag, &token, parens > 0 ? TOKEN_RPAREN : TOKEN_RBRACE);
+                status = 1;
+            } else if (line_open) {
+                output_char(&out, '\n');
+            }
+            break;
+        }
+        if ((parens > 0 && (type == TOKEN_LBRACE || type == TOKEN_RBRACE ||
+                            type == TOKEN_SEMICOLON)) ||
+            (type == TOKEN_RBRACE && depth == 0) || (type == TOKEN_RPAREN && parens == 0)) {
+            format_error(diag, &token, TOKEN_ERROR);
+            status = 1;
+            break;
+        }
+
+        /* Fecha a linha da "}" anterior, exceto em "} else" */
+        if (previous == TOKEN_RBRACE && type != TOKEN_ELSE) {
+            output_char(&out, '\n');
+            if (depth == 0) {
+                output_char(&out, '\n');
+            }
+            line_open = 0;
+        }
+
+        switch (type) {
+            case TOKEN_LBRACE:
+                if (line_open) {
+                    output_append(&out, " {\n", 3);
+                } else {
+                    output_indent(&out, depth);
+                    output_append(&out, "{\n", 2);
+                }
+                depth++;
+                line_open = 0;
+                break;
+            case TOKEN_RBRACE:
+                if (line_open) {
+                    output_char(&out, '\n');
+                }
+                depth--;
+                output_indent(&out, depth);
+                output_char(&out, '}');
+                line_open = 1;
+                break;
+            case TOKEN_SEMICOLON:
+                if (!line_open) {
+                    output_indent(&out, depth);     /* Comando vazio */
+                }
+                output_append(&out, ";\n", 2);
+                line_open = 0;
+                break;
+            default:
+                if (!line_open) {
+                    output_indent(&out, depth);
+                } else if (needs_space(previous, type)) {
+                    output_char(&out, ' ');
+                }
+                if (type == TOKEN_ID || type == TOKEN_NUM) {
+                    output_append(&out, token.lexeme, lexeme_length(&token));
+                } else {
+                    output_append(&out, fixed_text[type], fixed_length[type]);
+                }
+                line_open = 1;
+                parens += type == TOKEN_LPAREN;
+                parens -= type == TOKEN_RPAREN;
+                break;
+        }
+        previous = type;
+    }
+
+    output_flush(&out);
+    if (status == 0 && out.failed) {
+        diagnostic_set(diag, DIAG_FATAL, 0, 0, "Erro ao escrever a saída: %s",
+                       strerror(out.failed));
+        status = 1;
+    }
+    lexer_set_symbol_table(1);
+    free(out.data);
+    return status;
+}
@@ -0,0 +1,28 @@
+/*
+ * ============================================================================
+ * HEADER DO FORMATADOR DE CÓDIGO-FONTE LSI-2025-2
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * */
+
+#ifndef FORMATTER_H
+#define FORMATTER_H
+
+#include <stdio.h>
+#include "diagnostic.h"
+
+/* Tamanho do buffer de saída; cada esvaziamento é uma chamada write() */
+#define FORMAT_BUFFER_SIZE (1 << 20)
+
+/*
+ * Reescreve o programa lido de input no formato canônico, no descritor
+ * output. Retorna 0 em caso de sucesso, ou 1 após preencher diag com o
+ * erro léxico, de chaves ou parênteses desbalanceados ou de escrita; nesse
+ * caso a saída já escrita fica incompleta. Reformatar a saída produz os
+ * mesmos bytes.
+ */
+int format_file(FILE* input, int output, Diagnostic* diag);
+
+#endif
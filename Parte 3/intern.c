@@ -0,0 +1,343 @@
+/*
+ * ============================================================================
+ * TABELA DE INTERNAÇÃO DE NOMES COMPARTILHADA ENTRE THREADS
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * Substitui a tabela de símbolos do lexer quando vários arquivos são
+ * analisados em paralelo (--threads), de modo que cada nome é guardado uma
+ * única vez no processo e recebe o mesmo número em todos os arquivos:
+ *   - Os nomes são distribuídos pelo hash entre SHARD_COUNT partes, cada
+ *     uma uma tabela de endereçamento aberto com sondagem linear
+ *   - Uma posição só passa de vazia para ocupada, publicada por
+ *     compare-and-swap. A leitura não usa travas nem espera: segue a
+ *     sondagem até achar o nome ou uma posição vazia
+ *   - Uma parte cresce encadeando uma nova geração com o dobro de posições;
+ *     as antigas continuam válidas e são consultadas primeiro. Cada
+ *     geração aceita no máximo 3/4 de ocupação, contada por reservas. Só
+ *     no momento, raro, em que uma geração enche, a inserção pode esperar
+ *     as inserções já reservadas nela terminarem antes de passar à
+ *     seguinte, o que impede o mesmo nome em duas gerações
+ *   - Os textos ficam em blocos próprios de cada thread, sem disputa no
+ *     malloc
+ *   - Os números são consecutivos na ordem de inserção, exceto por uma
+ *     lacuna quando duas threads inserem o mesmo nome ao mesmo tempo
+ *
+ * ============================================================================
+ */
+
+#define _GNU_SOURCE
+
+#include "intern.h"
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ============================================================================
+ * ESTRUTURAS
+ * ============================================================================ */
+
+#define SHARD_BITS 6
+#define SHARD_COUNT (1 << SHARD_BITS)
+#define INITIAL_SLOTS 1024                  /* Posições da primeira geração de cada parte */
+#define TEXT_BLOCK_SIZE (64 * 1024)
+#define DIRECTORY_CHUNK 4096
+#define DIRECTORY_CHUNKS (INTERN_MAX_SYMBOLS / DIRECTORY_CHUNK)
+
+typedef struct {
+    uint64_t hash;
+    int id;
+    int length;
+    char text[];
+} InternEntry;
+
+typedef struct InternTable {
+    struct InternTable* next;   /* Geração seguinte, com o dobro de posições */
+    size_t mask;
+    size_t limit;               /* Reservas aceitas: 3/4 das posições */
+    size_t claimed;             /* Reservas pedidas, aceitas ou não */
+    size_t committed;           /* Reservas aceitas já concluídas */
+    InternEntry* slots[];
+} InternTable;
+
+typedef struct {
+    InternTable* first;
+} __attribute__((aligned(64))) InternShard;
+
+static InternShard shards[SHARD_COUNT];
+
+/* Número do símbolo -> entrada, em blocos alocados sob demanda */
+static InternEntry** directory[DIRECTORY_CHUNKS];
+static int next_id = 0;
+
+/* Bloco de textos da thread corrente */
+static __thread char* text_block = NULL;
+static __thread size_t text_left = 0;
+
+/* ============================================================================
+ * FUNÇÕES AUXILIARES
+ * ============================================================================ */
+
+static void intern_fatal(const char* message) {
+    fprintf(stderr, "Erro fatal: %s\n", message);
+    exit(1);
+}
+
+/*
+ * hash_name(name, length)
+ *
+ * FNV-1a de 64 bits seguido de uma mistura final, para que tanto os bits
+ * altos (escolha da parte) quanto os baixos (posição) variem bem.
+ */
+static uint64_t hash_name(const char* name, size_t length) {
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ (unsigned char)name[i]) * 1099511628211ull;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+static inline int entry_matches(const InternEntry* entry, uint64_t hash,
+                                const char* name, size_t length) {
+    return entry->hash == hash && (size_t)entry->length == length &&
+           memcmp(entry->text, name, length) == 0;
+}
+
+static InternTable* table_new(size_t slot_count) {
+    InternTable* table = (InternTable*)calloc(1, sizeof(InternTable) +
+                                              slot_count * sizeof(InternEntry*));
+    if (table == NULL) {
+        intern_fatal("Memória insuficiente para a tabela de símbolos.");
+    }
+    table->mask = slot_count - 1;
+    table->limit = slot_count / 4 * 3;
+    return table;
+}
+
+/*
+ * directory_store(id, entry)
+ *
+ * Registra a entrada do número id, criando o bloco do diretório se ele
+ * ainda não existe.
+ */
+static void directory_store(int id, InternEntry* entry) {
+    InternEntry*** cell = &directory[id / DIRECTORY_CHUNK];
+    InternEntry** chunk = __atomic_load_n(cell, __ATOMIC_ACQUIRE);
+    if (chunk == NULL) {
+        InternEntry** fresh = (InternEntry**)calloc(DIRECTORY_CHUNK, sizeof(InternEntry*));
+        if (fresh == NULL) {
+            intern_fatal("Memória insuficiente para a tabela de símbolos.");
+        }
+        if (__atomic_compare_exchange_n(cell, &chunk, fresh, 0,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            chunk = fresh;
+        } else {
+            free(fresh);
+        }
+    }
+    __atomic_store_n(&chunk[id % DIRECTORY_CHUNK], entry, __ATOMIC_RELEASE);
+}
+
+/*
+ * entry_new(hash, name, length)
+ *
+ * Copia o nome para o bloco de textos da thread e reserva seu número.
+ */
+static InternEntry* entry_new(uint64_t hash, const char* name, size_t length) {
+    size_t size = (sizeof(InternEntry) + length + 1 + 7) & ~(size_t)7;
+    if (size > text_left) {
+        size_t block_size = size > TEXT_BLOCK_SIZE ? size : TEXT_BLOCK_SIZE;
+        text_block = (char*)malloc(block_size);
+        if (text_block == NULL) {
+            intern_fatal("Memória insuficiente para a tabela de símbolos.");
+        }
+        text_left = block_size;
+    }
+    InternEntry* entry = (InternEntry*)text_block;
+    text_block += size;
+    text_left -= size;
+
+    entry->hash = hash;
+    entry->length = (int)length;
+    memcpy(entry->text, name, length);
+    entry->text[length] = '\0';
+    entry->id = __atomic_fetch_add(&next_id, 1, __ATOMIC_RELAXED);
+    if (entry->id >= INTERN_MAX_SYMBOLS) {
+        intern_fatal("Tabela de símbolos cheia.");
+    }
+    directory_store(entry->id, entry);
+    return entry;
+}
+
+/*
+ * entry_discard(entry)
+ *
+ * Desfaz entry_new() quando outra thread publicou o mesmo nome antes. A
+ * entrada é a última do bloco da thread, então o espaço é devolvido.
+ */
+static void entry_discard(InternEntry* entry) {
+    size_t size = (sizeof(InternEntry) + (size_t)entry->length + 1 + 7) & ~(size_t)7;
+    directory_store(entry->id, NULL);
+    text_block -= size;
+    text_left += size;
+}
+
+/* ============================================================================
+ * SONDAGEM E INSERÇÃO
+ * ============================================================================ */
+
+/*
+ * table_probe(table, hash, name, length)
+ *
+ * Segue a sondagem linear até o nome ou até uma posição vazia. Termina
+ * sempre, pois nenhuma geração passa de 3/4 de ocupação.
+ */
+static InternEntry* table_probe(const InternTable* table, uint64_t hash,
+                                const char* name, size_t length) {
+    for (size_t i = hash & table->mask;; i = (i + 1) & table->mask) {
+        InternEntry* entry = __atomic_load_n(&table->slots[i], __ATOMIC_ACQUIRE);
+        if (entry == NULL) {
+            return NULL;
+        }
+        if (entry_matches(entry, hash, name, length)) {
+            return entry;
+        }
+    }
+}
+
+/*
+ * table_insert(table, entry)
+ *
+ * Publica a entrada na primeira posição vazia da sondagem. Se outra
+ * thread publicar o mesmo nome antes, retorna a entrada dela.
+ */
+static InternEntry* table_insert(InternTable* table, InternEntry* entry) {
+    for (size_t i = entry->hash & table->mask;; i = (i + 1) & table->mask) {
+        InternEntry* current = __atomic_load_n(&table->slots[i], __ATOMIC_ACQUIRE);
+        if (current == NULL &&
+            __atomic_compare_exchange_n(&table->slots[i], &current, entry, 0,
+                                        __ATOMIC_RELEASE, __ATOMIC_ACQUIRE)) {
+            return entry;
+        }
+        if (entry_matches(current, entry->hash, entry->text, (size_t)entry->length)) {
+            return current;
+        }
+    }
+}
+
+/*
+ * table_seal(table)
+ *
+ * Chamada por quem encontrou a geração cheia: garante que a seguinte
+ * existe e espera as inserções já reservadas nesta terminarem, para que
+ * uma nova sondagem nela seja definitiva.
+ */
+static void table_seal(InternTable* table) {
+    if (__atomic_load_n(&table->next, __ATOMIC_ACQUIRE) == NULL) {
+        InternTable* expected = NULL;
+        InternTable* fresh = table_new((table->mask + 1) * 2);
+        if (!__atomic_compare_exchange_n(&table->next, &expected, fresh, 0,
+                                         __ATOMIC_RELEASE, __ATOMIC_ACQUIRE)) {
+            free(fresh);
+        }
+    }
+    while (__atomic_load_n(&table->committed, __ATOMIC_ACQUIRE) < table->limit) {
+        sched_yield();
+    }
+}
+
+/* ============================================================================
+ * INTERFACE
+ * ============================================================================ */
+
+void intern_init(void) {
+    static int initialized = 0;
+    if (!initialized) {
+        for (int i = 0; i < SHARD_COUNT; i++) {
+            shards[i].first = table_new(INITIAL_SLOTS);
+        }
+        initialized = 1;
+    }
+}
+
+/*
+ * intern_symbol(name, length, text)
+ *
+ * Percorre as gerações da parte do nome. Só passa de uma geração à
+ * seguinte depois que todas as inserções reservadas nela terminaram; do
+ * contrário, o nome poderia estar sendo inserido nela enquanto esta
+ * thread o insere na seguinte. Na última, reserva uma vaga e publica uma
+ * nova entrada; se a geração está cheia, sela-a e volta a sondá-la.
+ */
+int intern_symbol(const char* name, size_t length, const char** text) {
+    uint64_t hash = hash_name(name, length);
+    InternTable* table = __atomic_load_n(&shards[hash >> (64 - SHARD_BITS)].first,
+                                         __ATOMIC_ACQUIRE);
+
+    for (;;) {
+        /* Lido antes da sondagem: se a geração já estava completa, a falta é definitiva */
+        InternTable* next = __atomic_load_n(&table->next, __ATOMIC_ACQUIRE);
+        int complete = next != NULL &&
+                       __atomic_load_n(&table->committed, __ATOMIC_ACQUIRE) == table->limit;
+
+        InternEntry* found = table_probe(table, hash, name, length);
+        if (found != NULL) {
+            *text = found->text;
+            return found->id;
+        }
+        if (complete) {
+            table = next;
+            continue;
+        }
+
+        if (next == NULL &&
+            __atomic_fetch_add(&table->claimed, 1, __ATOMIC_RELAXED) < table->limit) {
+            InternEntry* entry = entry_new(hash, name, length);
+            InternEntry* winner = table_insert(table, entry);
+            __atomic_fetch_add(&table->committed, 1, __ATOMIC_RELEASE);
+            if (winner != entry) {
+                entry_discard(entry);
+            }
+            *text = winner->text;
+            return winner->id;
+        }
+        table_seal(table);
+    }
+}
+
+int intern_find(const char* name, size_t length) {
+    uint64_t hash = hash_name(name, length);
+    const InternTable* table = __atomic_load_n(&shards[hash >> (64 - SHARD_BITS)].first,
+                                               __ATOMIC_ACQUIRE);
+    while (table != NULL) {
+        InternEntry* found = table_probe(table, hash, name, length);
+        if (found != NULL) {
+            return found->id;
+        }
+        table = __atomic_load_n(&table->next, __ATOMIC_ACQUIRE);
+    }
+    return -1;
+}
+
+const char* intern_text(int id) {
+    if (id < 0 || id >= INTERN_MAX_SYMBOLS) {
+        return NULL;
+    }
+    InternEntry** chunk = __atomic_load_n(&directory[id / DIRECTORY_CHUNK], __ATOMIC_ACQUIRE);
+    if (chunk == NULL) {
+        return NULL;
+    }
+    InternEntry* entry = __atomic_load_n(&chunk[id % DIRECTORY_CHUNK], __ATOMIC_ACQUIRE);
+    return entry != NULL ? entry->text : NULL;
+}
+
+int intern_count(void) {
+    int count = __atomic_load_n(&next_id, __ATOMIC_ACQUIRE);
+    return count < INTERN_MAX_SYMBOLS ? count : INTERN_MAX_SYMBOLS;
+}
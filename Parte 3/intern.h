@@ -0,0 +1,38 @@
+/*
+ * ============================================================================
+ * HEADER DA TABELA DE INTERNAÇÃO DE NOMES
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * */
+
+#ifndef INTERN_H
+#define INTERN_H
+
+#include <stddef.h>
+
+/* Limite de nomes distintos por processo */
+#define INTERN_MAX_SYMBOLS (1 << 26)
+
+/* Prepara a tabela. Deve ser chamada uma vez, antes de criar as threads. */
+void intern_init(void);
+
+/*
+ * Procura o nome e o insere se ainda não existe. Retorna o número do
+ * símbolo, o mesmo para o mesmo nome em qualquer thread, e em *text a
+ * cópia guardada, válida enquanto o processo existir. Pode ser chamada de
+ * várias threads ao mesmo tempo.
+ */
+int intern_symbol(const char* name, size_t length, const char** text);
+
+/* Procura sem inserir. Retorna o número do símbolo ou -1. */
+int intern_find(const char* name, size_t length);
+
+/* Nome do símbolo, ou NULL se o número não foi atribuído */
+const char* intern_text(int id);
+
+/* Números atribuídos até agora (limite superior dos números válidos) */
+int intern_count(void);
+
+#endif
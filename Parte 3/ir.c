@@ -0,0 +1,804 @@
+/*
+ * ============================================================================
+ * REPRESENTAÇÃO INTERMEDIÁRIA EM SSA
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * Tradução da árvore para SSA em uma passada em ordem por função, sem
+ * fronteiras de dominância: como não há laços, cada if é uma região com
+ * uma entrada e uma junção, e o valor de cada variável ao fim de cada
+ * ramo é conhecido quando a junção é criada.
+ *   - value_of aponta, por variável local, a instrução do valor atual;
+ *     parâmetros começam em IR_PARAM e as demais variáveis no IR_CONST 0
+ *     da entrada (os geradores de código iniciam os locais com 0)
+ *   - Ao sair de um ramo, um registro de desfazer restaura value_of e
+ *     guarda o valor com que cada variável atribuída saiu dele; na junção,
+ *     cada uma ganha um PHI com um operando por predecessor vivo
+ *   - Comandos depois de return não são traduzidos, e um ramo que termina
+ *     em return não é predecessor da junção
+ *
+ * Os blocos são criados na ordem em que o código aparece e um bloco só
+ * começa depois que o anterior terminou, de modo que as instruções de
+ * cada bloco são contíguas e toda aresta vai para um bloco posterior.
+ *
+ * ============================================================================
+ */
+
+#include "ir.h"
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * grow(array, capacity, needed, element)
+ *
+ * Garante espaço para needed elementos, dobrando a capacidade. Encerra o
+ * processo se a memória acabar.
+ */
+static void grow(void** array, int* capacity, int needed, size_t element) {
+    if (needed <= *capacity) {
+        return;
+    }
+    int new_capacity = *capacity ? *capacity : 16;
+    while (new_capacity < needed) {
+        new_capacity *= 2;
+    }
+    void* memory = realloc(*array, element * (size_t)new_capacity);
+    if (memory == NULL) {
+        fprintf(stderr, "Erro fatal: Memória insuficiente para a representação intermediária.\n");
+        exit(1);
+    }
+    *array = memory;
+    *capacity = new_capacity;
+}
+
+static void* checked_calloc(size_t count, size_t size) {
+    void* memory = calloc(count ? count : 1, size);
+    if (memory == NULL) {
+        fprintf(stderr, "Erro fatal: Memória insuficiente para a representação intermediária.\n");
+        exit(1);
+    }
+    return memory;
+}
+
+/* ============================================================================
+ * CONTEXTO DA TRADUÇÃO
+ * ============================================================================ */
+
+typedef struct {
+    int local;
+    int32_t value;          /* Em var_log, o valor anterior; em pending, o de saída do ramo */
+} VarChange;
+
+typedef struct {
+    IrFunction* function;
+    const AstFunctionTable* table;
+    const int* program_index;   /* Por posição em table: índice da função no programa */
+    AstLocals locals;
+    int32_t* value_of;
+    int* stamp;                 /* Por variável local: marca de uso temporário */
+    int32_t* scratch;           /* Por variável local: valor guardado junto com stamp */
+    int stamp_counter;
+    VarChange* var_log;
+    int var_count;
+    int var_capacity;
+    VarChange* pending;         /* Valores de saída de cada ramo, empilhados pelos if */
+    int pending_count;
+    int pending_capacity;
+    int current;                /* Bloco aberto, ou -1 depois de return */
+    int32_t zero;               /* IR_CONST 0 da entrada */
+} IrBuilder;
+
+static int32_t emit(IrBuilder* builder, IrOp op, int32_t a, int32_t b, int32_t c, int64_t value) {
+    IrFunction* function = builder->function;
+    grow((void**)&function->insts, &function->inst_capacity, function->inst_count + 1,
+         sizeof(IrInst));
+    IrInst* inst = &function->insts[function->inst_count];
+    memset(inst, 0, sizeof(IrInst));
+    inst->op = (uint8_t)op;
+    inst->a = a;
+    inst->b = b;
+    inst->c = c;
+    inst->value = value;
+    return function->inst_count++;
+}
+
+static int32_t add_operands(IrFunction* function, int count) {
+    grow((void**)&function->operands, &function->operand_capacity,
+         function->operand_count + count, sizeof(int32_t));
+    int32_t start = function->operand_count;
+    function->operand_count += count;
+    return start;
+}
+
+static int begin_block(IrBuilder* builder) {
+    IrFunction* function = builder->function;
+    grow((void**)&function->blocks, &function->block_capacity, function->block_count + 1,
+         sizeof(IrBlock));
+    IrBlock* block = &function->blocks[function->block_count];
+    memset(block, 0, sizeof(IrBlock));
+    block->start = function->inst_count;
+    builder->current = function->block_count;
+    return function->block_count++;
+}
+
+/*
+ * terminate(builder, op, a, b, c)
+ *
+ * Emite o terminador do bloco aberto e o fecha.
+ */
+static int32_t terminate(IrBuilder* builder, IrOp op, int32_t a, int32_t b, int32_t c) {
+    int32_t inst = emit(builder, op, a, b, c, 0);
+    builder->function->blocks[builder->current].end = builder->function->inst_count;
+    builder->current = -1;
+    return inst;
+}
+
+static void set_value(IrBuilder* builder, int local, int32_t value) {
+    grow((void**)&builder->var_log, &builder->var_capacity, builder->var_count + 1,
+         sizeof(VarChange));
+    builder->var_log[builder->var_count++] = (VarChange){local, builder->value_of[local]};
+    builder->value_of[local] = value;
+}
+
+/*
+ * leave_branch(builder, var_mark)
+ *
+ * Desfaz as atribuições do ramo e empilha em pending, uma vez por
+ * variável, o valor com que ela saiu dele (a primeira ocorrência no
+ * registro percorrido de trás para a frente é a última atribuição).
+ */
+static void leave_branch(IrBuilder* builder, int var_mark) {
+    int mark = ++builder->stamp_counter;
+    for (int i = builder->var_count - 1; i >= var_mark; i--) {
+        int local = builder->var_log[i].local;
+        if (builder->stamp[local] != mark) {
+            builder->stamp[local] = mark;
+            grow((void**)&builder->pending, &builder->pending_capacity,
+                 builder->pending_count + 1, sizeof(VarChange));
+            builder->pending[builder->pending_count++] =
+                (VarChange){local, builder->value_of[local]};
+        }
+        builder->value_of[local] = builder->var_log[i].value;
+    }
+    builder->var_count = var_mark;
+}
+
+/* ============================================================================
+ * TRADUÇÃO DE EXPRESSÕES E COMANDOS
+ * ============================================================================ */
+
+static IrOp binary_op(TokenType op) {
+    switch (op) {
+        case TOKEN_PLUS: return IR_ADD;
+        case TOKEN_MINUS: return IR_SUB;
+        case TOKEN_MULT: return IR_MUL;
+        case TOKEN_DIV: return IR_DIV;
+        case TOKEN_LT: return IR_LT;
+        case TOKEN_LTE: return IR_LTE;
+        case TOKEN_GT: return IR_GT;
+        case TOKEN_GTE: return IR_GTE;
+        case TOKEN_EQ: return IR_EQ;
+        default: return IR_NEQ;
+    }
+}
+
+static int32_t variable_value(IrBuilder* builder, const AstNode* id) {
+    return builder->value_of[ast_locals_var(&builder->locals, id)];
+}
+
+static int32_t lower_expr(IrBuilder* builder, const AstNode* expr) {
+    if (expr->kind == AST_ID) {
+        return variable_value(builder, expr);
+    }
+    if (expr->kind == AST_NUM) {
+        return emit(builder, IR_CONST, 0, 0, 0, expr->value);
+    }
+    int32_t left = lower_expr(builder, expr->kids[0]);
+    int32_t right = lower_expr(builder, expr->kids[1]);
+    int64_t position = expr->op == TOKEN_DIV ? ((int64_t)expr->line << 32) | (uint32_t)expr->col : 0;
+    return emit(builder, binary_op(expr->op), left, right, 0, position);
+}
+
+static int32_t lower_call(IrBuilder* builder, const AstNode* call) {
+    IrFunction* function = builder->function;
+    int callee = ast_function_index(builder->table, call->name);
+    int32_t start = add_operands(function, call->kid_count);
+    for (int i = 0; i < call->kid_count; i++) {
+        function->operands[start + i] = variable_value(builder, call->kids[i]);
+    }
+    return emit(builder, IR_CALL, start, call->kid_count, 0,
+                callee >= 0 ? builder->program_index[callee] : -1);
+}
+
+static void lower_stmt(IrBuilder* builder, const AstNode* stmt);
+
+/*
+ * mark_branch(builder, start, end, mark)
+ *
+ * Marca em stamp as variáveis de pending[start .. end) e guarda em
+ * scratch o valor com que saíram do ramo.
+ */
+static void mark_branch(IrBuilder* builder, int start, int end, int mark) {
+    for (int i = start; i < end; i++) {
+        builder->stamp[builder->pending[i].local] = mark;
+        builder->scratch[builder->pending[i].local] = builder->pending[i].value;
+    }
+}
+
+/*
+ * lower_if(builder, stmt)
+ *
+ * O bloco da condição termina em BR para o then e para o else (ou para a
+ * junção). Os predecessores vivos da junção, em ordem crescente de
+ * bloco, são o fim do then e o fim do else (ou o bloco da condição); com
+ * dois, cada variável atribuída em algum ramo ganha um PHI.
+ */
+static void lower_if(IrBuilder* builder, const AstNode* stmt) {
+    IrFunction* function = builder->function;
+    int32_t condition = lower_expr(builder, stmt->kids[0]);
+    int condition_block = builder->current;
+    int32_t branch = terminate(builder, IR_BR, condition, 0, 0);
+    int var_mark = builder->var_count;
+
+    int then_start = builder->pending_count;
+    function->insts[branch].b = begin_block(builder);
+    lower_stmt(builder, stmt->kids[1]);
+    int then_end = builder->current;
+    int32_t then_jump = then_end >= 0 ? terminate(builder, IR_JMP, 0, 0, 0) : -1;
+    leave_branch(builder, var_mark);
+    if (then_end < 0) {
+        builder->pending_count = then_start;    /* Os valores de um ramo morto não chegam à junção */
+    }
+
+    int else_start = builder->pending_count;
+    int else_end = condition_block;
+    int32_t else_jump = -1;
+    if (stmt->kid_count > 2) {
+        function->insts[branch].c = begin_block(builder);
+        lower_stmt(builder, stmt->kids[2]);
+        else_end = builder->current;
+        else_jump = else_end >= 0 ? terminate(builder, IR_JMP, 0, 0, 0) : -1;
+        leave_branch(builder, var_mark);
+        if (else_end < 0) {
+            builder->pending_count = else_start;
+        }
+    }
+    int end = builder->pending_count;
+
+    if (then_end < 0 && else_end < 0) {
+        builder->pending_count = then_start;
+        builder->current = -1;
+        return;
+    }
+
+    int join = begin_block(builder);
+    if (then_jump >= 0) {
+        function->insts[then_jump].a = join;
+    }
+    if (else_jump >= 0) {
+        function->insts[else_jump].a = join;
+    }
+    if (stmt->kid_count <= 2) {
+        function->insts[branch].c = join;
+    }
+
+    if (then_end < 0 || else_end < 0) {
+        /* Um só predecessor: os valores são os do caminho vivo */
+        for (int i = then_start; i < end; i++) {
+            set_value(builder, builder->pending[i].local, builder->pending[i].value);
+        }
+        builder->pending_count = then_start;
+        return;
+    }
+
+    /*
+     * Com else, then_end < else_end e o primeiro operando de cada PHI vem
+     * do then; sem else, o primeiro predecessor é o bloco da condição.
+     */
+    int then_first = then_end < else_end;
+    int else_mark = ++builder->stamp_counter;
+    mark_branch(builder, else_start, end, else_mark);
+    for (int pass = 0; pass < 2; pass++) {
+        int from = pass == 0 ? then_start : else_start;
+        int to = pass == 0 ? else_start : end;
+        for (int i = from; i < to; i++) {
+            int local = builder->pending[i].local;
+            int32_t then_value, else_value;
+            if (pass == 0) {
+                then_value = builder->pending[i].value;
+                else_value = builder->stamp[local] == else_mark ? builder->scratch[local]
+                                                                : builder->value_of[local];
+                builder->stamp[local] = 0;
+            } else if (builder->stamp[local] == else_mark) {
+                then_value = builder->value_of[local];
+                else_value = builder->pending[i].value;
+            } else {
+                continue;   /* Já recebeu o PHI junto com as do then */
+            }
+            int32_t operands = add_operands(function, 2);
+            function->operands[operands + !then_first] = then_value;
+            function->operands[operands + then_first] = else_value;
+            set_value(builder, local, emit(builder, IR_PHI, operands, 2, 0, 0));
+        }
+    }
+    builder->pending_count = then_start;
+}
+
+static void lower_stmt(IrBuilder* builder, const AstNode* stmt) {
+    if (builder->current < 0) {
+        return;     /* Depois de return */
+    }
+    switch (stmt->kind) {
+        case AST_ASSIGN: {
+            const AstNode* value = stmt->kids[0];
+            int32_t result;
+            if (value->kind == AST_FCALL) {
+                result = lower_call(builder, value);
+            } else if (value->kind == AST_ID) {
+                result = emit(builder, IR_COPY, variable_value(builder, value), 0, 0, 0);
+            } else {
+                result = lower_expr(builder, value);
+            }
+            set_value(builder, ast_locals_var(&builder->locals, stmt), result);
+            break;
+        }
+        case AST_PRINT:
+            emit(builder, IR_PRINT, lower_expr(builder, stmt->kids[0]), 0, 0, 0);
+            break;
+        case AST_RETURN:
+            terminate(builder, IR_RET,
+                      stmt->kid_count > 0 ? variable_value(builder, stmt->kids[0])
+                                          : builder->zero, 0, 0);
+            break;
+        case AST_IF:
+            lower_if(builder, stmt);
+            break;
+        case AST_BLOCK:
+            for (int i = 0; i < stmt->kid_count; i++) {
+                lower_stmt(builder, stmt->kids[i]);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+/*
+ * ir_build_preds(function)
+ *
+ * Refaz a lista de predecessores a partir dos terminadores. Percorrer os
+ * blocos em ordem deixa os predecessores de cada bloco em ordem
+ * crescente.
+ */
+void ir_build_preds(IrFunction* function) {
+    int total = 0;
+    for (int b = 0; b < function->block_count; b++) {
+        function->blocks[b].pred_count = 0;
+    }
+    for (int b = 0; b < function->block_count; b++) {
+        const IrInst* last = &function->insts[function->blocks[b].end - 1];
+        if (last->op == IR_JMP) {
+            function->blocks[last->a].pred_count++;
+            total++;
+        } else if (last->op == IR_BR) {
+            function->blocks[last->b].pred_count++;
+            function->blocks[last->c].pred_count++;
+            total += 2;
+        }
+    }
+    free(function->preds);
+    function->preds = (int32_t*)checked_calloc((size_t)total, sizeof(int32_t));
+    function->pred_count = total;
+    int offset = 0;
+    for (int b = 0; b < function->block_count; b++) {
+        function->blocks[b].pred_start = offset;
+        offset += function->blocks[b].pred_count;
+        function->blocks[b].pred_count = 0;
+    }
+    for (int b = 0; b < function->block_count; b++) {
+        const IrInst* last = &function->insts[function->blocks[b].end - 1];
+        int targets[2] = {last->a, last->b};
+        int count = 0;
+        if (last->op == IR_JMP) {
+            count = 1;
+        } else if (last->op == IR_BR) {
+            targets[0] = last->b;
+            targets[1] = last->c;
+            count = 2;
+        }
+        for (int i = 0; i < count; i++) {
+            IrBlock* target = &function->blocks[targets[i]];
+            function->preds[target->pred_start + target->pred_count++] = b;
+        }
+    }
+}
+
+static void lower_function(const AstNode* fdef, IrFunction* function,
+                           const AstFunctionTable* table, const int* program_index) {
+    memset(function, 0, sizeof(IrFunction));
+    function->fdef = fdef;
+
+    IrBuilder builder;
+    memset(&builder, 0, sizeof(builder));
+    builder.function = function;
+    builder.table = table;
+    builder.program_index = program_index;
+    ast_locals_build(fdef, &builder.locals);
+    size_t locals = (size_t)builder.locals.count;
+    builder.value_of = (int32_t*)checked_calloc(locals, sizeof(int32_t));
+    builder.stamp = (int*)checked_calloc(locals, sizeof(int));
+    builder.scratch = (int32_t*)checked_calloc(locals, sizeof(int32_t));
+
+    begin_block(&builder);
+    for (int i = 0; i < fdef->param_count; i++) {
+        builder.value_of[i] = emit(&builder, IR_PARAM, 0, 0, 0, i);
+    }
+    builder.zero = emit(&builder, IR_CONST, 0, 0, 0, 0);
+    for (int i = fdef->param_count; i < builder.locals.count; i++) {
+        builder.value_of[i] = builder.zero;
+    }
+    for (int i = 0; i < fdef->kid_count; i++) {
+        lower_stmt(&builder, fdef->kids[i]);
+    }
+    if (builder.current >= 0) {
+        terminate(&builder, IR_RET, builder.zero, 0, 0);
+    }
+    ir_build_preds(function);
+
+    ast_locals_free(&builder.locals);
+    free(builder.value_of);
+    free(builder.stamp);
+    free(builder.scratch);
+    free(builder.var_log);
+    free(builder.pending);
+}
+
+/* ============================================================================
+ * PROGRAMA
+ * ============================================================================ */
+
+/*
+ * ir_lower_program(program, ir)
+ *
+ * As chamadas são resolvidas pela tabela de funções; com nomes
+ * repetidos, vale a definição que a tabela encontrar.
+ */
+void ir_lower_program(const AstNode* program, IrProgram* ir) {
+    int single_statement = program->kid_count > 0 && program->kids[0]->kind != AST_FDEF;
+    ir->count = single_statement ? 1 : program->kid_count;
+    ir->capacity = ir->count;
+    ir->functions = (IrFunction*)checked_calloc((size_t)ir->count, sizeof(IrFunction));
+
+    AstFunctionTable table;
+    ast_function_table_build(program, &table);
+    int* program_index = (int*)checked_calloc((size_t)table.count, sizeof(int));
+    for (int i = 0; !single_statement && i < program->kid_count; i++) {
+        int position = ast_function_index(&table, program->kids[i]->name);
+        if (table.fdefs[position] == program->kids[i]) {
+            program_index[position] = i;
+        }
+    }
+
+    for (int f = 0; f < ir->count; f++) {
+        lower_function(single_statement ? program : program->kids[f], &ir->functions[f],
+                       &table, program_index);
+    }
+    free(program_index);
+    ast_function_table_free(&table);
+}
+
+void ir_function_free(IrFunction* function) {
+    free(function->name);
+    free(function->insts);
+    free(function->operands);
+    free(function->blocks);
+    free(function->preds);
+    memset(function, 0, sizeof(IrFunction));
+}
+
+void ir_program_free(IrProgram* ir) {
+    for (int f = 0; f < ir->count; f++) {
+        ir_function_free(&ir->functions[f]);
+    }
+    free(ir->functions);
+    ir->functions = NULL;
+    ir->count = 0;
+    ir->capacity = 0;
+}
+
+static void* copy_array(const void* source, int count, size_t element) {
+    void* copy = checked_calloc((size_t)count, element);
+    if (count > 0) {
+        memcpy(copy, source, (size_t)count * element);
+    }
+    return copy;
+}
+
+void ir_function_copy(IrFunction* copy, const IrFunction* function) {
+    *copy = *function;
+    copy->name = function->name != NULL ? strdup(function->name) : NULL;
+    copy->insts = (IrInst*)copy_array(function->insts, function->inst_count, sizeof(IrInst));
+    copy->inst_capacity = function->inst_count;
+    copy->operands = (int32_t*)copy_array(function->operands, function->operand_count,
+                                          sizeof(int32_t));
+    copy->operand_capacity = function->operand_count;
+    copy->blocks = (IrBlock*)copy_array(function->blocks, function->block_count, sizeof(IrBlock));
+    copy->block_capacity = function->block_count;
+    copy->preds = (int32_t*)copy_array(function->preds, function->pred_count, sizeof(int32_t));
+}
+
+/* ============================================================================
+ * EDIÇÃO
+ * ============================================================================ */
+
+void ir_remove_edge(IrFunction* function, int from, int to) {
+    IrBlock* block = &function->blocks[to];
+    int32_t* preds = function->preds + block->pred_start;
+    int index = 0;
+    while (index < block->pred_count && preds[index] != from) {
+        index++;
+    }
+    if (index == block->pred_count) {
+        return;
+    }
+    memmove(preds + index, preds + index + 1,
+            sizeof(int32_t) * (size_t)(block->pred_count - index - 1));
+    block->pred_count--;
+
+    for (int i = block->start; i < block->end; i++) {
+        IrInst* inst = &function->insts[i];
+        if (inst->op == IR_PHI) {
+            int32_t* operands = function->operands + inst->a;
+            memmove(operands + index, operands + index + 1,
+                    sizeof(int32_t) * (size_t)(inst->b - index - 1));
+            inst->b--;
+        } else if (inst->op != IR_NOP && inst->op != IR_CONST) {
+            break;
+        }
+    }
+}
+
+/*
+ * ir_compact(function)
+ *
+ * Uma varredura em ordem: cada instrução viva vai para a próxima posição
+ * livre e seus operandos, já renumerados (são sempre anteriores), são
+ * traduzidos pelo mapa. Blocos sem nenhuma instrução viva (os que a
+ * propagação de constantes tornou inalcançáveis) somem, e os destinos dos
+ * terminadores e os predecessores são renumerados.
+ */
+void ir_compact(IrFunction* function) {
+    int32_t* value_map = (int32_t*)checked_calloc((size_t)function->inst_count, sizeof(int32_t));
+    int32_t* block_map = (int32_t*)checked_calloc((size_t)function->block_count, sizeof(int32_t));
+    int next = 0;
+    int next_block = 0;
+
+    for (int b = 0; b < function->block_count; b++) {
+        IrBlock block = function->blocks[b];
+        int start = next;
+        for (int i = block.start; i < block.end; i++) {
+            IrInst inst = function->insts[i];
+            if (inst.op == IR_NOP) {
+                value_map[i] = -1;
+                continue;
+            }
+            int32_t* operands;
+            int count = ir_operands(function, &inst, &operands);
+            for (int k = 0; k < count; k++) {
+                operands[k] = value_map[operands[k]];
+            }
+            value_map[i] = next;
+            function->insts[next++] = inst;
+        }
+        if (next == start) {
+            block_map[b] = -1;
+            continue;
+        }
+        block_map[b] = next_block;
+        function->blocks[next_block] = block;
+        function->blocks[next_block].start = start;
+        function->blocks[next_block].end = next;
+        next_block++;
+    }
+    function->inst_count = next;
+    function->block_count = next_block;
+
+    for (int b = 0; b < function->block_count; b++) {
+        IrInst* last = &function->insts[function->blocks[b].end - 1];
+        if (last->op == IR_JMP) {
+            last->a = block_map[last->a];
+        } else if (last->op == IR_BR) {
+            last->b = block_map[last->b];
+            last->c = block_map[last->c];
+        }
+    }
+    for (int p = 0; p < function->pred_count; p++) {
+        function->preds[p] = function->preds[p] >= 0 ? block_map[function->preds[p]] : -1;
+    }
+
+    free(value_map);
+    free(block_map);
+}
+
+int ir_live_count(const IrFunction* function) {
+    int count = 0;
+    for (int i = 0; i < function->inst_count; i++) {
+        count += function->insts[i].op != IR_NOP;
+    }
+    return count;
+}
+
+/* ============================================================================
+ * IMPRESSÃO E VERIFICAÇÃO
+ * ============================================================================ */
+
+static const char* const op_names[IR_OP_COUNT] = {
+    [IR_NOP] = "nop", [IR_CONST] = "const", [IR_PARAM] = "param", [IR_COPY] = "copy",
+    [IR_PHI] = "phi", [IR_ADD] = "add", [IR_SUB] = "sub", [IR_MUL] = "mul", [IR_DIV] = "div",
+    [IR_SHL] = "shl", [IR_DIVPOW2] = "divpow2", [IR_LT] = "lt", [IR_LTE] = "lte",
+    [IR_GT] = "gt", [IR_GTE] = "gte", [IR_EQ] = "eq", [IR_NEQ] = "neq", [IR_CALL] = "call",
+    [IR_PRINT] = "print", [IR_BR] = "br", [IR_JMP] = "jmp", [IR_RET] = "ret"
+};
+
+const char* ir_op_name(int op) {
+    return op >= 0 && op < IR_OP_COUNT ? op_names[op] : "?";
+}
+
+/*
+ * ir_print_function(out, ir, function)
+ *
+ * Um bloco por rótulo "bN:", com os predecessores em comentário, e uma
+ * instrução por linha; os valores são "vN", o índice da instrução.
+ */
+void ir_print_function(FILE* out, const IrProgram* ir, const IrFunction* function) {
+    const AstNode* fdef = function->fdef;
+    fprintf(out, "função %s(", ir_function_name(function));
+    for (int i = 0; i < fdef->param_count; i++) {
+        fprintf(out, "%s%s", i > 0 ? ", " : "", fdef->params[i]->name);
+    }
+    fprintf(out, ")\n");
+
+    for (int b = 0; b < function->block_count; b++) {
+        const IrBlock* block = &function->blocks[b];
+        fprintf(out, "b%d:", b);
+        for (int p = 0; p < block->pred_count; p++) {
+            fprintf(out, "%s b%d", p == 0 ? "    ; de" : ",", function->preds[block->pred_start + p]);
+        }
+        fprintf(out, "\n");
+        for (int i = block->start; i < block->end; i++) {
+            IrInst* inst = &function->insts[i];
+            int32_t* operands;
+            int count = ir_operands(function, inst, &operands);
+            if (inst->op == IR_NOP) {
+                continue;
+            }
+            fprintf(out, "    ");
+            if (!ir_has_effect(function, inst) || inst->op == IR_CALL || inst->op == IR_DIV) {
+                fprintf(out, "v%d = ", i);
+            }
+            fprintf(out, "%s", op_names[inst->op]);
+            switch (inst->op) {
+                case IR_CONST:
+                    fprintf(out, " %" PRId64 "\n", inst->value);
+                    continue;
+                case IR_PARAM:
+                    fprintf(out, " %s\n", fdef->params[inst->value]->name);
+                    continue;
+                case IR_CALL:
+                    fprintf(out, " %s", inst->value >= 0 ? ir_function_name(&ir->functions[inst->value]) : "?");
+                    break;
+                case IR_JMP:
+                    fprintf(out, " b%d\n", inst->a);
+                    continue;
+                default:
+                    break;
+            }
+            for (int k = 0; k < count; k++) {
+                fprintf(out, "%s v%d", k > 0 ? "," : "", operands[k]);
+            }
+            if (inst->op == IR_SHL || inst->op == IR_DIVPOW2) {
+                fprintf(out, ", %" PRId64, inst->value);
+            } else if (inst->op == IR_BR) {
+                fprintf(out, ", b%d, b%d", inst->b, inst->c);
+            }
+            fprintf(out, "\n");
+        }
+    }
+}
+
+static int has_pred(const IrFunction* function, int block, int pred) {
+    const IrBlock* target = &function->blocks[block];
+    for (int p = 0; p < target->pred_count; p++) {
+        if (function->preds[target->pred_start + p] == pred) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * ir_verify(function, message, size)
+ *
+ * "Definido antes do uso" é conferido pela posição: os operandos de uma
+ * instrução comum vêm de instruções anteriores, e os do i-ésimo operando
+ * de um PHI, de instruções até o fim do i-ésimo predecessor.
+ */
+int ir_verify(const IrFunction* function, char* message, size_t size) {
+    int edges = 0;
+    for (int b = 0; b < function->block_count; b++) {
+        const IrBlock* block = &function->blocks[b];
+        if (block->start >= block->end || block->end > function->inst_count ||
+            (b > 0 && block->start != function->blocks[b - 1].end)) {
+            snprintf(message, size, "b%d: faixa de instruções inválida", b);
+            return 1;
+        }
+        int phis_allowed = 1;
+        for (int i = block->start; i < block->end; i++) {
+            IrInst* inst = &function->insts[i];
+            if (inst->op >= IR_OP_COUNT) {
+                snprintf(message, size, "v%d: operação inválida", i);
+                return 1;
+            }
+            if (ir_is_terminator(inst->op) != (i == block->end - 1)) {
+                snprintf(message, size, "v%d: terminador fora do fim do bloco b%d", i, b);
+                return 1;
+            }
+            if (inst->op == IR_PHI) {
+                if (!phis_allowed) {
+                    snprintf(message, size, "v%d: phi depois de outras instruções", i);
+                    return 1;
+                }
+                if (inst->b != block->pred_count) {
+                    snprintf(message, size, "v%d: phi com %d operandos e %d predecessores",
+                             i, inst->b, block->pred_count);
+                    return 1;
+                }
+            } else if (inst->op != IR_NOP && inst->op != IR_CONST) {
+                phis_allowed = 0;
+            }
+            int32_t* operands;
+            int count = ir_operands(function, inst, &operands);
+            for (int k = 0; k < count; k++) {
+                int limit = i;
+                if (inst->op == IR_PHI) {
+                    limit = function->blocks[function->preds[block->pred_start + k]].end;
+                }
+                if (operands[k] < 0 || operands[k] >= limit ||
+                    function->insts[operands[k]].op == IR_NOP) {
+                    snprintf(message, size, "v%d: operando %d inválido", i, k);
+                    return 1;
+                }
+            }
+            if (inst->op == IR_JMP || inst->op == IR_BR) {
+                int targets[2] = {inst->op == IR_JMP ? inst->a : inst->b, inst->c};
+                for (int t = 0; t < (inst->op == IR_JMP ? 1 : 2); t++) {
+                    if (targets[t] <= b || targets[t] >= function->block_count ||
+                        !has_pred(function, targets[t], b)) {
+                        snprintf(message, size, "v%d: destino b%d inválido", i, targets[t]);
+                        return 1;
+                    }
+                }
+                edges += inst->op == IR_JMP ? 1 : 2;
+            }
+        }
+    }
+    int preds = 0;
+    for (int b = 0; b < function->block_count; b++) {
+        const IrBlock* block = &function->blocks[b];
+        for (int p = 0; p < block->pred_count; p++) {
+            int pred = function->preds[block->pred_start + p];
+            if (pred < 0 || pred >= b || (p > 0 && pred < function->preds[block->pred_start + p - 1])) {
+                snprintf(message, size, "b%d: predecessor inválido", b);
+                return 1;
+            }
+        }
+        preds += block->pred_count;
+    }
+    if (preds != edges) {
+        snprintf(message, size, "%d predecessores para %d arestas", preds, edges);
+        return 1;
+    }
+    return 0;
+}
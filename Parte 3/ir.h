@@ -0,0 +1,323 @@
+/*
+ * ============================================================================
+ * HEADER DA REPRESENTAÇÃO INTERMEDIÁRIA EM SSA
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * Cada AST_FDEF vira uma IrFunction em forma SSA: as variáveis int deixam
+ * de existir, e cada instrução que produz um valor é o próprio
+ * registrador virtual desse valor, identificado pelo seu índice em
+ * insts. Os if viram blocos básicos, com instruções PHI no início do
+ * bloco de junção; chamadas e print são instruções explícitas.
+ *
+ * Tudo fica em vetores planos, sem ponteiros entre instruções:
+ *   insts      instruções; as de cada bloco são contíguas
+ *   operands   operandos de PHI e CALL, em faixas [a, a + b)
+ *   blocks     faixa de instruções e de predecessores de cada bloco
+ *   preds      predecessores; o i-ésimo operando de um PHI vem do
+ *              i-ésimo predecessor do seu bloco
+ *
+ * Uma instrução removida vira IR_NOP e some na próxima compactação
+ * (ir_compact()), que renumera os valores.
+ *
+ * Como a linguagem não tem laços, o grafo de blocos é acíclico, e os
+ * blocos ficam em ordem topológica: toda aresta vai para um bloco de
+ * índice maior, os predecessores de cada bloco estão em ordem crescente,
+ * e todo operando é definido antes do seu uso na ordem das instruções.
+ * Por isso as passadas de fluxo de dados são uma única varredura, para
+ * frente ou para trás.
+ *
+ * */
+
+#ifndef IR_H
+#define IR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "ast.h"
+
+typedef enum {
+    IR_NOP,
+    IR_CONST,               /* value */
+    IR_PARAM,               /* Parâmetro de índice value */
+    IR_COPY,                /* a */
+    IR_PHI,                 /* operands[a .. a + b) */
+    IR_ADD,                 /* a + b, com wraparound em 64 bits */
+    IR_SUB,
+    IR_MUL,
+    IR_DIV,                 /* a / b; value = (linha << 32) | coluna, para o erro de divisão por zero */
+    IR_SHL,                 /* a << value */
+    IR_DIVPOW2,             /* a / 2^value, arredondando para zero (sem divisão nem erro) */
+    IR_LT,                  /* Comparações valem 0 ou 1 */
+    IR_LTE,
+    IR_GT,
+    IR_GTE,
+    IR_EQ,
+    IR_NEQ,
+    IR_CALL,                /* Função value (índice em IrProgram.functions, ou -1) com operands[a .. a + b) */
+    IR_PRINT,               /* a */
+    IR_BR,                  /* Se a != 0, bloco b; senão, bloco c */
+    IR_JMP,                 /* Bloco a */
+    IR_RET,                 /* a */
+    IR_OP_COUNT
+} IrOp;
+
+typedef struct {
+    uint8_t op;             /* IrOp */
+    uint8_t reserved[3];
+    int32_t a;
+    int32_t b;
+    int32_t c;
+    int64_t value;
+} IrInst;
+
+typedef struct {
+    int32_t start;          /* Instruções start .. end - 1; a última é BR, JMP ou RET */
+    int32_t end;
+    int32_t pred_start;     /* Predecessores: preds[pred_start .. pred_start + pred_count) */
+    int32_t pred_count;
+} IrBlock;
+
+typedef struct {
+    const AstNode* fdef;
+    char* name;             /* Nome de uma especialização (ir_inline_program()), ou NULL */
+    IrInst* insts;
+    int inst_count;
+    int inst_capacity;
+    int32_t* operands;
+    int operand_count;
+    int operand_capacity;
+    IrBlock* blocks;        /* O bloco 0 é a entrada */
+    int block_count;
+    int block_capacity;
+    int32_t* preds;
+    int pred_count;
+} IrFunction;
+
+typedef struct {
+    IrFunction* functions;  /* Na ordem do programa, seguidas das especializações */
+    int count;
+    int capacity;
+} IrProgram;
+
+static inline const char* ir_function_name(const IrFunction* function) {
+    if (function->name != NULL) {
+        return function->name;
+    }
+    return function->fdef->kind == AST_FDEF ? function->fdef->name : "(programa)";
+}
+
+static inline int ir_is_terminator(int op) {
+    return op == IR_BR || op == IR_JMP || op == IR_RET;
+}
+
+static inline int ir_is_binary(int op) {
+    return (op >= IR_ADD && op <= IR_DIV) || (op >= IR_LT && op <= IR_NEQ);
+}
+
+/*
+ * Operandos de valor da instrução: retorna quantos são e aponta *operands
+ * para o primeiro (a e b são vizinhos em IrInst).
+ */
+static inline int ir_operands(const IrFunction* function, IrInst* inst, int32_t** operands) {
+    switch (inst->op) {
+        case IR_PHI:
+        case IR_CALL:
+            *operands = function->operands + inst->a;
+            return inst->b;
+        case IR_COPY:
+        case IR_SHL:
+        case IR_DIVPOW2:
+        case IR_PRINT:
+        case IR_BR:
+        case IR_RET:
+            *operands = &inst->a;
+            return 1;
+        default:
+            *operands = &inst->a;
+            return ir_is_binary(inst->op) ? 2 : 0;
+    }
+}
+
+/*
+ * Instruções que não podem ser removidas mesmo sem usos: chamadas (que
+ * podem imprimir), print, terminadores e divisões que podem falhar por
+ * divisor zero.
+ */
+static inline int ir_has_effect(const IrFunction* function, const IrInst* inst) {
+    if (inst->op == IR_DIV) {
+        const IrInst* divisor = &function->insts[inst->b];
+        return divisor->op != IR_CONST || divisor->value == 0;
+    }
+    return inst->op == IR_CALL || inst->op == IR_PRINT || ir_is_terminator(inst->op);
+}
+
+/* ============================================================================
+ * CONSTRUÇÃO, CÓPIA E IMPRESSÃO
+ * ============================================================================ */
+
+/*
+ * Traduz cada função do programa (ou o programa de um único comando, como
+ * uma função sem parâmetros). x = y vira IR_COPY e, nas junções, toda
+ * variável atribuída em algum ramo ganha um PHI, mesmo que os dois
+ * caminhos tragam o mesmo valor: a tradução é direta, e as cópias e PHI
+ * redundantes ficam para as passadas.
+ */
+void ir_lower_program(const AstNode* program, IrProgram* ir);
+void ir_program_free(IrProgram* ir);
+
+/* Cópia independente (as passadas alteram a função no lugar) */
+void ir_function_copy(IrFunction* copy, const IrFunction* function);
+void ir_function_free(IrFunction* function);
+
+/* Remove os IR_NOP e os blocos vazios, renumerando valores e blocos */
+void ir_compact(IrFunction* function);
+
+/* Refaz os predecessores a partir dos terminadores, em ordem crescente */
+void ir_build_preds(IrFunction* function);
+
+/*
+ * Remove a aresta from -> to: o predecessor e o operando correspondente
+ * de cada PHI de to. Não altera o terminador de from.
+ */
+void ir_remove_edge(IrFunction* function, int from, int to);
+
+/* Instruções que não são IR_NOP */
+int ir_live_count(const IrFunction* function);
+
+void ir_print_function(FILE* out, const IrProgram* ir, const IrFunction* function);
+const char* ir_op_name(int op);
+
+/*
+ * Confere a estrutura: operandos dentro dos limites e definidos antes do
+ * uso, um terminador no fim de cada bloco e só nele, PHI só no início do
+ * bloco (antes deles, só IR_CONST, que é como a propagação de constantes
+ * deixa um PHI constante) e com um operando por predecessor, blocos em
+ * ordem topológica e predecessores coerentes com
+ * os terminadores. Retorna 0 se a função é válida; senão escreve o
+ * primeiro problema em message.
+ */
+int ir_verify(const IrFunction* function, char* message, size_t size);
+
+/* ============================================================================
+ * PASSADAS
+ * ============================================================================ */
+
+/* Uma passada altera a função no lugar e retorna quantas mudanças fez */
+typedef int (*IrPassFunction)(IrFunction* function);
+
+typedef struct {
+    const char* name;
+    IrPassFunction run;
+    const char* description;
+} IrPass;
+
+#define IR_MAX_PIPELINE 32
+#define IR_DEFAULT_PIPELINE "copyprop,sccp,strength,merge,copyprop,dce"
+
+typedef struct {
+    const IrPass* passes[IR_MAX_PIPELINE];
+    int count;
+    double millis[IR_MAX_PIPELINE];     /* Tempo acumulado de cada passada */
+    long long changes[IR_MAX_PIPELINE];
+    long long visited[IR_MAX_PIPELINE]; /* Instruções percorridas (com IR_NOP) */
+    long long runs;                     /* Execuções de passadas em funções */
+    double compact_millis;              /* Compactação no fim de cada sequência */
+} IrPipeline;
+
+int ir_copy_propagation(IrFunction* function);
+int ir_sccp(IrFunction* function);
+int ir_dead_code_elimination(IrFunction* function);
+int ir_strength_reduction(IrFunction* function);
+int ir_merge_blocks(IrFunction* function);
+
+/* Passadas registradas, terminadas por { NULL } */
+extern const IrPass ir_passes[];
+
+/*
+ * Monta a sequência a partir de nomes separados por vírgula ("" não
+ * executa nenhuma). Retorna 0 em caso de sucesso, ou -1 com o nome
+ * desconhecido (ou excedente) em message.
+ */
+int ir_pipeline_parse(IrPipeline* pipeline, const char* spec, char* message, size_t size);
+
+/* Executa a sequência na função, acumulando tempos e mudanças, e compacta no fim */
+void ir_pipeline_run(IrPipeline* pipeline, IrFunction* function);
+
+/* ============================================================================
+ * EXPANSÃO DE CHAMADAS E ESPECIALIZAÇÃO (ir_inline.c)
+ * ============================================================================ */
+
+#define IR_INLINE_DEFAULT_SIZE 40           /* Custo máximo de um chamado expandido */
+#define IR_INLINE_DEFAULT_FUNCTION 2000     /* Tamanho máximo de uma função depois da expansão */
+#define IR_INLINE_DEFAULT_CLONES 256
+#define IR_INLINE_DEFAULT_DEPTH 32
+
+typedef struct {
+    int max_callee_size;    /* Custo: instruções vivas do chamado, sem IR_PARAM; 0 não expande */
+    int max_function_size;
+    int max_clones;         /* Especializações no programa inteiro */
+    int max_depth;          /* Especializações criadas dentro de especializações */
+} IrInlineOptions;
+
+typedef struct {
+    int inlined;            /* Chamadas expandidas */
+    int specialized;        /* Chamadas mantidas, para uma especialização */
+    int clones;             /* Especializações criadas (inclusive as já expandidas) */
+    int recursive;          /* Chamadas mantidas, para uma função original recursiva */
+    int too_large;          /* Chamadas mantidas, pelo custo ou pelo tamanho do chamador */
+    long long insts_before; /* Instruções vivas, depois das passadas e antes da expansão */
+    long long insts_after;
+} IrInlineStats;
+
+void ir_inline_defaults(IrInlineOptions* options);
+
+/*
+ * Expande as chamadas a funções pequenas e especializa funções chamadas
+ * com argumentos constantes, aplicando pipeline a cada função. As
+ * funções são tratadas dos componentes chamados para os chamadores (grafo
+ * de chamadas de program, callgraph.h), de modo que um chamado já chega
+ * expandido e otimizado; funções de componentes recursivos nunca são
+ * expandidas. Uma especialização é uma cópia da função com os parâmetros
+ * constantes trocados pelos valores (e vira uma nova IrFunction no fim de
+ * ir->functions); ela só é mantida se as passadas a deixam menor, e pode
+ * por sua vez ser expandida no chamador.
+ */
+void ir_inline_program(IrProgram* ir, const AstNode* program, const IrInlineOptions* options,
+                       IrPipeline* pipeline, IrInlineStats* stats);
+
+/* ============================================================================
+ * EXECUÇÃO (ir_exec.c)
+ * ============================================================================ */
+
+#define IR_EXEC_MAX_DEPTH 1000000   /* Chamadas aninhadas */
+#define IR_EXEC_MEMO_MAX 4000000    /* Resultados guardados pela memoização */
+
+typedef void (*IrPrintFunction)(int64_t value, void* context);
+
+typedef struct {
+    long long calls;            /* Chamadas executadas, sem contar a de entrada */
+    long long instructions;     /* Instruções executadas, sem IR_NOP */
+    long long memo_hits;        /* Chamadas respondidas pela memoização */
+    long long memo_entries;     /* Resultados guardados */
+    int max_depth;
+    int error_line;             /* Divisão por zero (ir_execute() retorna 1) */
+    int error_col;
+} IrExecStats;
+
+/*
+ * Interpreta a função com os argumentos dados (os ausentes valem 0),
+ * com a mesma semântica do JIT e do C gerado. As chamadas usam uma pilha
+ * própria, não a do processo. Retorna 0 com o valor em *result, 1 em
+ * divisão por zero ou -1 se as chamadas aninhadas passam de
+ * IR_EXEC_MAX_DEPTH. Se memoize não é NULL, as chamadas às funções f com
+ * memoize[f] != 0 reaproveitam o resultado de uma chamada anterior com os
+ * mesmos argumentos (só vale para funções que não imprimem, purity.h).
+ */
+int ir_execute(const IrProgram* ir, int function, const int64_t* args, int arg_count,
+               const char* memoize, IrPrintFunction print, void* context, IrExecStats* stats,
+               int64_t* result);
+
+#endif
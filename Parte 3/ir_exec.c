@@ -0,0 +1,343 @@
+/*
+ * ============================================================================
+ * INTERPRETADOR DA REPRESENTAÇÃO INTERMEDIÁRIA
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * Executa uma IrProgram diretamente, para comparar o comportamento do
+ * programa antes e depois de uma transformação (--inline) e contar as
+ * chamadas e instruções executadas.
+ *
+ * Cada chamada empilha um quadro e reserva na pilha de valores espaço
+ * para os argumentos e para um valor por instrução da função (o
+ * registrador virtual da instrução, ir.h). As duas pilhas crescem com
+ * realloc(), de modo que a profundidade das chamadas não depende da
+ * pilha do processo; por isso os quadros guardam índices, não ponteiros.
+ *
+ * Um PHI escolhe o operando do predecessor pelo qual se entrou no bloco,
+ * cuja posição em preds cada quadro guarda ao seguir uma aresta.
+ *
+ * Memoização: as chamadas às funções marcadas em memoize (as que não
+ * imprimem, purity.h) consultam uma tabela hash aberta de (função,
+ * argumentos) antes de empilhar o quadro; o retorno de um quadro de uma
+ * dessas funções entra na tabela. Os argumentos ficam num vetor à parte,
+ * e a tabela para de crescer em IR_EXEC_MEMO_MAX resultados.
+ *
+ * ============================================================================
+ */
+
+#include "ir.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    int function;
+    int block;
+    int pred;               /* Posição, nos predecessores de block, do bloco anterior */
+    int pc;                 /* Instrução atual */
+    size_t args;            /* Argumentos: values[args .. args + arg_count) */
+    int arg_count;
+    size_t base;            /* Valores das instruções: values[base + i] */
+    int memoize;            /* Guarda o retorno na tabela de memoização */
+} Frame;
+
+typedef struct {
+    uint64_t hash;
+    int function;           /* -1: posição livre */
+    int arg_count;
+    size_t args;            /* Argumentos: memo_args[args .. args + arg_count) */
+    int64_t result;
+} MemoEntry;
+
+typedef struct {
+    const IrProgram* ir;
+    Frame* frames;
+    int frame_count;
+    int frame_capacity;
+    int64_t* values;
+    size_t value_count;
+    size_t value_capacity;
+    MemoEntry* memo;
+    size_t memo_count;
+    size_t memo_capacity;   /* Potência de 2 */
+    int64_t* memo_args;
+    size_t memo_arg_count;
+    size_t memo_arg_capacity;
+} Machine;
+
+static void* checked_realloc(void* memory, size_t size) {
+    memory = realloc(memory, size);
+    if (memory == NULL) {
+        fprintf(stderr, "Erro fatal: Memória insuficiente para executar a representação intermediária.\n");
+        exit(1);
+    }
+    return memory;
+}
+
+/*
+ * push_frame(machine, function, args, arg_count)
+ *
+ * Empilha a chamada; args aponta para fora da pilha de valores, que pode
+ * ser realocada aqui.
+ */
+static void push_frame(Machine* machine, int function, const int64_t* args, int arg_count) {
+    const IrFunction* callee = &machine->ir->functions[function];
+    size_t needed = machine->value_count + (size_t)arg_count + (size_t)callee->inst_count;
+    if (needed > machine->value_capacity) {
+        size_t capacity = machine->value_capacity ? machine->value_capacity : 1024;
+        while (capacity < needed) {
+            capacity *= 2;
+        }
+        machine->values = (int64_t*)checked_realloc(machine->values, sizeof(int64_t) * capacity);
+        machine->value_capacity = capacity;
+    }
+    if (machine->frame_count == machine->frame_capacity) {
+        machine->frame_capacity = machine->frame_capacity ? machine->frame_capacity * 2 : 64;
+        machine->frames = (Frame*)checked_realloc(machine->frames,
+                                                  sizeof(Frame) * (size_t)machine->frame_capacity);
+    }
+    Frame* frame = &machine->frames[machine->frame_count++];
+    frame->function = function;
+    frame->block = 0;
+    frame->pred = 0;
+    frame->pc = callee->blocks[0].start;
+    frame->args = machine->value_count;
+    frame->arg_count = arg_count;
+    frame->base = frame->args + (size_t)arg_count;
+    frame->memoize = 0;
+    if (arg_count > 0) {
+        memcpy(machine->values + frame->args, args, sizeof(int64_t) * (size_t)arg_count);
+    }
+    machine->value_count = needed;
+}
+
+/* ============================================================================
+ * MEMOIZAÇÃO
+ * ============================================================================ */
+
+static uint64_t memo_hash(int function, const int64_t* args, int arg_count) {
+    uint64_t hash = (uint64_t)(function + 1) * 0x9e3779b97f4a7c15ULL;
+    for (int k = 0; k < arg_count; k++) {
+        hash = (hash ^ (uint64_t)args[k]) * 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 32;
+    }
+    return hash;
+}
+
+/*
+ * memo_find(machine, function, args, arg_count, hash)
+ *
+ * Posição do resultado guardado para a chamada ou, se não há, da posição
+ * livre onde ele entraria. A tabela nunca fica cheia (memo_insert()).
+ */
+static size_t memo_find(const Machine* machine, int function, const int64_t* args, int arg_count,
+                        uint64_t hash) {
+    size_t mask = machine->memo_capacity - 1;
+    size_t slot = (size_t)hash & mask;
+    for (;;) {
+        const MemoEntry* entry = &machine->memo[slot];
+        if (entry->function < 0 ||
+            (entry->hash == hash && entry->function == function && entry->arg_count == arg_count &&
+             memcmp(machine->memo_args + entry->args, args,
+                    sizeof(int64_t) * (size_t)arg_count) == 0)) {
+            return slot;
+        }
+        slot = (slot + 1) & mask;
+    }
+}
+
+static void memo_grow(Machine* machine) {
+    MemoEntry* old = machine->memo;
+    size_t old_capacity = machine->memo_capacity;
+    machine->memo_capacity = old_capacity ? old_capacity * 2 : 1024;
+    machine->memo = (MemoEntry*)checked_realloc(NULL, sizeof(MemoEntry) * machine->memo_capacity);
+    for (size_t i = 0; i < machine->memo_capacity; i++) {
+        machine->memo[i].function = -1;
+    }
+    size_t mask = machine->memo_capacity - 1;
+    for (size_t i = 0; i < old_capacity; i++) {
+        if (old[i].function >= 0) {
+            size_t slot = (size_t)old[i].hash & mask;
+            while (machine->memo[slot].function >= 0) {
+                slot = (slot + 1) & mask;
+            }
+            machine->memo[slot] = old[i];
+        }
+    }
+    free(old);
+}
+
+static void memo_insert(Machine* machine, int function, const int64_t* args, int arg_count,
+                        int64_t result) {
+    if (machine->memo_count >= IR_EXEC_MEMO_MAX) {
+        return;
+    }
+    if ((machine->memo_count + 1) * 2 > machine->memo_capacity) {
+        memo_grow(machine);
+    }
+    uint64_t hash = memo_hash(function, args, arg_count);
+    size_t slot = memo_find(machine, function, args, arg_count, hash);
+    if (machine->memo[slot].function >= 0) {
+        return;
+    }
+    if (machine->memo_arg_count + (size_t)arg_count > machine->memo_arg_capacity) {
+        size_t capacity = machine->memo_arg_capacity ? machine->memo_arg_capacity : 1024;
+        while (capacity < machine->memo_arg_count + (size_t)arg_count) {
+            capacity *= 2;
+        }
+        machine->memo_args = (int64_t*)checked_realloc(machine->memo_args,
+                                                       sizeof(int64_t) * capacity);
+        machine->memo_arg_capacity = capacity;
+    }
+    MemoEntry* entry = &machine->memo[slot];
+    entry->hash = hash;
+    entry->function = function;
+    entry->arg_count = arg_count;
+    entry->args = machine->memo_arg_count;
+    entry->result = result;
+    if (arg_count > 0) {
+        memcpy(machine->memo_args + machine->memo_arg_count, args,
+               sizeof(int64_t) * (size_t)arg_count);
+    }
+    machine->memo_arg_count += (size_t)arg_count;
+    machine->memo_count++;
+}
+
+/* ============================================================================
+ * EXECUÇÃO
+ * ============================================================================ */
+
+static void enter_block(const IrFunction* function, Frame* frame, int block) {
+    const IrBlock* target = &function->blocks[block];
+    int pred = 0;
+    while (pred < target->pred_count && function->preds[target->pred_start + pred] != frame->block) {
+        pred++;
+    }
+    frame->pred = pred;
+    frame->block = block;
+    frame->pc = target->start;
+}
+
+int ir_execute(const IrProgram* ir, int function, const int64_t* args, int arg_count,
+               const char* memoize, IrPrintFunction print, void* context, IrExecStats* stats,
+               int64_t* result) {
+    memset(stats, 0, sizeof(*stats));
+    Machine machine;
+    memset(&machine, 0, sizeof(machine));
+    machine.ir = ir;
+    push_frame(&machine, function, args, arg_count);
+    stats->max_depth = 1;
+    int status = 0;
+
+    for (;;) {
+        Frame* frame = &machine.frames[machine.frame_count - 1];
+        const IrFunction* current = &ir->functions[frame->function];
+        const IrInst* inst = &current->insts[frame->pc];
+        int64_t* v = machine.values + frame->base;
+        uint64_t x = 0, y = 0;
+        if (ir_is_binary(inst->op) || inst->op == IR_SHL || inst->op == IR_DIVPOW2) {
+            x = (uint64_t)v[inst->a];
+            y = ir_is_binary(inst->op) ? (uint64_t)v[inst->b] : 0;
+        }
+        stats->instructions += inst->op != IR_NOP;
+
+        switch (inst->op) {
+            case IR_NOP: break;
+            case IR_CONST: v[frame->pc] = inst->value; break;
+            case IR_PARAM:
+                v[frame->pc] = inst->value < frame->arg_count
+                                   ? machine.values[frame->args + (size_t)inst->value] : 0;
+                break;
+            case IR_COPY: v[frame->pc] = v[inst->a]; break;
+            case IR_PHI: v[frame->pc] = v[current->operands[inst->a + frame->pred]]; break;
+            case IR_ADD: v[frame->pc] = (int64_t)(x + y); break;
+            case IR_SUB: v[frame->pc] = (int64_t)(x - y); break;
+            case IR_MUL: v[frame->pc] = (int64_t)(x * y); break;
+            case IR_DIV:
+                if (y == 0) {
+                    stats->error_line = (int)(inst->value >> 32);
+                    stats->error_col = (int)(inst->value & 0xffffffff);
+                    status = 1;
+                    goto done;
+                }
+                v[frame->pc] = (int64_t)y == -1 ? (int64_t)(0 - x) : (int64_t)x / (int64_t)y;
+                break;
+            case IR_SHL: v[frame->pc] = (int64_t)(x << inst->value); break;
+            case IR_DIVPOW2: v[frame->pc] = (int64_t)x / ((int64_t)1 << inst->value); break;
+            case IR_LT: v[frame->pc] = (int64_t)x < (int64_t)y; break;
+            case IR_LTE: v[frame->pc] = (int64_t)x <= (int64_t)y; break;
+            case IR_GT: v[frame->pc] = (int64_t)x > (int64_t)y; break;
+            case IR_GTE: v[frame->pc] = (int64_t)x >= (int64_t)y; break;
+            case IR_EQ: v[frame->pc] = x == y; break;
+            case IR_NEQ: v[frame->pc] = x != y; break;
+            case IR_CALL: {
+                if (inst->value < 0) {
+                    v[frame->pc] = 0;       /* Função não definida (a análise semântica avisa) */
+                    break;
+                }
+                if (machine.frame_count >= IR_EXEC_MAX_DEPTH) {
+                    status = -1;
+                    goto done;
+                }
+                int64_t call_args[inst->b > 0 ? inst->b : 1];
+                for (int k = 0; k < inst->b; k++) {
+                    call_args[k] = v[current->operands[inst->a + k]];
+                }
+                if (memoize != NULL && memoize[inst->value]) {
+                    if (machine.memo_capacity > 0) {
+                        uint64_t hash = memo_hash((int)inst->value, call_args, inst->b);
+                        const MemoEntry* entry = &machine.memo[memo_find(
+                            &machine, (int)inst->value, call_args, inst->b, hash)];
+                        if (entry->function >= 0) {
+                            v[frame->pc] = entry->result;
+                            stats->memo_hits++;
+                            break;
+                        }
+                    }
+                }
+                stats->calls++;
+                push_frame(&machine, (int)inst->value, call_args, inst->b);
+                machine.frames[machine.frame_count - 1].memoize =
+                    memoize != NULL && memoize[inst->value];
+                if (machine.frame_count > stats->max_depth) {
+                    stats->max_depth = machine.frame_count;
+                }
+                continue;           /* O chamador avança ao receber o retorno */
+            }
+            case IR_PRINT:
+                if (print != NULL) {
+                    print(v[inst->a], context);
+                }
+                break;
+            case IR_BR: enter_block(current, frame, v[inst->a] != 0 ? inst->b : inst->c); continue;
+            case IR_JMP: enter_block(current, frame, inst->a); continue;
+            case IR_RET: {
+                int64_t value = v[inst->a];
+                if (frame->memoize) {
+                    memo_insert(&machine, frame->function, machine.values + frame->args,
+                                frame->arg_count, value);
+                }
+                machine.value_count = frame->args;
+                machine.frame_count--;
+                if (machine.frame_count == 0) {
+                    *result = value;
+                    goto done;
+                }
+                Frame* caller = &machine.frames[machine.frame_count - 1];
+                machine.values[caller->base + (size_t)caller->pc] = value;
+                caller->pc++;
+                continue;
+            }
+        }
+        frame->pc++;
+    }
+
+done:
+    stats->memo_entries = (long long)machine.memo_count;
+    free(machine.frames);
+    free(machine.values);
+    free(machine.memo);
+    free(machine.memo_args);
+    return status;
+}
@@ -0,0 +1,630 @@
+/*
+ * ============================================================================
+ * EXPANSÃO DE CHAMADAS E ESPECIALIZAÇÃO SOBRE A REPRESENTAÇÃO INTERMEDIÁRIA
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * Uma chamada expandida é trocada pelo corpo do chamado, emendado no
+ * chamador:
+ *   - o bloco da chamada é dividido em dois; o bloco de entrada do
+ *     chamado continua a primeira metade, e os demais blocos do chamado
+ *     vêm logo depois dela
+ *   - cada IR_PARAM vira o argumento correspondente (0 se faltar), sem
+ *     cópia: em SSA o parâmetro é o próprio valor do argumento
+ *   - cada IR_RET vira um JMP para a segunda metade, que recebe o valor de
+ *     retorno por um PHI quando há mais de um retorno; com um único
+ *     retorno no último bloco do chamado, a segunda metade continua esse
+ *     bloco, e uma função de um só bloco não acrescenta nenhum salto
+ * Como o corpo do chamado fica entre as duas metades, os blocos continuam
+ * em ordem topológica, e a renumeração preserva a ordem dos predecessores
+ * de cada bloco (e portanto dos operandos dos PHI).
+ *
+ * Custo de um chamado: suas instruções vivas depois das passadas, sem os
+ * IR_PARAM. Cada função é tratada uma vez, dos componentes chamados para
+ * os chamadores, e só se expande uma função já tratada, de modo que a
+ * expansão sempre termina; funções de componentes recursivos, e
+ * especializações que voltam a chamar uma função ainda em tratamento, não
+ * são expandidas.
+ *
+ * Especialização: numa chamada que não foi expandida, os argumentos
+ * IR_CONST definem uma cópia do chamado em que esses parâmetros são
+ * constantes. A cópia passa pelas passadas e só é mantida se ficou menor
+ * que o original; ela é então tratada como as demais funções (e pode
+ * especializar as próprias chamadas, até IrInlineOptions.max_depth
+ * níveis) e, se ficou pequena, expandida no chamador. As especializações
+ * são lembradas por (função, parâmetros constantes), inclusive as
+ * recusadas.
+ *
+ * ============================================================================
+ */
+
+#include "ir.h"
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include "callgraph.h"
+
+#define IR_INLINE_ROUNDS 4      /* Varreduras das chamadas de uma função, com passadas entre elas */
+
+static void grow(void** array, int* capacity, int needed, size_t element) {
+    if (needed <= *capacity) {
+        return;
+    }
+    int new_capacity = *capacity ? *capacity : 16;
+    while (new_capacity < needed) {
+        new_capacity *= 2;
+    }
+    void* memory = realloc(*array, element * (size_t)new_capacity);
+    if (memory == NULL) {
+        fprintf(stderr, "Erro fatal: Memória insuficiente para a representação intermediária.\n");
+        exit(1);
+    }
+    *array = memory;
+    *capacity = new_capacity;
+}
+
+static void* checked_calloc(size_t count, size_t size) {
+    void* memory = calloc(count ? count : 1, size);
+    if (memory == NULL) {
+        fprintf(stderr, "Erro fatal: Memória insuficiente para a representação intermediária.\n");
+        exit(1);
+    }
+    return memory;
+}
+
+void ir_inline_defaults(IrInlineOptions* options) {
+    options->max_callee_size = IR_INLINE_DEFAULT_SIZE;
+    options->max_function_size = IR_INLINE_DEFAULT_FUNCTION;
+    options->max_clones = IR_INLINE_DEFAULT_CLONES;
+    options->max_depth = IR_INLINE_DEFAULT_DEPTH;
+}
+
+/* ============================================================================
+ * EMENDA DO CORPO DO CHAMADO
+ * ============================================================================ */
+
+static int32_t append(IrFunction* function, IrInst inst) {
+    grow((void**)&function->insts, &function->inst_capacity, function->inst_count + 1,
+         sizeof(IrInst));
+    function->insts[function->inst_count] = inst;
+    return function->inst_count++;
+}
+
+static void open_block(IrFunction* function) {
+    grow((void**)&function->blocks, &function->block_capacity, function->block_count + 1,
+         sizeof(IrBlock));
+    IrBlock* block = &function->blocks[function->block_count++];
+    memset(block, 0, sizeof(*block));
+    block->start = function->inst_count;
+}
+
+static void close_block(IrFunction* function) {
+    function->blocks[function->block_count - 1].end = function->inst_count;
+}
+
+/*
+ * copy_operands(out, source, inst, map)
+ *
+ * Copia a faixa de operandos de um PHI ou CALL de source para out,
+ * traduzida por map, e aponta inst para a cópia.
+ */
+static void copy_operands(IrFunction* out, const IrFunction* source, IrInst* inst,
+                          const int32_t* map) {
+    grow((void**)&out->operands, &out->operand_capacity, out->operand_count + inst->b,
+         sizeof(int32_t));
+    for (int k = 0; k < inst->b; k++) {
+        out->operands[out->operand_count + k] = map[source->operands[inst->a + k]];
+    }
+    inst->a = out->operand_count;
+    out->operand_count += inst->b;
+}
+
+/*
+ * remap(out, source, inst, map)
+ *
+ * Traduz os operandos de valor de inst (uma instrução de source) por map.
+ */
+static void remap(IrFunction* out, const IrFunction* source, IrInst* inst, const int32_t* map) {
+    if (inst->op == IR_PHI || inst->op == IR_CALL) {
+        copy_operands(out, source, inst, map);
+        return;
+    }
+    int32_t* operands;
+    int count = ir_operands(source, inst, &operands);
+    for (int k = 0; k < count; k++) {
+        operands[k] = map[operands[k]];
+    }
+}
+
+/*
+ * splice_call(caller, call, callee)
+ *
+ * Reconstrói caller com o corpo de callee no lugar da instrução call e
+ * retorna o índice, na função nova, da primeira instrução do chamador
+ * depois da chamada.
+ */
+static int splice_call(IrFunction* caller, int call, const IrFunction* callee) {
+    int call_block = 0;
+    while (caller->blocks[call_block].end <= call) {
+        call_block++;
+    }
+    int returns = 0;
+    for (int b = 0; b < callee->block_count; b++) {
+        returns += callee->insts[callee->blocks[b].end - 1].op == IR_RET;
+    }
+    int merge_tail = returns == 1 &&
+                     callee->insts[callee->blocks[callee->block_count - 1].end - 1].op == IR_RET;
+    int shift = callee->block_count - (merge_tail ? 1 : 0);
+
+    IrFunction out;
+    memset(&out, 0, sizeof(out));
+    out.fdef = caller->fdef;
+    out.name = caller->name;
+    int32_t* value_map = (int32_t*)checked_calloc((size_t)caller->inst_count, sizeof(int32_t));
+    int32_t* callee_map = (int32_t*)checked_calloc((size_t)callee->inst_count, sizeof(int32_t));
+    int32_t* returned = (int32_t*)checked_calloc((size_t)returns, sizeof(int32_t));
+    IrInst site = caller->insts[call];
+    int resume = 0;
+
+    for (int b = 0; b < caller->block_count; b++) {
+        open_block(&out);
+        for (int i = caller->blocks[b].start; i < caller->blocks[b].end; i++) {
+            IrInst inst = caller->insts[i];
+            if (inst.op == IR_NOP) {
+                continue;
+            }
+            if (i != call) {
+                remap(&out, caller, &inst, value_map);
+                if (inst.op == IR_JMP) {
+                    inst.a = inst.a > call_block ? inst.a + shift : inst.a;
+                } else if (inst.op == IR_BR) {
+                    inst.b = inst.b > call_block ? inst.b + shift : inst.b;
+                    inst.c = inst.c > call_block ? inst.c + shift : inst.c;
+                }
+                value_map[i] = append(&out, inst);
+                continue;
+            }
+
+            /* O corpo do chamado; seus blocos a partir do 1 vêm depois de call_block */
+            int return_count = 0;
+            int32_t result = -1;
+            for (int cb = 0; cb < callee->block_count; cb++) {
+                if (cb > 0) {
+                    open_block(&out);
+                }
+                for (int ci = callee->blocks[cb].start; ci < callee->blocks[cb].end; ci++) {
+                    IrInst body = callee->insts[ci];
+                    if (body.op == IR_NOP) {
+                        continue;
+                    }
+                    if (body.op == IR_PARAM) {
+                        if (body.value < site.b) {
+                            callee_map[ci] = value_map[caller->operands[site.a + body.value]];
+                        } else {
+                            IrInst zero = {IR_CONST, {0, 0, 0}, 0, 0, 0, 0};
+                            callee_map[ci] = append(&out, zero);
+                        }
+                        continue;
+                    }
+                    if (body.op == IR_RET) {
+                        result = callee_map[body.a];
+                        returned[return_count++] = result;
+                        if (!merge_tail) {
+                            IrInst jump = {IR_JMP, {0, 0, 0}, call_block + shift, 0, 0, 0};
+                            append(&out, jump);
+                            close_block(&out);
+                        }
+                        continue;
+                    }
+                    remap(&out, callee, &body, callee_map);
+                    if (body.op == IR_JMP) {
+                        body.a += call_block;
+                    } else if (body.op == IR_BR) {
+                        body.b += call_block;
+                        body.c += call_block;
+                    }
+                    callee_map[ci] = append(&out, body);
+                    if (ir_is_terminator(body.op)) {
+                        close_block(&out);
+                    }
+                }
+            }
+            if (!merge_tail) {
+                open_block(&out);
+                if (returns > 1) {
+                    IrInst phi = {IR_PHI, {0, 0, 0}, out.operand_count, returns, 0, 0};
+                    grow((void**)&out.operands, &out.operand_capacity,
+                         out.operand_count + returns, sizeof(int32_t));
+                    memcpy(out.operands + out.operand_count, returned,
+                           sizeof(int32_t) * (size_t)returns);
+                    out.operand_count += returns;
+                    result = append(&out, phi);
+                }
+            }
+            value_map[i] = result;
+            resume = out.inst_count;
+        }
+        close_block(&out);
+    }
+    ir_build_preds(&out);
+
+    free(value_map);
+    free(callee_map);
+    free(returned);
+    caller->name = NULL;
+    ir_function_free(caller);
+    *caller = out;
+    return resume;
+}
+
+/* ============================================================================
+ * ORDEM DE TRATAMENTO E DECISÕES
+ * ============================================================================ */
+
+typedef enum {
+    FUNCTION_PENDING,
+    FUNCTION_ACTIVE,        /* Em tratamento (na pilha de process_function) */
+    FUNCTION_DONE
+} FunctionState;
+
+typedef struct {
+    unsigned char state;    /* FunctionState */
+    unsigned char recursive;
+    int origin;             /* Função original de uma especialização (ela mesma, nas originais) */
+    int depth;              /* Nível de especialização */
+    int64_t* values;        /* Por parâmetro da original: constante da especialização */
+    char* fixed;            /* Por parâmetro: 1 se é constante */
+} FunctionInfo;
+
+typedef struct {
+    int origin;
+    int clone;              /* -1: especialização recusada */
+    int64_t* values;
+    char* fixed;
+} Specialization;
+
+typedef struct {
+    IrProgram* ir;
+    const IrInlineOptions* options;
+    IrPipeline* pipeline;
+    IrInlineStats* stats;
+    FunctionInfo* info;
+    int info_capacity;
+    Specialization* keys;
+    int key_count;
+    int key_capacity;
+} Inliner;
+
+static int param_count(const IrFunction* function) {
+    return function->fdef->kind == AST_FDEF ? function->fdef->param_count : 0;
+}
+
+/* Custo de expansão: instruções vivas sem os IR_PARAM */
+static int inline_cost(const IrFunction* function) {
+    int cost = 0;
+    for (int i = 0; i < function->inst_count; i++) {
+        cost += function->insts[i].op != IR_NOP && function->insts[i].op != IR_PARAM;
+    }
+    return cost;
+}
+
+static void process_function(Inliner* inliner, int f);
+
+/*
+ * find_specialization(inliner, origin, fixed, values)
+ *
+ * Índice em inliner->keys da especialização com os mesmos parâmetros
+ * constantes, ou -1.
+ */
+static int find_specialization(const Inliner* inliner, int origin, const char* fixed,
+                               const int64_t* values) {
+    int params = param_count(&inliner->ir->functions[origin]);
+    for (int k = 0; k < inliner->key_count; k++) {
+        const Specialization* key = &inliner->keys[k];
+        if (key->origin != origin || memcmp(key->fixed, fixed, (size_t)params) != 0) {
+            continue;
+        }
+        int same = 1;
+        for (int p = 0; p < params && same; p++) {
+            same = !fixed[p] || key->values[p] == values[p];
+        }
+        if (same) {
+            return k;
+        }
+    }
+    return -1;
+}
+
+/*
+ * specialization_name(function, fixed, values)
+ *
+ * "nome[p=valor,...]", alocado com malloc().
+ */
+static char* specialization_name(const IrFunction* function, const char* fixed,
+                                 const int64_t* values) {
+    const AstNode* fdef = function->fdef;
+    size_t size = strlen(fdef->name) + 3;
+    for (int p = 0; p < fdef->param_count; p++) {
+        size += fixed[p] ? strlen(fdef->params[p]->name) + 24 : 0;
+    }
+    char* name = (char*)malloc(size);
+    int length = sprintf(name, "%s[", fdef->name);
+    for (int p = 0, first = 1; p < fdef->param_count; p++) {
+        if (fixed[p]) {
+            length += sprintf(name + length, "%s%s=%" PRId64, first ? "" : ",",
+                              fdef->params[p]->name, values[p]);
+            first = 0;
+        }
+    }
+    strcpy(name + length, "]");
+    return name;
+}
+
+/*
+ * specialize(inliner, f, call)
+ *
+ * Especialização do chamado de call (em f) para os argumentos constantes
+ * da chamada, somados aos de um chamado que já é uma especialização.
+ * Retorna o índice da função, ou -1 se não há o que especializar ou a
+ * cópia não compensa.
+ */
+static int specialize(Inliner* inliner, int f, int call) {
+    IrProgram* ir = inliner->ir;
+    IrInst site = ir->functions[f].insts[call];
+    int target = (int)site.value;
+    int origin = inliner->info[target].origin;
+    int params = param_count(&ir->functions[origin]);
+    if (params == 0) {
+        return -1;
+    }
+
+    char* fixed = (char*)checked_calloc((size_t)params, 1);
+    int64_t* values = (int64_t*)checked_calloc((size_t)params, sizeof(int64_t));
+    if (target != origin) {
+        memcpy(fixed, inliner->info[target].fixed, (size_t)params);
+        memcpy(values, inliner->info[target].values, sizeof(int64_t) * (size_t)params);
+    }
+    int added = 0;
+    for (int p = 0; p < params && p < site.b; p++) {
+        const IrInst* arg = &ir->functions[f].insts[ir->functions[f].operands[site.a + p]];
+        if (arg->op == IR_CONST && !fixed[p]) {
+            fixed[p] = 1;
+            values[p] = arg->value;
+            added = 1;
+        }
+    }
+
+    int result = added ? -2 : (target != origin ? target : -1);
+    int key = added ? find_specialization(inliner, origin, fixed, values) : -1;
+    if (key >= 0) {
+        result = inliner->keys[key].clone;
+    } else if (result == -2 && (inliner->info[f].depth >= inliner->options->max_depth ||
+                                inliner->stats->clones >= inliner->options->max_clones)) {
+        result = -1;
+    } else if (result == -2) {
+        IrFunction clone;
+        ir_function_copy(&clone, &ir->functions[origin]);
+        for (int i = 0; i < clone.inst_count; i++) {
+            IrInst* inst = &clone.insts[i];
+            if (inst->op == IR_PARAM && fixed[inst->value]) {
+                inst->op = IR_CONST;
+                inst->value = values[inst->value];
+            }
+        }
+        ir_pipeline_run(inliner->pipeline, &clone);
+
+        grow((void**)&inliner->keys, &inliner->key_capacity, inliner->key_count + 1,
+             sizeof(Specialization));
+        Specialization* entry = &inliner->keys[inliner->key_count++];
+        entry->origin = origin;
+        entry->fixed = fixed;
+        entry->values = values;
+        if (inline_cost(&clone) >= inline_cost(&ir->functions[origin])) {
+            ir_function_free(&clone);
+            entry->clone = -1;
+            return -1;
+        }
+
+        free(clone.name);
+        clone.name = specialization_name(&clone, fixed, values);
+        grow((void**)&ir->functions, &ir->capacity, ir->count + 1, sizeof(IrFunction));
+        grow((void**)&inliner->info, &inliner->info_capacity, ir->count + 1, sizeof(FunctionInfo));
+        int index = ir->count++;
+        ir->functions[index] = clone;
+        FunctionInfo* info = &inliner->info[index];
+        memset(info, 0, sizeof(*info));
+        info->origin = origin;
+        info->depth = inliner->info[f].depth + 1;
+        info->fixed = fixed;
+        info->values = values;
+        entry->clone = index;
+        inliner->stats->clones++;
+        process_function(inliner, index);
+        return index;
+    }
+    free(fixed);
+    free(values);
+    return result;
+}
+
+/*
+ * can_inline(inliner, f, target)
+ *
+ * A política de expansão: o chamado já foi tratado, não é recursivo, cabe
+ * no custo máximo e o chamador não passa do tamanho máximo.
+ */
+static int can_inline(const Inliner* inliner, int f, int target) {
+    const FunctionInfo* info = &inliner->info[target];
+    const IrFunction* callee = &inliner->ir->functions[target];
+    return target != f && info->state == FUNCTION_DONE && !info->recursive &&
+           inline_cost(callee) <= inliner->options->max_callee_size &&
+           ir_live_count(&inliner->ir->functions[f]) + inline_cost(callee) <=
+               inliner->options->max_function_size;
+}
+
+/*
+ * visit_call(inliner, f, call, changed)
+ *
+ * Expande ou especializa a chamada e retorna o índice a partir do qual a
+ * varredura de f continua.
+ */
+static int visit_call(Inliner* inliner, int f, int call, int* changed) {
+    int target = (int)inliner->ir->functions[f].insts[call].value;
+    if (inliner->info[target].state == FUNCTION_ACTIVE) {
+        /* f foi chamada, direta ou indiretamente, pelo tratamento do chamado */
+        inliner->info[f].recursive = 1;
+    }
+    if (!can_inline(inliner, f, target)) {
+        int clone = specialize(inliner, f, call);
+        if (clone >= 0 && clone != target) {
+            inliner->ir->functions[f].insts[call].value = clone;
+            target = clone;
+            *changed = 1;
+        }
+        if (!can_inline(inliner, f, target)) {
+            return call + 1;
+        }
+    }
+    *changed = 1;
+    inliner->stats->inlined++;
+    return splice_call(&inliner->ir->functions[f], call, &inliner->ir->functions[target]);
+}
+
+static void process_function(Inliner* inliner, int f) {
+    inliner->info[f].state = FUNCTION_ACTIVE;
+    ir_pipeline_run(inliner->pipeline, &inliner->ir->functions[f]);
+    for (int round = 0; round < IR_INLINE_ROUNDS; round++) {
+        int changed = 0;
+        int i = 0;
+        while (i < inliner->ir->functions[f].inst_count) {
+            const IrInst* inst = &inliner->ir->functions[f].insts[i];
+            if (inst->op == IR_CALL && inst->value >= 0) {
+                i = visit_call(inliner, f, i, &changed);
+            } else {
+                i++;
+            }
+        }
+        if (!changed) {
+            break;
+        }
+        ir_pipeline_run(inliner->pipeline, &inliner->ir->functions[f]);
+    }
+    inliner->info[f].state = FUNCTION_DONE;
+}
+
+/*
+ * drop_unused_clones(ir, originals)
+ *
+ * Remove as especializações que não são mais chamadas (todas as chamadas
+ * a elas foram expandidas) e renumera as chamadas às restantes.
+ */
+static void drop_unused_clones(IrProgram* ir, int originals) {
+    char* used = (char*)checked_calloc((size_t)ir->count, 1);
+    int32_t* stack = (int32_t*)checked_calloc((size_t)ir->count, sizeof(int32_t));
+    int top = 0;
+    for (int f = 0; f < originals; f++) {
+        used[f] = 1;
+        stack[top++] = f;
+    }
+    while (top > 0) {
+        const IrFunction* function = &ir->functions[stack[--top]];
+        for (int i = 0; i < function->inst_count; i++) {
+            int target = (int)function->insts[i].value;
+            if (function->insts[i].op == IR_CALL && target >= 0 && !used[target]) {
+                used[target] = 1;
+                stack[top++] = target;
+            }
+        }
+    }
+
+    int32_t* map = stack;
+    int count = 0;
+    for (int f = 0; f < ir->count; f++) {
+        if (used[f]) {
+            map[f] = count;
+            ir->functions[count++] = ir->functions[f];
+        } else {
+            ir_function_free(&ir->functions[f]);
+        }
+    }
+    ir->count = count;
+    for (int f = 0; f < ir->count; f++) {
+        IrFunction* function = &ir->functions[f];
+        for (int i = 0; i < function->inst_count; i++) {
+            if (function->insts[i].op == IR_CALL && function->insts[i].value >= 0) {
+                function->insts[i].value = map[function->insts[i].value];
+            }
+        }
+    }
+    free(used);
+    free(stack);
+}
+
+void ir_inline_program(IrProgram* ir, const AstNode* program, const IrInlineOptions* options,
+                       IrPipeline* pipeline, IrInlineStats* stats) {
+    memset(stats, 0, sizeof(*stats));
+    Inliner inliner;
+    memset(&inliner, 0, sizeof(inliner));
+    inliner.ir = ir;
+    inliner.options = options;
+    inliner.pipeline = pipeline;
+    inliner.stats = stats;
+    int originals = ir->count;
+    grow((void**)&inliner.info, &inliner.info_capacity, originals, sizeof(FunctionInfo));
+    memset(inliner.info, 0, sizeof(FunctionInfo) * (size_t)originals);
+
+    /* As funções da IR e as do grafo estão ambas na ordem do programa */
+    CallGraph graph;
+    callgraph_build(program, &graph);
+    for (int f = 0; f < originals; f++) {
+        inliner.info[f].origin = f;
+        inliner.info[f].recursive = f < graph.count && graph.fdefs[f] == ir->functions[f].fdef &&
+                                    graph.recursive[graph.scc_of[f]];
+        ir_pipeline_run(pipeline, &ir->functions[f]);
+        stats->insts_before += ir_live_count(&ir->functions[f]);
+    }
+
+    for (int scc = 0; scc < graph.scc_count; scc++) {
+        for (int m = graph.scc_start[scc]; m < graph.scc_start[scc + 1]; m++) {
+            int f = graph.scc_members[m];
+            if (f < originals && graph.fdefs[f] == ir->functions[f].fdef) {
+                process_function(&inliner, f);
+            }
+        }
+    }
+    for (int f = 0; f < originals; f++) {
+        if (inliner.info[f].state != FUNCTION_DONE) {
+            process_function(&inliner, f);     /* Programa de um único comando */
+        }
+    }
+
+    for (int f = 0; f < ir->count; f++) {
+        const IrFunction* function = &ir->functions[f];
+        for (int i = 0; i < function->inst_count; i++) {
+            int target = (int)function->insts[i].value;
+            if (function->insts[i].op == IR_CALL && target >= 0) {
+                if (target >= originals) {
+                    stats->specialized++;
+                } else if (inliner.info[target].recursive ||
+                           inliner.info[target].state != FUNCTION_DONE) {
+                    stats->recursive++;
+                } else {
+                    stats->too_large++;
+                }
+            }
+        }
+    }
+    drop_unused_clones(ir, originals);
+    for (int f = 0; f < ir->count; f++) {
+        stats->insts_after += ir_live_count(&ir->functions[f]);
+    }
+
+    for (int k = 0; k < inliner.key_count; k++) {
+        free(inliner.keys[k].fixed);
+        free(inliner.keys[k].values);
+    }
+    free(inliner.keys);
+    free(inliner.info);
+    callgraph_free(&graph);
+}
@@ -0,0 +1,578 @@
+/*
+ * ============================================================================
+ * PASSADAS SOBRE A REPRESENTAÇÃO INTERMEDIÁRIA
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * Cada passada é uma função IrPassFunction registrada em ir_passes[] e
+ * executada pelo gerenciador na ordem dada por nome (--ir-passes):
+ *   - copyprop: substitui os usos de cada IR_COPY, e de cada PHI cujos
+ *     operandos são todos o mesmo valor, pelo valor original
+ *   - sccp: propagação de constantes condicional esparsa; só segue as
+ *     arestas que podem ser tomadas, dobra as operações e os PHI de
+ *     valor constante, troca BR de condição constante por JMP e apaga os
+ *     blocos inalcançáveis
+ *   - strength: troca multiplicação e divisão por potência de 2 por
+ *     deslocamentos e remove operações com elemento neutro
+ *   - dce: remove instruções sem efeito cujo valor não é usado
+ *   - merge: junta ao bloco anterior o bloco que só é alcançado por um
+ *     JMP dele
+ *
+ * Como os blocos estão em ordem topológica e todo operando vem antes do
+ * uso (ir.h), cada passada é uma única varredura: para frente na
+ * propagação de cópias e de constantes, para trás na eliminação de
+ * código morto. As instruções removidas viram IR_NOP, e o gerenciador
+ * compacta a função uma vez, no fim da sequência.
+ *
+ * ============================================================================
+ */
+
+#include "ir.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static void* checked_calloc(size_t count, size_t size) {
+    void* memory = calloc(count ? count : 1, size);
+    if (memory == NULL) {
+        fprintf(stderr, "Erro fatal: Memória insuficiente para as passadas da representação intermediária.\n");
+        exit(1);
+    }
+    return memory;
+}
+
+static inline IrInst* terminator(IrFunction* function, int block) {
+    return &function->insts[function->blocks[block].end - 1];
+}
+
+static inline void make_const(IrInst* inst, int64_t value) {
+    memset(inst, 0, sizeof(IrInst));
+    inst->op = IR_CONST;
+    inst->value = value;
+}
+
+static inline void make_copy(IrInst* inst, int32_t source) {
+    memset(inst, 0, sizeof(IrInst));
+    inst->op = IR_COPY;
+    inst->a = source;
+}
+
+/* ============================================================================
+ * PROPAGAÇÃO DE CÓPIAS
+ * ============================================================================ */
+
+/*
+ * ir_copy_propagation(function)
+ *
+ * replace[v] é o valor que substitui v. Como os operandos vêm antes dos
+ * usos, cada operando já está resolvido quando é lido, e cadeias de
+ * cópias se resolvem na mesma varredura. As cópias e PHI substituídos
+ * viram IR_NOP.
+ */
+int ir_copy_propagation(IrFunction* function) {
+    int32_t* replace = (int32_t*)checked_calloc((size_t)function->inst_count, sizeof(int32_t));
+    int changes = 0;
+
+    for (int i = 0; i < function->inst_count; i++) {
+        IrInst* inst = &function->insts[i];
+        replace[i] = i;
+        if (inst->op == IR_NOP) {
+            continue;
+        }
+        int32_t* operands;
+        int count = ir_operands(function, inst, &operands);
+        for (int k = 0; k < count; k++) {
+            operands[k] = replace[operands[k]];
+        }
+        if (inst->op == IR_COPY) {
+            replace[i] = inst->a;
+        } else if (inst->op == IR_PHI && count > 0) {
+            int same = 1;
+            for (int k = 1; k < count && same; k++) {
+                same = operands[k] == operands[0];
+            }
+            if (same) {
+                replace[i] = operands[0];
+            }
+        }
+        if (replace[i] != i) {
+            inst->op = IR_NOP;
+            changes++;
+        }
+    }
+    free(replace);
+    return changes;
+}
+
+/* ============================================================================
+ * PROPAGAÇÃO DE CONSTANTES CONDICIONAL ESPARSA
+ * ============================================================================
+ *
+ * O reticulado de cada valor é "indefinido" (ainda sem definição
+ * alcançável), "constante" ou "variável". Com o grafo acíclico em ordem
+ * topológica, uma varredura dos blocos em ordem basta: quando um bloco é
+ * visitado, todos os seus predecessores já foram, e já se sabe quais
+ * arestas de entrada podem ser tomadas.
+ */
+
+enum { LATTICE_UNDEFINED, LATTICE_CONSTANT, LATTICE_VARIABLE };
+
+typedef struct {
+    IrFunction* function;
+    uint8_t* state;
+    int64_t* constant;
+    char* executable;       /* Por bloco */
+} Sccp;
+
+/*
+ * fold(op, x, y, value, result)
+ *
+ * Calcula a operação sobre constantes com a aritmética dos geradores de
+ * código (wraparound em 64 bits, x / -1 = -x). Retorna 0 se a operação
+ * falharia (divisão por zero) e por isso não pode ser dobrada.
+ */
+static int fold(int op, int64_t x, int64_t y, int64_t value, int64_t* result) {
+    uint64_t ux = (uint64_t)x, uy = (uint64_t)y;
+    switch (op) {
+        case IR_ADD: *result = (int64_t)(ux + uy); return 1;
+        case IR_SUB: *result = (int64_t)(ux - uy); return 1;
+        case IR_MUL: *result = (int64_t)(ux * uy); return 1;
+        case IR_DIV:
+            if (y == 0) {
+                return 0;
+            }
+            *result = y == -1 ? (int64_t)(0 - ux) : x / y;
+            return 1;
+        case IR_SHL: *result = (int64_t)(ux << value); return 1;
+        case IR_DIVPOW2: *result = x / ((int64_t)1 << value); return 1;
+        case IR_LT: *result = x < y; return 1;
+        case IR_LTE: *result = x <= y; return 1;
+        case IR_GT: *result = x > y; return 1;
+        case IR_GTE: *result = x >= y; return 1;
+        case IR_EQ: *result = x == y; return 1;
+        case IR_NEQ: *result = x != y; return 1;
+        default: return 0;
+    }
+}
+
+/* A aresta pred -> block pode ser tomada */
+static int edge_executable(const Sccp* sccp, int pred, int block) {
+    if (!sccp->executable[pred]) {
+        return 0;
+    }
+    const IrInst* last = terminator(sccp->function, pred);
+    if (last->op != IR_BR || sccp->state[last->a] != LATTICE_CONSTANT) {
+        return 1;
+    }
+    return (sccp->constant[last->a] != 0 ? last->b : last->c) == block;
+}
+
+static void set_constant(Sccp* sccp, int value, int64_t constant) {
+    sccp->state[value] = LATTICE_CONSTANT;
+    sccp->constant[value] = constant;
+}
+
+static void evaluate(Sccp* sccp, int block, int i) {
+    IrFunction* function = sccp->function;
+    IrInst* inst = &function->insts[i];
+    switch (inst->op) {
+        case IR_NOP:
+            return;
+        case IR_CONST:
+            set_constant(sccp, i, inst->value);
+            return;
+        case IR_COPY:
+            sccp->state[i] = sccp->state[inst->a];
+            sccp->constant[i] = sccp->constant[inst->a];
+            return;
+        case IR_PHI: {
+            const IrBlock* target = &function->blocks[block];
+            uint8_t state = LATTICE_UNDEFINED;
+            int64_t constant = 0;
+            for (int k = 0; k < inst->b && state != LATTICE_VARIABLE; k++) {
+                int32_t operand = function->operands[inst->a + k];
+                if (!edge_executable(sccp, function->preds[target->pred_start + k], block) ||
+                    sccp->state[operand] == LATTICE_UNDEFINED) {
+                    continue;
+                }
+                if (sccp->state[operand] == LATTICE_VARIABLE ||
+                    (state == LATTICE_CONSTANT && constant != sccp->constant[operand])) {
+                    state = LATTICE_VARIABLE;
+                } else {
+                    state = LATTICE_CONSTANT;
+                    constant = sccp->constant[operand];
+                }
+            }
+            sccp->state[i] = state;
+            sccp->constant[i] = constant;
+            return;
+        }
+        default:
+            break;
+    }
+
+    if (!ir_is_binary(inst->op) && inst->op != IR_SHL && inst->op != IR_DIVPOW2) {
+        sccp->state[i] = LATTICE_VARIABLE;     /* PARAM, CALL; PRINT e terminadores não têm valor */
+        return;
+    }
+    int unary = !ir_is_binary(inst->op);
+    uint8_t left = sccp->state[inst->a];
+    uint8_t right = unary ? LATTICE_CONSTANT : sccp->state[inst->b];
+    int64_t x = sccp->constant[inst->a];
+    int64_t y = unary ? 0 : sccp->constant[inst->b];
+    int64_t result;
+
+    if (inst->op == IR_MUL && ((left == LATTICE_CONSTANT && x == 0) ||
+                               (right == LATTICE_CONSTANT && y == 0))) {
+        set_constant(sccp, i, 0);       /* x * 0, mesmo com x variável */
+    } else if (left == LATTICE_CONSTANT && right == LATTICE_CONSTANT &&
+               fold(inst->op, x, y, inst->value, &result)) {
+        set_constant(sccp, i, result);
+    } else {
+        sccp->state[i] = LATTICE_VARIABLE;
+    }
+}
+
+/*
+ * ir_sccp(function)
+ *
+ * Depois da análise, reescreve: valores constantes viram IR_CONST no
+ * lugar (um PHI constante vira IR_CONST no início do bloco), BR de
+ * condição constante vira JMP e perde a outra aresta, e os blocos que
+ * nenhuma aresta alcança perdem suas instruções e arestas de saída. Uma
+ * divisão por zero constante continua na função, para falhar na
+ * execução.
+ */
+int ir_sccp(IrFunction* function) {
+    Sccp sccp;
+    sccp.function = function;
+    sccp.state = (uint8_t*)checked_calloc((size_t)function->inst_count, 1);
+    sccp.constant = (int64_t*)checked_calloc((size_t)function->inst_count, sizeof(int64_t));
+    sccp.executable = (char*)checked_calloc((size_t)function->block_count, 1);
+    int changes = 0;
+
+    sccp.executable[0] = 1;
+    for (int b = 0; b < function->block_count; b++) {
+        const IrBlock* block = &function->blocks[b];
+        for (int p = 0; p < block->pred_count && !sccp.executable[b]; p++) {
+            sccp.executable[b] = edge_executable(&sccp, function->preds[block->pred_start + p], b);
+        }
+        if (!sccp.executable[b]) {
+            continue;
+        }
+        for (int i = block->start; i < block->end; i++) {
+            evaluate(&sccp, b, i);
+        }
+    }
+
+    for (int b = 0; b < function->block_count; b++) {
+        const IrBlock* block = &function->blocks[b];
+        IrInst* last = terminator(function, b);
+        if (!sccp.executable[b]) {
+            if (last->op == IR_JMP) {
+                ir_remove_edge(function, b, last->a);
+            } else if (last->op == IR_BR) {
+                ir_remove_edge(function, b, last->b);
+                ir_remove_edge(function, b, last->c);
+            }
+            for (int i = block->start; i < block->end; i++) {
+                function->insts[i].op = IR_NOP;
+            }
+            changes++;
+            continue;
+        }
+        for (int i = block->start; i < block->end - 1; i++) {
+            IrInst* inst = &function->insts[i];
+            if (sccp.state[i] == LATTICE_CONSTANT && inst->op != IR_CONST) {
+                make_const(inst, sccp.constant[i]);
+                changes++;
+            }
+        }
+        if (last->op == IR_BR && sccp.state[last->a] == LATTICE_CONSTANT) {
+            int taken = sccp.constant[last->a] != 0 ? last->b : last->c;
+            int other = sccp.constant[last->a] != 0 ? last->c : last->b;
+            if (other != taken) {
+                ir_remove_edge(function, b, other);
+            }
+            memset(last, 0, sizeof(IrInst));
+            last->op = IR_JMP;
+            last->a = taken;
+            changes++;
+        }
+    }
+
+    free(sccp.state);
+    free(sccp.constant);
+    free(sccp.executable);
+    return changes;
+}
+
+/* ============================================================================
+ * REDUÇÃO DE FORÇA
+ * ============================================================================ */
+
+static inline int constant_operand(const IrFunction* function, int32_t value, int64_t* constant) {
+    const IrInst* inst = &function->insts[value];
+    *constant = inst->value;
+    return inst->op == IR_CONST;
+}
+
+/* Expoente k se c = 2^k com 1 <= k <= 62, senão 0 */
+static inline int power_of_two(int64_t c) {
+    if (c <= 1 || (c & (c - 1)) != 0) {
+        return 0;
+    }
+    return __builtin_ctzll((unsigned long long)c);
+}
+
+/*
+ * ir_strength_reduction(function)
+ *
+ *   x * 2^k, 2^k * x   → x << k
+ *   x / 2^k            → divpow2 x, k (sem a instrução de divisão)
+ *   x * 0, 0 * x       → 0
+ *   x * 1, 1 * x, x / 1, x + 0, 0 + x, x - 0 → x
+ *   x - x              → 0
+ */
+int ir_strength_reduction(IrFunction* function) {
+    int changes = 0;
+    for (int i = 0; i < function->inst_count; i++) {
+        IrInst* inst = &function->insts[i];
+        if (inst->op != IR_ADD && inst->op != IR_SUB && inst->op != IR_MUL && inst->op != IR_DIV) {
+            continue;
+        }
+        int32_t x = inst->a, y = inst->b;
+        int64_t cx, cy;
+        int x_constant = constant_operand(function, x, &cx);
+        int y_constant = constant_operand(function, y, &cy);
+        int k;
+
+        switch (inst->op) {
+            case IR_MUL:
+                if (x_constant && !y_constant) {    /* Constante à direita */
+                    int32_t swap = x;
+                    x = y;
+                    y = swap;
+                    cy = cx;
+                    y_constant = 1;
+                }
+                if (!y_constant) {
+                    continue;
+                }
+                if (cy == 0) {
+                    make_const(inst, 0);
+                } else if (cy == 1) {
+                    make_copy(inst, x);
+                } else if ((k = power_of_two(cy)) > 0) {
+                    memset(inst, 0, sizeof(IrInst));
+                    inst->op = IR_SHL;
+                    inst->a = x;
+                    inst->value = k;
+                } else {
+                    continue;
+                }
+                break;
+            case IR_DIV:
+                if (!y_constant) {
+                    continue;
+                }
+                if (cy == 1) {
+                    make_copy(inst, x);
+                } else if ((k = power_of_two(cy)) > 0) {
+                    memset(inst, 0, sizeof(IrInst));
+                    inst->op = IR_DIVPOW2;
+                    inst->a = x;
+                    inst->value = k;
+                } else {
+                    continue;
+                }
+                break;
+            case IR_ADD:
+                if (y_constant && cy == 0) {
+                    make_copy(inst, x);
+                } else if (x_constant && cx == 0) {
+                    make_copy(inst, y);
+                } else {
+                    continue;
+                }
+                break;
+            default:    /* IR_SUB */
+                if (y_constant && cy == 0) {
+                    make_copy(inst, x);
+                } else if (x == y) {
+                    make_const(inst, 0);
+                } else {
+                    continue;
+                }
+                break;
+        }
+        changes++;
+    }
+    return changes;
+}
+
+/* ============================================================================
+ * ELIMINAÇÃO DE CÓDIGO MORTO
+ * ============================================================================ */
+
+/*
+ * ir_dead_code_elimination(function)
+ *
+ * Varredura de trás para a frente: quando uma instrução é visitada, todos
+ * os seus usos (posteriores) já foram, e ela está viva se algum uso vivo
+ * a marcou ou se tem efeito. Uma instrução morta não marca os seus
+ * operandos, de modo que cadeias inteiras somem na mesma varredura.
+ */
+int ir_dead_code_elimination(IrFunction* function) {
+    char* live = (char*)checked_calloc((size_t)function->inst_count, 1);
+    int changes = 0;
+
+    for (int i = function->inst_count - 1; i >= 0; i--) {
+        IrInst* inst = &function->insts[i];
+        if (inst->op == IR_NOP) {
+            continue;
+        }
+        if (!live[i] && !ir_has_effect(function, inst)) {
+            inst->op = IR_NOP;
+            changes++;
+            continue;
+        }
+        int32_t* operands;
+        int count = ir_operands(function, inst, &operands);
+        for (int k = 0; k < count; k++) {
+            live[operands[k]] = 1;
+        }
+    }
+    free(live);
+    return changes;
+}
+
+/* ============================================================================
+ * JUNÇÃO DE BLOCOS
+ * ============================================================================ */
+
+/*
+ * ir_merge_blocks(function)
+ *
+ * Um bloco cujo único predecessor é o bloco anterior, terminado por um JMP
+ * para ele, passa a fazer parte desse bloco: o JMP vira IR_NOP e os PHI
+ * (de um único operando) viram cópias. Como as instruções dos dois já são
+ * contíguas (a menos de blocos só com IR_NOP, que a sccp apagou e que
+ * saem aqui mesmo), nenhum valor muda de número; só os blocos são
+ * renumerados, e os predecessores, refeitos. Encadeamentos de blocos
+ * deixados pela propagação de constantes e pela expansão de chamadas
+ * (ir_inline.c) viram um único bloco na mesma varredura.
+ */
+int ir_merge_blocks(IrFunction* function) {
+    int32_t* block_map = (int32_t*)checked_calloc((size_t)function->block_count, sizeof(int32_t));
+    int next = 0;
+    int changes = 0;
+    int dropped = 0;
+
+    for (int b = 0; b < function->block_count; b++) {
+        IrBlock block = function->blocks[b];
+        int dead = b > 0 && block.pred_count == 0;
+        for (int i = block.start; i < block.end && dead; i++) {
+            dead = function->insts[i].op == IR_NOP;
+        }
+        if (dead) {
+            block_map[b] = -1;      /* Apagado pela sccp; ninguém salta para ele */
+            dropped = 1;
+            continue;
+        }
+        IrBlock* previous = next > 0 ? &function->blocks[next - 1] : NULL;
+        const IrInst* jump = previous != NULL ? &function->insts[previous->end - 1] : NULL;
+        if (jump != NULL && block.pred_count == 1 && jump->op == IR_JMP && jump->a == b &&
+            block_map[function->preds[block.pred_start]] == next - 1) {
+            function->insts[previous->end - 1].op = IR_NOP;
+            for (int i = block.start; i < block.end; i++) {
+                IrInst* inst = &function->insts[i];
+                if (inst->op == IR_PHI) {
+                    make_copy(inst, function->operands[inst->a]);
+                }
+            }
+            previous->end = block.end;
+            block_map[b] = next - 1;
+            changes++;
+            continue;
+        }
+        block_map[b] = next;
+        function->blocks[next++] = block;
+    }
+
+    if (changes > 0 || dropped) {
+        function->block_count = next;
+        for (int b = 0; b < function->block_count; b++) {
+            IrInst* last = terminator(function, b);
+            if (last->op == IR_JMP) {
+                last->a = block_map[last->a];
+            } else if (last->op == IR_BR) {
+                last->b = block_map[last->b];
+                last->c = block_map[last->c];
+            }
+        }
+        ir_build_preds(function);
+    }
+    free(block_map);
+    return changes;
+}
+
+/* ============================================================================
+ * GERENCIADOR DE PASSADAS
+ * ============================================================================ */
+
+const IrPass ir_passes[] = {
+    {"copyprop", ir_copy_propagation, "propagação de cópias e de PHI triviais"},
+    {"sccp", ir_sccp, "propagação de constantes condicional esparsa"},
+    {"strength", ir_strength_reduction, "redução de força e elementos neutros"},
+    {"dce", ir_dead_code_elimination, "eliminação de código morto"},
+    {"merge", ir_merge_blocks, "junção de blocos ligados por um único JMP"},
+    {NULL, NULL, NULL}
+};
+
+int ir_pipeline_parse(IrPipeline* pipeline, const char* spec, char* message, size_t size) {
+    memset(pipeline, 0, sizeof(IrPipeline));
+    while (*spec != '\0') {
+        const char* end = strchr(spec, ',');
+        size_t length = end != NULL ? (size_t)(end - spec) : strlen(spec);
+        const IrPass* found = NULL;
+        for (const IrPass* pass = ir_passes; pass->name != NULL && found == NULL; pass++) {
+            if (strlen(pass->name) == length && strncmp(pass->name, spec, length) == 0) {
+                found = pass;
+            }
+        }
+        if (found == NULL) {
+            snprintf(message, size, "passada desconhecida: %.*s", (int)length, spec);
+            return -1;
+        }
+        if (pipeline->count == IR_MAX_PIPELINE) {
+            snprintf(message, size, "mais de %d passadas", IR_MAX_PIPELINE);
+            return -1;
+        }
+        pipeline->passes[pipeline->count++] = found;
+        spec += length + (end != NULL);
+    }
+    return 0;
+}
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1e6;
+}
+
+void ir_pipeline_run(IrPipeline* pipeline, IrFunction* function) {
+    for (int p = 0; p < pipeline->count; p++) {
+        double t0 = now_ms();
+        pipeline->visited[p] += function->inst_count;
+        pipeline->changes[p] += pipeline->passes[p]->run(function);
+        pipeline->millis[p] += now_ms() - t0;
+    }
+    pipeline->runs += pipeline->count;
+    double t0 = now_ms();
+    if (ir_live_count(function) != function->inst_count) {
+        ir_compact(function);
+    }
+    pipeline->compact_millis += now_ms() - t0;
+}
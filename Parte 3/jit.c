@@ -0,0 +1,562 @@
+/*
+ * ============================================================================
+ * COMPILADOR JIT x86-64 PARA A LINGUAGEM LSI-2025-2
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * Este módulo gera código de máquina x86-64 diretamente a partir da árvore
+ * sintática, sem passar por um compilador C externo:
+ *   - Uma função nativa por FDEF, seguindo a convenção System V
+ *     (argumentos em rdi, rsi, rdx, rcx, r8, r9; retorno em rax)
+ *   - Variáveis int em slots de 8 bytes no quadro [rbp - 8 * (i + 1)]
+ *   - Expressões avaliadas em rax, com operandos pendentes na pilha
+ *   - Comparações com cmp/setcc e if/else com saltos condicionais
+ *   - print através de uma função do hospedeiro chamada por endereço
+ *
+ * O código é montado em um buffer comum e copiado para páginas obtidas com
+ * mmap, que depois passam a ser somente leitura e execução.
+ *
+ * Não suportados (falham com mensagem, sem gerar código):
+ *   - Funções com mais de JIT_MAX_ARGS parâmetros
+ *   - Chamadas a funções inexistentes ou com número errado de argumentos
+ *   - Literais que não cabem em 64 bits
+ *
+ * ============================================================================
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "jit.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+/* ============================================================================
+ * BUFFER DE CÓDIGO
+ * ============================================================================ */
+
+typedef struct {
+    unsigned char* bytes;
+    size_t len;
+    size_t cap;
+} CodeBuffer;
+
+typedef struct {
+    size_t at;              /* Posição do rel32 a corrigir */
+    int callee;             /* Índice da função chamada na tabela */
+} CallPatch;
+
+typedef struct {
+    CodeBuffer code;
+    AstFunctionTable functions;
+    size_t* function_start;     /* Deslocamento de cada função (índice da tabela) */
+    CallPatch* patches;
+    int patch_count;
+    int patch_cap;
+    AstLocals locals;           /* Locais da função em compilação */
+    size_t* epilogue_jumps;     /* Saltos de return pendentes da função atual */
+    int epilogue_count;
+    int epilogue_cap;
+    JitPrintFn print_fn;
+    int failed;
+} JitCompiler;
+
+struct JitProgram {
+    unsigned char* code;
+    size_t size;
+    size_t entry_offset;
+    int entry_params;
+};
+
+static void emit_u8(JitCompiler* jc, unsigned int byte) {
+    if (jc->code.len == jc->code.cap) {
+        jc->code.cap = jc->code.cap ? jc->code.cap * 2 : 4096;
+        jc->code.bytes = (unsigned char*)realloc(jc->code.bytes, jc->code.cap);
+    }
+    jc->code.bytes[jc->code.len++] = (unsigned char)byte;
+}
+
+static void emit_u32(JitCompiler* jc, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        emit_u8(jc, (value >> (8 * i)) & 0xFF);
+    }
+}
+
+static void emit_u64(JitCompiler* jc, uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        emit_u8(jc, (unsigned int)((value >> (8 * i)) & 0xFF));
+    }
+}
+
+/*
+ * patch_rel32(jc, at, target)
+ *
+ * Escreve em "at" o deslocamento relativo de um salto ou chamada cujo
+ * fim da instrução é at + 4.
+ */
+static void patch_rel32(JitCompiler* jc, size_t at, size_t target) {
+    int32_t rel = (int32_t)((int64_t)target - (int64_t)(at + 4));
+    memcpy(jc->code.bytes + at, &rel, 4);
+}
+
+/*
+ * jit_error(jc, node, message)
+ *
+ * Reporta uma construção não suportada. Apenas o primeiro erro é mostrado.
+ */
+static void jit_error(JitCompiler* jc, const AstNode* node, const char* message) {
+    if (jc->failed) {
+        return;
+    }
+    fprintf(stderr, "\n--- Erro do JIT ---\n");
+    fprintf(stderr, "%s na linha %d, coluna %d\n", message, node->line, node->col);
+    jc->failed = 1;
+}
+
+/* ============================================================================
+ * INSTRUÇÕES
+ * ============================================================================
+ *
+ * Registradores pelo número da codificação: rax = 0, rcx = 1, rdx = 2,
+ * rsi = 6, rdi = 7, r8 = 8, r9 = 9. Todas as instruções são de 64 bits
+ * (prefixo REX.W).
+ */
+
+#define REG_RAX 0
+#define REG_RCX 1
+#define REG_RDX 2
+#define REG_RSI 6
+#define REG_RDI 7
+#define REG_R8  8
+#define REG_R9  9
+
+static const int arg_registers[JIT_MAX_ARGS] = {REG_RDI, REG_RSI, REG_RDX, REG_RCX, REG_R8, REG_R9};
+
+static int32_t slot_displacement(int index) {
+    return -8 * (index + 1);
+}
+
+/* mov reg, [rbp + disp32] */
+static void emit_load_slot(JitCompiler* jc, int reg, int index) {
+    emit_u8(jc, 0x48 | (reg >= 8 ? 0x04 : 0));
+    emit_u8(jc, 0x8B);
+    emit_u8(jc, 0x85 | ((reg & 7) << 3));
+    emit_u32(jc, (uint32_t)slot_displacement(index));
+}
+
+/* mov [rbp + disp32], reg */
+static void emit_store_slot(JitCompiler* jc, int reg, int index) {
+    emit_u8(jc, 0x48 | (reg >= 8 ? 0x04 : 0));
+    emit_u8(jc, 0x89);
+    emit_u8(jc, 0x85 | ((reg & 7) << 3));
+    emit_u32(jc, (uint32_t)slot_displacement(index));
+}
+
+/* mov rax, imm (forma curta quando cabe em 32 bits com sinal) */
+static void emit_load_imm(JitCompiler* jc, int64_t value) {
+    if (value >= INT32_MIN && value <= INT32_MAX) {
+        emit_u8(jc, 0x48); emit_u8(jc, 0xC7); emit_u8(jc, 0xC0);
+        emit_u32(jc, (uint32_t)(int32_t)value);
+    } else {
+        emit_u8(jc, 0x48); emit_u8(jc, 0xB8);
+        emit_u64(jc, (uint64_t)value);
+    }
+}
+
+/* mov rax, imm64; call rax */
+static void emit_call_absolute(JitCompiler* jc, const void* target) {
+    emit_u8(jc, 0x48); emit_u8(jc, 0xB8);
+    emit_u64(jc, (uint64_t)(uintptr_t)target);
+    emit_u8(jc, 0xFF); emit_u8(jc, 0xD0);
+}
+
+/* jcc/jmp rel32 com destino a corrigir; retorna a posição do rel32 */
+static size_t emit_jump(JitCompiler* jc, int condition_opcode) {
+    if (condition_opcode == 0) {
+        emit_u8(jc, 0xE9);
+    } else {
+        emit_u8(jc, 0x0F);
+        emit_u8(jc, (unsigned int)condition_opcode);
+    }
+    size_t at = jc->code.len;
+    emit_u32(jc, 0);
+    return at;
+}
+
+#define JMP_ALWAYS 0
+#define JZ_OPCODE  0x84
+#define JNE_OPCODE 0x85
+
+/* ============================================================================
+ * ROTINAS DO HOSPEDEIRO
+ * ============================================================================ */
+
+/*
+ * jit_division_by_zero(line, col)
+ *
+ * Chamada pelo código gerado quando o divisor é zero. Não retorna.
+ */
+static void jit_division_by_zero(long long line, long long col) {
+    fflush(stdout);
+    fprintf(stderr, "Erro de execução: divisão por zero na linha %lld, coluna %lld\n",
+            line, col);
+    exit(1);
+}
+
+/* ============================================================================
+ * EXPRESSÕES
+ * ============================================================================ */
+
+static void compile_expr(JitCompiler* jc, const AstNode* node);
+
+/*
+ * compile_division(jc, node)
+ *
+ * rax = rax / rcx com truncamento. Divisor zero chama o hospedeiro, com a
+ * pilha realinhada sem cerimônia, já que a chamada nunca retorna. Divisor
+ * -1 vira negação, evitando a exceção de INT64_MIN / -1.
+ */
+static void compile_division(JitCompiler* jc, const AstNode* node) {
+    /* test rcx, rcx; jnz nonzero */
+    emit_u8(jc, 0x48); emit_u8(jc, 0x85); emit_u8(jc, 0xC9);
+    size_t nonzero = emit_jump(jc, JNE_OPCODE);
+    /* mov edi, line; mov esi, col; and rsp, -16; call hospedeiro */
+    emit_u8(jc, 0xBF); emit_u32(jc, (uint32_t)node->line);
+    emit_u8(jc, 0xBE); emit_u32(jc, (uint32_t)node->col);
+    emit_u8(jc, 0x48); emit_u8(jc, 0x83); emit_u8(jc, 0xE4); emit_u8(jc, 0xF0);
+    emit_call_absolute(jc, (const void*)jit_division_by_zero);
+    patch_rel32(jc, nonzero, jc->code.len);
+
+    /* cmp rcx, -1; jne divide; neg rax; jmp done */
+    emit_u8(jc, 0x48); emit_u8(jc, 0x83); emit_u8(jc, 0xF9); emit_u8(jc, 0xFF);
+    size_t divide = emit_jump(jc, JNE_OPCODE);
+    emit_u8(jc, 0x48); emit_u8(jc, 0xF7); emit_u8(jc, 0xD8);
+    size_t done = emit_jump(jc, JMP_ALWAYS);
+    patch_rel32(jc, divide, jc->code.len);
+    /* cqo; idiv rcx */
+    emit_u8(jc, 0x48); emit_u8(jc, 0x99);
+    emit_u8(jc, 0x48); emit_u8(jc, 0xF7); emit_u8(jc, 0xF9);
+    patch_rel32(jc, done, jc->code.len);
+}
+
+/*
+ * compile_binop(jc, node)
+ *
+ * Avalia a esquerda, guarda na pilha, avalia a direita e combina com
+ * rax = esquerda e rcx = direita.
+ */
+static void compile_binop(JitCompiler* jc, const AstNode* node) {
+    compile_expr(jc, node->kids[0]);
+    emit_u8(jc, 0x50);                                      /* push rax */
+    compile_expr(jc, node->kids[1]);
+    emit_u8(jc, 0x48); emit_u8(jc, 0x89); emit_u8(jc, 0xC1);   /* mov rcx, rax */
+    emit_u8(jc, 0x58);                                      /* pop rax */
+
+    int setcc = 0;
+    switch (node->op) {
+        case TOKEN_PLUS:
+            emit_u8(jc, 0x48); emit_u8(jc, 0x01); emit_u8(jc, 0xC8);            /* add rax, rcx */
+            return;
+        case TOKEN_MINUS:
+            emit_u8(jc, 0x48); emit_u8(jc, 0x29); emit_u8(jc, 0xC8);            /* sub rax, rcx */
+            return;
+        case TOKEN_MULT:
+            emit_u8(jc, 0x48); emit_u8(jc, 0x0F); emit_u8(jc, 0xAF); emit_u8(jc, 0xC1); /* imul rax, rcx */
+            return;
+        case TOKEN_DIV:
+            compile_division(jc, node);
+            return;
+        case TOKEN_LT:  setcc = 0x9C; break;
+        case TOKEN_LTE: setcc = 0x9E; break;
+        case TOKEN_GT:  setcc = 0x9F; break;
+        case TOKEN_GTE: setcc = 0x9D; break;
+        case TOKEN_EQ:  setcc = 0x94; break;
+        case TOKEN_NEQ: setcc = 0x95; break;
+        default:
+            jit_error(jc, node, "Operador não suportado pelo JIT");
+            return;
+    }
+
+    /* cmp rax, rcx; setcc al; movzx eax, al */
+    emit_u8(jc, 0x48); emit_u8(jc, 0x39); emit_u8(jc, 0xC8);
+    emit_u8(jc, 0x0F); emit_u8(jc, (unsigned int)setcc); emit_u8(jc, 0xC0);
+    emit_u8(jc, 0x0F); emit_u8(jc, 0xB6); emit_u8(jc, 0xC0);
+}
+
+static void compile_expr(JitCompiler* jc, const AstNode* node) {
+    switch (node->kind) {
+        case AST_NUM:
+            emit_load_imm(jc, node->value);
+            break;
+        case AST_ID:
+            emit_load_slot(jc, REG_RAX, ast_locals_var(&jc->locals, node));
+            break;
+        case AST_BINOP:
+            compile_binop(jc, node);
+            break;
+        default:
+            jit_error(jc, node, "Expressão não suportada pelo JIT");
+            break;
+    }
+}
+
+/* ============================================================================
+ * COMANDOS
+ * ============================================================================ */
+
+/*
+ * compile_call(jc, call)
+ *
+ * Carrega os argumentos nos registradores e chama a função. O destino é
+ * corrigido depois que todas as funções têm endereço.
+ */
+static void compile_call(JitCompiler* jc, const AstNode* call) {
+    int callee = ast_function_index(&jc->functions, call->name);
+    if (callee < 0) {
+        jit_error(jc, call, "Chamada a função não definida");
+        return;
+    }
+    if (jc->functions.fdefs[callee]->param_count != call->kid_count) {
+        jit_error(jc, call, "Número de argumentos diferente do número de parâmetros");
+        return;
+    }
+
+    for (int i = 0; i < call->kid_count; i++) {
+        emit_load_slot(jc, arg_registers[i], ast_locals_var(&jc->locals, call->kids[i]));
+    }
+
+    emit_u8(jc, 0xE8);
+    if (jc->patch_count == jc->patch_cap) {
+        jc->patch_cap = jc->patch_cap ? jc->patch_cap * 2 : 64;
+        jc->patches = (CallPatch*)realloc(jc->patches, sizeof(CallPatch) * (size_t)jc->patch_cap);
+    }
+    jc->patches[jc->patch_count].at = jc->code.len;
+    jc->patches[jc->patch_count].callee = callee;
+    jc->patch_count++;
+    emit_u32(jc, 0);
+}
+
+static void compile_stmt(JitCompiler* jc, const AstNode* node) {
+    switch (node->kind) {
+        case AST_VARDECL:
+        case AST_EMPTY:
+            break;
+        case AST_ASSIGN:
+            if (node->kids[0]->kind == AST_FCALL) {
+                compile_call(jc, node->kids[0]);
+            } else {
+                compile_expr(jc, node->kids[0]);
+            }
+            emit_store_slot(jc, REG_RAX, ast_locals_var(&jc->locals, node));
+            break;
+        case AST_PRINT:
+            compile_expr(jc, node->kids[0]);
+            emit_u8(jc, 0x48); emit_u8(jc, 0x89); emit_u8(jc, 0xC7);   /* mov rdi, rax */
+            emit_call_absolute(jc, (const void*)jc->print_fn);
+            break;
+        case AST_RETURN:
+            if (node->kid_count > 0) {
+                emit_load_slot(jc, REG_RAX, ast_locals_var(&jc->locals, node->kids[0]));
+            } else {
+                emit_u8(jc, 0x31); emit_u8(jc, 0xC0);                  /* xor eax, eax */
+            }
+            if (jc->epilogue_count == jc->epilogue_cap) {
+                jc->epilogue_cap = jc->epilogue_cap ? jc->epilogue_cap * 2 : 16;
+                jc->epilogue_jumps = (size_t*)realloc(jc->epilogue_jumps,
+                                                      sizeof(size_t) * (size_t)jc->epilogue_cap);
+            }
+            jc->epilogue_jumps[jc->epilogue_count++] = emit_jump(jc, JMP_ALWAYS);
+            break;
+        case AST_IF: {
+            compile_expr(jc, node->kids[0]);
+            emit_u8(jc, 0x48); emit_u8(jc, 0x85); emit_u8(jc, 0xC0);   /* test rax, rax */
+            size_t to_else = emit_jump(jc, JZ_OPCODE);
+            compile_stmt(jc, node->kids[1]);
+            if (node->kid_count > 2) {
+                size_t to_end = emit_jump(jc, JMP_ALWAYS);
+                patch_rel32(jc, to_else, jc->code.len);
+                compile_stmt(jc, node->kids[2]);
+                patch_rel32(jc, to_end, jc->code.len);
+            } else {
+                patch_rel32(jc, to_else, jc->code.len);
+            }
+            break;
+        }
+        case AST_BLOCK:
+            for (int i = 0; i < node->kid_count; i++) {
+                compile_stmt(jc, node->kids[i]);
+            }
+            break;
+        default:
+            jit_error(jc, node, "Comando não suportado pelo JIT");
+            break;
+    }
+}
+
+/* ============================================================================
+ * FUNÇÕES
+ * ============================================================================ */
+
+/*
+ * compile_function(jc, fdef)
+ *
+ * Prólogo (quadro alinhado a 16 bytes, parâmetros copiados para seus
+ * slots, demais locais zerados), corpo e epílogo comum a todos os return.
+ */
+static void compile_function(JitCompiler* jc, const AstNode* fdef) {
+    if (fdef->param_count > JIT_MAX_ARGS) {
+        jit_error(jc, fdef, "Função com mais de 6 parâmetros não suportada pelo JIT");
+        return;
+    }
+
+    ast_locals_build(fdef, &jc->locals);
+    jc->epilogue_count = 0;
+
+    uint32_t frame = (uint32_t)((jc->locals.count * 8 + 15) & ~15);
+    emit_u8(jc, 0x55);                                              /* push rbp */
+    emit_u8(jc, 0x48); emit_u8(jc, 0x89); emit_u8(jc, 0xE5);        /* mov rbp, rsp */
+    emit_u8(jc, 0x48); emit_u8(jc, 0x81); emit_u8(jc, 0xEC);        /* sub rsp, frame */
+    emit_u32(jc, frame);
+
+    for (int i = 0; i < fdef->param_count; i++) {
+        emit_store_slot(jc, arg_registers[i], i);
+    }
+    if (jc->locals.count > fdef->param_count) {
+        emit_u8(jc, 0x31); emit_u8(jc, 0xC0);                      /* xor eax, eax */
+        for (int i = fdef->param_count; i < jc->locals.count; i++) {
+            emit_store_slot(jc, REG_RAX, i);
+        }
+    }
+
+    for (int i = 0; i < fdef->kid_count; i++) {
+        compile_stmt(jc, fdef->kids[i]);
+    }
+
+    emit_u8(jc, 0x31); emit_u8(jc, 0xC0);                          /* xor eax, eax */
+    for (int i = 0; i < jc->epilogue_count; i++) {
+        patch_rel32(jc, jc->epilogue_jumps[i], jc->code.len);
+    }
+    emit_u8(jc, 0xC9);                                              /* leave */
+    emit_u8(jc, 0xC3);                                              /* ret */
+
+    ast_locals_free(&jc->locals);
+}
+
+/*
+ * jit_compile(program, print_fn)
+ *
+ * Compila as funções na ordem do programa, corrige as chamadas e copia o
+ * resultado para páginas executáveis.
+ */
+JitProgram* jit_compile(const AstNode* program, JitPrintFn print_fn) {
+    JitCompiler jc;
+    memset(&jc, 0, sizeof(jc));
+    jc.print_fn = print_fn;
+
+    const AstNode* duplicate = ast_function_table_build(program, &jc.functions);
+    if (duplicate != NULL) {
+        jit_error(&jc, duplicate, "Função definida mais de uma vez");
+    }
+
+    const AstNode* entry = ast_entry_function(program);
+    size_t entry_offset = 0;
+    int entry_params = 0;
+
+    if (!jc.failed && entry == NULL) {
+        /* Programa de um único comando: compilado como função sem parâmetros */
+        compile_function(&jc, program);
+    } else if (!jc.failed) {
+        jc.function_start = (size_t*)malloc(sizeof(size_t) * (size_t)(jc.functions.count + 1));
+        for (int i = 0; i < program->kid_count && !jc.failed; i++) {
+            const AstNode* fdef = program->kids[i];
+            jc.function_start[ast_function_index(&jc.functions, fdef->name)] = jc.code.len;
+            if (fdef == entry) {
+                entry_offset = jc.code.len;
+                entry_params = fdef->param_count;
+            }
+            compile_function(&jc, fdef);
+        }
+        for (int i = 0; i < jc.patch_count && !jc.failed; i++) {
+            patch_rel32(&jc, jc.patches[i].at, jc.function_start[jc.patches[i].callee]);
+        }
+    }
+
+    JitProgram* jit = NULL;
+    if (!jc.failed) {
+        jit = (JitProgram*)malloc(sizeof(JitProgram));
+        jit->size = jc.code.len;
+        jit->entry_offset = entry_offset;
+        jit->entry_params = entry_params;
+        jit->code = (unsigned char*)mmap(NULL, jit->size, PROT_READ | PROT_WRITE,
+                                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (jit->code == MAP_FAILED) {
+            perror("Erro do JIT: mmap");
+            free(jit);
+            jit = NULL;
+        } else {
+            memcpy(jit->code, jc.code.bytes, jit->size);
+            if (mprotect(jit->code, jit->size, PROT_READ | PROT_EXEC) != 0) {
+                perror("Erro do JIT: mprotect");
+                munmap(jit->code, jit->size);
+                free(jit);
+                jit = NULL;
+            }
+        }
+    }
+
+    free(jc.code.bytes);
+    free(jc.function_start);
+    free(jc.patches);
+    free(jc.epilogue_jumps);
+    ast_function_table_free(&jc.functions);
+    return jit;
+}
+
+/* ============================================================================
+ * EXECUÇÃO
+ * ============================================================================ */
+
+typedef long long (*JitFn0)(void);
+typedef long long (*JitFn6)(long long, long long, long long, long long, long long, long long);
+
+int jit_entry_param_count(const JitProgram* jit) {
+    return jit->entry_params;
+}
+
+unsigned long jit_code_size(const JitProgram* jit) {
+    return (unsigned long)jit->size;
+}
+
+/*
+ * jit_run(jit, args)
+ *
+ * Chama o ponto de entrada. Passar seis argumentos a uma função que usa
+ * menos é seguro na convenção System V: os registradores extras são
+ * simplesmente ignorados.
+ */
+long long jit_run(const JitProgram* jit, const long long* args) {
+    long long a[JIT_MAX_ARGS] = {0, 0, 0, 0, 0, 0};
+    for (int i = 0; i < jit->entry_params; i++) {
+        a[i] = args[i];
+    }
+
+    void* entry = jit->code + jit->entry_offset;
+    if (jit->entry_params == 0) {
+        JitFn0 fn;
+        memcpy(&fn, &entry, sizeof(fn));
+        return fn();
+    }
+    JitFn6 fn;
+    memcpy(&fn, &entry, sizeof(fn));
+    return fn(a[0], a[1], a[2], a[3], a[4], a[5]);
+}
+
+void jit_free(JitProgram* jit) {
+    if (jit != NULL) {
+        munmap(jit->code, jit->size);
+        free(jit);
+    }
+}
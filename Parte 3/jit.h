@@ -0,0 +1,39 @@
+/*
+ * ============================================================================
+ * HEADER DO COMPILADOR JIT x86-64 PARA A LINGUAGEM LSI-2025-2
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * */
+
+#ifndef JIT_H
+#define JIT_H
+
+#include "ast.h"
+
+#define JIT_MAX_ARGS 6      /* Argumentos passados em registradores (System V) */
+
+typedef void (*JitPrintFn)(long long value);
+
+typedef struct JitProgram JitProgram;
+
+/*
+ * Compila todas as funções do programa para código de máquina em páginas
+ * executáveis. Retorna NULL se o programa usa algo que o JIT não suporta
+ * (o motivo é reportado em stderr).
+ */
+JitProgram* jit_compile(const AstNode* program, JitPrintFn print_fn);
+
+/* Número de parâmetros do ponto de entrada do programa compilado */
+int jit_entry_param_count(const JitProgram* jit);
+
+/* Executa o ponto de entrada com os argumentos dados e retorna seu valor */
+long long jit_run(const JitProgram* jit, const long long* args);
+
+/* Tamanho do código de máquina gerado, em bytes */
+unsigned long jit_code_size(const JitProgram* jit);
+
+void jit_free(JitProgram* jit);
+
+#endif
@@ -10,6 +10,16 @@
  *   - Reconhecimento baseado em diagramas de transição (autômatos)
  *   - Tabela de símbolos com técnica "maximal munch"
  *   - Detecção de erros léxicos com linha e coluna
+ *   - Leitura em blocos e linha/coluna calculadas sob demanda
+ *   - Conversão de literais numéricos para int64_t com detecção de estouro
+ *   - Espaços e identificadores delimitados direto no bloco de entrada e,
+ *     para o formatador, modo sem a tabela de símbolos
+ *   - Estado de leitura próprio de cada thread e, com várias threads, a
+ *     tabela de nomes compartilhada de intern.c
+ *   - Posições de 64 bits, lexemas de qualquer comprimento e índice de
+ *     linhas de tamanho constante, para entradas de vários gigabytes
+ *   - Limite opcional de comprimento de lexemas e contagem da memória
+ *     alocada, para os orçamentos do parser
  *
  * ============================================================================
  */
@@ -17,42 +27,178 @@
 #define _DEFAULT_SOURCE
 
 #include "lexer.h"
+#include "intern.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <limits.h>
+#include <stdint.h>
 
 /* ============================================================================
  * CONSTANTES
  * ============================================================================ */
 
-#define SYMBOL_TABLE_SIZE 100
-#define LEXEME_BUFFER_SIZE 256
+#define SYMBOL_TABLE_SIZE 100          /* Número inicial de buckets */
+#define ERROR_MESSAGE_SIZE 256
+
+/* ============================================================================
+ * ÁREA DE LEXEMAS
+ * ============================================================================
+ *
+ * Números e mensagens de erro são copiados para blocos que lexer_reset()
+ * reaproveita, de modo que analisar muitos arquivos no mesmo processo não
+ * acumula memória. Identificadores e palavras-chave apontam para a cópia
+ * guardada na tabela de símbolos.
+ */
+
+#define LEXEME_POOL_BLOCK 4096
+
+/* Bytes alocados pelo lexer nesta thread (lexer_memory_used()) */
+static __thread size_t memory_used = 0;
+
+/* Comprimento máximo de identificadores e números (lexer_set_max_lexeme()) */
+static size_t max_lexeme = SIZE_MAX;
+
+typedef struct PoolBlock {
+    struct PoolBlock* next;
+    size_t used;
+    size_t size;
+    char data[];
+} PoolBlock;
+
+static __thread PoolBlock* pool_head = NULL;
+
+/*
+ * pool_copy(data, length)
+ *
+ * Copia length bytes, mais o terminador, para o bloco corrente, abrindo um
+ * novo bloco quando não há espaço.
+ */
+static char* pool_copy(const char* data, size_t length) {
+    size_t size = length + 1;
+
+    if (pool_head == NULL || pool_head->used + size > pool_head->size) {
+        size_t block_size = size > LEXEME_POOL_BLOCK ? size : LEXEME_POOL_BLOCK;
+        PoolBlock* block = (PoolBlock*)malloc(sizeof(PoolBlock) + block_size);
+        if (block == NULL) {
+            fprintf(stderr, "Erro fatal: Memória insuficiente para os lexemas.\n");
+            exit(1);
+        }
+        block->next = pool_head;
+        block->used = 0;
+        block->size = block_size;
+        pool_head = block;
+        memory_used += sizeof(PoolBlock) + block_size;
+    }
+
+    char* copy = pool_head->data + pool_head->used;
+    memcpy(copy, data, length);
+    copy[length] = '\0';
+    pool_head->used += size;
+    return copy;
+}
+
+static char* pool_strdup(const char* str) {
+    return pool_copy(str, strlen(str));
+}
+
+/*
+ * pool_reset()
+ *
+ * Descarta todos os lexemas, mantendo o bloco mais antigo para reúso.
+ */
+static void pool_reset(void) {
+    while (pool_head != NULL && pool_head->next != NULL) {
+        PoolBlock* next = pool_head->next;
+        memory_used -= sizeof(PoolBlock) + pool_head->size;
+        free(pool_head);
+        pool_head = next;
+    }
+    if (pool_head != NULL) {
+        pool_head->used = 0;
+    }
+}
 
 /* ============================================================================
  * TABELA DE SÍMBOLOS
- * ============================================================================ */
+ * ============================================================================
+ *
+ * Cada nome recebe um número, na ordem de inserção, que segue no token
+ * (Token.value). As palavras-chave são inseridas primeiro e ficam com os
+ * números 0 a KEYWORD_COUNT - 1.
+ *
+ * Com symtable_enable_interning(), os nomes passam a ser guardados na
+ * tabela compartilhada de intern.c, que pode ser usada por várias threads
+ * ao mesmo tempo e dá o mesmo número ao mesmo nome em todos os arquivos.
+ */
+
+#define KEYWORD_COUNT 6
+
+static const char* const keyword_lexemes[KEYWORD_COUNT] = {
+    "int", "if", "else", "def", "print", "return"
+};
+static const TokenType keyword_types[KEYWORD_COUNT] = {
+    TOKEN_INT, TOKEN_IF, TOKEN_ELSE, TOKEN_DEF, TOKEN_PRINT, TOKEN_RETURN
+};
 
 typedef struct Symbol {
     char* lexeme;
+    size_t length;
     TokenType type;
+    int id;
     struct Symbol* next;
 } Symbol;
 
-static Symbol* symbol_table[SYMBOL_TABLE_SIZE];
+/* Sem a tabela de símbolos (lexer_set_symbol_table(0)); próprio de cada thread */
+static __thread int skip_symbols = 0;
+
+static Symbol** symbol_table = NULL;
+static unsigned int symbol_table_size = 0;
+static int symbol_count = 0;
+static int use_interning = 0;
 
 /*
- * hash(str)
+ * hash(str, length)
  *
- * Função hash para strings usando o método shift-add.
- * Distribui chaves de forma uniforme entre os buckets da tabela.
+ * Função hash para strings usando o método shift-add (multiplicação por
+ * 31). Distribui chaves de forma uniforme entre os buckets da tabela.
  */
-static unsigned int hash(const char* str) {
+static unsigned int hash(const char* str, size_t length) {
     unsigned int hash_value = 0;
-    while (*str) {
-        hash_value = (hash_value << 5) + *str++;
+    for (size_t i = 0; i < length; i++) {
+        hash_value = (hash_value << 5) - hash_value + (unsigned char)str[i];
     }
-    return hash_value % SYMBOL_TABLE_SIZE;
+    return hash_value % symbol_table_size;
+}
+
+/*
+ * symtable_grow()
+ *
+ * Dobra o número de buckets e redistribui os símbolos, para que as listas
+ * continuem curtas em arquivos com muitos nomes distintos.
+ */
+static void symtable_grow(void) {
+    unsigned int old_size = symbol_table_size;
+    Symbol** old_table = symbol_table;
+
+    symbol_table_size = old_size * 2;
+    symbol_table = (Symbol**)calloc(symbol_table_size, sizeof(Symbol*));
+    if (symbol_table == NULL) {
+        fprintf(stderr, "Erro fatal: Memória insuficiente para a tabela de símbolos.\n");
+        exit(1);
+    }
+    for (unsigned int i = 0; i < old_size; i++) {
+        Symbol* current = old_table[i];
+        while (current != NULL) {
+            Symbol* next = current->next;
+            unsigned int index = hash(current->lexeme, current->length);
+            current->next = symbol_table[index];
+            symbol_table[index] = current;
+            current = next;
+        }
+    }
+    free(old_table);
 }
 
 /*
@@ -62,52 +208,118 @@ static unsigned int hash(const char* str) {
  * As palavras-chave são inseridas diretamente na tabela durante a inicialização.
  */
 void symtable_init() {
-    for (int i = 0; i < SYMBOL_TABLE_SIZE; i++) {
-        symbol_table[i] = NULL;
-    }
-
-    const char* keywords[] = {"int", "if", "else", "def", "print", "return"};
-    TokenType types[] = {TOKEN_INT, TOKEN_IF, TOKEN_ELSE, TOKEN_DEF, TOKEN_PRINT, TOKEN_RETURN};
-    int num_keywords = sizeof(keywords) / sizeof(keywords[0]);
+    symbol_table_size = SYMBOL_TABLE_SIZE;
+    symbol_table = (Symbol**)calloc(symbol_table_size, sizeof(Symbol*));
+    symbol_count = 0;
 
-    for (int i = 0; i < num_keywords; i++) {
-        unsigned int index = hash(keywords[i]);
+    for (int i = 0; i < KEYWORD_COUNT; i++) {
+        size_t length = strlen(keyword_lexemes[i]);
+        unsigned int index = hash(keyword_lexemes[i], length);
         Symbol* new_symbol = (Symbol*)malloc(sizeof(Symbol));
-        new_symbol->lexeme = strdup(keywords[i]);
-        new_symbol->type = types[i];
+        new_symbol->lexeme = strdup(keyword_lexemes[i]);
+        new_symbol->length = length;
+        new_symbol->type = keyword_types[i];
+        new_symbol->id = symbol_count++;
         new_symbol->next = symbol_table[index];
         symbol_table[index] = new_symbol;
     }
 }
 
 /*
- * symtable_lookup_insert(lexeme, line, col)
+ * symtable_enable_interning()
+ *
+ * Passa a guardar os nomes na tabela compartilhada entre threads. Deve ser
+ * chamada antes de criar as threads e antes do primeiro token.
+ */
+void symtable_enable_interning(void) {
+    const char* text;
+    intern_init();
+    for (int i = 0; i < KEYWORD_COUNT; i++) {
+        if (intern_symbol(keyword_lexemes[i], strlen(keyword_lexemes[i]), &text) != i) {
+            fprintf(stderr, "Erro fatal: Tabela de símbolos já em uso.\n");
+            exit(1);
+        }
+    }
+    use_interning = 1;
+}
+
+/*
+ * symtable_lookup(lexeme, length, start)
  *
- * Consulta a tabela de símbolos procurando pelo lexema.
+ * Consulta a tabela de símbolos procurando pelo lexema, que não precisa
+ * ter terminador (pode apontar direto para o buffer de entrada).
  * Se encontrado como palavra-chave, retorna seu tipo.
  * Se não encontrado, insere como identificador (TOKEN_ID).
+ * O lexema do token é a cópia guardada na tabela, válida enquanto o
+ * processo existir.
  *
  * Implementa a técnica "maximal munch": reconhece o identificador
  * e consulta a tabela para verificar se é palavra-chave.
  */
-Token symtable_lookup_insert(const char* lexeme, int line, int col) {
-    unsigned int index = hash(lexeme);
+static Token symtable_lookup(const char* lexeme, size_t length, int64_t start) {
+    if (use_interning) {
+        const char* text;
+        int id = intern_symbol(lexeme, length, &text);
+        return (Token){id < KEYWORD_COUNT ? keyword_types[id] : TOKEN_ID, (char*)text, start, id};
+    }
+
+    unsigned int index = hash(lexeme, length);
     Symbol* current = symbol_table[index];
 
     while (current != NULL) {
-        if (strcmp(current->lexeme, lexeme) == 0) {
-            return (Token){current->type, strdup(lexeme), line, col};
+        if (current->length == length && memcmp(current->lexeme, lexeme, length) == 0) {
+            return (Token){current->type, current->lexeme, start, current->id};
         }
         current = current->next;
     }
 
     Symbol* new_symbol = (Symbol*)malloc(sizeof(Symbol));
-    new_symbol->lexeme = strdup(lexeme);
+    new_symbol->lexeme = strndup(lexeme, length);
+    new_symbol->length = length;
+    memory_used += sizeof(Symbol) + length + 1;
     new_symbol->type = TOKEN_ID;
+    new_symbol->id = symbol_count++;
     new_symbol->next = symbol_table[index];
     symbol_table[index] = new_symbol;
+    if ((unsigned int)symbol_count > 2 * symbol_table_size) {
+        symtable_grow();
+    }
+
+    return (Token){TOKEN_ID, new_symbol->lexeme, start, new_symbol->id};
+}
+
+/*
+ * keyword_token(lexeme, length, start)
+ *
+ * Reconhece as palavras-chave sem consultar a tabela de símbolos; os
+ * demais lexemas são identificadores com value -1.
+ */
+static Token keyword_token(const char* lexeme, size_t length, int64_t start) {
+    for (int i = 0; i < KEYWORD_COUNT; i++) {
+        if (keyword_lexemes[i][0] == lexeme[0] && strlen(keyword_lexemes[i]) == length &&
+            memcmp(keyword_lexemes[i], lexeme, length) == 0) {
+            return (Token){keyword_types[i], (char*)keyword_lexemes[i], start, i};
+        }
+    }
+    return (Token){TOKEN_ID, (char*)lexeme, start, -1};
+}
+
+/*
+ * lexer_set_symbol_table(enabled)
+ *
+ * Liga ou desliga, na thread atual, a consulta à tabela de símbolos.
+ */
+void lexer_set_symbol_table(int enabled) {
+    skip_symbols = !enabled;
+}
 
-    return (Token){TOKEN_ID, strdup(lexeme), line, col};
+/*
+ * symtable_lookup_insert(lexeme, start)
+ *
+ * Como symtable_lookup(), para um lexema terminado por '\0'.
+ */
+Token symtable_lookup_insert(const char* lexeme, int64_t start) {
+    return symtable_lookup(lexeme, strlen(lexeme), start);
 }
 
 /*
@@ -118,10 +330,10 @@ Token symtable_lookup_insert(const char* lexeme, int line, int col) {
  */
 void symtable_print() {
     printf("\n--- Tabela de Símbolos ---\n");
-    for (int i = 0; i < SYMBOL_TABLE_SIZE; i++) {
+    for (unsigned int i = 0; i < symbol_table_size; i++) {
         Symbol* current = symbol_table[i];
         if (current) {
-            printf("Bucket[%d]: ", i);
+            printf("Bucket[%u]: ", i);
             while (current != NULL) {
                 printf("('%s', %s) -> ", current->lexeme, token_type_to_string(current->type));
                 current = current->next;
@@ -133,58 +345,331 @@ void symtable_print() {
 
 /* ============================================================================
  * VARIÁVEIS GLOBAIS
- * ============================================================================ */
+ * ============================================================================
+ *
+ * O estado de leitura é próprio de cada thread (__thread), de modo que
+ * várias threads podem analisar arquivos diferentes ao mesmo tempo.
+ */
+
+__thread FILE* inputFile;
+__thread int64_t offset = 0;         /* Posição de currentChar na entrada, em bytes */
+__thread int currentChar;            /* Byte de 0 a 255, ou EOF */
+
+/* ============================================================================
+ * BUFFER DE ENTRADA
+ * ============================================================================
+ *
+ * A entrada é lida em blocos de INPUT_BUFFER_SIZE bytes com fread(), em
+ * vez de uma chamada fgetc() por caractere. input_base é a posição, na
+ * entrada, do primeiro byte do bloco corrente.
+ */
+
+#define INPUT_BUFFER_SIZE (64 * 1024)
+
+static __thread unsigned char input_buffer[INPUT_BUFFER_SIZE];
+static __thread size_t input_length = 0;
+static __thread size_t input_pos = 0;
+static __thread int64_t input_base = 0;
+
+static void newline_index_scan(int64_t limit);
+static void line_index_compact(void);
+
+/*
+ * refill_input()
+ *
+ * Indexa as quebras de linha do bloco corrente, que será descartado, e lê
+ * o próximo. Retorna 0 no fim da entrada.
+ */
+static int refill_input(void) {
+    newline_index_scan(input_base + (int64_t)input_length);
+    line_index_compact();
+    input_base += (int64_t)input_length;
+    input_length = fread(input_buffer, 1, INPUT_BUFFER_SIZE, inputFile);
+    input_pos = 0;
+    return input_length > 0;
+}
 
-FILE* inputFile;
-int line = 1;
-int col = 1;
-char currentChar;
+static inline int read_byte(void) {
+    if (input_pos == input_length && !refill_input()) {
+        return EOF;
+    }
+    return input_buffer[input_pos++];
+}
+
+static inline int peek_byte(void) {
+    if (input_pos == input_length && !refill_input()) {
+        return EOF;
+    }
+    return input_buffer[input_pos];
+}
+
+/* ============================================================================
+ * ÍNDICE DE QUEBRAS DE LINHA
+ * ============================================================================
+ *
+ * Tokens guardam apenas a posição em bytes; linha e coluna são calculadas
+ * sob demanda a partir das posições das quebras de linha. Os '\n' são
+ * localizados com memchr() por blocos, sempre de forma preguiçosa: até a
+ * posição consultada ou antes de um bloco ser descartado. Um '\r' isolado
+ * (quebra no estilo Mac antigo) é raro e é registrado por advance() em uma
+ * lista à parte. Em "\r\n" a quebra é o '\n'.
+ *
+ * A posição de uma quebra pertence à linha seguinte, com coluna 0, e o
+ * primeiro caractere de cada linha tem coluna 1, como na contagem por
+ * caractere feita antes por advance().
+ *
+ * Cada quebra guarda também quantas quebras da sua lista vêm até ela, de
+ * modo que as anteriores podem ser descartadas. Só são consultadas as
+ * posições dos dois últimos tokens devolvidos por getToken() (o token
+ * corrente e o seguinte, no parser) e as posições adiante; como nenhum
+ * token contém quebras, basta guardar, de cada lista, a última quebra
+ * antes de cada uma dessas posições. line_index_compact() reduz as listas
+ * a isso sempre que um bloco é descartado, e o índice ocupa no máximo um
+ * bloco de quebras, qualquer que seja o tamanho da entrada.
+ */
+
+typedef struct {
+    int64_t offset;
+    int64_t number;         /* Quebras da lista até esta, inclusive */
+} LineBreak;
+
+typedef struct {
+    LineBreak* breaks;
+    size_t count;
+    size_t capacity;
+    LineBreak folded;       /* Última quebra descartada; offset -1 se nenhuma */
+} BreakList;
+
+static __thread BreakList newline_breaks;        /* '\n', em ordem crescente */
+static __thread BreakList cr_breaks;             /* '\r' isolados, em ordem crescente */
+static __thread int64_t newline_scanned = 0;     /* Bytes [0, newline_scanned) já indexados */
+static __thread size_t newline_cursor = 0;       /* Linha da última consulta, para consultas em ordem */
+static __thread int64_t token_offsets[2];        /* Penúltimo e último tokens devolvidos */
+
+static void break_list_reset(BreakList* list) {
+    list->count = 0;
+    list->folded.offset = -1;
+    list->folded.number = 0;
+}
+
+static void break_list_add(BreakList* list, int64_t value) {
+    if (list->count == list->capacity) {
+        memory_used += sizeof(LineBreak) * (list->capacity ? list->capacity : 1024);
+        list->capacity = list->capacity ? list->capacity * 2 : 1024;
+        list->breaks = (LineBreak*)realloc(list->breaks, sizeof(LineBreak) * list->capacity);
+        if (list->breaks == NULL) {
+            fprintf(stderr, "Erro fatal: Memória insuficiente para o índice de linhas.\n");
+            exit(1);
+        }
+    }
+    int64_t previous = list->count > 0 ? list->breaks[list->count - 1].number
+                                       : list->folded.number;
+    list->breaks[list->count].offset = value;
+    list->breaks[list->count].number = previous + 1;
+    list->count++;
+}
+
+/*
+ * break_list_count_upto(list, value)
+ *
+ * Busca binária: quantas quebras guardadas estão em posições menores ou
+ * iguais a value.
+ */
+static size_t break_list_count_upto(const BreakList* list, int64_t value) {
+    size_t lo = 0;
+    size_t hi = list->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (list->breaks[mid].offset <= value) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/* Última quebra em posição menor ou igual à de índice k - 1 da lista */
+static inline const LineBreak* break_list_last(const BreakList* list, size_t k) {
+    return k > 0 ? &list->breaks[k - 1] : &list->folded;
+}
+
+/*
+ * break_list_compact(list, previous, last)
+ *
+ * Mantém só as quebras necessárias para consultar previous, last e
+ * posições depois das quebras já indexadas: a que está exatamente em
+ * previous (um token de erro pode começar em uma quebra), a última até
+ * last e a última de todas. As anteriores a previous viram folded.
+ */
+static void break_list_compact(BreakList* list, int64_t previous, int64_t last) {
+    LineBreak* at_previous = NULL;
+    LineBreak* upto_last = NULL;
+    LineBreak* newest = NULL;
+    for (size_t i = 0; i < list->count; i++) {
+        LineBreak* entry = &list->breaks[i];
+        if (entry->offset < previous) {
+            list->folded = *entry;
+        } else if (entry->offset == previous) {
+            at_previous = entry;
+        } else if (entry->offset <= last) {
+            upto_last = entry;
+        } else {
+            newest = entry;
+        }
+    }
+    size_t kept = 0;
+    if (at_previous != NULL) {
+        list->breaks[kept++] = *at_previous;
+    }
+    if (upto_last != NULL) {
+        list->breaks[kept++] = *upto_last;
+    }
+    if (newest != NULL) {
+        list->breaks[kept++] = *newest;
+    }
+    list->count = kept;
+}
+
+static void line_index_compact(void) {
+    break_list_compact(&newline_breaks, token_offsets[0], token_offsets[1]);
+    break_list_compact(&cr_breaks, token_offsets[0], token_offsets[1]);
+    newline_cursor = 0;
+}
+
+/*
+ * newline_index_scan(limit)
+ *
+ * Registra os '\n' do bloco corrente entre newline_scanned e limit.
+ */
+static void newline_index_scan(int64_t limit) {
+    if (limit <= newline_scanned) {
+        return;
+    }
+    const unsigned char* p = input_buffer + (newline_scanned - input_base);
+    const unsigned char* end = input_buffer + (limit - input_base);
+    while ((p = memchr(p, '\n', (size_t)(end - p))) != NULL) {
+        break_list_add(&newline_breaks, input_base + (int64_t)(p - input_buffer));
+        p++;
+    }
+    newline_scanned = limit;
+}
+
+/*
+ * lexer_position(pos, line, col)
+ *
+ * Converte uma posição em bytes do arquivo corrente em linha e coluna.
+ * Consultas em ordem crescente, o caso comum, são resolvidas sem busca.
+ */
+void lexer_position(int64_t pos, int64_t* line, int64_t* col) {
+    int64_t buffer_end = input_base + (int64_t)input_length;
+    newline_index_scan(pos + 1 < buffer_end ? pos + 1 : buffer_end);
+
+    const LineBreak* nl = newline_breaks.breaks;
+    size_t k = newline_cursor;
+    if (k > newline_breaks.count || (k > 0 && nl[k - 1].offset > pos) ||
+        (k < newline_breaks.count && nl[k].offset <= pos)) {
+        k = break_list_count_upto(&newline_breaks, pos);
+        newline_cursor = k;
+    }
+
+    const LineBreak* last = break_list_last(&newline_breaks, k);
+    int64_t last_break = last->offset;
+    int64_t breaks = last->number;
+    if (cr_breaks.count > 0 || cr_breaks.folded.number > 0) {
+        const LineBreak* cr = break_list_last(&cr_breaks, break_list_count_upto(&cr_breaks, pos));
+        if (cr->offset > last_break) {
+            last_break = cr->offset;
+        }
+        breaks += cr->number;
+    }
+    *line = 1 + breaks;
+    *col = pos - last_break;
+}
+
+/*
+ * lexer_position_int(pos, line, col)
+ *
+ * Como lexer_position(), para os campos int da árvore sintática.
+ */
+void lexer_position_int(int64_t pos, int* line, int* col) {
+    int64_t line64, col64;
+    lexer_position(pos, &line64, &col64);
+    *line = line64 > INT_MAX ? INT_MAX : (int)line64;
+    *col = col64 > INT_MAX ? INT_MAX : (int)col64;
+}
 
 /* ============================================================================
  * FUNÇÕES DE LEITURA DO ARQUIVO
  * ============================================================================ */
 
+/*
+ * advance_carriage_return()
+ *
+ * Caso raro de advance(), fora da função para que ela fique pequena o
+ * bastante para ser expandida em cada chamada.
+ */
+static __attribute__((noinline)) void advance_carriage_return(void) {
+    if (peek_byte() == '\n') {
+        read_byte();
+        offset++;
+    } else {
+        break_list_add(&cr_breaks, offset);
+    }
+    currentChar = '\n';
+}
+
 /*
  * advance()
  *
- * Lê o próximo caractere do arquivo e atualiza linha e coluna.
- * Trata corretamente diferentes tipos de quebra de linha:
+ * Lê o próximo caractere do arquivo e registra sua posição em bytes.
+ * Trata corretamente diferentes tipos de quebra de linha, todas vistas
+ * como '\n' pelo restante do lexer:
  *   - Unix: \n
- *   - Windows: \r\n
- *   - Antigo (Mac): \r
+ *   - Windows: \r\n (a posição é a do \n)
+ *   - Antigo (Mac): \r (registrado no índice de quebras de linha)
+ *
+ * É chamada uma ou mais vezes por token; expandida em cada chamada, o
+ * lexer fica perto de duas vezes mais rápido em arquivos com muitos
+ * tokens curtos.
  */
-void advance() {
-    currentChar = fgetc(inputFile);
+static inline __attribute__((always_inline)) void advance(void) {
+    offset = input_base + (int64_t)input_pos;
+    currentChar = read_byte();
     if (currentChar == '\r') {
-        int next = fgetc(inputFile);
-        if (next == '\n') {
-            currentChar = '\n';
-            line++;
-            col = 1;
-        } else {
-            ungetc(next, inputFile);
-            currentChar = '\n';
-            line++;
-            col = 1;
-        }
-    } else if (currentChar == '\n') {
-        line++;
-        col = 1;
-    } else {
-        col++;
+        advance_carriage_return();
     }
 }
 
+/*
+ * lexer_reset(input)
+ *
+ * Prepara o lexer para ler um novo arquivo desde o início, liberando os
+ * lexemas e o índice de linhas do arquivo anterior. A tabela de símbolos
+ * é mantida.
+ */
+void lexer_reset(FILE* input) {
+    inputFile = input;
+    input_length = 0;
+    input_pos = 0;
+    input_base = 0;
+    break_list_reset(&newline_breaks);
+    break_list_reset(&cr_breaks);
+    newline_scanned = 0;
+    newline_cursor = 0;
+    token_offsets[0] = 0;
+    token_offsets[1] = 0;
+    pool_reset();
+    advance();
+}
+
 /*
  * peek()
  *
- * Espira o próximo caractere sem consumi-lo.
- * Retorna o caractere e repositiona o ponteiro do arquivo.
+ * Espia o próximo caractere sem consumi-lo.
  */
 char peek() {
-    char c = fgetc(inputFile);
-    ungetc(c, inputFile);
-    return c;
+    return (char)peek_byte();
 }
 
 /* ============================================================================
@@ -192,18 +677,270 @@ char peek() {
  * ============================================================================ */
 
 /*
- * create_error_token(message)
+ * create_error_token(message, start)
  *
- * Cria um token de erro com a mensagem especificada.
+ * Cria um token de erro com a mensagem especificada, na posição do
+ * primeiro caractere que não forma token.
  * Retorna um token do tipo TOKEN_ERROR com o prefixo "ERRO: ".
  */
-Token create_error_token(const char* message) {
-    char* errorLexeme = (char*)malloc(LEXEME_BUFFER_SIZE);
-    snprintf(errorLexeme, LEXEME_BUFFER_SIZE, "ERRO: %s", message);
-    return (Token){TOKEN_ERROR, errorLexeme, line, col - 1};
+Token create_error_token(const char* message, int64_t start) {
+    char errorLexeme[ERROR_MESSAGE_SIZE];
+    snprintf(errorLexeme, ERROR_MESSAGE_SIZE, "ERRO: %s", message);
+    return (Token){TOKEN_ERROR, pool_strdup(errorLexeme), start};
 }
 
-static char lexemeBuffer[LEXEME_BUFFER_SIZE];
+/*
+ * Números e identificadores que atravessam o fim de um bloco são
+ * acumulados aqui, um caractere por vez; a área cresce conforme o lexema,
+ * sem limite de comprimento.
+ */
+static __thread char* lexeme_scratch = NULL;
+static __thread size_t lexeme_scratch_capacity = 0;
+
+/*
+ * scratch_put(count, c)
+ *
+ * Guarda c na posição count de lexeme_scratch, deixando espaço para o
+ * terminador.
+ */
+static inline void scratch_put(size_t count, char c) {
+    if (count + 1 >= lexeme_scratch_capacity) {
+        memory_used += lexeme_scratch_capacity ? lexeme_scratch_capacity : 64;
+        lexeme_scratch_capacity = lexeme_scratch_capacity ? lexeme_scratch_capacity * 2 : 64;
+        lexeme_scratch = (char*)realloc(lexeme_scratch, lexeme_scratch_capacity);
+        if (lexeme_scratch == NULL) {
+            fprintf(stderr, "Erro fatal: Memória insuficiente para os lexemas.\n");
+            exit(1);
+        }
+    }
+    lexeme_scratch[count] = c;
+}
+
+/*
+ * lexeme_limit_error(start)
+ *
+ * Token de erro para um identificador ou número com mais de max_lexeme
+ * bytes. O restante do lexema não é lido nem copiado.
+ */
+static Token lexeme_limit_error(int64_t start) {
+    char errorLexeme[ERROR_MESSAGE_SIZE];
+    snprintf(errorLexeme, ERROR_MESSAGE_SIZE, "ERRO: Lexema maior que o limite de %zu bytes",
+             max_lexeme);
+    return (Token){TOKEN_ERROR, pool_strdup(errorLexeme), start, TOKEN_ERROR_LIMIT};
+}
+
+/*
+ * lexer_set_max_lexeme(max_length)
+ *
+ * Define o comprimento máximo de identificadores e números; 0 remove o limite.
+ */
+void lexer_set_max_lexeme(size_t max_length) {
+    max_lexeme = max_length > 0 ? max_length : SIZE_MAX;
+}
+
+size_t lexer_memory_used(void) {
+    return memory_used;
+}
+
+/* ============================================================================
+ * LITERAIS NUMÉRICOS
+ * ============================================================================
+ *
+ * Os dígitos são convertidos para int64_t durante a leitura, oito por vez
+ * (SWAR: os oito bytes são tratados como um único inteiro de 64 bits), e o
+ * valor segue no token. Literais acima de INT64_MAX viram TOKEN_ERROR na
+ * posição do seu primeiro dígito.
+ */
+
+#define INT64_MAX_DIGITS 19
+
+static inline uint64_t load_u64(const unsigned char* p) {
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+/*
+ * is_eight_digits(chunk)
+ *
+ * Verdadeiro se os oito bytes (little-endian) são todos '0'..'9'.
+ */
+static inline int is_eight_digits(uint64_t chunk) {
+    return ((chunk & 0xF0F0F0F0F0F0F0F0ull) |
+            (((chunk + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4)) ==
+           0x3333333333333333ull;
+}
+
+/*
+ * parse_eight_digits(chunk)
+ *
+ * Converte oito dígitos ASCII em seu valor com três multiplicações:
+ * combina pares de dígitos, depois pares de pares e por fim as metades.
+ */
+static inline uint64_t parse_eight_digits(uint64_t chunk) {
+    chunk -= 0x3030303030303030ull;
+    chunk = (chunk * 10) + (chunk >> 8);
+    chunk = (((chunk & 0x000000FF000000FFull) * (100 + (1000000ull << 32))) +
+             (((chunk >> 16) & 0x000000FF000000FFull) * (1 + (10000ull << 32)))) >> 32;
+    return chunk;
+}
+
+/*
+ * digits_to_int64(digits, count, value)
+ *
+ * Converte a sequência de dígitos. Retorna 0 se o valor não cabe em
+ * int64_t. Zeros à esquerda não contam para o limite de 19 dígitos.
+ */
+static int digits_to_int64(const unsigned char* digits, size_t count, int64_t* value) {
+    while (count > 1 && *digits == '0') {
+        digits++;
+        count--;
+    }
+    if (count > INT64_MAX_DIGITS) {
+        return 0;
+    }
+
+    uint64_t result = 0;
+    for (; count >= 8; digits += 8, count -= 8) {
+        result = result * 100000000u + parse_eight_digits(load_u64(digits));
+    }
+    for (; count > 0; digits++, count--) {
+        result = result * 10 + (uint64_t)(*digits - '0');
+    }
+    if (result > (uint64_t)INT64_MAX) {
+        return 0;
+    }
+    *value = (int64_t)result;
+    return 1;
+}
+
+/*
+ * scan_number(start)
+ *
+ * Reconhece uma sequência de dígitos a partir de currentChar. No caso
+ * comum a sequência termina dentro do bloco de entrada corrente: é
+ * delimitada oito bytes por vez e convertida direto do buffer, sem passar
+ * por advance() a cada dígito. Caso contrário, os dígitos são acumulados
+ * um a um em lexeme_scratch.
+ */
+static Token scan_number(int64_t start) {
+    const unsigned char* digits;
+    size_t count;
+    size_t first = input_pos - 1;       /* currentChar é o último byte lido */
+    size_t end = first + 1;
+
+    while (end + 8 <= input_length && is_eight_digits(load_u64(input_buffer + end))) {
+        end += 8;
+    }
+    while (end < input_length && isdigit(input_buffer[end])) {
+        end++;
+    }
+    if (end - first > max_lexeme) {
+        return lexeme_limit_error(start);
+    }
+
+    /* Com end + 1 < input_length, advance() não troca o bloco nem para ver um "\r\n" */
+    if (end + 1 < input_length) {
+        digits = input_buffer + first;
+        count = end - first;
+        input_pos = end;
+        advance();
+    } else {
+        count = 0;
+        while (isdigit(currentChar)) {
+            if (count == max_lexeme) {
+                return lexeme_limit_error(start);
+            }
+            scratch_put(count++, currentChar);
+            advance();
+        }
+        scratch_put(count, '\0');
+        digits = (const unsigned char*)lexeme_scratch;
+    }
+
+    int64_t value = 0;
+    if (!digits_to_int64(digits, count, &value)) {
+        char errorLexeme[ERROR_MESSAGE_SIZE];
+        snprintf(errorLexeme, ERROR_MESSAGE_SIZE,
+                 "ERRO: Literal numérico fora do intervalo de 64 bits: '%.*s%s'",
+                 count > 40 ? 40 : (int)count, (const char*)digits, count > 40 ? "..." : "");
+        return (Token){TOKEN_ERROR, pool_strdup(errorLexeme), start, 0};
+    }
+    if (skip_symbols) {
+        return (Token){TOKEN_NUM, (char*)digits, start, value};
+    }
+    return (Token){TOKEN_NUM, pool_copy((const char*)digits, count), start, value};
+}
+
+/* ============================================================================
+ * ESPAÇOS E IDENTIFICADORES
+ * ============================================================================
+ *
+ * Como em scan_number(), o caso comum é resolvido direto no bloco de
+ * entrada: espaços são pulados e identificadores delimitados sem uma
+ * chamada a advance() por caractere, e o identificador é procurado na
+ * tabela de símbolos a partir do próprio buffer. Um '\r' não é pulado
+ * aqui, porque advance() precisa registrá-lo no índice de quebras.
+ */
+
+static inline int is_fast_space(int c) {
+    return c == ' ' || c == '\n' || c == '\t' || c == '\v' || c == '\f';
+}
+
+/* Letras, dígitos e '_', sem a chamada de isalnum() por caractere */
+static const unsigned char identifier_chars[256] = {
+    ['0' ... '9'] = 1, ['A' ... 'Z'] = 1, ['a' ... 'z'] = 1, ['_'] = 1
+};
+
+static inline int is_identifier_char(int c) {
+    return identifier_chars[(unsigned char)c];
+}
+
+static void skip_whitespace(void) {
+    while (isspace(currentChar)) {
+        while (input_pos < input_length && is_fast_space(input_buffer[input_pos])) {
+            input_pos++;
+        }
+        advance();
+    }
+}
+
+/*
+ * scan_identifier(start)
+ *
+ * Reconhece um identificador ou palavra-chave a partir de currentChar.
+ * Se ele atravessa o fim do bloco, os caracteres são acumulados um a um
+ * em lexeme_scratch.
+ */
+static Token scan_identifier(int64_t start) {
+    size_t first = input_pos - 1;       /* currentChar é o último byte lido */
+    size_t end = first + 1;
+    while (end < input_length && is_identifier_char(input_buffer[end])) {
+        end++;
+    }
+    if (end - first > max_lexeme) {
+        return lexeme_limit_error(start);
+    }
+    if (end + 1 < input_length) {      /* Ver scan_number() */
+        const char* lexeme = (const char*)input_buffer + first;
+        input_pos = end;
+        advance();
+        return skip_symbols ? keyword_token(lexeme, end - first, start)
+                            : symtable_lookup(lexeme, end - first, start);
+    }
+
+    size_t length = 0;
+    while (is_identifier_char(currentChar)) {
+        if (length == max_lexeme) {
+            return lexeme_limit_error(start);
+        }
+        scratch_put(length++, currentChar);
+        advance();
+    }
+    scratch_put(length, '\0');
+    return skip_symbols ? keyword_token(lexeme_scratch, length, start)
+                        : symtable_lookup(lexeme_scratch, length, start);
+}
 
 /*
  * getToken()
@@ -220,41 +957,29 @@ static char lexemeBuffer[LEXEME_BUFFER_SIZE];
  * Retorna o token encontrado ou TOKEN_ERROR se caractere inválido.
  */
 Token getToken() {
-    int pos = 0;
+    skip_whitespace();
 
-    while (isspace(currentChar)) {
-        advance();
-    }
-
-    int startLine = line;
-    int startCol = col - 1;
+    /* Posições que lexer_position() ainda precisa resolver */
+    int64_t start = offset;
+    token_offsets[0] = token_offsets[1];
+    token_offsets[1] = start;
 
     if (currentChar == EOF) {
-        return (Token){TOKEN_EOF, "EOF", startLine, startCol};
+        return (Token){TOKEN_EOF, "EOF", start};
     }
 
     /*
      * Reconhecimento de números.
      */
     if (isdigit(currentChar)) {
-        while (isdigit(currentChar)) {
-            lexemeBuffer[pos++] = currentChar;
-            advance();
-        }
-        lexemeBuffer[pos] = '\0';
-        return (Token){TOKEN_NUM, strdup(lexemeBuffer), startLine, startCol};
+        return scan_number(start);
     }
 
     /*
      * Reconhecimento de identificadores e palavras-chave.
      */
     if (isalpha(currentChar) || currentChar == '_') {
-        while (isalnum(currentChar) || currentChar == '_') {
-            lexemeBuffer[pos++] = currentChar;
-            advance();
-        }
-        lexemeBuffer[pos] = '\0';
-        return symtable_lookup_insert(lexemeBuffer, startLine, startCol);
+        return scan_identifier(start);
     }
 
     /*
@@ -264,49 +989,49 @@ Token getToken() {
         advance();
         if (currentChar == '=') {
             advance();
-            return (Token){TOKEN_EQ, "==", startLine, startCol};
+            return (Token){TOKEN_EQ, "==", start};
         }
-        return (Token){TOKEN_ASSIGN, "=", startLine, startCol};
+        return (Token){TOKEN_ASSIGN, "=", start};
     }
     if (currentChar == '!') {
         advance();
         if (currentChar == '=') {
             advance();
-            return (Token){TOKEN_NEQ, "!=", startLine, startCol};
+            return (Token){TOKEN_NEQ, "!=", start};
         }
-        return create_error_token("Caractere '!' inesperado. Esperava '!='?");
+        return create_error_token("Caractere '!' inesperado. Esperava '!='?", start);
     }
     if (currentChar == '<') {
         advance();
         if (currentChar == '=') {
             advance();
-            return (Token){TOKEN_LTE, "<=", startLine, startCol};
+            return (Token){TOKEN_LTE, "<=", start};
         }
-        return (Token){TOKEN_LT, "<", startLine, startCol};
+        return (Token){TOKEN_LT, "<", start};
     }
     if (currentChar == '>') {
         advance();
         if (currentChar == '=') {
             advance();
-            return (Token){TOKEN_GTE, ">=", startLine, startCol};
+            return (Token){TOKEN_GTE, ">=", start};
         }
-        return (Token){TOKEN_GT, ">", startLine, startCol};
+        return (Token){TOKEN_GT, ">", start};
     }
 
     /*
      * Reconhecimento de operadores simples e símbolos especiais.
      */
     switch (currentChar) {
-        case '+': advance(); return (Token){TOKEN_PLUS, "+", startLine, startCol};
-        case '-': advance(); return (Token){TOKEN_MINUS, "-", startLine, startCol};
-        case '*': advance(); return (Token){TOKEN_MULT, "*", startLine, startCol};
-        case '/': advance(); return (Token){TOKEN_DIV, "/", startLine, startCol};
-        case '(': advance(); return (Token){TOKEN_LPAREN, "(", startLine, startCol};
-        case ')': advance(); return (Token){TOKEN_RPAREN, ")", startLine, startCol};
-        case '{': advance(); return (Token){TOKEN_LBRACE, "{", startLine, startCol};
-        case '}': advance(); return (Token){TOKEN_RBRACE, "}", startLine, startCol};
-        case ',': advance(); return (Token){TOKEN_COMMA, ",", startLine, startCol};
-        case ';': advance(); return (Token){TOKEN_SEMICOLON, ";", startLine, startCol};
+        case '+': advance(); return (Token){TOKEN_PLUS, "+", start};
+        case '-': advance(); return (Token){TOKEN_MINUS, "-", start};
+        case '*': advance(); return (Token){TOKEN_MULT, "*", start};
+        case '/': advance(); return (Token){TOKEN_DIV, "/", start};
+        case '(': advance(); return (Token){TOKEN_LPAREN, "(", start};
+        case ')': advance(); return (Token){TOKEN_RPAREN, ")", start};
+        case '{': advance(); return (Token){TOKEN_LBRACE, "{", start};
+        case '}': advance(); return (Token){TOKEN_RBRACE, "}", start};
+        case ',': advance(); return (Token){TOKEN_COMMA, ",", start};
+        case ';': advance(); return (Token){TOKEN_SEMICOLON, ";", start};
     }
 
     /*
@@ -315,7 +1040,7 @@ Token getToken() {
     char errorMsg[50];
     snprintf(errorMsg, 50, "Caractere inválido: '%c'", currentChar);
     advance();
-    return create_error_token(errorMsg);
+    return create_error_token(errorMsg, start);
 }
 
 /*
@@ -10,6 +10,9 @@
 #ifndef LEXER_H
 #define LEXER_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 typedef enum {
     TOKEN_INT,      // int
     TOKEN_IF,       // if
@@ -43,10 +46,56 @@ typedef enum {
 typedef struct {
     TokenType type;
     char* lexeme;
-    int line;
-    int col;
+    int64_t offset;         /* Posição do início do token, em bytes */
+    int64_t value;          /* Valor de TOKEN_NUM; número do símbolo de TOKEN_ID */
 } Token;
 
 const char* token_type_to_string(TokenType type);
 
+/*
+ * Converte a posição de um token do arquivo corrente em linha e coluna.
+ * Vale para os dois últimos tokens devolvidos por getToken() e para
+ * posições adiante deles; para posições anteriores, o índice de linhas já
+ * foi descartado.
+ */
+void lexer_position(int64_t offset, int64_t* line, int64_t* col);
+
+/* Como lexer_position(), limitando linha e coluna a INT_MAX (para a árvore) */
+void lexer_position_int(int64_t offset, int* line, int* col);
+
+/*
+ * Guarda os nomes na tabela compartilhada entre threads (intern.h). Deve
+ * ser chamada antes de criar as threads de análise.
+ */
+void symtable_enable_interning(void);
+
+/*
+ * Com enabled = 0, a thread atual deixa de consultar a tabela de símbolos,
+ * para quem só precisa do texto dos tokens (--format). O lexema de
+ * TOKEN_ID e TOKEN_NUM passa a apontar para o buffer de entrada (ou para
+ * uma cópia do lexer) e só vale até a próxima chamada de getToken(); ele
+ * pode não ter terminador, mas termina no primeiro caractere que não pode
+ * continuar o token. value de TOKEN_ID é -1.
+ */
+void lexer_set_symbol_table(int enabled);
+
+/* Token.value de um TOKEN_ERROR causado pelo limite de lexer_set_max_lexeme() */
+#define TOKEN_ERROR_LIMIT 1
+
+/*
+ * Identificadores e números com mais de max_length bytes passam a ser
+ * TOKEN_ERROR com value TOKEN_ERROR_LIMIT, sem que o restante do lexema
+ * seja lido ou copiado; 0 remove o limite. Vale para todas as threads e
+ * deve ser chamada antes de criá-las.
+ */
+void lexer_set_max_lexeme(size_t max_length);
+
+/*
+ * Bytes alocados pelo lexer na thread atual: área de lexemas, índice de
+ * linhas e nomes novos na tabela de símbolos (sem contar a tabela
+ * compartilhada de intern.c). Depois de lexer_reset() só cresce, de modo
+ * que a diferença entre duas leituras é o que o arquivo alocou entre elas.
+ */
+size_t lexer_memory_used(void);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,264 @@
+/*
+ * ============================================================================
+ * GERADOR DE CARGA PARA O lsi-serverd
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * Envia pedidos PARSE (ou LINT) ao servidor por várias conexões em laço
+ * fechado: cada conexão tem no máximo um pedido pendente e envia o próximo
+ * assim que recebe a resposta. Ao final reporta pedidos por segundo e as
+ * latências p50, p99 e máxima, medidas do envio até a resposta completa.
+ *
+ * Com --sem-cache, cada pedido recebe um sufixo distinto de espaços e
+ * quebras de linha, o que muda o hash do conteúdo sem mudar seus tokens e
+ * obriga o servidor a analisar de novo.
+ *
+ * ============================================================================
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_SOCKET_PATH "/tmp/lsi-serverd.sock"
+#define MAX_CONNECTIONS 64
+#define UNIQUE_SUFFIX_SIZE 24
+
+typedef struct {
+    char* data;
+    size_t length;
+} Source;
+
+typedef struct {
+    int fd;
+    int busy;
+    double sent_at;
+    char reply[65536];
+    size_t reply_length;
+} Connection;
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/*
+ * load_source(path, source)
+ *
+ * Lê o arquivo inteiro, reservando espaço para o sufixo de --sem-cache.
+ */
+static int load_source(const char* path, Source* source) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        perror(path);
+        return -1;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    source->data = (char*)malloc((size_t)size + UNIQUE_SUFFIX_SIZE);
+    source->length = fread(source->data, 1, (size_t)size, file);
+    fclose(file);
+    return 0;
+}
+
+static int connect_server(const char* path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        perror("Erro ao conectar ao servidor");
+        if (fd >= 0) {
+            close(fd);
+        }
+        return -1;
+    }
+    return fd;
+}
+
+static int send_all(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t n = send(fd, data, length, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        data += n;
+        length -= (size_t)n;
+    }
+    return 0;
+}
+
+/*
+ * send_request(conn, source, sequence, command, unique)
+ *
+ * Envia um pedido DATA com o conteúdo do arquivo, acrescido do sufixo
+ * único do pedido quando unique está ligado.
+ */
+static int send_request(Connection* conn, Source* source, long sequence,
+                        const char* command, int unique) {
+    size_t length = source->length;
+    if (unique) {
+        for (int bit = 0; bit < UNIQUE_SUFFIX_SIZE; bit++) {
+            source->data[length++] = (sequence >> bit) & 1 ? '\n' : ' ';
+        }
+    }
+
+    char header[64];
+    int header_length = snprintf(header, sizeof(header), "%s DATA %zu\n", command, length);
+    conn->sent_at = now_us();
+    conn->busy = 1;
+    conn->reply_length = 0;
+    if (send_all(conn->fd, header, (size_t)header_length) != 0 ||
+        send_all(conn->fd, source->data, length) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    const char* socket_path = DEFAULT_SOCKET_PATH;
+    const char* command = "PARSE";
+    long total = 10000;
+    int connection_count = 1;
+    int unique = 0;
+    Source sources[256];
+    int source_count = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc) {
+            socket_path = argv[++i];
+        } else if (strcmp(argv[i], "--requisicoes") == 0 && i + 1 < argc) {
+            total = strtol(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--conexoes") == 0 && i + 1 < argc) {
+            connection_count = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--lint") == 0) {
+            command = "LINT";
+        } else if (strcmp(argv[i], "--sem-cache") == 0) {
+            unique = 1;
+        } else if (argv[i][0] != '-' && source_count < 256) {
+            if (load_source(argv[i], &sources[source_count]) != 0) {
+                return 1;
+            }
+            source_count++;
+        } else {
+            source_count = 0;
+            break;
+        }
+    }
+
+    if (source_count == 0 || total <= 0 ||
+        connection_count < 1 || connection_count > MAX_CONNECTIONS) {
+        fprintf(stderr, "Uso: %s [--socket <caminho>] [--requisicoes <n>] [--conexoes <1-%d>]\n"
+                        "       [--lint] [--sem-cache] <arquivo.lsi>...\n",
+                argv[0], MAX_CONNECTIONS);
+        return 1;
+    }
+
+    Connection* conns = (Connection*)calloc((size_t)connection_count, sizeof(Connection));
+    struct pollfd fds[MAX_CONNECTIONS];
+    double* latencies = (double*)malloc(sizeof(double) * (size_t)total);
+    long sent = 0;
+    long done = 0;
+    long cached = 0;
+    long failed = 0;
+
+    for (int i = 0; i < connection_count; i++) {
+        conns[i].fd = connect_server(socket_path);
+        if (conns[i].fd < 0) {
+            return 1;
+        }
+    }
+
+    double start = now_us();
+    for (int i = 0; i < connection_count && sent < total; i++, sent++) {
+        if (send_request(&conns[i], &sources[sent % source_count], sent, command, unique) != 0) {
+            perror("Erro ao enviar pedido");
+            return 1;
+        }
+    }
+
+    while (done < total) {
+        for (int i = 0; i < connection_count; i++) {
+            fds[i].fd = conns[i].fd;
+            fds[i].events = conns[i].busy ? POLLIN : 0;
+        }
+        if (poll(fds, (nfds_t)connection_count, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("Erro em poll");
+            return 1;
+        }
+
+        for (int i = 0; i < connection_count; i++) {
+            Connection* conn = &conns[i];
+            if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) {
+                continue;
+            }
+            ssize_t n = recv(conn->fd, conn->reply + conn->reply_length,
+                             sizeof(conn->reply) - 1 - conn->reply_length, 0);
+            if (n <= 0) {
+                fprintf(stderr, "Erro: o servidor fechou a conexão\n");
+                return 1;
+            }
+            conn->reply_length += (size_t)n;
+            conn->reply[conn->reply_length] = '\0';
+            if (memchr(conn->reply, '\n', conn->reply_length) == NULL) {
+                continue;   /* Resposta ainda incompleta */
+            }
+
+            latencies[done++] = now_us() - conn->sent_at;
+            conn->busy = 0;
+            if (strstr(conn->reply, "\"cached\":true") != NULL) {
+                cached++;
+            }
+            if (strstr(conn->reply, "\"status\":\"ok\"") == NULL) {
+                failed++;
+            }
+            if (sent < total) {
+                if (send_request(conn, &sources[sent % source_count], sent, command, unique) != 0) {
+                    perror("Erro ao enviar pedido");
+                    return 1;
+                }
+                sent++;
+            }
+        }
+    }
+    double elapsed = now_us() - start;
+
+    qsort(latencies, (size_t)total, sizeof(double), compare_doubles);
+    printf("pedidos:      %ld (%d conexões, %ld da cache, %ld com erro)\n",
+           total, connection_count, cached, failed);
+    printf("duração:      %.3f s\n", elapsed / 1e6);
+    printf("pedidos/s:    %.0f\n", total / (elapsed / 1e6));
+    printf("latência p50: %.1f us\n", latencies[total / 2]);
+    printf("latência p99: %.1f us\n", latencies[(long)(total * 0.99)]);
+    printf("latência máx: %.1f us\n", latencies[total - 1]);
+
+    for (int i = 0; i < connection_count; i++) {
+        close(conns[i].fd);
+    }
+    return 0;
+}
@@ -0,0 +1,2689 @@
+/*
+ * ============================================================================
+ * LINHA DE COMANDO DO ANALISADOR LSI-2025-2
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * Analisa um arquivo e, conforme as opções, verifica a semântica
+ * (--semantica), aponta usos sem inicialização e atribuições e
+ * declarações sem efeito (--avisos, sem alterar o código de saída), imprime a árvore sintática, traduz o programa para C ou
+ * executa-o pelo JIT. Os diagnósticos do analisador são impressos em
+ * stderr e encerram o processo com código 1.
+ *
+ * Com --cache <dir>, uma validação simples (sem --semantica, --avisos, --cse, --ir,
+ * --inline, --purity, --ast, --emit-c, --salvar-ast ou --jit) consulta antes a cache de
+ * resultados em disco e só analisa o arquivo se o conteúdo ainda não foi
+ * visto.
+ *
+ * Com --threads <n>, valida vários arquivos em paralelo, com a tabela de
+ * nomes compartilhada entre as threads, e imprime os resultados na ordem
+ * dos argumentos.
+ *
+ * Com --callgraph, imprime o grafo de chamadas do arquivo e calcula os
+ * resumos por função (e os avisos, com --avisos) componente a componente,
+ * em <n> threads se --threads também for dado.
+ *
+ * Com --cse, monta o DAG de expressões de cada função (exprdag.h) e
+ * informa quantas operações repetidas a eliminação de subexpressões
+ * comuns remove.
+ *
+ * Com --ir, traduz cada função para a representação intermediária em SSA
+ * (ir.h), aplica as passadas de --ir-passes e imprime o resultado;
+ * --ir-bench <n> repete as passadas n vezes sobre cópias da tradução e
+ * mede passadas por segundo.
+ *
+ * Com --inline, expande as chamadas a funções pequenas e especializa as
+ * chamadas com argumentos constantes (ir_inline.c); com --ir, imprime o
+ * resultado, e sozinho executa a função de entrada antes e depois da
+ * expansão (ir_exec.c) e compara as chamadas executadas.
+ *
+ * Com --purity, classifica as funções em puras, somente leitura e com
+ * efeito (purity.h); com --memo, executa também a função de entrada sem e
+ * com memoização das funções que não imprimem e compara as chamadas.
+ *
+ * Com --format, reescreve o arquivo no formato canônico em stdout.
+ *
+ * Com --lexico, só percorre os tokens do arquivo, em memória constante, e
+ * imprime quantos são e a posição do último; serve para entradas de vários
+ * gigabytes (inclusive /dev/stdin).
+ *
+ * Com --contadores, lê o arquivo três vezes (só os tokens, os tokens com a
+ * tabela de símbolos e a análise completa) com contadores de desempenho
+ * do Linux ligados (perfcount.h) e imprime ciclos, instruções, desvios
+ * mal previstos, falhas de cache e faltas de página por fase e por MB.
+ *
+ * Com --indexar <índice>, atualiza o índice de referências cruzadas com
+ * os arquivos dados (e os já indexados que mudaram); --xref <índice>
+ * <nome> lista as definições e os usos do nome registrados no índice.
+ *
+ * Com --salvar-ast <arquivo>, grava a árvore do programa analisado no
+ * formato binário de astbin.h; --ler-ast <arquivo> [<arquivo.lsi>] abre
+ * uma árvore gravada (recusando-a se o fonte mudou) e, com --tempo,
+ * compara o tempo de carga com o de analisar o fonte de novo.
+ *
+ * Com --lote <manifesto|diretório|->, valida todos os arquivos listados no
+ * manifesto, encontrados no diretório ou lidos de stdin (separados por
+ * '\0') em um único processo, e escreve um resultado JSON por linha em
+ * stdout.
+ *
+ * Com --watch <diretório>, valida os arquivos .lsi da árvore e fica
+ * observando-a com inotify: a cada rajada de gravações, criações,
+ * renomeações e remoções (agrupadas por --watch-ms), reanalisa só os
+ * arquivos afetados e imprime os resultados deles, os erros dos demais a
+ * partir da memória e as latências do lote.
+ *
+ * As opções --limite-* (PARSE_LIMIT_OPTIONS) definem orçamentos de tokens,
+ * profundidade, comprimento de lexemas, memória e tempo para cada análise,
+ * em todos os modos que usam o parser; um orçamento esgotado é um
+ * diagnóstico do tipo "limit", e esses resultados não entram na cache.
+ *
+ * ============================================================================
+ */
+
+#include <dirent.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "astbin.h"
+#include "callgraph.h"
+#include "intern.h"
+#include "parser.h"
+#include "perfcount.h"
+#include "codegen_c.h"
+#include "exprdag.h"
+#include "formatter.h"
+#include "ir.h"
+#include "jit.h"
+#include "purity.h"
+#include "result_cache.h"
+#include "sema.h"
+#include "warnings.h"
+#include "xref.h"
+
+extern Token getToken(void);
+extern void lexer_reset(FILE* input);
+
+static int check_semantics = 0;     /* --semantica */
+static int check_warnings = 0;      /* --avisos */
+
+/* ============================================================================
+ * EXECUÇÃO PELO JIT
+ * ============================================================================ */
+
+/*
+ * now_ms()
+ *
+ * Relógio monotônico em milissegundos, para as medições de --tempo.
+ */
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+/*
+ * host_print(value)
+ *
+ * Implementação de print oferecida ao código gerado pelo JIT.
+ */
+static void host_print(long long value) {
+    printf("%lld\n", value);
+}
+
+/*
+ * run_jit(program, args, nargs, show_time)
+ *
+ * Compila o programa com o JIT e executa seu ponto de entrada, com os
+ * argumentos restantes da linha de comando (ausentes valem 0).
+ */
+static int run_jit(const AstNode* program, char** args, int nargs, int show_time) {
+    double t0 = now_ms();
+    JitProgram* jit = jit_compile(program, host_print);
+    double t1 = now_ms();
+    if (jit == NULL) {
+        return 1;
+    }
+
+    long long values[JIT_MAX_ARGS] = {0, 0, 0, 0, 0, 0};
+    for (int i = 0; i < nargs && i < JIT_MAX_ARGS; i++) {
+        values[i] = strtoll(args[i], NULL, 10);
+    }
+    jit_run(jit, values);
+    fflush(stdout);
+    double t2 = now_ms();
+
+    if (show_time) {
+        fprintf(stderr, "JIT: %lu bytes de código, compilação %.3f ms, execução %.3f ms\n",
+                jit_code_size(jit), t1 - t0, t2 - t1);
+    }
+    jit_free(jit);
+    return 0;
+}
+
+/* ============================================================================
+ * ANÁLISE SEMÂNTICA
+ * ============================================================================ */
+
+/*
+ * report_semantics(program)
+ *
+ * Executa a análise semântica e imprime seus diagnósticos em stderr.
+ * Retorna 0 se o programa é semanticamente válido.
+ */
+static int report_semantics(const AstNode* program) {
+    DiagnosticList diags = {0};
+    int count = sema_check_program(program, &diags);
+    for (int i = 0; i < diags.count; i++) {
+        diagnostic_print(stderr, &diags.items[i]);
+    }
+    if (count == 0) {
+        printf("Análise Semântica concluída com sucesso!\n");
+    }
+    diagnostic_list_free(&diags);
+    return count != 0;
+}
+
+/*
+ * report_warnings(program)
+ *
+ * Executa as análises de fluxo de dados e imprime os avisos em stderr.
+ */
+static void report_warnings(const AstNode* program) {
+    DiagnosticList diags = {0};
+    warnings_check_program(program, &diags);
+    for (int i = 0; i < diags.count; i++) {
+        diagnostic_print(stderr, &diags.items[i]);
+    }
+    diagnostic_list_free(&diags);
+}
+
+/*
+ * report_cse(program, show_time)
+ *
+ * Monta o DAG de expressões de cada função e imprime, por função e no
+ * total, as operações da árvore, os nós de operação do DAG e as operações
+ * redundantes eliminadas. A memória compara os nós de expressão da árvore
+ * (AstNode e a lista de filhos de cada AST_BINOP) com os DagNode.
+ */
+static void report_cse(const AstNode* program, int show_time) {
+    int single_statement = program->kid_count > 0 && program->kids[0]->kind != AST_FDEF;
+    int count = single_statement ? 1 : program->kid_count;
+    long long operations = 0, binop_nodes = 0, eliminated = 0;
+    size_t tree_bytes = 0, dag_bytes = 0;
+    double t0 = now_ms();
+
+    printf("Subexpressões comuns (DAG de expressões por função):\n");
+    for (int f = 0; f < count; f++) {
+        const AstNode* fdef = single_statement ? program : program->kids[f];
+        ExprDag dag;
+        exprdag_build(fdef, &dag);
+        printf("  %s: %d operações, %d nós no DAG, %d redundantes eliminadas\n",
+               single_statement ? "(programa)" : fdef->name,
+               dag.operations, dag.binop_nodes, dag.eliminated);
+        operations += dag.operations;
+        binop_nodes += dag.binop_nodes;
+        eliminated += dag.eliminated;
+        tree_bytes += (size_t)dag.expr_nodes * sizeof(AstNode) +
+                      (size_t)dag.operations * 2 * sizeof(AstNode*);
+        dag_bytes += (size_t)dag.node_count * sizeof(DagNode);
+        exprdag_free(&dag);
+    }
+    double t1 = now_ms();
+
+    printf("Total: %lld operações, %lld nós no DAG, %lld redundantes eliminadas (%.1f%%)\n",
+           operations, binop_nodes, eliminated,
+           operations > 0 ? 100.0 * (double)eliminated / (double)operations : 0.0);
+    printf("Memória das expressões: árvore %.1f KiB, DAG %.1f KiB\n",
+           (double)tree_bytes / 1024.0, (double)dag_bytes / 1024.0);
+    if (show_time) {
+        fprintf(stderr, "DAG de expressões: %d funções em %.3f ms\n", count, t1 - t0);
+    }
+}
+
+/* ============================================================================
+ * REPRESENTAÇÃO INTERMEDIÁRIA
+ * ============================================================================ */
+
+/*
+ * verify_ir(function)
+ *
+ * Confere a função com ir_verify() e reporta o primeiro problema.
+ * Retorna 0 se ela é válida.
+ */
+static int verify_ir(const IrFunction* function) {
+    char message[256];
+    if (ir_verify(function, message, sizeof(message)) == 0) {
+        return 0;
+    }
+    fprintf(stderr, "Erro interno na representação intermediária de %s: %s\n",
+            ir_function_name(function), message);
+    return 1;
+}
+
+/*
+ * report_passes(out, pipeline, functions, rounds)
+ *
+ * Tempo, passadas por segundo (execuções da passada em funções),
+ * instruções percorridas por segundo e mudanças por rodada de cada
+ * passada.
+ */
+static void report_passes(FILE* out, const IrPipeline* pipeline, int functions, int rounds) {
+    double total = pipeline->compact_millis;
+    for (int p = 0; p < pipeline->count; p++) {
+        double seconds = pipeline->millis[p] / 1000.0;
+        fprintf(out, "  %-12s %9.1f ms %12.0f passadas/s %8.1f M instruções/s %10lld mudanças\n",
+                pipeline->passes[p]->name, pipeline->millis[p],
+                seconds > 0 ? (double)functions * rounds / seconds : 0.0,
+                seconds > 0 ? (double)pipeline->visited[p] / seconds / 1e6 : 0.0,
+                pipeline->changes[p] / rounds);
+        total += pipeline->millis[p];
+    }
+    fprintf(out, "  compactação  %9.1f ms\n", pipeline->compact_millis);
+    fprintf(out, "Sequência completa: %.1f ms por rodada, %.0f passadas/s\n",
+            total / rounds, total > 0 ? (double)pipeline->runs / (total / 1000.0) : 0.0);
+}
+
+/*
+ * parse_ir_passes(pipeline, passes)
+ *
+ * Monta a sequência de --ir-passes, reportando o nome desconhecido e as
+ * passadas disponíveis. Retorna 0 em caso de sucesso.
+ */
+static int parse_ir_passes(IrPipeline* pipeline, const char* passes) {
+    char message[256];
+    if (ir_pipeline_parse(pipeline, passes, message, sizeof(message)) == 0) {
+        return 0;
+    }
+    fprintf(stderr, "--ir-passes: %s (disponíveis:", message);
+    for (const IrPass* pass = ir_passes; pass->name != NULL; pass++) {
+        fprintf(stderr, " %s", pass->name);
+    }
+    fprintf(stderr, ")\n");
+    return 1;
+}
+
+/*
+ * report_inline(out, stats, options)
+ *
+ * Resumo de ir_inline_program().
+ */
+static void report_inline(FILE* out, const IrInlineStats* stats, const IrInlineOptions* options) {
+    fprintf(out, "Expansão: %d chamadas expandidas, %d especializações criadas; chamadas "
+                 "mantidas: %d para especializações, %d recursivas, %d pelo tamanho\n",
+            stats->inlined, stats->clones, stats->specialized, stats->recursive,
+            stats->too_large);
+    fprintf(out, "Instruções vivas: %lld antes, %lld depois (custo máximo expandido: %d)\n",
+            stats->insts_before, stats->insts_after, options->max_callee_size);
+}
+
+/*
+ * run_ir(program, pipeline, passes, rounds, inline_options, show_time)
+ *
+ * Sem rounds, aplica as passadas à tradução (e expande as chamadas, com
+ * inline_options) e imprime as funções. Com rounds > 0, cada rodada copia
+ * a tradução e aplica as passadas à cópia, e só o resumo é impresso. A
+ * estrutura é conferida depois da tradução e depois das passadas (na
+ * primeira rodada).
+ */
+static int run_ir(const AstNode* program, IrPipeline* pipeline, const char* passes, int rounds,
+                  const IrInlineOptions* inline_options, int show_time) {
+    double t0 = now_ms();
+    IrProgram ir;
+    ir_lower_program(program, &ir);
+    double t1 = now_ms();
+
+    long long before = 0, after = 0, blocks = 0;
+    int status = 0;
+    for (int f = 0; f < ir.count && status == 0; f++) {
+        before += ir.functions[f].inst_count;
+        blocks += ir.functions[f].block_count;
+        status = verify_ir(&ir.functions[f]);
+    }
+
+    IrInlineStats inline_stats;
+    if (status == 0 && rounds == 0 && inline_options != NULL) {
+        ir_inline_program(&ir, program, inline_options, pipeline, &inline_stats);
+    }
+    if (status == 0 && rounds == 0) {
+        for (int f = 0; f < ir.count && status == 0; f++) {
+            if (inline_options == NULL) {
+                ir_pipeline_run(pipeline, &ir.functions[f]);
+            }
+            after += ir.functions[f].inst_count;
+            status = verify_ir(&ir.functions[f]);
+            if (status == 0) {
+                ir_print_function(stdout, &ir, &ir.functions[f]);
+            }
+        }
+        if (status == 0 && show_time) {
+            fprintf(stderr, "Tradução: %.3f ms; %lld instruções antes das passadas, %lld depois\n",
+                    t1 - t0, before, after);
+            report_passes(stderr, pipeline, ir.count, 1);
+            if (inline_options != NULL) {
+                report_inline(stderr, &inline_stats, inline_options);
+            }
+        }
+    }
+
+    for (int r = 0; r < rounds && status == 0; r++) {
+        for (int f = 0; f < ir.count && status == 0; f++) {
+            IrFunction copy;
+            ir_function_copy(&copy, &ir.functions[f]);
+            ir_pipeline_run(pipeline, &copy);
+            if (r == 0) {
+                after += copy.inst_count;
+                status = verify_ir(&copy);
+            }
+            ir_function_free(&copy);
+        }
+    }
+    if (status == 0 && rounds > 0) {
+        printf("Representação intermediária: %d funções, %lld blocos, %lld instruções "
+               "(tradução: %.1f ms)\n", ir.count, blocks, before, t1 - t0);
+        printf("Passadas: %s (%d rodadas)\n", passes, rounds);
+        report_passes(stdout, pipeline, ir.count, rounds);
+        printf("Instruções: %lld antes, %lld depois (%.1f%% removidas)\n", before, after,
+               before > 0 ? 100.0 * (double)(before - after) / (double)before : 0.0);
+    }
+
+    ir_program_free(&ir);
+    return status;
+}
+
+/* Saída capturada de ir_execute() */
+typedef struct {
+    int64_t* values;
+    int count;
+    int capacity;
+} PrintLog;
+
+static void log_print(int64_t value, void* context) {
+    PrintLog* log = (PrintLog*)context;
+    if (log->count == log->capacity) {
+        log->capacity = log->capacity ? log->capacity * 2 : 64;
+        log->values = (int64_t*)realloc(log->values, sizeof(int64_t) * (size_t)log->capacity);
+        if (log->values == NULL) {
+            fprintf(stderr, "Erro fatal: Memória insuficiente para a saída do programa.\n");
+            exit(1);
+        }
+    }
+    log->values[log->count++] = value;
+}
+
+/* Execução da função de entrada para --inline e --memo */
+typedef struct {
+    int status;             /* De ir_execute() */
+    int64_t result;
+    IrExecStats stats;
+    PrintLog log;
+    double millis;
+} InlineRun;
+
+static void execute_entry(const IrProgram* ir, int entry, const int64_t* args, int arg_count,
+                          const char* memoize, InlineRun* run) {
+    memset(run, 0, sizeof(*run));
+    double t0 = now_ms();
+    run->status = ir_execute(ir, entry, args, arg_count, memoize, log_print, &run->log, &run->stats,
+                             &run->result);
+    run->millis = now_ms() - t0;
+}
+
+static void report_run(const char* label, const InlineRun* run) {
+    printf("  %s: %lld chamadas, %lld instruções, profundidade %d, %.3f ms\n", label,
+           run->stats.calls, run->stats.instructions, run->stats.max_depth, run->millis);
+}
+
+static int same_run(const InlineRun* a, const InlineRun* b) {
+    return a->status == b->status && a->log.count == b->log.count &&
+           memcmp(a->log.values, b->log.values, sizeof(int64_t) * (size_t)a->log.count) == 0 &&
+           (a->status != 0 || a->result == b->result) &&
+           (a->status != 1 || (a->stats.error_line == b->stats.error_line &&
+                               a->stats.error_col == b->stats.error_col));
+}
+
+static double reduction(long long before, long long after) {
+    return before > 0 ? 100.0 * (double)(before - after) / (double)before : 0.0;
+}
+
+/*
+ * run_inline(program, pipeline, options, args, nargs, show_time)
+ *
+ * Traduz o programa duas vezes: uma só com as passadas e outra também
+ * com a expansão de chamadas. Executa a função de entrada
+ * (ast_entry_function()) nas duas com ir_execute(), com os argumentos
+ * dados, e compara saída, retorno e chamadas executadas. Retorna 1 se as
+ * duas versões não se comportam igual.
+ */
+static int run_inline(const AstNode* program, IrPipeline* pipeline, const IrInlineOptions* options,
+                      char** args, int nargs, int show_time) {
+    IrProgram base, expanded;
+    ir_lower_program(program, &base);
+    ir_lower_program(program, &expanded);
+    int status = 0;
+    for (int f = 0; f < base.count && status == 0; f++) {
+        ir_pipeline_run(pipeline, &base.functions[f]);
+        status = verify_ir(&base.functions[f]);
+    }
+    double t0 = now_ms();
+    IrInlineStats stats;
+    ir_inline_program(&expanded, program, options, pipeline, &stats);
+    double t1 = now_ms();
+    for (int f = 0; f < expanded.count && status == 0; f++) {
+        status = verify_ir(&expanded.functions[f]);
+    }
+    if (status != 0 || base.count == 0) {
+        if (status == 0) {
+            printf("Nada a executar: o programa não tem comandos\n");
+        }
+        ir_program_free(&base);
+        ir_program_free(&expanded);
+        return status != 0;
+    }
+    report_inline(stdout, &stats, options);
+    if (show_time) {
+        fprintf(stderr, "Expansão: %.3f ms\n", t1 - t0);
+    }
+
+    /* As funções originais estão na ordem do programa nas duas traduções */
+    const AstNode* entry_fdef = ast_entry_function(program);
+    int entry = 0;
+    while (entry < base.count - 1 && base.functions[entry].fdef != entry_fdef) {
+        entry++;
+    }
+    int64_t* values = (int64_t*)calloc((size_t)(nargs > 0 ? nargs : 1), sizeof(int64_t));
+    if (values == NULL) {
+        fprintf(stderr, "Erro fatal: Memória insuficiente para a execução com expansão.\n");
+        exit(1);
+    }
+    for (int i = 0; i < nargs; i++) {
+        values[i] = strtoll(args[i], NULL, 10);
+    }
+    InlineRun before, after;
+    execute_entry(&base, entry, values, nargs, NULL, &before);
+    execute_entry(&expanded, entry, values, nargs, NULL, &after);
+
+    printf("Execução de %s(", ir_function_name(&base.functions[entry]));
+    for (int i = 0; i < nargs; i++) {
+        printf("%s%" PRId64, i > 0 ? ", " : "", values[i]);
+    }
+    printf("):\n");
+    report_run("sem expansão", &before);
+    report_run("com expansão", &after);
+    if (before.status == 1) {
+        printf("  Erro de execução: divisão por zero na linha %d, coluna %d\n",
+               before.stats.error_line, before.stats.error_col);
+    } else if (before.status < 0) {
+        printf("  Erro de execução: mais de %d chamadas aninhadas\n", IR_EXEC_MAX_DEPTH);
+    }
+    printf("Chamadas executadas: %.1f%% a menos; instruções: %.1f%% a menos\n",
+           reduction(before.stats.calls, after.stats.calls),
+           reduction(before.stats.instructions, after.stats.instructions));
+    if (before.status < 0 && after.status < 0) {
+        /* Com menos quadros por nível, a versão expandida vai mais fundo antes do limite */
+        printf("Saída não comparada: as duas execuções passaram do limite de chamadas aninhadas\n");
+    } else if (same_run(&before, &after)) {
+        printf("Saída (%d valores) e retorno (%" PRId64 ") iguais\n", before.log.count,
+               before.status == 0 ? before.result : 0);
+    } else {
+        fprintf(stderr, "Erro interno: a expansão mudou o comportamento do programa "
+                        "(saída: %d e %d valores; retorno: %" PRId64 " e %" PRId64 ")\n",
+                before.log.count, after.log.count, before.result, after.result);
+        status = 1;
+    }
+
+    free(values);
+    free(before.log.values);
+    free(after.log.values);
+    ir_program_free(&base);
+    ir_program_free(&expanded);
+    return status;
+}
+
+/* ============================================================================
+ * PUREZA E MEMOIZAÇÃO
+ * ============================================================================ */
+
+static void print_purity_reason(const PurityInfo* info) {
+    switch (info->reason) {
+        case PURITY_REASON_PRINT:
+            printf(": print na linha %d, coluna %d", info->line, info->col);
+            break;
+        case PURITY_REASON_DIVISION:
+            printf(": divisão que pode falhar na linha %d, coluna %d", info->line, info->col);
+            break;
+        case PURITY_REASON_CALL:
+            printf(": chama %s na linha %d, coluna %d", info->name, info->line, info->col);
+            break;
+        case PURITY_REASON_UNDEFINED:
+            printf(": chama a função não definida %s na linha %d, coluna %d", info->name,
+                   info->line, info->col);
+            break;
+        default:
+            break;
+    }
+}
+
+/*
+ * run_purity(program, pipeline, memo, args, nargs, show_time)
+ *
+ * Classifica as funções do programa (purity.h) e imprime a classe de cada
+ * uma com o motivo. Com memo, traduz o programa, executa a função de
+ * entrada com os argumentos dados sem e com memoização das funções que
+ * não imprimem e compara saída, retorno e chamadas executadas. Retorna 1
+ * se as duas execuções não se comportam igual.
+ */
+static int run_purity(const AstNode* program, IrPipeline* pipeline, int memo, char** args,
+                      int nargs, int show_time) {
+    double t0 = now_ms();
+    CallGraph graph;
+    callgraph_build(program, &graph);
+    double t1 = now_ms();
+    PurityTable table;
+    purity_analyze(program, &graph, &table);
+    double t2 = now_ms();
+
+    printf("Pureza: %d funções; %d puras, %d somente leitura, %d com efeito\n", graph.count,
+           table.class_count[PURITY_PURE], table.class_count[PURITY_READONLY],
+           table.class_count[PURITY_EFFECTFUL]);
+    for (int f = 0; f < graph.count; f++) {
+        printf("  %s: %s", graph.fdefs[f]->name, purity_class_name(table.functions[f].level));
+        print_purity_reason(&table.functions[f]);
+        printf("%s\n", graph.recursive[graph.scc_of[f]] ? " (recursiva)" : "");
+    }
+    if (show_time) {
+        fprintf(stderr, "Grafo: %.3f ms; pureza: %.3f ms\n", t1 - t0, t2 - t1);
+    }
+    if (!memo) {
+        purity_free(&table);
+        callgraph_free(&graph);
+        return 0;
+    }
+
+    IrProgram ir;
+    ir_lower_program(program, &ir);
+    int status = 0;
+    for (int f = 0; f < ir.count && status == 0; f++) {
+        ir_pipeline_run(pipeline, &ir.functions[f]);
+        status = verify_ir(&ir.functions[f]);
+    }
+    if (status != 0 || ir.count == 0) {
+        if (status == 0) {
+            printf("Nada a executar: o programa não tem comandos\n");
+        }
+        ir_program_free(&ir);
+        purity_free(&table);
+        callgraph_free(&graph);
+        return status != 0;
+    }
+
+    /* Uma função da tradução por FDEF, na ordem do programa, como no grafo */
+    char* memoize = (char*)calloc((size_t)ir.count, 1);
+    int64_t* values = (int64_t*)calloc((size_t)(nargs > 0 ? nargs : 1), sizeof(int64_t));
+    if (memoize == NULL || values == NULL) {
+        fprintf(stderr, "Erro fatal: Memória insuficiente para a execução com memoização.\n");
+        exit(1);
+    }
+    for (int f = 0; f < ir.count && f < graph.count; f++) {
+        memoize[f] = ir.functions[f].fdef == graph.fdefs[f] &&
+                     purity_memoizable(table.functions[f].level);
+    }
+    const AstNode* entry_fdef = ast_entry_function(program);
+    int entry = 0;
+    while (entry < ir.count - 1 && ir.functions[entry].fdef != entry_fdef) {
+        entry++;
+    }
+    for (int i = 0; i < nargs; i++) {
+        values[i] = strtoll(args[i], NULL, 10);
+    }
+    InlineRun plain, memoized;
+    execute_entry(&ir, entry, values, nargs, NULL, &plain);
+    execute_entry(&ir, entry, values, nargs, memoize, &memoized);
+
+    printf("Execução de %s(", ir_function_name(&ir.functions[entry]));
+    for (int i = 0; i < nargs; i++) {
+        printf("%s%" PRId64, i > 0 ? ", " : "", values[i]);
+    }
+    printf("):\n");
+    report_run("sem memoização", &plain);
+    report_run("com memoização", &memoized);
+    printf("  Memoização: %lld chamadas reaproveitadas, %lld resultados guardados\n",
+           memoized.stats.memo_hits, memoized.stats.memo_entries);
+    if (plain.status == 1) {
+        printf("  Erro de execução: divisão por zero na linha %d, coluna %d\n",
+               plain.stats.error_line, plain.stats.error_col);
+    } else if (plain.status < 0) {
+        printf("  Erro de execução: mais de %d chamadas aninhadas\n", IR_EXEC_MAX_DEPTH);
+    }
+    printf("Chamadas executadas: %.1f%% a menos; instruções: %.1f%% a menos\n",
+           reduction(plain.stats.calls, memoized.stats.calls),
+           reduction(plain.stats.instructions, memoized.stats.instructions));
+    if (plain.status < 0 && memoized.status < 0) {
+        printf("Saída não comparada: as duas execuções passaram do limite de chamadas aninhadas\n");
+    } else if (same_run(&plain, &memoized)) {
+        printf("Saída (%d valores) e retorno (%" PRId64 ") iguais\n", plain.log.count,
+               plain.status == 0 ? plain.result : 0);
+    } else {
+        fprintf(stderr, "Erro interno: a memoização mudou o comportamento do programa "
+                        "(saída: %d e %d valores; retorno: %" PRId64 " e %" PRId64 ")\n",
+                plain.log.count, memoized.log.count, plain.result, memoized.result);
+        status = 1;
+    }
+
+    free(values);
+    free(memoize);
+    free(plain.log.values);
+    free(memoized.log.values);
+    ir_program_free(&ir);
+    purity_free(&table);
+    callgraph_free(&graph);
+    return status;
+}
+
+/* ============================================================================
+ * GRAFO DE CHAMADAS
+ * ============================================================================ */
+
+/*
+ * Resumos por função, preenchidos pelas tarefas de callgraph_schedule().
+ * Cada tarefa escreve só nas posições das funções do seu componente; a
+ * classe de pureza de cada função é calculada a partir das classes dos
+ * componentes chamados, já terminados.
+ */
+typedef struct {
+    PurityTable purity;
+    DiagnosticList* warnings;   /* Com --avisos */
+} FunctionSummaries;
+
+/*
+ * summarize_component(graph, scc, context)
+ *
+ * Calcula os resumos das funções do componente.
+ */
+static void summarize_component(const CallGraph* graph, int scc, void* context) {
+    FunctionSummaries* summaries = (FunctionSummaries*)context;
+    purity_analyze_component(&summaries->purity, scc);
+    if (summaries->warnings != NULL) {
+        for (int m = graph->scc_start[scc]; m < graph->scc_start[scc + 1]; m++) {
+            int f = graph->scc_members[m];
+            warnings_check_function(graph->fdefs[f], &summaries->warnings[f]);
+        }
+    }
+}
+
+/*
+ * print_function_list(graph, label, include)
+ *
+ * Imprime "label: f, g, ..." com as funções marcadas em include.
+ */
+static void print_function_list(const CallGraph* graph, const char* label, const char* include) {
+    int printed = 0;
+    printf("%s:", label);
+    for (int f = 0; f < graph->count; f++) {
+        if (include[f]) {
+            printf("%s %s", printed++ ? "," : "", graph->fdefs[f]->name);
+        }
+    }
+    printf("%s\n", printed ? "" : " nenhuma");
+}
+
+/*
+ * report_callgraph(program, thread_count, show_time)
+ *
+ * Monta o grafo, calcula os resumos de baixo para cima e imprime o grafo
+ * em stdout e os avisos (com --avisos) em stderr, na ordem do programa.
+ */
+static void report_callgraph(const AstNode* program, int thread_count, int show_time) {
+    double t0 = now_ms();
+    CallGraph graph;
+    callgraph_build(program, &graph);
+    double t1 = now_ms();
+
+    FunctionSummaries summaries;
+    memset(&summaries, 0, sizeof(summaries));
+    purity_begin(program, &graph, &summaries.purity);
+    if (check_warnings) {
+        summaries.warnings = (DiagnosticList*)calloc((size_t)graph.count + 1,
+                                                     sizeof(DiagnosticList));
+        if (summaries.warnings == NULL) {
+            fprintf(stderr, "Erro fatal: Memória insuficiente para os avisos.\n");
+            exit(1);
+        }
+    }
+    callgraph_schedule(&graph, thread_count, summarize_component, &summaries);
+    purity_finish(&summaries.purity);
+    const PurityTable* purity = &summaries.purity;
+    double t2 = now_ms();
+
+    int recursive = 0;
+    for (int c = 0; c < graph.scc_count; c++) {
+        recursive += graph.recursive[c];
+    }
+    printf("Grafo de chamadas: %d funções, %d chamadas distintas, %d componentes, %d com recursão\n",
+           graph.count, graph.call_count, graph.scc_count, recursive);
+    for (int f = 0; f < graph.count; f++) {
+        int scc = graph.scc_of[f];
+        printf("  %s (c%d%s, %s) ->", graph.fdefs[f]->name, scc,
+               graph.recursive[scc] ? ", recursiva" : "",
+               purity_class_name(purity->functions[f].level));
+        for (int e = graph.call_start[f]; e < graph.call_start[f + 1]; e++) {
+            printf("%s %s", e > graph.call_start[f] ? "," : "", graph.fdefs[graph.callees[e]]->name);
+        }
+        printf("%s\n", graph.call_start[f] == graph.call_start[f + 1] ? " nenhuma" : "");
+    }
+    if (graph.unresolved_calls > 0) {
+        printf("Chamadas a funções não definidas: %d\n", graph.unresolved_calls);
+    }
+
+    printf("Recursão:");
+    for (int c = 0; c < graph.scc_count; c++) {
+        if (!graph.recursive[c]) {
+            continue;
+        }
+        printf(" {");
+        for (int m = graph.scc_start[c]; m < graph.scc_start[c + 1]; m++) {
+            printf("%s%s", m > graph.scc_start[c] ? ", " : "",
+                   graph.fdefs[graph.scc_members[m]]->name);
+        }
+        printf("}");
+    }
+    printf("%s\n", recursive ? "" : " nenhuma");
+
+    if (graph.entry >= 0) {
+        char* roots = (char*)calloc((size_t)graph.count, 1);
+        char* unreachable = (char*)calloc((size_t)graph.count, 1);
+        char label[256];
+        for (int f = 0; f < graph.count; f++) {
+            roots[f] = graph.caller_count[f] == 0;
+            unreachable[f] = !graph.reachable[f];
+        }
+        printf("Ponto de entrada: %s\n", graph.fdefs[graph.entry]->name);
+        print_function_list(&graph, "Sem chamadores", roots);
+        snprintf(label, sizeof(label), "Inalcançáveis a partir de %s",
+                 graph.fdefs[graph.entry]->name);
+        print_function_list(&graph, label, unreachable);
+        free(roots);
+        free(unreachable);
+    }
+
+    if (check_warnings && graph.count == 0) {
+        report_warnings(program);   /* Programa de um único comando */
+    } else if (summaries.warnings != NULL) {
+        for (int f = 0; f < graph.count; f++) {
+            for (int i = 0; i < summaries.warnings[f].count; i++) {
+                diagnostic_print(stderr, &summaries.warnings[f].items[i]);
+            }
+            diagnostic_list_free(&summaries.warnings[f]);
+        }
+    }
+
+    if (show_time) {
+        fprintf(stderr, "Grafo: %.3f ms; análise por componente: %d funções, "
+                        "%d componentes, %d threads: %.3f ms\n",
+                t1 - t0, graph.count, graph.scc_count,
+                thread_count > 1 ? thread_count : 1, t2 - t1);
+    }
+    free(summaries.warnings);
+    purity_free(&summaries.purity);
+    callgraph_free(&graph);
+}
+
+/* ============================================================================
+ * VALIDAÇÃO COM CACHE EM DISCO
+ * ============================================================================ */
+
+/*
+ * validate_cached(path, cache_dir, cache_mb)
+ *
+ * Valida o arquivo consultando a cache pela chave do conteúdo. Em caso de
+ * falta, analisa a cópia já lida em memória e guarda o resultado. A saída
+ * é a mesma da validação sem cache.
+ */
+static int validate_cached(const char* path, const char* cache_dir, size_t cache_mb) {
+    TextBuffer data = {0};
+    if (text_read_file(&data, path) != 0) {
+        perror("Erro ao abrir arquivo");
+        return 1;
+    }
+
+    ResultCache cache;
+    DiagnosticList diags = {0};
+    unsigned char key[SHA256_DIGEST_SIZE];
+    int usable = result_cache_open(&cache, cache_dir, cache_mb * 1024 * 1024) == 0;
+
+    result_cache_key(data.data ? data.data : "", data.length, key);
+    if (!usable || !result_cache_lookup(&cache, key, &diags)) {
+        FILE* input = fmemopen(data.data ? data.data : "", data.length, "r");
+        Diagnostic diag;
+        if (parse_file(input, &diag) == NULL) {
+            *diagnostic_list_add(&diags) = diag;
+        }
+        fclose(input);
+        ast_reset();
+        /* Um orçamento esgotado depende das opções e do momento, não só do conteúdo */
+        if (usable && (diags.count == 0 || diags.items[0].kind != DIAG_LIMIT)) {
+            result_cache_store(&cache, key, &diags);
+        }
+    }
+
+    int status = diags.count > 0;
+    if (status == 0) {
+        printf("\nAnálise Sintática concluída com sucesso!\n");
+    }
+    for (int i = 0; i < diags.count; i++) {
+        diagnostic_print(stderr, &diags.items[i]);
+    }
+    diagnostic_list_free(&diags);
+    text_free(&data);
+    return status;
+}
+
+/* ============================================================================
+ * VALIDAÇÃO EM PARALELO
+ * ============================================================================ */
+
+typedef struct {
+    const char* path;
+    int status;             /* 0 válido, 1 erro sintático, 2 erro semântico, -1 erro de leitura */
+    int error;              /* errno do erro de leitura */
+    Diagnostic diag;
+    DiagnosticList semantic;    /* Erros semânticos e avisos */
+} FileResult;
+
+static FileResult* batch_results;
+static int batch_count;
+static int batch_next = 0;
+
+/*
+ * batch_worker(arg)
+ *
+ * Retira o próximo arquivo da fila comum até esvaziá-la. Cada thread tem
+ * seu próprio lexer, pilhas e arena de nós.
+ */
+static void* batch_worker(void* arg) {
+    (void)arg;
+    for (;;) {
+        int i = __atomic_fetch_add(&batch_next, 1, __ATOMIC_RELAXED);
+        if (i >= batch_count) {
+            break;
+        }
+        FileResult* result = &batch_results[i];
+        FILE* input = fopen(result->path, "r");
+        if (input == NULL) {
+            result->status = -1;
+            result->error = errno;
+            continue;
+        }
+        AstNode* program = parse_file(input, &result->diag);
+        result->status = program == NULL;
+        if (program != NULL && check_semantics &&
+            sema_check_program(program, &result->semantic) > 0) {
+            result->status = 2;
+        }
+        if (program != NULL && check_warnings) {
+            warnings_check_program(program, &result->semantic);
+        }
+        fclose(input);
+        ast_reset();
+    }
+    return NULL;
+}
+
+/*
+ * run_workers(thread_count)
+ *
+ * Analisa batch_results[0..batch_count) com thread_count threads; com uma
+ * só, na própria thread principal.
+ */
+static void run_workers(int thread_count) {
+    batch_next = 0;
+    if (thread_count <= 1) {
+        batch_worker(NULL);
+        return;
+    }
+    pthread_t* threads = (pthread_t*)malloc(sizeof(pthread_t) * (size_t)thread_count);
+    for (int i = 0; i < thread_count; i++) {
+        if (pthread_create(&threads[i], NULL, batch_worker, NULL) != 0) {
+            fprintf(stderr, "Erro fatal: Não foi possível criar as threads de análise.\n");
+            exit(1);
+        }
+    }
+    for (int i = 0; i < thread_count; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+}
+
+/*
+ * print_file_result(result)
+ *
+ * Imprime o resultado de um arquivo: o sucesso em stdout, os erros e os
+ * avisos em stderr, precedidos do caminho. Retorna 1 se o arquivo falhou.
+ */
+static int print_file_result(const FileResult* result) {
+    if (result->status == 0) {
+        printf("%s: Análise Sintática concluída com sucesso!\n", result->path);
+        if (result->semantic.count > 0) {
+            fprintf(stderr, "%s:", result->path);
+            for (int j = 0; j < result->semantic.count; j++) {
+                diagnostic_print(stderr, &result->semantic.items[j]);
+            }
+        }
+        return 0;
+    }
+    if (result->status < 0) {
+        fprintf(stderr, "%s: Erro ao abrir arquivo\n", result->path);
+    } else if (result->status == 1) {
+        fprintf(stderr, "%s:", result->path);
+        diagnostic_print(stderr, &result->diag);
+    } else {
+        fprintf(stderr, "%s:", result->path);
+        for (int j = 0; j < result->semantic.count; j++) {
+            diagnostic_print(stderr, &result->semantic.items[j]);
+        }
+    }
+    return 1;
+}
+
+/*
+ * validate_parallel(paths, count, thread_count, show_time)
+ *
+ * Valida os arquivos com thread_count threads e imprime, na ordem dos
+ * argumentos, o resultado de cada um. Retorna 1 se algum falhou.
+ */
+static int validate_parallel(char** paths, int count, int thread_count, int show_time) {
+    symtable_enable_interning();
+    parser_init();
+
+    batch_results = (FileResult*)calloc((size_t)count, sizeof(FileResult));
+    batch_count = count;
+    for (int i = 0; i < count; i++) {
+        batch_results[i].path = paths[i];
+    }
+
+    double t0 = now_ms();
+    run_workers(thread_count);
+    double t1 = now_ms();
+
+    int status = 0;
+    for (int i = 0; i < count; i++) {
+        status |= print_file_result(&batch_results[i]);
+        diagnostic_list_free(&batch_results[i].semantic);
+    }
+
+    if (show_time) {
+        fprintf(stderr, "%d arquivos, %d threads: %.3f ms, %d símbolos\n",
+                count, thread_count, t1 - t0, intern_count());
+    }
+    free(batch_results);
+    return status;
+}
+
+/* ============================================================================
+ * VALIDAÇÃO EM LOTE (--lote)
+ * ============================================================================
+ *
+ * Os caminhos vêm de um manifesto (um por linha), de "-" (stdin, separados
+ * por '\0', como em find -print0) ou de um diretório percorrido
+ * recursivamente em ordem alfabética, e são lidos BATCH_WINDOW por vez:
+ * a janela é analisada (em paralelo, com --threads) e seus resultados
+ * entram em ordem no fluxo JSON Lines de stdout antes da próxima. O
+ * parser é inicializado uma vez e só reiniciado entre os arquivos, e a
+ * memória não cresce com o tamanho do lote.
+ */
+
+#define BATCH_WINDOW 1024
+#define BATCH_OUTPUT_FLUSH (1 << 20)
+
+typedef struct {
+    char* path;
+    char** names;           /* Entradas ainda não visitadas, em ordem */
+    int count;
+    int next;
+} DirFrame;
+
+typedef struct {
+    FILE* list;             /* Manifesto ou stdin; NULL ao percorrer um diretório */
+    int separator;
+    char* line;
+    size_t line_capacity;
+    DirFrame* dirs;         /* Pilha dos diretórios em aberto */
+    int dir_count;
+    int dir_capacity;
+    int failed;             /* Algum diretório não pôde ser lido */
+} PathSource;
+
+static int compare_names(const void* a, const void* b) {
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+/*
+ * push_directory(source, path)
+ *
+ * Lê e ordena as entradas do diretório e o coloca no topo da pilha. Um
+ * diretório ilegível é reportado em stderr e pulado.
+ */
+static void push_directory(PathSource* source, char* path) {
+    DIR* dir = opendir(path);
+    if (dir == NULL) {
+        fprintf(stderr, "%s: Erro ao abrir diretório: %s\n", path, strerror(errno));
+        source->failed = 1;
+        free(path);
+        return;
+    }
+    DirFrame frame = {path, NULL, 0, 0};
+    int capacity = 0;
+    struct dirent* ent;
+    while ((ent = readdir(dir)) != NULL) {
+        if (strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0) {
+            continue;
+        }
+        if (frame.count == capacity) {
+            capacity = capacity ? capacity * 2 : 16;
+            frame.names = (char**)realloc(frame.names, sizeof(char*) * (size_t)capacity);
+        }
+        frame.names[frame.count++] = strdup(ent->d_name);
+    }
+    closedir(dir);
+    qsort(frame.names, (size_t)frame.count, sizeof(char*), compare_names);
+
+    if (source->dir_count == source->dir_capacity) {
+        source->dir_capacity = source->dir_capacity ? source->dir_capacity * 2 : 8;
+        source->dirs = (DirFrame*)realloc(source->dirs,
+                                          sizeof(DirFrame) * (size_t)source->dir_capacity);
+    }
+    source->dirs[source->dir_count++] = frame;
+}
+
+/*
+ * path_source_open(source, origin)
+ *
+ * Retorna 0 em caso de sucesso.
+ */
+static int path_source_open(PathSource* source, const char* origin) {
+    memset(source, 0, sizeof(*source));
+    struct stat st;
+    if (strcmp(origin, "-") == 0) {
+        source->list = stdin;
+        source->separator = '\0';
+        return 0;
+    }
+    if (stat(origin, &st) == 0 && S_ISDIR(st.st_mode)) {
+        push_directory(source, strdup(origin));
+        return source->failed ? -1 : 0;
+    }
+    source->list = fopen(origin, "r");
+    if (source->list == NULL) {
+        perror("Erro ao abrir o manifesto");
+        return -1;
+    }
+    source->separator = '\n';
+    return 0;
+}
+
+/*
+ * path_source_next(source)
+ *
+ * Próximo caminho, alocado com malloc(), ou NULL no fim. Linhas vazias do
+ * manifesto são ignoradas. No diretório, entram os arquivos .lsi; links
+ * simbólicos para arquivos são seguidos, para diretórios não (evita
+ * ciclos).
+ */
+static char* path_source_next(PathSource* source) {
+    if (source->list != NULL) {
+        ssize_t length;
+        while ((length = getdelim(&source->line, &source->line_capacity,
+                                  source->separator, source->list)) >= 0) {
+            if (length > 0 && source->line[length - 1] == source->separator) {
+                source->line[--length] = '\0';
+            }
+            if (length > 0 && source->separator == '\n' && source->line[length - 1] == '\r') {
+                source->line[--length] = '\0';
+            }
+            if (length > 0) {
+                return strdup(source->line);
+            }
+        }
+        return NULL;
+    }
+
+    while (source->dir_count > 0) {
+        DirFrame* top = &source->dirs[source->dir_count - 1];
+        if (top->next == top->count) {
+            free(top->names);
+            free(top->path);
+            source->dir_count--;
+            continue;
+        }
+        char* name = top->names[top->next++];
+        size_t length = strlen(name);
+        char* path = (char*)malloc(strlen(top->path) + length + 2);
+        sprintf(path, "%s/%s", top->path, name);
+        free(name);
+
+        struct stat st;
+        if (lstat(path, &st) == 0 && S_ISDIR(st.st_mode)) {
+            push_directory(source, path);
+        } else if (length > 4 && strcmp(path + strlen(path) - 4, ".lsi") == 0 &&
+                   stat(path, &st) == 0 && S_ISREG(st.st_mode)) {
+            return path;
+        } else {
+            free(path);
+        }
+    }
+    return NULL;
+}
+
+static void path_source_close(PathSource* source) {
+    if (source->list != NULL && source->list != stdin) {
+        fclose(source->list);
+    }
+    free(source->line);
+    while (source->dir_count > 0) {
+        DirFrame* top = &source->dirs[--source->dir_count];
+        for (int i = top->next; i < top->count; i++) {
+            free(top->names[i]);
+        }
+        free(top->names);
+        free(top->path);
+    }
+    free(source->dirs);
+}
+
+/*
+ * append_batch_result(out, result)
+ *
+ * Uma linha JSON por arquivo, com os mesmos campos "valid" e
+ * "diagnostics" das respostas do lsi-serverd; avisos não invalidam.
+ */
+static void append_batch_result(TextBuffer* out, const FileResult* result) {
+    text_append(out, "{\"path\":", 8);
+    text_append_json_string(out, result->path);
+    if (result->status < 0) {
+        text_append(out, ",\"valid\":false,\"error\":", 23);
+        text_append_json_string(out, strerror(result->error));
+        text_append(out, ",\"diagnostics\":[]}\n", 19);
+        return;
+    }
+    text_printf(out, ",\"valid\":%s,\"diagnostics\":[", result->status == 0 ? "true" : "false");
+    if (result->status == 1) {
+        diagnostic_append_json(out, &result->diag);
+    }
+    for (int i = 0; i < result->semantic.count; i++) {
+        if (i > 0) {
+            text_append(out, ",", 1);
+        }
+        diagnostic_append_json(out, &result->semantic.items[i]);
+    }
+    text_append(out, "]}\n", 3);
+}
+
+static void flush_output(TextBuffer* out) {
+    if (out->length > 0 && fwrite(out->data, 1, out->length, stdout) != out->length) {
+        perror("Erro ao escrever a saída");
+        exit(1);
+    }
+    out->length = 0;
+}
+
+/*
+ * validate_batch(origin, thread_count, show_time)
+ *
+ * Retorna 1 se algum arquivo é inválido ou não pôde ser lido.
+ */
+static int validate_batch(const char* origin, int thread_count, int show_time) {
+    PathSource source;
+    if (path_source_open(&source, origin) != 0) {
+        path_source_close(&source);
+        return 1;
+    }
+    if (thread_count > 1) {
+        symtable_enable_interning();
+    }
+    parser_init();
+
+    TextBuffer out = {0};
+    FileResult* window = (FileResult*)calloc(BATCH_WINDOW, sizeof(FileResult));
+    long files = 0, invalid = 0, unreadable = 0;
+    double t0 = now_ms();
+
+    for (;;) {
+        int count = 0;
+        char* path;
+        while (count < BATCH_WINDOW && (path = path_source_next(&source)) != NULL) {
+            memset(&window[count], 0, sizeof(FileResult));
+            window[count++].path = path;
+        }
+        if (count == 0) {
+            break;
+        }
+
+        batch_results = window;
+        batch_count = count;
+        run_workers(thread_count);
+
+        for (int i = 0; i < count; i++) {
+            append_batch_result(&out, &window[i]);
+            invalid += window[i].status > 0;
+            unreadable += window[i].status < 0;
+            diagnostic_list_free(&window[i].semantic);
+            free((char*)window[i].path);
+            if (out.length >= BATCH_OUTPUT_FLUSH) {
+                flush_output(&out);
+            }
+        }
+        files += count;
+    }
+    flush_output(&out);
+    fflush(stdout);
+    double t1 = now_ms();
+
+    if (show_time) {
+        fprintf(stderr, "%ld arquivos (%ld válidos, %ld inválidos, %ld ilegíveis), "
+                        "%d thread(s): %.3f ms\n",
+                files, files - invalid - unreadable, invalid, unreadable,
+                thread_count > 1 ? thread_count : 1, t1 - t0);
+    }
+    int status = invalid > 0 || unreadable > 0 || source.failed;
+    text_free(&out);
+    free(window);
+    path_source_close(&source);
+    return status;
+}
+
+/* ============================================================================
+ * MODO DE OBSERVAÇÃO (--watch)
+ * ============================================================================
+ *
+ * Observa um diretório e os subdiretórios com inotify e guarda em memória
+ * o resultado de cada arquivo .lsi. Os eventos de escrita, criação,
+ * renomeação e remoção só marcam o arquivo como pendente; o lote é
+ * analisado depois de debounce_ms (--watch-ms) sem eventos novos, ou de
+ * WATCH_MAX_DELAY_FACTOR vezes isso desde o primeiro, de modo que uma
+ * rajada de gravações vira uma única análise. Só os arquivos pendentes
+ * são lidos e analisados de novo, na thread principal, cujo lexer, pilhas
+ * e arena continuam alocados entre os lotes (lotes grandes usam
+ * --threads); os demais são reportados a partir da memória.
+ */
+
+#define WATCH_DEFAULT_DEBOUNCE_MS 50
+#define WATCH_MAX_DELAY_FACTOR 10
+#define WATCH_PARALLEL_MIN 64       /* Lotes menores ficam na thread principal */
+#define WATCH_EVENTS (IN_CLOSE_WRITE | IN_MODIFY | IN_CREATE | IN_DELETE | IN_MOVED_FROM | \
+                      IN_MOVED_TO | IN_DELETE_SELF | IN_ONLYDIR)
+
+typedef struct {
+    char* path;
+    FileResult result;
+    int present;            /* O arquivo existe e result é o da última análise */
+    int pending;            /* Marcado por um evento do lote atual */
+    int batch;              /* No relatório do lote: 1 reanalisado, 2 removido */
+    unsigned generation;    /* Última varredura completa que o encontrou */
+    ino_t inode;            /* Estado na última análise, para a varredura completa */
+    off_t size;
+    struct timespec mtime;
+} WatchFile;
+
+typedef struct {
+    int fd;                 /* Descritor do inotify */
+    int root_wd;
+    const char* root;
+    char** dirs;            /* Por descritor de observação: caminho do diretório */
+    int dir_capacity;
+    int dir_count;
+    WatchFile* files;       /* Arquivos já vistos, inclusive os removidos */
+    int file_count;
+    int file_capacity;
+    int* slots;             /* Tabela hash de caminhos: índice em files + 1, ou 0 */
+    int slot_capacity;
+    int* pending;           /* Índices em files, na ordem dos eventos */
+    int pending_count;
+    int pending_capacity;
+    int rescan;             /* A fila do inotify transbordou */
+    unsigned generation;
+    int present_count;
+    int invalid_count;
+    long events;            /* Eventos do lote atual */
+    double first_event;     /* 0 sem lote em aberto */
+    double last_event;
+} Watch;
+
+static volatile sig_atomic_t watch_stop = 0;
+
+static void handle_watch_signal(int sig) {
+    (void)sig;
+    watch_stop = 1;
+}
+
+/*
+ * watch_checked(memory)
+ *
+ * Retorna memory; o modo de observação não tem como continuar sem as
+ * suas tabelas, então uma alocação que falhou encerra o processo.
+ */
+static void* watch_checked(void* memory) {
+    if (memory == NULL) {
+        fprintf(stderr, "Erro fatal: Memória insuficiente para observar o diretório.\n");
+        exit(1);
+    }
+    return memory;
+}
+
+static uint64_t hash_path(const char* path) {
+    uint64_t hash = 14695981039346656037ULL;     /* FNV-1a */
+    for (const unsigned char* p = (const unsigned char*)path; *p; p++) {
+        hash = (hash ^ *p) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+/*
+ * watch_file(watch, path)
+ *
+ * Índice do arquivo em watch->files, criando a entrada na primeira vez.
+ */
+static int watch_file(Watch* watch, const char* path) {
+    if (2 * (watch->file_count + 1) > watch->slot_capacity) {
+        int capacity = watch->slot_capacity ? watch->slot_capacity * 2 : 1024;
+        int* slots = (int*)watch_checked(calloc((size_t)capacity, sizeof(int)));
+        for (int i = 0; i < watch->file_count; i++) {
+            size_t slot = hash_path(watch->files[i].path) & (size_t)(capacity - 1);
+            while (slots[slot] != 0) {
+                slot = (slot + 1) & (size_t)(capacity - 1);
+            }
+            slots[slot] = i + 1;
+        }
+        free(watch->slots);
+        watch->slots = slots;
+        watch->slot_capacity = capacity;
+    }
+    size_t mask = (size_t)watch->slot_capacity - 1;
+    size_t slot = hash_path(path) & mask;
+    while (watch->slots[slot] != 0) {
+        int index = watch->slots[slot] - 1;
+        if (strcmp(watch->files[index].path, path) == 0) {
+            return index;
+        }
+        slot = (slot + 1) & mask;
+    }
+    if (watch->file_count == watch->file_capacity) {
+        watch->file_capacity = watch->file_capacity ? watch->file_capacity * 2 : 256;
+        watch->files = (WatchFile*)watch_checked(
+            realloc(watch->files, sizeof(WatchFile) * (size_t)watch->file_capacity));
+    }
+    WatchFile* file = &watch->files[watch->file_count];
+    memset(file, 0, sizeof(*file));
+    file->path = (char*)watch_checked(strdup(path));
+    watch->slots[slot] = watch->file_count + 1;
+    return watch->file_count++;
+}
+
+static void watch_mark(Watch* watch, int index) {
+    if (watch->files[index].pending) {
+        return;
+    }
+    if (watch->pending_count == watch->pending_capacity) {
+        watch->pending_capacity = watch->pending_capacity ? watch->pending_capacity * 2 : 256;
+        watch->pending = (int*)watch_checked(
+            realloc(watch->pending, sizeof(int) * (size_t)watch->pending_capacity));
+    }
+    watch->files[index].pending = 1;
+    watch->pending[watch->pending_count++] = index;
+}
+
+static int is_lsi_name(const char* name) {
+    size_t length = strlen(name);
+    return length > 4 && strcmp(name + length - 4, ".lsi") == 0;
+}
+
+/*
+ * watch_directory(watch, path, rescan)
+ *
+ * Observa o diretório e, recursivamente, os subdiretórios (sem seguir
+ * links simbólicos para diretórios) e marca os arquivos .lsi. A
+ * observação é registrada antes da leitura do diretório, para que um
+ * arquivo criado nesse intervalo não se perca. Na varredura completa
+ * (rescan), só marca os arquivos novos ou alterados desde a última
+ * análise.
+ */
+static void watch_directory(Watch* watch, const char* path, int rescan) {
+    int wd = inotify_add_watch(watch->fd, path, WATCH_EVENTS);
+    if (wd < 0) {
+        fprintf(stderr, "%s: Erro ao observar diretório: %s\n", path, strerror(errno));
+    } else {
+        if (wd >= watch->dir_capacity) {
+            int capacity = watch->dir_capacity ? watch->dir_capacity : 64;
+            while (capacity <= wd) {
+                capacity *= 2;
+            }
+            watch->dirs = (char**)watch_checked(
+                realloc(watch->dirs, sizeof(char*) * (size_t)capacity));
+            memset(watch->dirs + watch->dir_capacity, 0,
+                   sizeof(char*) * (size_t)(capacity - watch->dir_capacity));
+            watch->dir_capacity = capacity;
+        }
+        if (watch->dirs[wd] == NULL) {
+            watch->dir_count++;
+        }
+        free(watch->dirs[wd]);
+        watch->dirs[wd] = (char*)watch_checked(strdup(path));
+        if (watch->root_wd < 0) {
+            watch->root_wd = wd;
+        }
+    }
+
+    DIR* dir = opendir(path);
+    if (dir == NULL) {
+        fprintf(stderr, "%s: Erro ao abrir diretório: %s\n", path, strerror(errno));
+        return;
+    }
+    struct dirent* ent;
+    while ((ent = readdir(dir)) != NULL) {
+        if (strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0) {
+            continue;
+        }
+        char* child = (char*)watch_checked(malloc(strlen(path) + strlen(ent->d_name) + 2));
+        sprintf(child, "%s/%s", path, ent->d_name);
+        struct stat st;
+        if (lstat(child, &st) == 0 && S_ISDIR(st.st_mode)) {
+            watch_directory(watch, child, rescan);
+        } else if (is_lsi_name(ent->d_name)) {
+            int index = watch_file(watch, child);
+            WatchFile* file = &watch->files[index];
+            file->generation = watch->generation;
+            if (!rescan || !file->present || stat(child, &st) != 0 ||
+                st.st_ino != file->inode || st.st_size != file->size ||
+                st.st_mtim.tv_sec != file->mtime.tv_sec ||
+                st.st_mtim.tv_nsec != file->mtime.tv_nsec) {
+                watch_mark(watch, index);
+            }
+        }
+        free(child);
+    }
+    closedir(dir);
+}
+
+/*
+ * watch_forget(watch, path)
+ *
+ * O diretório saiu da árvore (removido ou renomeado): marca os arquivos
+ * abaixo dele, que o lote vai encontrar ausentes, e desfaz as
+ * observações. Se ele só mudou de lugar dentro da árvore, o IN_MOVED_TO
+ * correspondente volta a observá-lo.
+ */
+static void watch_forget(Watch* watch, const char* path) {
+    size_t length = strlen(path);
+    for (int i = 0; i < watch->file_count; i++) {
+        const char* name = watch->files[i].path;
+        if (watch->files[i].present && strncmp(name, path, length) == 0 && name[length] == '/') {
+            watch_mark(watch, i);
+        }
+    }
+    for (int wd = 0; wd < watch->dir_capacity; wd++) {
+        const char* name = watch->dirs[wd];
+        if (name != NULL && wd != watch->root_wd && strncmp(name, path, length) == 0 &&
+            (name[length] == '\0' || name[length] == '/')) {
+            inotify_rm_watch(watch->fd, wd);    /* O IN_IGNORED libera a entrada */
+        }
+    }
+}
+
+/*
+ * watch_handle_events(watch, buffer, length)
+ *
+ * Trata os eventos lidos do inotify. Retorna -1 se o diretório observado
+ * deixou de existir.
+ */
+static int watch_handle_events(Watch* watch, const char* buffer, size_t length) {
+    const char* end = buffer + length;
+    while (buffer < end) {
+        const struct inotify_event* event = (const struct inotify_event*)buffer;
+        buffer += sizeof(struct inotify_event) + event->len;
+
+        if (event->mask & IN_Q_OVERFLOW) {
+            watch->rescan = 1;
+            watch->events++;
+            continue;
+        }
+        if (event->wd < 0 || event->wd >= watch->dir_capacity || watch->dirs[event->wd] == NULL) {
+            continue;
+        }
+        if (event->mask & IN_IGNORED) {
+            if (event->wd == watch->root_wd) {
+                return -1;
+            }
+            free(watch->dirs[event->wd]);
+            watch->dirs[event->wd] = NULL;
+            watch->dir_count--;
+            continue;
+        }
+        if (event->len == 0) {
+            continue;       /* IN_DELETE_SELF: o IN_IGNORED vem em seguida */
+        }
+
+        const char* dir = watch->dirs[event->wd];
+        char* path = (char*)watch_checked(malloc(strlen(dir) + strlen(event->name) + 2));
+        sprintf(path, "%s/%s", dir, event->name);
+        if (event->mask & IN_ISDIR) {
+            if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                watch_directory(watch, path, 0);
+                watch->events++;
+            } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                watch_forget(watch, path);
+                watch->events++;
+            }
+        } else if (is_lsi_name(event->name)) {
+            watch_mark(watch, watch_file(watch, path));
+            watch->events++;
+        }
+        free(path);
+    }
+    return 0;
+}
+
+static void watch_drop_result(Watch* watch, WatchFile* file) {
+    watch->present_count--;
+    watch->invalid_count -= file->result.status != 0;
+    diagnostic_list_free(&file->result.semantic);
+    file->present = 0;
+}
+
+/*
+ * watch_process(watch, thread_count, initial)
+ *
+ * Analisa os arquivos pendentes e imprime o lote: o resultado de cada
+ * arquivo reanalisado ou removido e, a partir da memória, os que
+ * continuam com erros sem terem mudado. Na análise inicial, só os
+ * arquivos com erros e o resumo.
+ */
+static void watch_process(Watch* watch, int thread_count, int initial) {
+    double t0 = now_ms();
+    if (watch->rescan) {
+        watch->generation++;
+        watch_directory(watch, watch->root, 1);
+        for (int i = 0; i < watch->file_count; i++) {
+            if (watch->files[i].present && watch->files[i].generation != watch->generation) {
+                watch_mark(watch, i);
+            }
+        }
+        watch->rescan = 0;
+    }
+
+    int count = 0, removed = 0;
+    FileResult* window =
+        (FileResult*)watch_checked(calloc((size_t)watch->pending_count + 1, sizeof(FileResult)));
+    int* window_file =
+        (int*)watch_checked(malloc(sizeof(int) * ((size_t)watch->pending_count + 1)));
+    for (int i = 0; i < watch->pending_count; i++) {
+        WatchFile* file = &watch->files[watch->pending[i]];
+        struct stat st;
+        file->pending = 0;
+        if (stat(file->path, &st) != 0 || !S_ISREG(st.st_mode)) {
+            if (file->present) {
+                watch_drop_result(watch, file);
+                file->batch = 2;
+                removed++;
+            }
+            continue;
+        }
+        file->inode = st.st_ino;
+        file->size = st.st_size;
+        file->mtime = st.st_mtim;
+        file->batch = 1;
+        window[count].path = file->path;
+        window_file[count++] = watch->pending[i];
+    }
+
+    batch_results = window;
+    batch_count = count;
+    run_workers(count >= WATCH_PARALLEL_MIN ? thread_count : 1);
+    double t1 = now_ms();
+
+    for (int i = 0; i < count; i++) {
+        WatchFile* file = &watch->files[window_file[i]];
+        if (file->present) {
+            watch_drop_result(watch, file);
+        }
+        file->result = window[i];
+        file->present = 1;
+        watch->present_count++;
+        watch->invalid_count += file->result.status != 0;
+    }
+
+    if (initial) {
+        for (int i = 0; i < watch->file_count; i++) {
+            if (watch->files[i].present && watch->files[i].result.status != 0) {
+                print_file_result(&watch->files[i].result);
+            }
+        }
+        printf("Observando %s: %d arquivos .lsi em %d diretórios; %d válidos, %d com erros "
+               "(análise inicial: %.1f ms)\n",
+               watch->root, watch->present_count, watch->dir_count,
+               watch->present_count - watch->invalid_count, watch->invalid_count, t1 - t0);
+    } else {
+        for (int i = 0; i < watch->pending_count; i++) {
+            WatchFile* file = &watch->files[watch->pending[i]];
+            if (file->batch == 1) {
+                print_file_result(&file->result);
+            } else if (file->batch == 2) {
+                printf("%s: removido\n", file->path);
+            }
+        }
+        int unchanged = 0;
+        for (int i = 0; i < watch->file_count; i++) {
+            WatchFile* file = &watch->files[i];
+            if (file->present && file->batch == 0 && file->result.status != 0) {
+                if (unchanged++ == 0) {
+                    printf("Sem mudanças, ainda com erros:\n");
+                }
+                print_file_result(&file->result);
+            }
+        }
+        double t2 = now_ms();
+        printf("Lote: %ld eventos, %d reanalisados e %d removidos em %.3f ms; latência %.1f ms "
+               "desde o primeiro evento, %.1f ms desde o último; %d válidos, %d com erros\n",
+               watch->events, count, removed, t1 - t0, t2 - watch->first_event,
+               t2 - watch->last_event, watch->present_count - watch->invalid_count,
+               watch->invalid_count);
+    }
+
+    for (int i = 0; i < watch->pending_count; i++) {
+        watch->files[watch->pending[i]].batch = 0;
+    }
+    watch->pending_count = 0;
+    watch->events = 0;
+    watch->first_event = 0;
+    free(window);
+    free(window_file);
+}
+
+/*
+ * watch_tree(root, thread_count, debounce_ms)
+ *
+ * Valida todos os arquivos .lsi da árvore e passa a revalidar os que
+ * mudam, até SIGINT ou SIGTERM. Retorna 1 se algum arquivo terminou com
+ * erros ou se a observação falhou.
+ */
+static int watch_tree(const char* root, int thread_count, int debounce_ms) {
+    struct stat st;
+    if (stat(root, &st) != 0) {
+        fprintf(stderr, "%s: Erro ao abrir diretório: %s\n", root, strerror(errno));
+        return 1;
+    }
+    if (!S_ISDIR(st.st_mode)) {
+        fprintf(stderr, "%s: Não é um diretório\n", root);
+        return 1;
+    }
+    Watch watch;
+    memset(&watch, 0, sizeof(watch));
+    watch.root = root;
+    watch.root_wd = -1;
+    watch.fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watch.fd < 0) {
+        perror("Erro em inotify_init1");
+        return 1;
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = handle_watch_signal;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    if (thread_count > 1) {
+        symtable_enable_interning();
+    }
+    parser_init();
+    watch_directory(&watch, root, 0);
+    watch_process(&watch, thread_count, 1);
+
+    int status = 0;
+    char buffer[65536] __attribute__((aligned(__alignof__(struct inotify_event))));
+    while (!watch_stop) {
+        int timeout = -1;
+        if (watch.pending_count > 0 || watch.rescan) {
+            double now = now_ms();
+            double due = watch.last_event + debounce_ms;
+            double limit = watch.first_event + (double)debounce_ms * WATCH_MAX_DELAY_FACTOR;
+            if (due > limit) {
+                due = limit;
+            }
+            if (now >= due) {
+                watch_process(&watch, thread_count, 0);
+                continue;
+            }
+            timeout = (int)(due - now) + 1;
+        }
+
+        struct pollfd pfd = {watch.fd, POLLIN, 0};
+        if (poll(&pfd, 1, timeout) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("Erro em poll");
+            status = 1;
+            break;
+        }
+        long events = watch.events;
+        ssize_t n;
+        while ((n = read(watch.fd, buffer, sizeof(buffer))) > 0) {
+            if (watch_handle_events(&watch, buffer, (size_t)n) != 0) {
+                fprintf(stderr, "%s: O diretório observado foi removido\n", root);
+                watch_stop = 1;
+                status = 1;
+                break;
+            }
+        }
+        if (n < 0 && errno != EAGAIN && errno != EINTR) {
+            perror("Erro ao ler os eventos do inotify");
+            status = 1;
+            break;
+        }
+        if (watch.events > events) {
+            watch.last_event = now_ms();
+            if (watch.first_event == 0) {
+                watch.first_event = watch.last_event;
+            }
+        }
+    }
+
+    printf("Encerrando: %d arquivos, %d válidos, %d com erros\n", watch.present_count,
+           watch.present_count - watch.invalid_count, watch.invalid_count);
+    status |= watch.invalid_count > 0;
+
+    close(watch.fd);
+    for (int i = 0; i < watch.file_count; i++) {
+        diagnostic_list_free(&watch.files[i].result.semantic);
+        free(watch.files[i].path);
+    }
+    for (int wd = 0; wd < watch.dir_capacity; wd++) {
+        free(watch.dirs[wd]);
+    }
+    free(watch.files);
+    free(watch.slots);
+    free(watch.pending);
+    free(watch.dirs);
+    return status;
+}
+
+/* ============================================================================
+ * FORMATAÇÃO
+ * ============================================================================ */
+
+/*
+ * format_to_stdout(path, show_time)
+ *
+ * Formata o arquivo em stdout. Retorna 1 em caso de erro.
+ */
+static int format_to_stdout(const char* path, int show_time) {
+    FILE* input = fopen(path, "r");
+    if (!input) {
+        perror("Erro ao abrir arquivo");
+        return 1;
+    }
+    Diagnostic diag;
+    fflush(stdout);
+    double t0 = now_ms();
+    int status = format_file(input, STDOUT_FILENO, &diag);
+    double t1 = now_ms();
+    long size = ftell(input);
+    fclose(input);
+    if (status != 0) {
+        diagnostic_print(stderr, &diag);
+        return 1;
+    }
+    if (show_time) {
+        fprintf(stderr, "Formatação: %.1f MB em %.3f ms (%.0f MB/s)\n",
+                size / 1e6, t1 - t0, t1 > t0 ? size / 1e3 / (t1 - t0) : 0.0);
+    }
+    return 0;
+}
+
+/* ============================================================================
+ * ANÁLISE LÉXICA ISOLADA
+ * ============================================================================ */
+
+/*
+ * lex_only(path, show_time)
+ *
+ * Lê todos os tokens sem a tabela de símbolos, como o formatador, de modo
+ * que a memória não cresce com a entrada. Linha e coluna são as de 64
+ * bits do lexer, sem o limite dos campos int. Retorna 1 em caso de erro.
+ */
+static int lex_only(const char* path, int show_time) {
+    FILE* input = fopen(path, "r");
+    if (!input) {
+        perror("Erro ao abrir arquivo");
+        return 1;
+    }
+    lexer_set_symbol_table(0);
+    double t0 = now_ms();
+    lexer_reset(input);
+
+    int64_t tokens = 0;
+    int64_t last_offset = -1;
+    Token token;
+    while ((token = getToken()).type != TOKEN_EOF && token.type != TOKEN_ERROR) {
+        last_offset = token.offset;
+        tokens++;
+    }
+    double t1 = now_ms();
+
+    int64_t line, col;
+    int status = 0;
+    if (token.type == TOKEN_ERROR) {
+        lexer_position(token.offset, &line, &col);
+        fprintf(stderr, "--- Erro Sintático ---\n"
+                        "Token inesperado: '%s' (%s)\n"
+                        "Localização: linha %" PRId64 ", coluna %" PRId64 "\n",
+                token.lexeme, token_type_to_string(token.type), line, col);
+        status = 1;
+    } else {
+        int64_t lines, eof_col;
+        lexer_position(token.offset, &lines, &eof_col);
+        if (eof_col == 1 || token.offset == 0) {
+            lines--;        /* A última linha termina com quebra, ou o arquivo é vazio */
+        }
+        printf("Análise Léxica concluída: %" PRId64 " tokens, %" PRId64 " linhas\n",
+               tokens, lines);
+        if (last_offset >= 0) {
+            lexer_position(last_offset, &line, &col);
+            printf("Último token: linha %" PRId64 ", coluna %" PRId64 " (byte %" PRId64 ")\n",
+                   line, col, last_offset);
+        }
+    }
+    fflush(stdout);
+
+    if (show_time) {
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        fprintf(stderr, "Leitura: %.1f MB em %.3f ms (%.0f MB/s), memória máxima: %.1f MB\n",
+                token.offset / 1e6, t1 - t0,
+                t1 > t0 ? token.offset / 1e3 / (t1 - t0) : 0.0, usage.ru_maxrss / 1024.0);
+    }
+    fclose(input);
+    return status;
+}
+
+/* ============================================================================
+ * CONTADORES DE DESEMPENHO POR FASE
+ * ============================================================================ */
+
+/* Uma linha do relatório de --contadores: valores medidos ou diferença de duas fases */
+typedef struct {
+    const char* label;
+    double values[PERF_COUNTER_COUNT];
+    char valid[PERF_COUNTER_COUNT];
+    double millis;
+} PhaseRow;
+
+static void phase_measured(PhaseRow* row, const char* label, const PerfSample* sample) {
+    row->label = label;
+    row->millis = sample->millis;
+    for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+        row->values[c] = (double)sample->values[c];
+        row->valid[c] = sample->valid[c];
+    }
+}
+
+static void phase_difference(PhaseRow* row, const char* label, const PhaseRow* total,
+                             const PhaseRow* part) {
+    row->label = label;
+    row->millis = total->millis - part->millis;
+    for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+        row->values[c] = total->values[c] - part->values[c];
+        row->valid[c] = total->valid[c] && part->valid[c];
+    }
+}
+
+/* Bytes de continuação UTF-8: o que %*s conta a mais que as colunas ocupadas */
+static int utf8_extra_bytes(const char* text) {
+    int extra = 0;
+    for (const char* p = text; *p != '\0'; p++) {
+        extra += ((unsigned char)*p & 0xc0) == 0x80;
+    }
+    return extra;
+}
+
+/*
+ * print_phase_table(rows, count, scale)
+ *
+ * Uma coluna por fase e uma linha por contador aberto, com os valores
+ * divididos por scale ("-" se a leitura falhou). Com scale 1, acrescenta
+ * as instruções por ciclo.
+ */
+static void print_phase_table(const PhaseRow* rows, int count, double scale,
+                              const PerfCounters* counters) {
+    printf("  %-18s", "");
+    for (int r = 0; r < count; r++) {
+        printf(" %*s", 14 + utf8_extra_bytes(rows[r].label), rows[r].label);
+    }
+    printf("\n  %-18s", "ms");
+    for (int r = 0; r < count; r++) {
+        printf(" %14.3f", rows[r].millis / scale);
+    }
+    printf("\n");
+    for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+        if (counters->fds[c] < 0) {
+            continue;           /* Já listado como indisponível */
+        }
+        const char* name = perf_counter_name((PerfCounter)c);
+        printf("  %-*s", 18 + utf8_extra_bytes(name), name);
+        for (int r = 0; r < count; r++) {
+            if (rows[r].valid[c]) {
+                printf(" %14.0f", rows[r].values[c] / scale);
+            } else {
+                printf(" %14s", "-");
+            }
+        }
+        printf("\n");
+    }
+    if (scale == 1.0 && counters->fds[PERF_CYCLES] >= 0 && counters->fds[PERF_INSTRUCTIONS] >= 0) {
+        printf("  %-18s", "IPC");
+        for (int r = 0; r < count; r++) {
+            if (rows[r].valid[PERF_CYCLES] && rows[r].valid[PERF_INSTRUCTIONS] &&
+                rows[r].values[PERF_CYCLES] > 0) {
+                printf(" %14.2f", rows[r].values[PERF_INSTRUCTIONS] / rows[r].values[PERF_CYCLES]);
+            } else {
+                printf(" %14s", "-");
+            }
+        }
+        printf("\n");
+    }
+}
+
+/* Percorre os tokens até o fim ou o primeiro erro; retorna o último token */
+static Token scan_tokens(FILE* input, int64_t* tokens) {
+    lexer_reset(input);
+    Token token;
+    *tokens = 0;
+    while ((token = getToken()).type != TOKEN_EOF && token.type != TOKEN_ERROR) {
+        (*tokens)++;
+    }
+    return token;
+}
+
+/*
+ * profile_phases(path)
+ *
+ * Depois de uma leitura dos tokens que não é medida, lê o arquivo três
+ * vezes, com os contadores de perfcount.h ligados só durante cada
+ * passada: só os tokens, sem a tabela de símbolos (como --lexico); os
+ * tokens com a tabela (a primeira passada a inserir os nomes); e a
+ * análise completa de parse_file(), que já encontra os nomes na tabela.
+ * A tabela de símbolos e o laço de parse() são as diferenças entre
+ * passadas seguidas. Imprime os valores por fase e por MB; sem
+ * contadores, só os tempos. Retorna 1 se o arquivo tem erro.
+ */
+static int profile_phases(const char* path) {
+    FILE* input = fopen(path, "r");
+    if (!input) {
+        perror("Erro ao abrir arquivo");
+        return 1;
+    }
+    parser_init();
+    PerfCounters counters;
+    perf_counters_open(&counters);
+
+    PerfSample sample;
+    PhaseRow rows[5];
+    int64_t tokens;
+    lexer_set_symbol_table(0);
+    scan_tokens(input, &tokens);    /* Aquece o cache de páginas e as áreas do lexer */
+    rewind(input);
+    perf_counters_start(&counters);
+    Token last = scan_tokens(input, &tokens);
+    perf_counters_stop(&counters, &sample);
+    lexer_set_symbol_table(1);
+    phase_measured(&rows[0], "léxico", &sample);
+    int64_t bytes = last.offset;
+
+    rewind(input);
+    perf_counters_start(&counters);
+    scan_tokens(input, &tokens);
+    perf_counters_stop(&counters, &sample);
+    phase_measured(&rows[1], "léxico+tabela", &sample);
+
+    rewind(input);
+    Diagnostic diag;
+    perf_counters_start(&counters);
+    AstNode* program = parse_file(input, &diag);
+    perf_counters_stop(&counters, &sample);
+    phase_measured(&rows[2], "parse_file", &sample);
+    fclose(input);
+
+    phase_difference(&rows[3], "tabela", &rows[1], &rows[0]);
+    phase_difference(&rows[4], "parse()", &rows[2], &rows[1]);
+
+    double mb = bytes / 1e6;
+    printf("Contadores de %s: %.1f MB, %" PRId64 " tokens%s\n", path, mb, tokens,
+           expr_fast_path ? "" : " (expressões pela tabela LL(1))");
+    /* Com EACCES ou EPERM, perf_event_paranoid acima de 2 bloqueia o processo */
+    const char* hint = counters.first_error == EACCES || counters.first_error == EPERM
+                           ? "; veja /proc/sys/kernel/perf_event_paranoid" : "";
+    if (counters.open_count == 0) {
+        printf("Contadores indisponíveis (perf_event_open: %s%s); só os tempos foram medidos\n",
+               strerror(counters.first_error), hint);
+    } else if (counters.open_count < PERF_COUNTER_COUNT) {
+        printf("Indisponíveis (perf_event_open: %s%s):", strerror(counters.first_error), hint);
+        for (int c = 0, n = 0; c < PERF_COUNTER_COUNT; c++) {
+            if (counters.fds[c] < 0) {
+                printf("%s %s", n++ > 0 ? "," : "", perf_counter_name((PerfCounter)c));
+            }
+        }
+        printf("\n");
+    }
+    print_phase_table(rows, 5, 1.0, &counters);
+    if (mb > 0) {
+        printf("Por MB:\n");
+        print_phase_table(rows, 5, mb, &counters);
+    }
+    printf("tabela = (léxico+tabela) - léxico; parse() = parse_file - (léxico+tabela)\n");
+    fflush(stdout);
+    perf_counters_close(&counters);
+
+    if (program == NULL) {
+        diagnostic_print(stderr, &diag);
+        return 1;
+    }
+    return 0;
+}
+
+/* ============================================================================
+ * ÍNDICE DE REFERÊNCIAS CRUZADAS
+ * ============================================================================ */
+
+/*
+ * update_index(index_path, paths, count, thread_count, show_time)
+ *
+ * Atualiza o índice e imprime o resumo. Retorna 1 se o índice não pôde
+ * ser gravado ou se algum arquivo falhou.
+ */
+static int update_index(const char* index_path, char** paths, int count,
+                        int thread_count, int show_time) {
+    XrefStats stats;
+    double t0 = now_ms();
+    int status = xref_update(index_path, paths, count, thread_count, &stats);
+    double t1 = now_ms();
+    if (status != 0) {
+        return 1;
+    }
+    printf("Índice '%s': %d arquivos (%d analisados, %d reaproveitados, %d removidos, "
+           "%d com erro), %d nomes, %d ocorrências\n",
+           index_path, stats.files, stats.parsed, stats.reused, stats.removed,
+           stats.failed, stats.names, stats.sites);
+    fflush(stdout);
+    if (show_time) {
+        fprintf(stderr, "Indexação: %.3f ms\n", t1 - t0);
+    }
+    return stats.failed != 0;
+}
+
+/*
+ * print_sites(index, name, definitions)
+ *
+ * Imprime as ocorrências do nome que são definições (ou usos), na ordem
+ * de arquivo e posição. Retorna quantas foram impressas.
+ */
+static int print_sites(const XrefIndex* index, const XrefName* name, int definitions) {
+    int printed = 0;
+    for (uint32_t s = name->first_site; s < name->first_site + name->site_count; s++) {
+        const XrefSite* site = &index->sites[s];
+        if (XREF_IS_DEFINITION(site->kind) != definitions ||
+            site->file >= index->header->file_count) {
+            continue;
+        }
+        printf("  %s:%u:%u: %s", xref_text(index, index->files[site->file].path),
+               site->line, site->col, xref_kind_to_string((XrefKind)site->kind));
+        if (site->function < index->header->name_count && site->kind != XREF_FUNCTION) {
+            printf(" (em %s)", xref_text(index, index->names[site->function].text));
+        }
+        printf("\n");
+        printed++;
+    }
+    return printed;
+}
+
+/*
+ * query_index(index_path, name, show_time)
+ *
+ * Lista as definições e depois os usos do nome. Retorna 1 se o índice
+ * não pôde ser aberto ou se o nome não aparece nele.
+ */
+static int query_index(const char* index_path, const char* name, int show_time) {
+    XrefIndex index;
+    double t0 = now_ms();
+    if (xref_open(&index, index_path) != 0) {
+        fprintf(stderr, "Erro ao abrir o índice '%s'\n", index_path);
+        return 1;
+    }
+    const XrefName* entry = xref_find(&index, name);
+    if (entry == NULL) {
+        fprintf(stderr, "'%s' não aparece no índice\n", name);
+        xref_close(&index);
+        return 1;
+    }
+    printf("Definições de '%s':\n", name);
+    if (print_sites(&index, entry, 1) == 0) {
+        printf("  nenhuma\n");
+    }
+    printf("Usos de '%s':\n", name);
+    if (print_sites(&index, entry, 0) == 0) {
+        printf("  nenhum\n");
+    }
+    fflush(stdout);
+    double t1 = now_ms();
+    if (show_time) {
+        fprintf(stderr, "Consulta: %.3f ms (%u nomes, %u ocorrências no índice)\n",
+                t1 - t0, index.header->name_count, index.header->site_count);
+    }
+    xref_close(&index);
+    return 0;
+}
+
+/* ============================================================================
+ * ÁRVORE EM FORMATO BINÁRIO
+ * ============================================================================ */
+
+/*
+ * count_nodes(file, index)
+ *
+ * Percorre a subárvore pelos filhos, como faria um consumidor do arquivo,
+ * e retorna o número de nós visitados.
+ */
+static uint32_t count_nodes(const AstBinFile* file, uint32_t index) {
+    const AstBinNode* node = astbin_node(file, index);
+    uint32_t count = 1;
+    for (uint32_t i = 0; i < node->param_count + node->kid_count; i++) {
+        count += count_nodes(file, file->links[node->links + i]);
+    }
+    return count;
+}
+
+/*
+ * load_binary_ast(ast_path, source_path, print_ast, show_time)
+ *
+ * Abre a árvore gravada, conferindo-a contra o fonte quando ele é dado, e
+ * a percorre inteira. Com --tempo, analisa o fonte de novo para comparar.
+ * Retorna 1 se a árvore não pôde ser usada.
+ */
+static int load_binary_ast(const char* ast_path, const char* source_path,
+                           int print_ast, int show_time) {
+    AstBinFile file;
+    double t0 = now_ms();
+    int status = astbin_open(&file, ast_path, source_path);
+    double t1 = now_ms();
+    if (status == ASTBIN_STALE) {
+        fprintf(stderr, "Árvore '%s' desatualizada: o fonte ou a gramática mudou\n", ast_path);
+        return 1;
+    }
+    if (status != ASTBIN_OK) {
+        fprintf(stderr, "Erro ao abrir a árvore '%s'\n", ast_path);
+        return 1;
+    }
+    if (astbin_verify(&file) != 0) {
+        fprintf(stderr, "Árvore '%s' inválida\n", ast_path);
+        astbin_close(&file);
+        return 1;
+    }
+    double t2 = now_ms();
+    uint32_t visited = count_nodes(&file, 0);
+    double t3 = now_ms();
+
+    if (print_ast) {
+        astbin_print(&file, 0, 0);
+    } else {
+        printf("Árvore '%s': %u nós, %u bytes de textos\n", ast_path, visited,
+               file.header->string_size);
+    }
+    fflush(stdout);
+
+    if (show_time) {
+        fprintf(stderr, "Carga: %.3f ms, verificação: %.3f ms, percurso: %.3f ms (%.1f MB)\n",
+                t1 - t0, t2 - t1, t3 - t2, file.size / 1e6);
+        FILE* input = source_path != NULL ? fopen(source_path, "r") : NULL;
+        if (input != NULL) {
+            Diagnostic diag;
+            double t4 = now_ms();
+            AstNode* program = parse_file(input, &diag);
+            double t5 = now_ms();
+            fclose(input);
+            if (program != NULL) {
+                fprintf(stderr, "Reanálise de '%s': %.3f ms\n", source_path, t5 - t4);
+            }
+            ast_reset();
+        }
+    }
+    astbin_close(&file);
+    return 0;
+}
+
+/* ============================================================================
+ * COMBINAÇÕES DE OPÇÕES
+ * ============================================================================ */
+
+/* Opções dadas na linha de comando, como bits de um uint64_t */
+#define OPT_ARQUIVO         (1ull << 0)     /* <arquivo.lsi> */
+#define OPT_VARIOS_ARQUIVOS (1ull << 1)     /* Mais de um <arquivo.lsi> */
+#define OPT_TABELA_PURA     (1ull << 2)
+#define OPT_SEMANTICA       (1ull << 3)
+#define OPT_AVISOS          (1ull << 4)
+#define OPT_AST             (1ull << 5)
+#define OPT_EMIT_C          (1ull << 6)
+#define OPT_JIT             (1ull << 7)
+#define OPT_CALLGRAPH       (1ull << 8)
+#define OPT_CSE             (1ull << 9)
+#define OPT_IR              (1ull << 10)
+#define OPT_IR_PASSES       (1ull << 11)
+#define OPT_IR_BENCH        (1ull << 12)
+#define OPT_INLINE          (1ull << 13)
+#define OPT_INLINE_TAMANHO  (1ull << 14)
+#define OPT_PURITY          (1ull << 15)
+#define OPT_MEMO            (1ull << 16)
+#define OPT_FORMAT          (1ull << 17)
+#define OPT_LEXICO          (1ull << 18)
+#define OPT_CONTADORES      (1ull << 19)
+#define OPT_TEMPO           (1ull << 20)
+#define OPT_CACHE           (1ull << 21)
+#define OPT_CACHE_MAX_MB    (1ull << 22)
+#define OPT_THREADS         (1ull << 23)
+#define OPT_INDEXAR         (1ull << 24)
+#define OPT_XREF            (1ull << 25)
+#define OPT_SALVAR_AST      (1ull << 26)
+#define OPT_LER_AST         (1ull << 27)
+#define OPT_LOTE            (1ull << 28)
+#define OPT_WATCH           (1ull << 29)
+#define OPT_WATCH_MS        (1ull << 30)
+#define OPT_LIMITES         (1ull << 31)    /* Qualquer --limite-* */
+
+/* Todas as opções exceto as dadas */
+#define OPT_ONLY(options) (~(uint64_t)(options))
+
+/* Regra: option não pode vir com nenhuma de conflicts, a não ser que uma de unless venha */
+typedef struct {
+    uint64_t option;
+    uint64_t conflicts;
+    uint64_t unless;
+    const char* message;
+} OptionRule;
+
+static const OptionRule option_rules[] = {
+    {OPT_LIMITES, OPT_FORMAT | OPT_LEXICO | OPT_INDEXAR | OPT_XREF | OPT_LER_AST, 0,
+     "As opções --limite-* não se aplicam a --format, --lexico, --indexar, --xref e --ler-ast"},
+    {OPT_WATCH,
+     OPT_ONLY(OPT_WATCH_MS | OPT_THREADS | OPT_TABELA_PURA | OPT_SEMANTICA | OPT_AVISOS |
+              OPT_LIMITES), 0,
+     "--watch só pode ser usado com --watch-ms, --threads, --tabela-pura, --semantica, "
+     "--avisos e --limite-*"},
+    {OPT_LOTE,
+     OPT_ONLY(OPT_THREADS | OPT_TABELA_PURA | OPT_SEMANTICA | OPT_AVISOS | OPT_TEMPO |
+              OPT_LIMITES), 0,
+     "--lote só pode ser usado com --threads, --tabela-pura, --semantica, --avisos, --tempo "
+     "e --limite-*"},
+    {OPT_CONTADORES, OPT_ONLY(OPT_ARQUIVO | OPT_TABELA_PURA | OPT_LIMITES), 0,
+     "--contadores só pode ser usado com --tabela-pura, --limite-* e um único arquivo"},
+    {OPT_FORMAT, OPT_ONLY(OPT_ARQUIVO | OPT_TEMPO), 0,
+     "--format só pode ser usado com --tempo e um único arquivo"},
+    {OPT_LEXICO, OPT_ONLY(OPT_ARQUIVO | OPT_TEMPO), 0,
+     "--lexico só pode ser usado com --tempo e um único arquivo"},
+    {OPT_INLINE, OPT_IR_BENCH | OPT_JIT, 0,
+     "--inline não pode ser usado com --ir-bench e --jit"},
+    {OPT_MEMO, OPT_ONLY(0), OPT_PURITY,
+     "--memo só pode ser usado com --purity"},
+    {OPT_MEMO, OPT_JIT | OPT_INLINE, 0,
+     "--memo não pode ser usado com --jit e --inline"},
+    {OPT_CALLGRAPH, OPT_VARIOS_ARQUIVOS, 0,
+     "--callgraph analisa um único arquivo"},
+    /* Com --callgraph, --threads é o número de threads da análise por componente */
+    {OPT_THREADS,
+     OPT_AST | OPT_EMIT_C | OPT_SALVAR_AST | OPT_JIT | OPT_CSE | OPT_IR | OPT_IR_BENCH |
+     OPT_INLINE | OPT_PURITY | OPT_CACHE, OPT_CALLGRAPH,
+     "--threads só pode ser usado na validação simples"},
+};
+
+/*
+ * check_option_rules(given)
+ *
+ * Confere as opções dadas contra option_rules e imprime a mensagem da
+ * primeira regra violada. Retorna 0 se a combinação é válida.
+ */
+static int check_option_rules(uint64_t given) {
+    for (size_t i = 0; i < sizeof(option_rules) / sizeof(option_rules[0]); i++) {
+        const OptionRule* rule = &option_rules[i];
+        if ((given & rule->option) && !(given & rule->unless) &&
+            (given & rule->conflicts & ~rule->option)) {
+            fprintf(stderr, "%s\n", rule->message);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* ============================================================================
+ * FUNÇÃO PRINCIPAL
+ * ============================================================================ */
+
+int main(int argc, char* argv[]) {
+    const char* path = NULL;
+    const char* emit_c_path = NULL;
+    const char* cache_dir = NULL;
+    const char* index_path = NULL;
+    const char* xref_index = NULL;
+    const char* xref_name = NULL;
+    const char* save_ast_path = NULL;
+    const char* load_ast_path = NULL;
+    const char* batch_origin = NULL;
+    const char* watch_dir = NULL;
+    int watch_debounce_ms = WATCH_DEFAULT_DEBOUNCE_MS;
+    const char* ir_passes_spec = IR_DEFAULT_PIPELINE;
+    IrPipeline ir_pipeline;
+    size_t cache_mb = RESULT_CACHE_DEFAULT_MB;
+    int thread_count = 0;
+    char** paths = (char**)malloc(sizeof(char*) * (size_t)argc);
+    int path_count = 0;
+    int print_ast = 0;
+    int use_jit = 0;
+    int show_time = 0;
+    int show_callgraph = 0;
+    int show_cse = 0;
+    int show_ir = 0;
+    int ir_rounds = 0;
+    int use_inline = 0;
+    IrInlineOptions inline_options;
+    int show_purity = 0;
+    int use_memo = 0;
+    int format = 0;
+    int lex = 0;
+    int profile = 0;
+    int bad_usage = 0;
+    int first_program_arg = argc;
+    ParseLimits limits = {0};
+    int limit_status;
+    uint64_t given = 0;
+    ir_inline_defaults(&inline_options);
+
+    for (int i = 1; i < argc; i++) {
+        if (path != NULL && (use_jit || (use_inline && !show_ir) || use_memo)) {
+            first_program_arg = i;  /* Restante: argumentos do programa */
+            break;
+        } else if (strcmp(argv[i], "--tabela-pura") == 0) {
+            expr_fast_path = 0;   /* Expressões também pela tabela LL(1) */
+            given |= OPT_TABELA_PURA;
+        } else if (strcmp(argv[i], "--semantica") == 0) {
+            check_semantics = 1;
+            given |= OPT_SEMANTICA;
+        } else if (strcmp(argv[i], "--avisos") == 0) {
+            check_warnings = 1;
+            given |= OPT_AVISOS;
+        } else if (strcmp(argv[i], "--ast") == 0) {
+            print_ast = 1;
+            given |= OPT_AST;
+        } else if (strcmp(argv[i], "--emit-c") == 0 && i + 1 < argc) {
+            emit_c_path = argv[++i];
+            given |= OPT_EMIT_C;
+        } else if (strcmp(argv[i], "--jit") == 0) {
+            use_jit = 1;
+            given |= OPT_JIT;
+        } else if (strcmp(argv[i], "--callgraph") == 0) {
+            show_callgraph = 1;
+            given |= OPT_CALLGRAPH;
+        } else if (strcmp(argv[i], "--cse") == 0) {
+            show_cse = 1;
+            given |= OPT_CSE;
+        } else if (strcmp(argv[i], "--ir") == 0) {
+            show_ir = 1;
+            given |= OPT_IR;
+        } else if (strcmp(argv[i], "--ir-passes") == 0 && i + 1 < argc) {
+            ir_passes_spec = argv[++i];
+            given |= OPT_IR_PASSES;
+        } else if (strcmp(argv[i], "--ir-bench") == 0 && i + 1 < argc) {
+            ir_rounds = atoi(argv[++i]);
+            bad_usage |= ir_rounds < 1;
+            given |= OPT_IR_BENCH;
+        } else if (strcmp(argv[i], "--inline") == 0) {
+            use_inline = 1;
+            given |= OPT_INLINE;
+        } else if (strcmp(argv[i], "--inline-tamanho") == 0 && i + 1 < argc) {
+            inline_options.max_callee_size = atoi(argv[++i]);
+            bad_usage |= inline_options.max_callee_size < 0;
+            given |= OPT_INLINE_TAMANHO;
+        } else if (strcmp(argv[i], "--purity") == 0) {
+            show_purity = 1;
+            given |= OPT_PURITY;
+        } else if (strcmp(argv[i], "--memo") == 0) {
+            use_memo = 1;
+            given |= OPT_MEMO;
+        } else if (strcmp(argv[i], "--format") == 0) {
+            format = 1;
+            given |= OPT_FORMAT;
+        } else if (strcmp(argv[i], "--lexico") == 0) {
+            lex = 1;
+            given |= OPT_LEXICO;
+        } else if (strcmp(argv[i], "--contadores") == 0) {
+            profile = 1;
+            given |= OPT_CONTADORES;
+        } else if (strcmp(argv[i], "--tempo") == 0) {
+            show_time = 1;
+            given |= OPT_TEMPO;
+        } else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc) {
+            cache_dir = argv[++i];
+            given |= OPT_CACHE;
+        } else if (strcmp(argv[i], "--cache-max-mb") == 0 && i + 1 < argc) {
+            cache_mb = strtoul(argv[++i], NULL, 10);
+            given |= OPT_CACHE_MAX_MB;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            thread_count = atoi(argv[++i]);
+            bad_usage |= thread_count < 1;
+            given |= OPT_THREADS;
+        } else if (strcmp(argv[i], "--indexar") == 0 && i + 1 < argc) {
+            index_path = argv[++i];
+            given |= OPT_INDEXAR;
+        } else if (strcmp(argv[i], "--xref") == 0 && i + 2 < argc) {
+            xref_index = argv[++i];
+            xref_name = argv[++i];
+            given |= OPT_XREF;
+        } else if (strcmp(argv[i], "--salvar-ast") == 0 && i + 1 < argc) {
+            save_ast_path = argv[++i];
+            given |= OPT_SALVAR_AST;
+        } else if (strcmp(argv[i], "--ler-ast") == 0 && i + 1 < argc) {
+            load_ast_path = argv[++i];
+            given |= OPT_LER_AST;
+        } else if (strcmp(argv[i], "--lote") == 0 && i + 1 < argc) {
+            batch_origin = argv[++i];
+            given |= OPT_LOTE;
+        } else if (strcmp(argv[i], "--watch") == 0 && i + 1 < argc) {
+            watch_dir = argv[++i];
+            given |= OPT_WATCH;
+        } else if (strcmp(argv[i], "--watch-ms") == 0 && i + 1 < argc) {
+            watch_debounce_ms = atoi(argv[++i]);
+            bad_usage |= watch_debounce_ms < 0;
+            given |= OPT_WATCH_MS;
+        } else if (i + 1 < argc &&
+                   (limit_status = parser_limit_option(argv[i], argv[i + 1], &limits)) != 0) {
+            bad_usage |= limit_status < 0;
+            given |= OPT_LIMITES;
+            i++;
+        } else if ((path == NULL || thread_count > 0 || index_path != NULL) && argv[i][0] != '-') {
+            if (path == NULL) {
+                path = argv[i];
+            }
+            given |= path_count > 0 ? OPT_VARIOS_ARQUIVOS : OPT_ARQUIVO;
+            paths[path_count++] = argv[i];      /* Com --threads ou --indexar, vários arquivos */
+        } else {
+            bad_usage = 1;
+        }
+    }
+
+    if (!bad_usage && check_option_rules(given) != 0) {
+        return 1;
+    }
+
+    if (given & OPT_LIMITES) {
+        parser_set_limits(&limits);
+    }
+
+    if (watch_dir != NULL && !bad_usage) {
+        return watch_tree(watch_dir, thread_count, watch_debounce_ms);
+    }
+
+    if (batch_origin != NULL && !bad_usage) {
+        return validate_batch(batch_origin, thread_count, show_time);
+    }
+
+    if (xref_index != NULL && path == NULL && index_path == NULL && !bad_usage) {
+        return query_index(xref_index, xref_name, show_time);
+    }
+
+    if (load_ast_path != NULL && !bad_usage) {
+        return load_binary_ast(load_ast_path, path, print_ast, show_time);
+    }
+
+    if (index_path != NULL && xref_index == NULL && !bad_usage) {
+        return update_index(index_path, paths, path_count, thread_count, show_time);
+    }
+
+    if (path == NULL || bad_usage) {
+        fprintf(stderr, "Uso: %s [--tabela-pura] [--semantica] [--avisos] [--cse] [--ir] [--ir-bench <n>] [--ir-passes <lista>] [--ast] [--emit-c <saida.c>] [--salvar-ast <arquivo>] [--tempo] <arquivo.lsi>\n"
+                        "     %s [--semantica] [--tempo] --jit <arquivo.lsi> [argumentos...]\n"
+                        "     %s [--ir] [--ir-passes <lista>] [--inline-tamanho <n>] [--tempo] --inline <arquivo.lsi> [argumentos...]\n"
+                        "     %s [--ir-passes <lista>] [--tempo] --purity [--memo] <arquivo.lsi> [argumentos...]\n"
+                        "     %s --cache <diretório> [--cache-max-mb <n>] <arquivo.lsi>\n"
+                        "     %s --threads <n> [--tabela-pura] [--semantica] [--avisos] [--tempo] <arquivo.lsi>...\n"
+                        "     %s --callgraph [--threads <n>] [--semantica] [--avisos] [--tempo] <arquivo.lsi>\n"
+                        "     %s --format [--tempo] <arquivo.lsi>\n"
+                        "     %s --lexico [--tempo] <arquivo.lsi>\n"
+                        "     %s --contadores [--tabela-pura] <arquivo.lsi>\n"
+                        "     %s --indexar <índice> [--threads <n>] [--tempo] [<arquivo.lsi>...]\n"
+                        "     %s --xref <índice> <nome> [--tempo]\n"
+                        "     %s --ler-ast <arquivo> [--ast] [--tempo] [<arquivo.lsi>]\n"
+                        "     %s --lote <manifesto|diretório|-> [--threads <n>] [--semantica] [--avisos] [--tempo]\n"
+                        "     %s --watch <diretório> [--watch-ms <n>] [--threads <n>] [--semantica] [--avisos]\n"
+                        "Orçamentos de cada análise: " PARSE_LIMIT_OPTIONS "\n",
+                argv[0], argv[0], argv[0], argv[0], argv[0], argv[0], argv[0], argv[0], argv[0],
+                argv[0], argv[0], argv[0], argv[0], argv[0], argv[0]);
+        return 1;
+    }
+
+    if (profile) {
+        return profile_phases(path);
+    }
+
+    if (format || lex) {
+        return format ? format_to_stdout(path, show_time) : lex_only(path, show_time);
+    }
+
+    if ((show_ir || ir_rounds > 0 || use_inline || use_memo) &&
+        parse_ir_passes(&ir_pipeline, ir_passes_spec) != 0) {
+        return 1;
+    }
+
+    if (thread_count > 0 && !show_callgraph) {
+        return validate_parallel(paths, path_count, thread_count, show_time);
+    }
+
+    if (cache_dir != NULL && !print_ast && emit_c_path == NULL && save_ast_path == NULL &&
+        !use_jit && !check_semantics && !check_warnings && !show_callgraph && !show_cse &&
+        !show_ir && ir_rounds == 0 && !use_inline && !show_purity) {
+        return validate_cached(path, cache_dir, cache_mb);
+    }
+
+    /* O fonte é lido para a árvore binária antes da análise (astbin_source_info()) */
+    AstBinSource source;
+    if (save_ast_path != NULL && astbin_source_info(path, &source) != 0) {
+        perror("Erro ao abrir arquivo");
+        return 1;
+    }
+
+    /* Abre arquivo de entrada */
+    FILE* input = fopen(path, "r");
+    if (!input) {
+        perror("Erro ao abrir arquivo");
+        return 1;
+    }
+
+    /* Executa análise sintática */
+    Diagnostic diag;
+    AstNode* program = parse_file(input, &diag);
+    fclose(input);
+
+    if (program == NULL) {
+        diagnostic_print(stderr, &diag);
+        return 1;
+    }
+    printf("\nAnálise Sintática concluída com sucesso!\n");
+
+    if (check_semantics && report_semantics(program) != 0) {
+        return 1;
+    }
+
+    if (show_callgraph) {
+        report_callgraph(program, thread_count, show_time);
+    } else if (check_warnings) {
+        report_warnings(program);
+    }
+
+    if (show_cse) {
+        report_cse(program, show_time);
+    }
+
+    if ((show_ir || ir_rounds > 0) &&
+        run_ir(program, &ir_pipeline, ir_passes_spec, ir_rounds,
+               use_inline ? &inline_options : NULL, show_time) != 0) {
+        return 1;
+    }
+
+    if (use_inline && !show_ir &&
+        run_inline(program, &ir_pipeline, &inline_options, argv + first_program_arg,
+                   argc - first_program_arg, show_time) != 0) {
+        return 1;
+    }
+
+    if (show_purity &&
+        run_purity(program, &ir_pipeline, use_memo, argv + first_program_arg,
+                   argc - first_program_arg, show_time) != 0) {
+        return 1;
+    }
+
+    if (print_ast) {
+        ast_print(program, 0);
+    }
+
+    if (save_ast_path != NULL && astbin_write(save_ast_path, program, &source) != 0) {
+        return 1;
+    }
+
+    /* Traduz o programa para C, se solicitado */
+    if (emit_c_path != NULL) {
+        FILE* out = fopen(emit_c_path, "w");
+        if (!out) {
+            perror("Erro ao criar arquivo de saída");
+            return 1;
+        }
+        int status = codegen_c_emit(out, program, path);
+        fclose(out);
+        if (status != 0) {
+            remove(emit_c_path);
+            return 1;
+        }
+    }
+
+    /* Executa o programa pelo JIT, se solicitado */
+    if (use_jit && run_jit(program, argv + first_program_arg,
+                           argc - first_program_arg, show_time) != 0) {
+        return 1;
+    }
+
+    ast_reset();
+    return 0;
+}
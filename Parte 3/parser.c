@@ -11,32 +11,38 @@
  *   - Tabela LL(1) construída a partir da gramática transformada
  *   - Detecção de erros sintáticos com linha e coluna
  *   - Integração com analisador léxico da Parte 1
+ *   - Caminho rápido para expressões (precedence climbing) sobre a mesma pilha
+ *   - Construção da árvore sintática por símbolos de ação na pilha
+ *   - Erros devolvidos como diagnósticos, sem encerrar o processo
+ *   - Orçamentos de tokens, profundidade, lexemas, memória e tempo
  *
  * Funcionamento:
  *   1. Inicializa a pilha com símbolo inicial (NT_MAIN) e EOF
  *   2. Consulta a tabela[não-terminal][terminal] para obter regra de produção
  *   3. Aplica a regra empilhando símbolos na ordem reversa
  *   4. Compara terminais do topo da pilha com tokens da entrada
- *   5. Repete até pilha vazia ou erro encontrado
+ *   5. Executa símbolos de ação, que montam a árvore sintática
+ *   6. Repete até pilha vazia ou erro encontrado
  *
  * ============================================================================
  */
 
+#include <inttypes.h>
+#include <setjmp.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include "lexer.h"
+#include "parser.h"
 
 /* ============================================================================
  * DECLARAÇÕES EXTERNAS DO LEXER
  * ============================================================================ */
 
-extern FILE* inputFile;
-extern int line;
-extern int col;
-extern char currentChar;
-extern void advance(void);
 extern Token getToken(void);
 extern void symtable_init(void);
+extern void lexer_reset(FILE* input);
 
 /* ============================================================================
  * ENUMERAÇÃO DOS NÃO-TERMINAIS DA GRAMÁTICA
@@ -76,36 +82,79 @@ typedef enum {
     NT_FACTOR               /* Fator */
 } NonTerminal;
 
+/* ============================================================================
+ * ENUMERAÇÃO DAS AÇÕES SEMÂNTICAS
+ * ============================================================================
+ *
+ * Símbolos de ação são empilhados junto com o lado direito das produções.
+ * Quando chegam ao topo, montam nós da árvore a partir da pilha semântica:
+ * terminais id, num e operadores empilham folhas ao serem consumidos, e
+ * ACT_MARK delimita listas de tamanho variável.
+ */
+
+typedef enum {
+    ACT_MARK,               /* Empilha marcador com a posição do token atual */
+    ACT_PROGRAM,            /* Programa: tudo acima do marcador */
+    ACT_FDEF,               /* def id ( PARLIST ) { STMTLIST } */
+    ACT_VARDECL,            /* int VARLIST ; */
+    ACT_ASSIGN,             /* id = ATRIBST_TAIL */
+    ACT_FCALL,              /* id ( PARLISTCALL ) */
+    ACT_PRINT,              /* print EXPR */
+    ACT_RETURN,             /* return RETURN_TAIL */
+    ACT_IF,                 /* if ( EXPR ) { STMT } IF_TAIL */
+    ACT_BLOCK,              /* { STMTLIST } */
+    ACT_EMPTY,              /* ; */
+    ACT_BINOP               /* operando operador operando */
+} SemanticAction;
+
 /* ============================================================================
  * ESTRUTURA DE SÍMBOLOS DA PILHA
  * ============================================================================ */
 
+typedef enum {
+    SYM_TERMINAL,
+    SYM_NON_TERMINAL,
+    SYM_ACTION
+} SymbolKind;
+
 typedef struct {
-    int is_terminal;        /* 1 se terminal, 0 se não-terminal */
+    SymbolKind kind;        /* Terminal, não-terminal ou ação semântica */
     union {
         TokenType terminal;        /* Tipo do token (se terminal) */
         NonTerminal non_terminal;  /* Tipo do não-terminal */
+        SemanticAction action;     /* Ação (se símbolo de ação) */
     } value;
 } StackSymbol;
 
 /* ============================================================================
  * PILHA DE PARSING
- * ============================================================================ */
+ * ============================================================================
+ *
+ * Cresce sob demanda até o orçamento de profundidade (stack_grow()).
+ */
+
+__thread StackSymbol* parse_stack = NULL;
+__thread int stack_top = -1;
+static __thread int stack_capacity = 0;
+
+/*
+ * Um erro interrompe a análise de qualquer ponto da pilha de chamadas:
+ * o diagnóstico é preenchido em parse_diag e longjmp volta a parse_file().
+ */
+static __thread jmp_buf parse_abort;
+static __thread Diagnostic* parse_diag;
 
-#define STACK_SIZE 200
-StackSymbol parse_stack[STACK_SIZE];
-int stack_top = -1;
+static void stack_grow(void);      /* Em ORÇAMENTOS DA ANÁLISE */
 
 /*
  * stack_push(symbol)
  *
  * Empilha um símbolo na pilha de parsing.
- * Verifica overflow antes de empilhar.
+ * Aumenta a pilha, ou esgota o orçamento de profundidade, quando está cheia.
  */
 void stack_push(StackSymbol symbol) {
-    if (stack_top >= STACK_SIZE - 1) {
-        fprintf(stderr, "Erro fatal: Estouro da pilha do parser.\n");
-        exit(1);
+    if (stack_top + 1 >= stack_capacity) {
+        stack_grow();
     }
     parse_stack[++stack_top] = symbol;
 }
@@ -118,8 +167,8 @@ void stack_push(StackSymbol symbol) {
  */
 StackSymbol stack_pop() {
     if (stack_top < 0) {
-        fprintf(stderr, "Erro fatal: Pilha do parser vazia.\n");
-        exit(1);
+        diagnostic_set(parse_diag, DIAG_FATAL, 0, 0, "Erro fatal: Pilha do parser vazia.");
+        longjmp(parse_abort, 1);
     }
     return parse_stack[stack_top--];
 }
@@ -130,7 +179,7 @@ StackSymbol stack_pop() {
  * Cria um símbolo terminal com o tipo especificado.
  */
 StackSymbol create_terminal_symbol(TokenType type) {
-    return (StackSymbol){.is_terminal = 1, .value.terminal = type};
+    return (StackSymbol){.kind = SYM_TERMINAL, .value.terminal = type};
 }
 
 /*
@@ -139,7 +188,16 @@ StackSymbol create_terminal_symbol(TokenType type) {
  * Cria um símbolo não-terminal com o tipo especificado.
  */
 StackSymbol create_non_terminal_symbol(NonTerminal type) {
-    return (StackSymbol){.is_terminal = 0, .value.non_terminal = type};
+    return (StackSymbol){.kind = SYM_NON_TERMINAL, .value.non_terminal = type};
+}
+
+/*
+ * create_action_symbol(action)
+ *
+ * Cria um símbolo de ação semântica.
+ */
+StackSymbol create_action_symbol(SemanticAction action) {
+    return (StackSymbol){.kind = SYM_ACTION, .value.action = action};
 }
 
 /* ============================================================================
@@ -270,6 +328,9 @@ ProductionRule parse_table[31][30];
  * Exemplo: Para a regra STMT → int VARLIST ;
  * Empilha: ;, VARLIST, int (nesta ordem)
  * Assim, int será processado primeiro (topo da pilha)
+ *
+ * Os símbolos de ação entram no lado direito como se fossem símbolos da
+ * gramática: STMT → #MARK int VARLIST ; #VARDECL.
  */
 void apply_rule(ProductionRule rule) {
     switch (rule) {
@@ -285,9 +346,11 @@ void apply_rule(ProductionRule rule) {
 
         /* Regras STMT */
         case RULE_STMT_INT:
+            stack_push(create_action_symbol(ACT_VARDECL));
             stack_push(create_terminal_symbol(TOKEN_SEMICOLON));
             stack_push(create_non_terminal_symbol(NT_VARLIST));
             stack_push(create_terminal_symbol(TOKEN_INT));
+            stack_push(create_action_symbol(ACT_MARK));
             break;
         case RULE_STMT_ATRIB:
             stack_push(create_terminal_symbol(TOKEN_SEMICOLON));
@@ -305,12 +368,16 @@ void apply_rule(ProductionRule rule) {
             stack_push(create_non_terminal_symbol(NT_IFSTMT));
             break;
         case RULE_STMT_BLOCK:
+            stack_push(create_action_symbol(ACT_BLOCK));
             stack_push(create_terminal_symbol(TOKEN_RBRACE));
             stack_push(create_non_terminal_symbol(NT_STMTLIST));
             stack_push(create_terminal_symbol(TOKEN_LBRACE));
+            stack_push(create_action_symbol(ACT_MARK));
             break;
         case RULE_STMT_SEMICOLON:
+            stack_push(create_action_symbol(ACT_EMPTY));
             stack_push(create_terminal_symbol(TOKEN_SEMICOLON));
+            stack_push(create_action_symbol(ACT_MARK));
             break;
 
         /* Regras FLIST */
@@ -327,14 +394,17 @@ void apply_rule(ProductionRule rule) {
 
         /* Regra FDEF */
         case RULE_FDEF:
+            stack_push(create_action_symbol(ACT_FDEF));
             stack_push(create_terminal_symbol(TOKEN_RBRACE));
             stack_push(create_non_terminal_symbol(NT_STMTLIST));
             stack_push(create_terminal_symbol(TOKEN_LBRACE));
+            stack_push(create_action_symbol(ACT_MARK));
             stack_push(create_terminal_symbol(TOKEN_RPAREN));
             stack_push(create_non_terminal_symbol(NT_PARLIST));
             stack_push(create_terminal_symbol(TOKEN_LPAREN));
             stack_push(create_terminal_symbol(TOKEN_ID));
             stack_push(create_terminal_symbol(TOKEN_DEF));
+            stack_push(create_action_symbol(ACT_MARK));
             break;
 
         /* Regras PARLIST */
@@ -366,6 +436,7 @@ void apply_rule(ProductionRule rule) {
 
         /* Regras ATRIBST */
         case RULE_ATRIBST:
+            stack_push(create_action_symbol(ACT_ASSIGN));
             stack_push(create_non_terminal_symbol(NT_ATRIBST_TAIL));
             stack_push(create_terminal_symbol(TOKEN_ASSIGN));
             stack_push(create_terminal_symbol(TOKEN_ID));
@@ -379,8 +450,10 @@ void apply_rule(ProductionRule rule) {
 
         /* Regras FCALL */
         case RULE_FCALL:
+            stack_push(create_action_symbol(ACT_FCALL));
             stack_push(create_terminal_symbol(TOKEN_RPAREN));
             stack_push(create_non_terminal_symbol(NT_PARLISTCALL));
+            stack_push(create_action_symbol(ACT_MARK));
             stack_push(create_terminal_symbol(TOKEN_LPAREN));
             stack_push(create_terminal_symbol(TOKEN_ID));
             break;
@@ -399,12 +472,16 @@ void apply_rule(ProductionRule rule) {
 
         /* Regras PRINTST e RETURNST */
         case RULE_PRINTST:
+            stack_push(create_action_symbol(ACT_PRINT));
             stack_push(create_non_terminal_symbol(NT_EXPR));
             stack_push(create_terminal_symbol(TOKEN_PRINT));
+            stack_push(create_action_symbol(ACT_MARK));
             break;
         case RULE_RETURNST:
+            stack_push(create_action_symbol(ACT_RETURN));
             stack_push(create_non_terminal_symbol(NT_RETURN_TAIL));
             stack_push(create_terminal_symbol(TOKEN_RETURN));
+            stack_push(create_action_symbol(ACT_MARK));
             break;
         case RULE_RETURN_TAIL_ID:
             stack_push(create_terminal_symbol(TOKEN_ID));
@@ -414,6 +491,7 @@ void apply_rule(ProductionRule rule) {
 
         /* Regras IFSTMT */
         case RULE_IFSTMT:
+            stack_push(create_action_symbol(ACT_IF));
             stack_push(create_non_terminal_symbol(NT_IF_TAIL));
             stack_push(create_terminal_symbol(TOKEN_RBRACE));
             stack_push(create_non_terminal_symbol(NT_STMT));
@@ -422,6 +500,7 @@ void apply_rule(ProductionRule rule) {
             stack_push(create_non_terminal_symbol(NT_EXPR));
             stack_push(create_terminal_symbol(TOKEN_LPAREN));
             stack_push(create_terminal_symbol(TOKEN_IF));
+            stack_push(create_action_symbol(ACT_MARK));
             break;
         case RULE_IF_TAIL_ELSE:
             stack_push(create_terminal_symbol(TOKEN_RBRACE));
@@ -450,6 +529,7 @@ void apply_rule(ProductionRule rule) {
             stack_push(create_non_terminal_symbol(NT_NUMEXPR));
             break;
         case RULE_EXPR_PRIME:
+            stack_push(create_action_symbol(ACT_BINOP));
             stack_push(create_non_terminal_symbol(NT_NUMEXPR));
             stack_push(create_non_terminal_symbol(NT_RELOP));
             break;
@@ -483,6 +563,7 @@ void apply_rule(ProductionRule rule) {
             break;
         case RULE_NUMEXPR_PRIME_ADDOP:
             stack_push(create_non_terminal_symbol(NT_NUMEXPR_PRIME));
+            stack_push(create_action_symbol(ACT_BINOP));
             stack_push(create_non_terminal_symbol(NT_TERM));
             stack_push(create_non_terminal_symbol(NT_ADDOP));
             break;
@@ -504,6 +585,7 @@ void apply_rule(ProductionRule rule) {
             break;
         case RULE_TERM_PRIME_MULOP:
             stack_push(create_non_terminal_symbol(NT_TERM_PRIME));
+            stack_push(create_action_symbol(ACT_BINOP));
             stack_push(create_non_terminal_symbol(NT_FACTOR));
             stack_push(create_non_terminal_symbol(NT_MULOP));
             break;
@@ -716,10 +798,633 @@ void initialize_parse_table() {
     parse_table[NT_FACTOR][TOKEN_ID] = RULE_FACTOR_ID;
 }
 
+/* ============================================================================
+ * TOKEN CORRENTE E MENSAGENS DE ERRO SINTÁTICO
+ * ============================================================================ */
+
+static __thread Token currentToken;
+static __thread Token lookaheadToken;
+static __thread int has_lookahead = 0;
+
+static Token read_token(void);     /* Em ORÇAMENTOS DA ANÁLISE */
+static void check_lexeme_limit(void);
+
+/*
+ * next_token()
+ *
+ * Retorna o próximo token da entrada, consumindo primeiro o token
+ * guardado por peek_token(), se houver.
+ */
+static Token next_token(void) {
+    if (has_lookahead) {
+        has_lookahead = 0;
+        return lookaheadToken;
+    }
+    return read_token();
+}
+
+/*
+ * peek_token()
+ *
+ * Espia o token seguinte ao token atual sem consumi-lo.
+ */
+static Token peek_token(void) {
+    if (!has_lookahead) {
+        lookaheadToken = read_token();
+        has_lookahead = 1;
+    }
+    return lookaheadToken;
+}
+
+/*
+ * error_kind()
+ *
+ * Um TOKEN_ERROR no lugar do token esperado é um erro léxico; os demais
+ * são sintáticos. O texto da mensagem é o mesmo nos dois casos.
+ */
+static DiagnosticKind error_kind(void) {
+    return currentToken.type == TOKEN_ERROR ? DIAG_LEXICAL : DIAG_SYNTAX;
+}
+
+/*
+ * syntax_error_expected(expected)
+ *
+ * Reporta que o terminal do topo da pilha não coincide com o token atual.
+ */
+static void syntax_error_expected(TokenType expected) {
+    check_lexeme_limit();
+    int64_t line, col;
+    lexer_position(currentToken.offset, &line, &col);
+    diagnostic_set(parse_diag, error_kind(), line, col,
+                   "--- Erro Sintático ---\n"
+                   "Esperado: %s\n"
+                   "Encontrado: '%s' (%s) na linha %" PRId64 ", coluna %" PRId64,
+                   token_type_to_string(expected),
+                   currentToken.lexeme, token_type_to_string(currentToken.type),
+                   line, col);
+    longjmp(parse_abort, 1);
+}
+
+/*
+ * syntax_error_unexpected()
+ *
+ * Reporta uma combinação (não-terminal, terminal) sem regra na tabela.
+ */
+static void syntax_error_unexpected(void) {
+    check_lexeme_limit();
+    int64_t line, col;
+    lexer_position(currentToken.offset, &line, &col);
+    diagnostic_set(parse_diag, error_kind(), line, col,
+                   "--- Erro Sintático ---\n"
+                   "Token inesperado: '%s' (%s)\n"
+                   "Localização: linha %" PRId64 ", coluna %" PRId64,
+                   currentToken.lexeme, token_type_to_string(currentToken.type),
+                   line, col);
+    longjmp(parse_abort, 1);
+}
+
+/* ============================================================================
+ * PRECEDÊNCIA DOS OPERADORES BINÁRIOS
+ * ============================================================================ */
+
+#define PREC_NONE 0
+#define PREC_REL  1
+#define PREC_ADD  2
+#define PREC_MUL  3
+
+/*
+ * binary_precedence(type)
+ *
+ * Retorna a precedência do operador binário, ou PREC_NONE se o token
+ * não é operador.
+ */
+static int binary_precedence(TokenType type) {
+    switch (type) {
+        case TOKEN_MULT:
+        case TOKEN_DIV:
+            return PREC_MUL;
+        case TOKEN_PLUS:
+        case TOKEN_MINUS:
+            return PREC_ADD;
+        case TOKEN_LT:
+        case TOKEN_LTE:
+        case TOKEN_GT:
+        case TOKEN_GTE:
+        case TOKEN_EQ:
+        case TOKEN_NEQ:
+            return PREC_REL;
+        default:
+            return PREC_NONE;
+    }
+}
+
+/* ============================================================================
+ * PILHA SEMÂNTICA E AÇÕES DE CONSTRUÇÃO DA ÁRVORE
+ * ============================================================================
+ *
+ * Cresce sob demanda, pois o corpo de uma função acumula um nó por comando
+ * até o ACT_FDEF correspondente.
+ */
+
+static __thread AstNode** semantic_stack = NULL;
+static __thread int semantic_top = -1;
+static __thread int semantic_capacity = 0;
+
+/*
+ * semantic_push(node)
+ *
+ * Empilha um nó na pilha semântica.
+ */
+static void semantic_push(AstNode* node) {
+    if (semantic_top + 1 >= semantic_capacity) {
+        semantic_capacity = semantic_capacity ? semantic_capacity * 2 : 256;
+        semantic_stack = (AstNode**)realloc(semantic_stack,
+                                            sizeof(AstNode*) * (size_t)semantic_capacity);
+        if (semantic_stack == NULL) {
+            fprintf(stderr, "Erro fatal: Memória insuficiente para a pilha semântica.\n");
+            exit(1);
+        }
+    }
+    semantic_stack[++semantic_top] = node;
+}
+
+/*
+ * semantic_pop()
+ *
+ * Desempilha e retorna o nó do topo da pilha semântica.
+ */
+static AstNode* semantic_pop(void) {
+    return semantic_stack[semantic_top--];
+}
+
+/*
+ * new_node_at(kind, name, token)
+ *
+ * Cria um nó na posição do token, convertida em linha e coluna.
+ */
+static AstNode* new_node_at(AstKind kind, const char* name, Token token) {
+    int line, col;
+    lexer_position_int(token.offset, &line, &col);
+    return ast_new(kind, name, line, col);
+}
+
+/*
+ * push_leaf(token)
+ *
+ * Empilha a folha correspondente a um terminal consumido: identificadores,
+ * números e operadores binários. Os demais terminais não geram nós.
+ */
+static void push_leaf(Token token) {
+    if (token.type == TOKEN_ID || token.type == TOKEN_NUM) {
+        AstNode* node = new_node_at(token.type == TOKEN_ID ? AST_ID : AST_NUM, token.lexeme, token);
+        node->value = token.value;
+        semantic_push(node);
+    } else if (binary_precedence(token.type) != PREC_NONE) {
+        AstNode* node = new_node_at(AST_BINOP, NULL, token);
+        node->op = token.type;
+        semantic_push(node);
+    }
+}
+
+/*
+ * close_mark(kind)
+ *
+ * Transforma o marcador mais próximo do topo em um nó do tipo indicado,
+ * cujos filhos são todos os nós empilhados acima dele.
+ */
+static AstNode* close_mark(AstKind kind) {
+    int mark = semantic_top;
+    while (semantic_stack[mark]->kind != AST_MARK) {
+        mark--;
+    }
+
+    AstNode* node = semantic_stack[mark];
+    node->kind = kind;
+    node->kid_count = semantic_top - mark;
+    node->kids = ast_alloc_list(node->kid_count);
+    for (int i = 0; i < node->kid_count; i++) {
+        node->kids[i] = semantic_stack[mark + 1 + i];
+    }
+    semantic_top = mark - 1;
+    return node;
+}
+
+/*
+ * reduce_binop()
+ *
+ * Combina "esquerda operador direita" do topo da pilha semântica em um
+ * único nó AST_BINOP.
+ */
+static void reduce_binop(void) {
+    AstNode* right = semantic_pop();
+    AstNode* node = semantic_pop();
+    AstNode* left = semantic_pop();
+    node->kids = ast_alloc_list(2);
+    node->kids[0] = left;
+    node->kids[1] = right;
+    node->kid_count = 2;
+    semantic_push(node);
+}
+
+/*
+ * run_action(action)
+ *
+ * Executa uma ação semântica retirada da pilha de parsing.
+ */
+static void run_action(SemanticAction action) {
+    AstNode* node;
+    AstNode* body;
+    AstNode* target;
+
+    switch (action) {
+        case ACT_MARK:
+            semantic_push(new_node_at(AST_MARK, NULL, currentToken));
+            break;
+        case ACT_PROGRAM:
+            semantic_push(close_mark(AST_PROGRAM));
+            break;
+        case ACT_FDEF:
+            /* Filhos do marcador externo: nome da função seguido dos parâmetros */
+            body = close_mark(AST_BLOCK);
+            node = close_mark(AST_FDEF);
+            node->name = node->kids[0]->name;
+            node->value = node->kids[0]->value;
+            node->params = node->kids + 1;
+            node->param_count = node->kid_count - 1;
+            node->kids = body->kids;
+            node->kid_count = body->kid_count;
+            semantic_push(node);
+            break;
+        case ACT_VARDECL:
+            semantic_push(close_mark(AST_VARDECL));
+            break;
+        case ACT_ASSIGN:
+            body = semantic_pop();
+            target = semantic_pop();
+            node = ast_new(AST_ASSIGN, target->name, target->line, target->col);
+            node->value = target->value;
+            node->kids = ast_alloc_list(1);
+            node->kids[0] = body;
+            node->kid_count = 1;
+            semantic_push(node);
+            break;
+        case ACT_FCALL:
+            node = close_mark(AST_FCALL);
+            target = semantic_pop();
+            node->name = target->name;
+            node->value = target->value;
+            node->line = target->line;
+            node->col = target->col;
+            semantic_push(node);
+            break;
+        case ACT_PRINT:
+            semantic_push(close_mark(AST_PRINT));
+            break;
+        case ACT_RETURN:
+            semantic_push(close_mark(AST_RETURN));
+            break;
+        case ACT_IF:
+            semantic_push(close_mark(AST_IF));
+            break;
+        case ACT_BLOCK:
+            semantic_push(close_mark(AST_BLOCK));
+            break;
+        case ACT_EMPTY:
+            semantic_push(close_mark(AST_EMPTY));
+            break;
+        case ACT_BINOP:
+            reduce_binop();
+            break;
+    }
+}
+
+/* ============================================================================
+ * CAMINHO RÁPIDO DE EXPRESSÕES (PRECEDENCE CLIMBING)
+ * ============================================================================
+ *
+ * Pela tabela, cada operando percorre EXPR → NUMEXPR → TERM → FACTOR e
+ * empilha/desempilha EXPR_PRIME, NUMEXPR_PRIME e TERM_PRIME, de modo que
+ * até "a = b;" custa cerca de dez operações de pilha. Quando o topo da pilha
+ * é NT_EXPR ou NT_NUMEXPR, o parser entrega o controle a este analisador de
+ * precedência de operadores, que consome a expressão inteira em um único laço.
+ *
+ * Os operadores pendentes e os parênteses abertos ficam na própria
+ * parse_stack, acima do ponto de entrega, de modo que o orçamento de
+ * profundidade continua valendo. As mensagens de erro são as mesmas do caminho pela
+ * tabela: após cada fator a tabela está em TERM_PRIME, e é a linha
+ * parse_table[NT_TERM_PRIME] que decide se o token seguinte é aceitável.
+ *
+ * Precedências (maior liga mais forte; todos associativos à esquerda):
+ *   3: * /
+ *   2: + -
+ *   1: < <= > >= == != (no máximo um por EXPR e nunca entre parênteses)
+ */
+
+int expr_fast_path = 1;
+
+/*
+ * reduce_operator()
+ *
+ * Desempilha um operador pendente e monta seu nó com os dois operandos
+ * do topo da pilha semântica.
+ */
+static void reduce_operator(void) {
+    stack_pop();
+    reduce_binop();
+}
+
+/*
+ * parse_expression_fast(nt)
+ *
+ * Reconhece uma EXPR (que admite um operador relacional no nível externo)
+ * ou uma NUMEXPR (que não admite), no lugar da expansão pela tabela.
+ *
+ * O laço alterna dois estados: esperando operando (num, id ou '(') e
+ * esperando operador. Um operador só é empilhado depois de reduzir os
+ * pendentes de precedência maior ou igual, o que dá associatividade à
+ * esquerda. A expressão termina no primeiro token que não a continua,
+ * que fica para o restante da pilha verificar.
+ */
+static void parse_expression_fast(NonTerminal nt) {
+    int base = stack_top;
+    int open_parens = 0;
+    int relop_allowed = (nt == NT_EXPR);
+
+    for (;;) {
+        /* Esperando operando: abre parênteses até encontrar num ou id */
+        while (currentToken.type == TOKEN_LPAREN) {
+            stack_push(create_terminal_symbol(TOKEN_LPAREN));
+            open_parens++;
+            currentToken = next_token();
+        }
+        if (currentToken.type != TOKEN_NUM && currentToken.type != TOKEN_ID) {
+            syntax_error_unexpected();
+        }
+        push_leaf(currentToken);
+        currentToken = next_token();
+
+        /* Esperando operador: fecha parênteses e trata o fim da expressão */
+        for (;;) {
+            if (parse_table[NT_TERM_PRIME][currentToken.type] == RULE_ERROR) {
+                syntax_error_unexpected();
+            }
+            if (currentToken.type != TOKEN_RPAREN || open_parens == 0) {
+                break;
+            }
+            while (parse_stack[stack_top].value.terminal != TOKEN_LPAREN) {
+                reduce_operator();
+            }
+            stack_pop();
+            open_parens--;
+            currentToken = next_token();
+        }
+
+        int prec = binary_precedence(currentToken.type);
+        if (prec == PREC_REL && (!relop_allowed || open_parens > 0)) {
+            prec = PREC_NONE;
+        }
+        if (prec == PREC_NONE) {
+            if (open_parens > 0) {
+                syntax_error_expected(TOKEN_RPAREN);
+            }
+            while (stack_top > base) {
+                reduce_operator();
+            }
+            return;
+        }
+
+        while (stack_top > base &&
+               parse_stack[stack_top].value.terminal != TOKEN_LPAREN &&
+               binary_precedence(parse_stack[stack_top].value.terminal) >= prec) {
+            reduce_operator();
+        }
+        if (prec == PREC_REL) {
+            relop_allowed = 0;
+        }
+        stack_push(create_terminal_symbol(currentToken.type));
+        push_leaf(currentToken);
+        currentToken = next_token();
+    }
+}
+
+/* ============================================================================
+ * ORÇAMENTOS DA ANÁLISE
+ * ============================================================================
+ *
+ * Os limites valem para o processo (parser_set_limits()) e os contadores
+ * são de cada thread, zerados por parse_file(). No laço principal só há
+ * uma comparação por token, com next_checkpoint: o número de tokens em
+ * que é preciso conferir algo, seja o orçamento de tokens, seja a
+ * memória e o prazo, conferidos a cada PARSE_CHECK_INTERVAL tokens. A
+ * profundidade só é conferida quando a pilha precisa crescer, e o
+ * comprimento dos lexemas, pelo próprio lexer: o token de erro que ele
+ * devolve no lugar do lexema longo é reconhecido aqui quando a análise
+ * para nele.
+ */
+
+static ParseLimits limits = {0, PARSE_DEPTH_DEFAULT, 0, 0, 0};
+
+static __thread int64_t tokens_read;
+static __thread int64_t next_checkpoint;
+static __thread size_t memory_base;        /* Memória do lexer e da árvore no início */
+static __thread struct timespec parse_start;
+
+void parser_set_limits(const ParseLimits* new_limits) {
+    limits = *new_limits;
+    if (limits.max_depth <= 0) {
+        limits.max_depth = PARSE_DEPTH_DEFAULT;
+    }
+    if (limits.max_depth > PARSE_DEPTH_MAX) {
+        limits.max_depth = PARSE_DEPTH_MAX;
+    }
+    lexer_set_max_lexeme((size_t)limits.max_lexeme);
+}
+
+/*
+ * parser_limit_option(name, value, limits)
+ *
+ * value deve ser um inteiro decimal não negativo; a memória é dada em MiB.
+ */
+int parser_limit_option(const char* name, const char* value, ParseLimits* limits) {
+    static const struct {
+        const char* name;
+        int64_t maximum;
+    } options[] = {
+        {"--limite-tokens", INT64_MAX - 1},
+        {"--limite-profundidade", PARSE_DEPTH_MAX},
+        {"--limite-lexema", INT64_MAX},
+        {"--limite-memoria-mb", INT64_MAX >> 20},
+        {"--limite-tempo-ms", INT64_MAX / 2}
+    };
+    int option = -1;
+    for (int i = 0; i < (int)(sizeof(options) / sizeof(options[0])); i++) {
+        if (strcmp(name, options[i].name) == 0) {
+            option = i;
+        }
+    }
+    if (option < 0) {
+        return 0;
+    }
+
+    int64_t number = 0;
+    if (*value == '\0') {
+        return -1;
+    }
+    for (const char* p = value; *p != '\0'; p++) {
+        if (*p < '0' || *p > '9' || number > (options[option].maximum - (*p - '0')) / 10) {
+            return -1;
+        }
+        number = number * 10 + (*p - '0');
+    }
+
+    switch (option) {
+        case 0: limits->max_tokens = number; break;
+        case 1: limits->max_depth = (int)number; break;
+        case 2: limits->max_lexeme = number; break;
+        case 3: limits->max_memory = number << 20; break;
+        case 4: limits->max_millis = number; break;
+    }
+    return 1;
+}
+
+/*
+ * limit_exceeded(token, name, maximum, unit)
+ *
+ * Termina a análise com um diagnóstico DIAG_LIMIT na posição do token.
+ */
+static void limit_exceeded(Token token, const char* name, int64_t maximum, const char* unit) {
+    int64_t line, col;
+    lexer_position(token.offset, &line, &col);
+    diagnostic_set(parse_diag, DIAG_LIMIT, line, col,
+                   "--- Limite de Recursos Excedido ---\n"
+                   "Orçamento esgotado: %s (máximo %lld %s)\n"
+                   "Localização: linha %" PRId64 ", coluna %" PRId64,
+                   name, (long long)maximum, unit, line, col);
+    longjmp(parse_abort, 1);
+}
+
+/*
+ * memory_in_use()
+ *
+ * Bytes alocados desde o início da análise: arena da árvore, lexemas,
+ * índice de linhas e nomes novos, mais as duas pilhas do parser.
+ */
+static size_t memory_in_use(void) {
+    return ast_memory_used() + lexer_memory_used() - memory_base +
+           sizeof(StackSymbol) * (size_t)stack_capacity +
+           sizeof(AstNode*) * (size_t)semantic_capacity;
+}
+
+static int64_t elapsed_millis(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)(now.tv_sec - parse_start.tv_sec) * 1000 +
+           (now.tv_nsec - parse_start.tv_nsec) / 1000000;
+}
+
+/*
+ * schedule_checkpoint()
+ *
+ * Calcula o próximo valor de tokens_read em que read_token() chama
+ * budget_checkpoint().
+ */
+static void schedule_checkpoint(void) {
+    next_checkpoint = INT64_MAX;
+    if (limits.max_memory > 0 || limits.max_millis > 0) {
+        next_checkpoint = tokens_read + PARSE_CHECK_INTERVAL;
+    }
+    if (limits.max_tokens > 0 && limits.max_tokens + 1 < next_checkpoint) {
+        next_checkpoint = limits.max_tokens + 1;
+    }
+}
+
+/*
+ * budget_checkpoint(token)
+ *
+ * O EOF não conta como token, de modo que um arquivo com exatamente
+ * max_tokens tokens é aceito.
+ */
+static __attribute__((noinline)) void budget_checkpoint(Token token) {
+    if (limits.max_tokens > 0 && tokens_read > limits.max_tokens && token.type != TOKEN_EOF) {
+        limit_exceeded(token, "tokens", limits.max_tokens, "tokens");
+    }
+    if (limits.max_memory > 0 && memory_in_use() > (size_t)limits.max_memory) {
+        limit_exceeded(token, "memória", limits.max_memory, "bytes");
+    }
+    if (limits.max_millis > 0 && elapsed_millis() > limits.max_millis) {
+        limit_exceeded(token, "tempo", limits.max_millis, "ms");
+    }
+    schedule_checkpoint();
+}
+
+/*
+ * read_token()
+ *
+ * Lê o próximo token da entrada, conferindo os orçamentos quando
+ * tokens_read chega a next_checkpoint.
+ */
+static inline Token read_token(void) {
+    Token token = getToken();
+    if (++tokens_read >= next_checkpoint) {
+        budget_checkpoint(token);
+    }
+    return token;
+}
+
+/*
+ * stack_grow()
+ *
+ * Dobra a pilha de parsing, até max_depth símbolos; cheia nesse tamanho,
+ * esgota o orçamento de profundidade no token atual.
+ */
+static __attribute__((noinline)) void stack_grow(void) {
+    if (stack_capacity >= limits.max_depth) {
+        limit_exceeded(currentToken, "profundidade da pilha", limits.max_depth, "símbolos");
+    }
+    int capacity = stack_capacity ? stack_capacity * 2 : 256;
+    if (capacity > limits.max_depth) {
+        capacity = limits.max_depth;
+    }
+    StackSymbol* grown = (StackSymbol*)realloc(parse_stack, sizeof(StackSymbol) * (size_t)capacity);
+    if (grown == NULL) {
+        limit_exceeded(currentToken, "memória", (int64_t)(sizeof(StackSymbol) * (size_t)capacity),
+                       "bytes");
+    }
+    parse_stack = grown;
+    stack_capacity = capacity;
+}
+
+/*
+ * check_lexeme_limit()
+ *
+ * Chamada antes de reportar um erro sintático: se a análise parou no
+ * token de erro de um lexema longo demais, o erro é o orçamento.
+ */
+static void check_lexeme_limit(void) {
+    if (currentToken.type == TOKEN_ERROR && currentToken.value == TOKEN_ERROR_LIMIT) {
+        limit_exceeded(currentToken, "comprimento de lexema", limits.max_lexeme, "bytes");
+    }
+}
+
 /* ============================================================================
  * FUNÇÃO PRINCIPAL DE PARSING
  * ============================================================================ */
 
+/*
+ * select_rule(nt)
+ *
+ * Consulta parse_table[nt][token_atual]. A única decisão que não é LL(1)
+ * é ATRIBST_TAIL → EXPR | FCALL, pois ambas começam com id: nesse caso
+ * espia mais um token e escolhe FCALL quando ele é '('.
+ */
+static ProductionRule select_rule(NonTerminal nt) {
+    if (nt == NT_ATRIBST_TAIL && currentToken.type == TOKEN_ID &&
+        peek_token().type == TOKEN_LPAREN) {
+        return RULE_ATRIBST_TAIL_FCALL;
+    }
+    return parse_table[nt][currentToken.type];
+}
+
 /*
  * parse()
  *
@@ -737,81 +1442,118 @@ void initialize_parse_table() {
  *       - Consulta tabela[X][token_atual]
  *       - Se tem regra: aplica regra (empilha lado direito)
  *       - Senão: erro sintático
- * 3. Sucesso quando pilha vazia e EOF alcançado
+ *    d) Se X é ação semântica: monta nós na pilha semântica
+ * 3. Sucesso quando pilha vazia e EOF alcançado; retorna o nó AST_PROGRAM
  */
-void parse() {
-    Token currentToken = getToken();
+static AstNode* parse(void) {
+    currentToken = next_token();
 
-    /* Inicializa pilha com EOF e símbolo inicial */
+    /* Inicializa pilha com EOF, ação do programa e símbolo inicial */
     stack_push(create_terminal_symbol(TOKEN_EOF));
+    stack_push(create_action_symbol(ACT_PROGRAM));
     stack_push(create_non_terminal_symbol(NT_MAIN));
+    stack_push(create_action_symbol(ACT_MARK));
 
     /* Loop principal do parser */
     while (stack_top > -1) {
         StackSymbol X = stack_pop();
 
-        if (X.is_terminal) {
+        if (X.kind == SYM_ACTION) {
+            /* X é uma ação semântica - monta nós da árvore */
+            run_action(X.value.action);
+        } else if (X.kind == SYM_TERMINAL) {
             /* X é um terminal - deve coincidir com token atual */
             if (X.value.terminal == currentToken.type) {
                 if (currentToken.type == TOKEN_EOF) {
-                    printf("\nAnálise Sintática concluída com sucesso!\n");
-                    return;
+                    return semantic_pop();
                 }
-                currentToken = getToken(); /* Consome token */
+                push_leaf(currentToken);
+                currentToken = next_token(); /* Consome token */
             } else {
                 /* Erro: terminal esperado não coincide */
-                fprintf(stderr, "\n--- Erro Sintático ---\n");
-                fprintf(stderr, "Esperado: %s\n", token_type_to_string(X.value.terminal));
-                fprintf(stderr, "Encontrado: '%s' (%s) na linha %d, coluna %d\n",
-                        currentToken.lexeme, token_type_to_string(currentToken.type),
-                        currentToken.line, currentToken.col);
-                exit(1);
+                syntax_error_expected(X.value.terminal);
             }
         } else {
+            /* Expressões seguem pelo caminho rápido, se habilitado */
+            if (expr_fast_path &&
+                (X.value.non_terminal == NT_EXPR || X.value.non_terminal == NT_NUMEXPR)) {
+                parse_expression_fast(X.value.non_terminal);
+                continue;
+            }
+
             /* X é não-terminal - consulta tabela para obter regra */
-            ProductionRule rule = parse_table[X.value.non_terminal][currentToken.type];
+            ProductionRule rule = select_rule(X.value.non_terminal);
 
             if (rule == RULE_ERROR) {
                 /* Erro: combinação (não-terminal, terminal) inválida */
-                fprintf(stderr, "\n--- Erro Sintático ---\n");
-                fprintf(stderr, "Token inesperado: '%s' (%s)\n",
-                        currentToken.lexeme, token_type_to_string(currentToken.type));
-                fprintf(stderr, "Localização: linha %d, coluna %d\n",
-                        currentToken.line, currentToken.col);
-                exit(1);
+                syntax_error_unexpected();
             }
 
             /* Aplica a regra de produção (empilha lado direito) */
             apply_rule(rule);
         }
     }
+    return NULL;
 }
 
-/* ============================================================================
- * FUNÇÃO PRINCIPAL
- * ============================================================================ */
+/* Incrementar quando o lexer ou o texto dos diagnósticos mudar */
+#define PARSER_RESULT_REVISION 4
 
-int main(int argc, char* argv[]) {
-    if (argc < 2) {
-        fprintf(stderr, "Uso: %s <arquivo.lsi>\n", argv[0]);
-        return 1;
-    }
+static char grammar_version[64];
 
-    /* Abre arquivo de entrada */
-    inputFile = fopen(argv[1], "r");
-    if (!inputFile) {
-        perror("Erro ao abrir arquivo");
-        return 1;
+/*
+ * parser_init()
+ *
+ * Inicializa as tabelas do lexer e do parser uma única vez por processo e
+ * calcula a versão da gramática: a revisão dos resultados mais o hash
+ * FNV-1a da tabela LL(1).
+ */
+void parser_init(void) {
+    static int initialized = 0;
+    if (!initialized) {
+        symtable_init();              /* Inicializa tabela de símbolos do lexer */
+        initialize_parse_table();     /* Inicializa tabela de reconhecimento sintático */
+
+        unsigned long long hash_value = 14695981039346656037ull;
+        for (int i = 0; i < 31; i++) {
+            for (int j = 0; j < 30; j++) {
+                hash_value = (hash_value ^ (unsigned)parse_table[i][j]) * 1099511628211ull;
+            }
+        }
+        snprintf(grammar_version, sizeof(grammar_version), "LSI-2025-2/r%d/%016llx",
+                 PARSER_RESULT_REVISION, hash_value);
+        initialized = 1;
     }
+}
 
-    /* Inicializa componentes */
-    symtable_init();              /* Inicializa tabela de símbolos do lexer */
-    initialize_parse_table();     /* Inicializa tabela de reconhecimento sintático */
-    advance();                    /* Lê primeiro caractere */
+const char* parser_grammar_version(void) {
+    parser_init();
+    return grammar_version;
+}
 
-    /* Executa análise sintática */
-    parse();
+/*
+ * parse_file(input, diag)
+ *
+ * Reinicia o lexer e as pilhas e executa parse(). Em caso de erro, o
+ * longjmp de volta para cá descarta o estado parcial da análise.
+ */
+AstNode* parse_file(FILE* input, Diagnostic* diag) {
+    parser_init();
+    lexer_reset(input);
+    stack_top = -1;
+    semantic_top = -1;
+    has_lookahead = 0;
+    parse_diag = diag;
+
+    tokens_read = 0;
+    memory_base = ast_memory_used() + lexer_memory_used();
+    if (limits.max_millis > 0) {
+        clock_gettime(CLOCK_MONOTONIC, &parse_start);
+    }
+    schedule_checkpoint();
 
-    fclose(inputFile);
-    return 0;
+    if (setjmp(parse_abort) != 0) {
+        return NULL;
+    }
+    return parse();
 }
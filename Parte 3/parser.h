@@ -0,0 +1,82 @@
+/*
+ * ============================================================================
+ * HEADER DO ANALISADOR SINTÁTICO PARA A LINGUAGEM LSI-2025-2
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * */
+
+#ifndef PARSER_H
+#define PARSER_H
+
+#include <stdio.h>
+#include "ast.h"
+#include "diagnostic.h"
+
+/* 0 para analisar expressões apenas pela tabela LL(1) (--tabela-pura) */
+extern int expr_fast_path;
+
+/* Profundidade da pilha de parsing sem ParseLimits.max_depth, e o máximo aceito */
+#define PARSE_DEPTH_DEFAULT 200
+#define PARSE_DEPTH_MAX 20000
+
+/*
+ * Orçamentos de cada análise, para entradas de origem não confiável. Um
+ * limite excedido termina a análise com um diagnóstico DIAG_LIMIT na
+ * posição do token em que ocorreu; 0 desliga o limite (em max_depth, usa
+ * PARSE_DEPTH_DEFAULT). Tokens e profundidade são verificados a cada
+ * token e a cada símbolo empilhado; memória e prazo, a cada
+ * PARSE_CHECK_INTERVAL tokens.
+ */
+#define PARSE_CHECK_INTERVAL 1024
+
+typedef struct {
+    int64_t max_tokens;         /* Tokens lidos, sem contar o EOF */
+    int max_depth;              /* Símbolos na pilha de parsing, até PARSE_DEPTH_MAX */
+    int64_t max_lexeme;         /* Bytes de um identificador ou número */
+    int64_t max_memory;         /* Bytes alocados pela análise: árvore, lexemas, pilhas */
+    int64_t max_millis;         /* Prazo, em milissegundos desde o início da análise */
+} ParseLimits;
+
+/*
+ * Define os orçamentos de todas as análises seguintes, em todas as
+ * threads; deve ser chamada antes de criá-las.
+ */
+void parser_set_limits(const ParseLimits* limits);
+
+/* Opções de linha de comando dos orçamentos, para as mensagens de uso */
+#define PARSE_LIMIT_OPTIONS "[--limite-tokens <n>] [--limite-profundidade <n>] " \
+                            "[--limite-lexema <bytes>] [--limite-memoria-mb <n>] " \
+                            "[--limite-tempo-ms <n>]"
+
+/*
+ * Reconhece uma das opções de PARSE_LIMIT_OPTIONS e guarda value no campo
+ * correspondente de limits. Retorna 1 se name é uma delas e value é
+ * válido, -1 se o valor é inválido e 0 se name não é opção de orçamento.
+ */
+int parser_limit_option(const char* name, const char* value, ParseLimits* limits);
+
+/*
+ * Inicializa a tabela de símbolos e a tabela de reconhecimento sintático.
+ * Chamadas repetidas não têm efeito, de modo que um processo pode analisar
+ * vários arquivos com o mesmo estado aquecido. Com várias threads, deve ser
+ * chamada antes de criá-las.
+ */
+void parser_init(void);
+
+/*
+ * Identifica a gramática e o conteúdo da tabela LL(1); muda sempre que a
+ * tabela muda. Usada como parte da chave da cache de resultados.
+ */
+const char* parser_grammar_version(void);
+
+/*
+ * Analisa o conteúdo de input. Retorna a árvore do programa, válida até o
+ * próximo ast_reset() da mesma thread, ou NULL após preencher diag com o
+ * primeiro erro. Threads diferentes podem analisar ao mesmo tempo desde
+ * que symtable_enable_interning() tenha sido chamada.
+ */
+AstNode* parse_file(FILE* input, Diagnostic* diag);
+
+#endif
@@ -0,0 +1,130 @@
+/*
+ * ============================================================================
+ * CONTADORES DE DESEMPENHO (perf_event_open)
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * Mostra onde o tempo das fases do analisador vai (--contadores): desvios
+ * mal previstos na cadeia de testes de getToken(), falhas de cache nas
+ * consultas à tabela de símbolos e à tabela LL(1), faltas de página nas
+ * áreas recém-alocadas.
+ *
+ * ============================================================================
+ */
+
+#include "perfcount.h"
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#define CACHE_READ_MISS(cache) \
+    ((cache) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+static const struct {
+    uint32_t type;
+    uint64_t config;
+    const char* name;
+} counter_events[PERF_COUNTER_COUNT] = {
+    [PERF_CYCLES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, "ciclos"},
+    [PERF_INSTRUCTIONS] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, "instruções"},
+    [PERF_BRANCH_MISSES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, "desvios errados"},
+    [PERF_L1D_MISSES] = {PERF_TYPE_HW_CACHE, CACHE_READ_MISS(PERF_COUNT_HW_CACHE_L1D), "falhas L1d"},
+    [PERF_LLC_MISSES] = {PERF_TYPE_HW_CACHE, CACHE_READ_MISS(PERF_COUNT_HW_CACHE_LL), "falhas LLC"},
+    [PERF_PAGE_FAULTS] = {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS, "faltas de página"},
+};
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+const char* perf_counter_name(PerfCounter counter) {
+    return counter_events[counter].name;
+}
+
+/*
+ * perf_counters_open(counters)
+ *
+ * Um descritor por contador, fora de grupo: num grupo, um evento que não
+ * cabe nos registradores da PMU impediria a leitura de todos.
+ */
+int perf_counters_open(PerfCounters* counters) {
+    counters->open_count = 0;
+    counters->first_error = 0;
+    for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = counter_events[c].type;
+        attr.config = counter_events[c].config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;    /* Permitido com perf_event_paranoid 2 */
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        counters->fds[c] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (counters->fds[c] >= 0) {
+            counters->open_count++;
+        } else if (counters->first_error == 0) {
+            counters->first_error = errno;
+        }
+    }
+    return counters->open_count;
+}
+
+void perf_counters_start(PerfCounters* counters) {
+    for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+        if (counters->fds[c] >= 0) {
+            ioctl(counters->fds[c], PERF_EVENT_IOC_RESET, 0);
+        }
+    }
+    for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+        if (counters->fds[c] >= 0) {
+            ioctl(counters->fds[c], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+    counters->started_ms = now_ms();
+}
+
+/*
+ * perf_counters_stop(counters, sample)
+ *
+ * O tempo de relógio vai do fim de perf_counters_start() ao início desta
+ * função; os contadores incluem também o custo dos ioctl (poucos
+ * microssegundos por fase).
+ */
+void perf_counters_stop(PerfCounters* counters, PerfSample* sample) {
+    sample->millis = now_ms() - counters->started_ms;
+    for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+        if (counters->fds[c] >= 0) {
+            ioctl(counters->fds[c], PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+    for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+        uint64_t data[3];   /* Valor, tempo ligado, tempo contando */
+        sample->values[c] = 0;
+        sample->valid[c] = counters->fds[c] >= 0 &&
+                           read(counters->fds[c], data, sizeof(data)) == (ssize_t)sizeof(data) &&
+                           data[2] > 0;
+        if (sample->valid[c]) {
+            sample->values[c] = data[2] < data[1]
+                                    ? (uint64_t)((double)data[0] * (double)data[1] / (double)data[2])
+                                    : data[0];
+        }
+    }
+}
+
+void perf_counters_close(PerfCounters* counters) {
+    for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+        if (counters->fds[c] >= 0) {
+            close(counters->fds[c]);
+            counters->fds[c] = -1;
+        }
+    }
+    counters->open_count = 0;
+}
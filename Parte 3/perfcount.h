@@ -0,0 +1,59 @@
+/*
+ * ============================================================================
+ * HEADER DOS CONTADORES DE DESEMPENHO
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * Contadores do processo atual abertos com perf_event_open (Linux), só
+ * em modo usuário. Cada contador é aberto em separado: os que o núcleo ou
+ * a máquina não oferecem (por exemplo, os de hardware numa máquina
+ * virtual sem PMU, ou com perf_event_paranoid alto) ficam de fora sem
+ * impedir os demais. Quando o núcleo divide os contadores de hardware
+ * entre eventos, a contagem é extrapolada pelo tempo em que o contador
+ * esteve ativo.
+ *
+ * */
+
+#ifndef PERFCOUNT_H
+#define PERFCOUNT_H
+
+#include <stdint.h>
+
+typedef enum {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_BRANCH_MISSES,
+    PERF_L1D_MISSES,            /* Leituras que falharam na cache L1 de dados */
+    PERF_LLC_MISSES,            /* Leituras que falharam no último nível de cache */
+    PERF_PAGE_FAULTS,
+    PERF_COUNTER_COUNT
+} PerfCounter;
+
+typedef struct {
+    int fds[PERF_COUNTER_COUNT];    /* -1: indisponível */
+    int open_count;
+    int first_error;                /* errno da primeira falha ao abrir, ou 0 */
+    double started_ms;
+} PerfCounters;
+
+typedef struct {
+    uint64_t values[PERF_COUNTER_COUNT];
+    char valid[PERF_COUNTER_COUNT];
+    double millis;                  /* Tempo de relógio entre start e stop */
+} PerfSample;
+
+/* Abre os contadores, parados. Retorna quantos foram abertos. */
+int perf_counters_open(PerfCounters* counters);
+
+/* Zera e liga os contadores abertos */
+void perf_counters_start(PerfCounters* counters);
+
+/* Desliga os contadores e lê os valores */
+void perf_counters_stop(PerfCounters* counters, PerfSample* sample);
+
+void perf_counters_close(PerfCounters* counters);
+
+const char* perf_counter_name(PerfCounter counter);
+
+#endif
@@ -0,0 +1,193 @@
+/*
+ * ============================================================================
+ * ANÁLISE DE PUREZA PARA A LINGUAGEM LSI-2025-2
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * Cada função é percorrida uma vez, em ordem de posição, procurando print,
+ * divisões que podem falhar e chamadas. Uma chamada para outro componente
+ * usa a classe já calculada do chamado (os componentes vêm dos chamados
+ * para os chamadores); uma chamada dentro do componente só é anotada, e
+ * a classe do componente inteiro é a pior entre as dos membros. Em cada
+ * função, o motivo registrado é a primeira ocorrência da pior classe.
+ *
+ * ============================================================================
+ */
+
+#include "purity.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static void* checked_calloc(size_t count, size_t size) {
+    void* memory = calloc(count ? count : 1, size);
+    if (memory == NULL) {
+        fprintf(stderr, "Erro fatal: Memória insuficiente para a análise de pureza.\n");
+        exit(1);
+    }
+    return memory;
+}
+
+const char* purity_class_name(PurityClass level) {
+    switch (level) {
+        case PURITY_PURE: return "pura";
+        case PURITY_READONLY: return "somente leitura";
+        default: return "com efeito";
+    }
+}
+
+typedef struct {
+    const PurityTable* table;
+    int scc;                    /* Componente sendo analisado */
+    PurityInfo info;            /* Da função sendo percorrida */
+    const AstNode* first_internal;  /* Primeira chamada dentro do componente */
+} Scan;
+
+static void note(Scan* scan, PurityClass level, PurityReason reason, const AstNode* node,
+                 const char* name) {
+    if (level <= scan->info.level) {
+        return;                 /* Só a primeira ocorrência de cada classe, e só se piora */
+    }
+    scan->info.level = level;
+    scan->info.reason = reason;
+    scan->info.line = node->line;
+    scan->info.col = node->col;
+    scan->info.name = name;
+}
+
+static void scan_expression(Scan* scan, const AstNode* expr) {
+    if (expr->kind != AST_BINOP) {
+        return;
+    }
+    scan_expression(scan, expr->kids[0]);
+    scan_expression(scan, expr->kids[1]);
+    const AstNode* divisor = expr->kids[1];
+    if (expr->op == TOKEN_DIV && (divisor->kind != AST_NUM || divisor->value == 0)) {
+        note(scan, PURITY_READONLY, PURITY_REASON_DIVISION, expr, NULL);
+    }
+}
+
+static void scan_call(Scan* scan, const AstNode* call) {
+    int sorted = ast_function_index(&scan->table->names, call->name);
+    if (sorted < 0) {
+        note(scan, PURITY_EFFECTFUL, PURITY_REASON_UNDEFINED, call, call->name);
+        return;
+    }
+    int callee = scan->table->index_of_sorted[sorted];
+    if (scan->table->graph->scc_of[callee] == scan->scc) {
+        if (scan->first_internal == NULL) {
+            scan->first_internal = call;
+        }
+        return;
+    }
+    PurityClass level = scan->table->functions[callee].level;
+    if (level != PURITY_PURE) {
+        note(scan, level, PURITY_REASON_CALL, call, call->name);
+    }
+}
+
+static void scan_statement(Scan* scan, const AstNode* stmt) {
+    switch (stmt->kind) {
+        case AST_ASSIGN:
+            if (stmt->kids[0]->kind == AST_FCALL) {
+                scan_call(scan, stmt->kids[0]);
+            } else {
+                scan_expression(scan, stmt->kids[0]);
+            }
+            break;
+        case AST_PRINT:
+            scan_expression(scan, stmt->kids[0]);
+            note(scan, PURITY_EFFECTFUL, PURITY_REASON_PRINT, stmt, NULL);
+            break;
+        case AST_IF:
+            scan_expression(scan, stmt->kids[0]);
+            for (int i = 1; i < stmt->kid_count; i++) {
+                scan_statement(scan, stmt->kids[i]);
+            }
+            break;
+        case AST_BLOCK:
+        case AST_FDEF:
+            for (int i = 0; i < stmt->kid_count; i++) {
+                scan_statement(scan, stmt->kids[i]);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+void purity_begin(const AstNode* program, const CallGraph* graph, PurityTable* table) {
+    table->count = graph->count;
+    table->functions = (PurityInfo*)checked_calloc((size_t)graph->count, sizeof(PurityInfo));
+    for (int c = 0; c < 3; c++) {
+        table->class_count[c] = 0;
+    }
+
+    /* Mesma resolução de nomes do grafo: a primeira definição vence */
+    table->graph = graph;
+    ast_function_table_build(program, &table->names);
+    table->index_of_sorted = (int*)checked_calloc((size_t)graph->count, sizeof(int));
+    for (int f = graph->count - 1; f >= 0; f--) {
+        table->index_of_sorted[ast_function_index(&table->names, graph->fdefs[f]->name)] = f;
+    }
+    table->internal = (const AstNode**)checked_calloc((size_t)graph->count, sizeof(AstNode*));
+}
+
+/*
+ * purity_analyze_component(table, scc)
+ *
+ * Lê table->functions só nas posições dos componentes chamados, que
+ * callgraph_schedule() garante terminados, e escreve só nas dos membros.
+ */
+void purity_analyze_component(PurityTable* table, int scc) {
+    const CallGraph* graph = table->graph;
+    Scan scan = {table, scc, {0}, NULL};
+    PurityClass worst = PURITY_PURE;
+    for (int m = graph->scc_start[scc]; m < graph->scc_start[scc + 1]; m++) {
+        int f = graph->scc_members[m];
+        scan.info = (PurityInfo){PURITY_PURE, PURITY_REASON_NONE, 0, 0, NULL};
+        scan.first_internal = NULL;
+        scan_statement(&scan, graph->fdefs[f]);
+        table->functions[f] = scan.info;
+        table->internal[f] = scan.first_internal;
+        worst = scan.info.level > worst ? scan.info.level : worst;
+    }
+    /* Quem não chega à pior classe sozinho chega a ela por outro membro */
+    for (int m = graph->scc_start[scc]; m < graph->scc_start[scc + 1]; m++) {
+        int f = graph->scc_members[m];
+        PurityInfo* info = &table->functions[f];
+        if (info->level < worst) {
+            const AstNode* call = table->internal[f];
+            info->level = worst;
+            info->reason = PURITY_REASON_CALL;
+            info->line = call->line;
+            info->col = call->col;
+            info->name = call->name;
+        }
+    }
+}
+
+void purity_finish(PurityTable* table) {
+    for (int f = 0; f < table->count; f++) {
+        table->class_count[table->functions[f].level]++;
+    }
+    free(table->internal);
+    free(table->index_of_sorted);
+    ast_function_table_free(&table->names);
+    table->internal = NULL;
+    table->index_of_sorted = NULL;
+}
+
+void purity_analyze(const AstNode* program, const CallGraph* graph, PurityTable* table) {
+    purity_begin(program, graph, table);
+    for (int scc = 0; scc < graph->scc_count; scc++) {
+        purity_analyze_component(table, scc);
+    }
+    purity_finish(table);
+}
+
+void purity_free(PurityTable* table) {
+    free(table->functions);
+    table->functions = NULL;
+    table->count = 0;
+}
@@ -0,0 +1,103 @@
+/*
+ * ============================================================================
+ * HEADER DA ANÁLISE DE PUREZA PARA A LINGUAGEM LSI-2025-2
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * Classifica cada função pelo que uma chamada a ela pode fazer além de
+ * devolver um valor. Como a linguagem não tem variáveis globais, toda
+ * função só lê os próprios parâmetros e locais; o que distingue as
+ * classes é o que é observável de fora:
+ *   PURITY_PURE       nada: o retorno depende só dos argumentos, e uma
+ *                     chamada pode ser memoizada, reaproveitada, movida
+ *                     ou removida se o valor não é usado
+ *   PURITY_READONLY   não imprime, mas pode encerrar o programa com
+ *                     divisão por zero (nela ou numa função chamada): o
+ *                     retorno, ou o erro, ainda depende só dos
+ *                     argumentos, e a chamada pode ser memoizada, mas não
+ *                     removida nem movida para antes de um print
+ *   PURITY_EFFECTFUL  executa print, diretamente ou por uma chamada, ou
+ *                     chama uma função não definida
+ * Uma divisão só conta se o divisor não é um literal diferente de zero.
+ *
+ * A análise percorre os componentes do grafo de chamadas (callgraph.h)
+ * dos chamados para os chamadores; os membros de um componente recursivo
+ * recebem todos a pior classe entre eles. A recursão não rebaixa a
+ * classe: uma função pura recursiva que termina continua pura (fibonacci).
+ *
+ * */
+
+#ifndef PURITY_H
+#define PURITY_H
+
+#include "ast.h"
+#include "callgraph.h"
+
+typedef enum {
+    PURITY_PURE,
+    PURITY_READONLY,
+    PURITY_EFFECTFUL
+} PurityClass;
+
+/* O que determinou a classe de uma função */
+typedef enum {
+    PURITY_REASON_NONE,         /* Pura */
+    PURITY_REASON_PRINT,
+    PURITY_REASON_DIVISION,     /* Divisão que pode falhar */
+    PURITY_REASON_CALL,         /* Chamada a uma função de classe igual */
+    PURITY_REASON_UNDEFINED     /* Chamada a uma função não definida */
+} PurityReason;
+
+typedef struct {
+    PurityClass level;
+    PurityReason reason;
+    int line;                   /* Posição do print, da divisão ou da chamada */
+    int col;
+    const char* name;           /* Função chamada, com PURITY_REASON_CALL e _UNDEFINED */
+} PurityInfo;
+
+typedef struct {
+    PurityInfo* functions;      /* Por função, na numeração do grafo */
+    int count;
+    int class_count[3];         /* Funções de cada classe (depois de purity_finish) */
+    /* Resolução das chamadas, entre purity_begin e purity_finish */
+    const CallGraph* graph;
+    AstFunctionTable names;
+    int* index_of_sorted;       /* Posição em names -> função do grafo */
+    const AstNode** internal;   /* Por função: primeira chamada dentro do componente */
+} PurityTable;
+
+/*
+ * Classifica as funções do grafo (montado de program por
+ * callgraph_build()), componente a componente, na thread atual.
+ */
+void purity_analyze(const AstNode* program, const CallGraph* graph, PurityTable* table);
+
+/*
+ * Para calcular as classes dentro de callgraph_schedule(): purity_begin()
+ * prepara a tabela, purity_analyze_component() classifica os membros de
+ * um componente a partir das classes dos componentes chamados (já
+ * terminados) e escreve só nas posições desses membros, e purity_finish()
+ * conta as classes. Tarefas de componentes diferentes podem rodar ao
+ * mesmo tempo.
+ */
+void purity_begin(const AstNode* program, const CallGraph* graph, PurityTable* table);
+void purity_analyze_component(PurityTable* table, int scc);
+void purity_finish(PurityTable* table);
+
+void purity_free(PurityTable* table);
+
+const char* purity_class_name(PurityClass level);
+
+/* Uma chamada pode ser trocada pelo resultado de outra com os mesmos argumentos */
+static inline int purity_memoizable(PurityClass level) {
+    return level != PURITY_EFFECTFUL;
+}
+
+/* Uma chamada cujo valor não é usado pode ser removida */
+static inline int purity_removable(PurityClass level) {
+    return level == PURITY_PURE;
+}
+
+#endif
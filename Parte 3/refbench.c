@@ -0,0 +1,700 @@
+/*
+ * ============================================================================
+ * COMPARAÇÃO COM O ANALISADOR DE REFERÊNCIA (lsi-refbench)
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * Roda o analisador principal (lexer.c e parser.c) e o de referência
+ * gerado pelo bison (referencia.y) sobre os mesmos arquivos e compara:
+ *   - Desempenho: tokens/s, MB/s e memória máxima, separadamente para a
+ *     tokenização e para a análise completa. Cada combinação de motor e
+ *     fase roda em um processo filho, de modo que a memória máxima
+ *     (ru_maxrss) é só dela; o tempo é o da melhor de --repetir passadas
+ *     sobre todos os arquivos.
+ *   - Conformidade: os dois motores devem aceitar os mesmos arquivos e
+ *     parar no mesmo token (linha e coluna) nos demais, e a tokenização
+ *     deve produzir o mesmo número de tokens. Esgotar a pilha é um limite
+ *     de implementação, listado à parte e não como divergência.
+ *
+ * Com --gerar, escreve um corpus de programas aleatórios da gramática,
+ * metade deles com uma mutação (byte apagado, trocado ou inserido) que em
+ * geral os torna inválidos, para exercitar os caminhos de erro.
+ *
+ * O analisador principal monta a árvore sintática e consulta a tabela de
+ * símbolos; a referência só reconhece. A diferença na fase de análise
+ * inclui esse trabalho.
+ *
+ * ============================================================================
+ */
+
+#define _GNU_SOURCE
+
+#include <dirent.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ast.h"
+#include "lexer.h"
+#include "parser.h"
+#include "referencia.h"
+
+extern Token getToken(void);
+extern void lexer_reset(FILE* input);
+
+#define MAX_SHOWN_DIVERGENCES 20
+
+typedef enum {
+    ENGINE_LSI,
+    ENGINE_REFERENCE
+} Engine;
+
+typedef enum {
+    PHASE_LEX,
+    PHASE_PARSE
+} Phase;
+
+/* Medição de uma combinação de motor e fase */
+typedef struct {
+    double best_ms;
+    int64_t tokens;             /* Da tokenização, nas duas fases */
+    int64_t bytes;
+    double max_rss_mb;
+    RefResult* results;         /* Um por arquivo */
+} Run;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+/* ============================================================================
+ * MOTORES
+ * ============================================================================ */
+
+/*
+ * lsi_lex(input, result)
+ *
+ * Tokenização como em --lexico: sem a tabela de símbolos, até o EOF ou
+ * o primeiro TOKEN_ERROR.
+ */
+static void lsi_lex(FILE* input, RefResult* result) {
+    memset(result, 0, sizeof(*result));
+    lexer_set_symbol_table(0);
+    lexer_reset(input);
+    Token token;
+    while ((token = getToken()).type != TOKEN_EOF && token.type != TOKEN_ERROR) {
+        result->tokens++;
+    }
+    if (token.type == TOKEN_ERROR) {
+        result->status = REF_ERROR;
+        lexer_position(token.offset, &result->line, &result->col);
+    }
+    lexer_set_symbol_table(1);
+}
+
+/*
+ * lsi_parse(input, result)
+ *
+ * Análise completa, com a árvore. O orçamento de profundidade da pilha
+ * (DIAG_LIMIT) é o limite de implementação.
+ */
+static void lsi_parse(FILE* input, RefResult* result) {
+    Diagnostic diag;
+    memset(result, 0, sizeof(*result));
+    if (parse_file(input, &diag) == NULL) {
+        result->status = diag.kind == DIAG_LIMIT ? REF_LIMIT : REF_ERROR;
+        result->line = diag.line;
+        result->col = diag.col;
+    }
+    ast_reset();
+}
+
+static void run_file(Engine engine, Phase phase, const char* path, RefResult* result) {
+    FILE* input = fopen(path, "rb");
+    if (input == NULL) {
+        perror(path);
+        exit(1);
+    }
+    if (engine == ENGINE_LSI) {
+        (phase == PHASE_LEX ? lsi_lex : lsi_parse)(input, result);
+    } else {
+        (phase == PHASE_LEX ? ref_lex_file : ref_parse_file)(input, result);
+    }
+    fclose(input);
+}
+
+/*
+ * measure(engine, phase, paths, count, repeat, run)
+ *
+ * Roda a combinação em um processo filho, que devolve pelo pipe o melhor
+ * tempo e os resultados da primeira passada; a memória máxima vem de
+ * wait4().
+ */
+static int measure(Engine engine, Phase phase, char** paths, int count, int repeat, Run* run) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        perror("Erro ao criar pipe");
+        return -1;
+    }
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("Erro em fork");
+        return -1;
+    }
+
+    if (pid == 0) {
+        close(fds[0]);
+        if (engine == ENGINE_LSI) {
+            parser_init();
+        }
+        RefResult* results = (RefResult*)calloc((size_t)count, sizeof(RefResult));
+        double best = 0.0;
+        for (int r = 0; r < repeat; r++) {
+            RefResult scratch;
+            double t0 = now_ms();
+            for (int i = 0; i < count; i++) {
+                run_file(engine, phase, paths[i], r == 0 ? &results[i] : &scratch);
+            }
+            double elapsed = now_ms() - t0;
+            if (r == 0 || elapsed < best) {
+                best = elapsed;
+            }
+        }
+        FILE* out = fdopen(fds[1], "wb");
+        fwrite(&best, sizeof(best), 1, out);
+        fwrite(results, sizeof(RefResult), (size_t)count, out);
+        fclose(out);
+        _exit(0);
+    }
+
+    close(fds[1]);
+    FILE* in = fdopen(fds[0], "rb");
+    run->results = (RefResult*)calloc((size_t)count, sizeof(RefResult));
+    int ok = fread(&run->best_ms, sizeof(run->best_ms), 1, in) == 1 &&
+             fread(run->results, sizeof(RefResult), (size_t)count, in) == (size_t)count;
+    fclose(in);
+
+    int status;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) < 0 || !WIFEXITED(status) ||
+        WEXITSTATUS(status) != 0 || !ok) {
+        fprintf(stderr, "Erro: a medição de %s terminou sem resultado\n",
+                engine == ENGINE_LSI ? "LSI" : "referência");
+        return -1;
+    }
+    run->max_rss_mb = usage.ru_maxrss / 1024.0;
+    run->tokens = 0;
+    for (int i = 0; i < count; i++) {
+        run->tokens += run->results[i].tokens;
+    }
+    return 0;
+}
+
+/* ============================================================================
+ * CONFORMIDADE
+ * ============================================================================ */
+
+static void describe(const RefResult* result, char* text, size_t size) {
+    switch (result->status) {
+        case REF_ACCEPTED:
+            snprintf(text, size, "aceita");
+            break;
+        case REF_ERROR:
+            snprintf(text, size, "erro na linha %" PRId64 ", coluna %" PRId64,
+                     result->line, result->col);
+            break;
+        default:
+            snprintf(text, size, "pilha esgotada");
+            break;
+    }
+}
+
+static int same_outcome(const RefResult* a, const RefResult* b) {
+    return a->status == b->status &&
+           (a->status != REF_ERROR || (a->line == b->line && a->col == b->col));
+}
+
+/*
+ * compare(paths, count, runs)
+ *
+ * Imprime as divergências (até MAX_SHOWN_DIVERGENCES) e o resumo.
+ * Retorna o número de arquivos divergentes.
+ */
+static int compare(char** paths, int count, Run runs[2][2]) {
+    int accepted = 0, rejected = 0, limited = 0, divergent = 0;
+    char ours[96], theirs[96];
+
+    for (int i = 0; i < count; i++) {
+        const RefResult* lex[2] = {&runs[ENGINE_LSI][PHASE_LEX].results[i],
+                                   &runs[ENGINE_REFERENCE][PHASE_LEX].results[i]};
+        const RefResult* parse[2] = {&runs[ENGINE_LSI][PHASE_PARSE].results[i],
+                                     &runs[ENGINE_REFERENCE][PHASE_PARSE].results[i]};
+
+        if (parse[0]->status == REF_LIMIT || parse[1]->status == REF_LIMIT) {
+            describe(parse[0], ours, sizeof(ours));
+            describe(parse[1], theirs, sizeof(theirs));
+            printf("Limite: %s: LSI %s; referência %s\n", paths[i], ours, theirs);
+            limited++;
+            continue;
+        }
+
+        const char* what = NULL;
+        if (!same_outcome(lex[0], lex[1]) || lex[0]->tokens != lex[1]->tokens) {
+            what = "tokenização";
+            describe(lex[0], ours, sizeof(ours));
+            describe(lex[1], theirs, sizeof(theirs));
+            snprintf(ours + strlen(ours), sizeof(ours) - strlen(ours),
+                     " (%" PRId64 " tokens)", lex[0]->tokens);
+            snprintf(theirs + strlen(theirs), sizeof(theirs) - strlen(theirs),
+                     " (%" PRId64 " tokens)", lex[1]->tokens);
+        } else if (!same_outcome(parse[0], parse[1])) {
+            what = "análise";
+            describe(parse[0], ours, sizeof(ours));
+            describe(parse[1], theirs, sizeof(theirs));
+        }
+        if (what != NULL) {
+            if (divergent < MAX_SHOWN_DIVERGENCES) {
+                printf("Divergência (%s): %s: LSI %s; referência %s\n", what, paths[i], ours, theirs);
+            }
+            divergent++;
+        } else if (parse[0]->status == REF_ACCEPTED) {
+            accepted++;
+        } else {
+            rejected++;
+        }
+    }
+
+    if (divergent > MAX_SHOWN_DIVERGENCES) {
+        printf("... e mais %d divergências\n", divergent - MAX_SHOWN_DIVERGENCES);
+    }
+    printf("Conformidade: %d arquivos; %d aceitos e %d com erro na mesma posição pelos dois, "
+           "%d no limite da pilha, %d divergências\n",
+           count, accepted, rejected, limited, divergent);
+    return divergent;
+}
+
+/* Rótulo alinhado pelo número de caracteres, não de bytes UTF-8 */
+static void print_run(const char* label, const Run* run) {
+    double seconds = run->best_ms / 1e3;
+    int width = 22;
+    for (const char* p = label; *p; p++) {
+        width += (*p & 0xC0) == 0x80;
+    }
+    printf("%-*s %12.0f %9.1f %12.1f %10.1f\n", width, label,
+           seconds > 0 ? run->tokens / seconds : 0.0,
+           seconds > 0 ? run->bytes / 1e6 / seconds : 0.0,
+           run->best_ms, run->max_rss_mb);
+}
+
+/* ============================================================================
+ * ARQUIVOS DE ENTRADA
+ * ============================================================================ */
+
+typedef struct {
+    char** items;
+    int count;
+    int capacity;
+    int64_t bytes;              /* Soma dos tamanhos */
+} PathList;
+
+static void path_list_add(PathList* list, const char* path) {
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : 64;
+        list->items = (char**)realloc(list->items, sizeof(char*) * (size_t)list->capacity);
+    }
+    list->items[list->count++] = strdup(path);
+}
+
+static int compare_strings(const void* a, const void* b) {
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+/*
+ * collect(list, path)
+ *
+ * Um arquivo entra como está; de um diretório entram os arquivos .lsi,
+ * em ordem alfabética.
+ */
+static int collect(PathList* list, const char* path) {
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        perror(path);
+        return -1;
+    }
+    if (!S_ISDIR(st.st_mode)) {
+        path_list_add(list, path);
+        list->bytes += (int64_t)st.st_size;
+        return 0;
+    }
+
+    DIR* dir = opendir(path);
+    if (dir == NULL) {
+        perror(path);
+        return -1;
+    }
+    int first = list->count;
+    struct dirent* ent;
+    char full[4096];
+    while ((ent = readdir(dir)) != NULL) {
+        size_t length = strlen(ent->d_name);
+        if (length > 4 && strcmp(ent->d_name + length - 4, ".lsi") == 0) {
+            snprintf(full, sizeof(full), "%s/%s", path, ent->d_name);
+            if (stat(full, &st) == 0 && S_ISREG(st.st_mode)) {
+                path_list_add(list, full);
+                list->bytes += (int64_t)st.st_size;
+            }
+        }
+    }
+    closedir(dir);
+    qsort(list->items + first, (size_t)(list->count - first), sizeof(char*), compare_strings);
+    return 0;
+}
+
+/* ============================================================================
+ * GERADOR DE CORPUS
+ * ============================================================================ */
+
+typedef struct {
+    uint64_t state;
+    char* data;
+    size_t length;
+    size_t capacity;
+    const char* newline;        /* "\n", "\r\n" ou "\r" no arquivo inteiro */
+} Generator;
+
+static uint64_t gen_next(Generator* g) {
+    g->state ^= g->state << 13;
+    g->state ^= g->state >> 7;
+    g->state ^= g->state << 17;
+    return g->state;
+}
+
+static int gen_below(Generator* g, int n) {
+    return (int)(gen_next(g) % (uint64_t)n);
+}
+
+static void gen_put(Generator* g, const char* text) {
+    size_t length = strlen(text);
+    if (g->length + length + 1 > g->capacity) {
+        g->capacity = (g->length + length + 1) * 2;
+        g->data = (char*)realloc(g->data, g->capacity);
+    }
+    memcpy(g->data + g->length, text, length);
+    g->length += length;
+}
+
+static void gen_name(Generator* g, const char* prefix, int count) {
+    char name[32];
+    snprintf(name, sizeof(name), "%s%d", prefix, gen_below(g, count));
+    gen_put(g, name);
+}
+
+static void gen_space(Generator* g) {
+    static const char* const spaces[] = {" ", " ", " ", "  ", "\t"};
+    gen_put(g, spaces[gen_below(g, 5)]);
+}
+
+static void gen_line(Generator* g, int depth) {
+    gen_put(g, g->newline);
+    for (int i = 0; i < depth; i++) {
+        gen_put(g, gen_below(g, 8) == 0 ? "\t" : "    ");
+    }
+}
+
+static void gen_numexpr(Generator* g, int depth) {
+    static const char* const operators[] = {"+", "-", "*", "/"};
+    int terms = 1 + gen_below(g, depth > 2 ? 1 : 3);
+    for (int i = 0; i < terms; i++) {
+        if (i > 0) {
+            gen_space(g);
+            gen_put(g, operators[gen_below(g, 4)]);
+            gen_space(g);
+        }
+        int kind = gen_below(g, 5);
+        if (kind == 0 && depth < 3) {
+            gen_put(g, "(");
+            gen_numexpr(g, depth + 1);
+            gen_put(g, ")");
+        } else if (kind <= 2) {
+            gen_name(g, "v", 8);
+        } else {
+            char number[32];
+            snprintf(number, sizeof(number), "%" PRIu64, gen_next(g) % (kind == 3 ? 100 : 1000000007));
+            gen_put(g, number);
+        }
+    }
+}
+
+static void gen_expr(Generator* g) {
+    static const char* const relops[] = {"<", "<=", ">", ">=", "==", "!="};
+    gen_numexpr(g, 0);
+    if (gen_below(g, 3) == 0) {
+        gen_space(g);
+        gen_put(g, relops[gen_below(g, 6)]);
+        gen_space(g);
+        gen_numexpr(g, 0);
+    }
+}
+
+static void gen_stmt(Generator* g, int depth);
+
+static void gen_braced(Generator* g, int depth, int statements) {
+    gen_put(g, "{");
+    for (int i = 0; i < statements; i++) {
+        gen_line(g, depth + 1);
+        gen_stmt(g, depth + 1);
+    }
+    gen_line(g, depth);
+    gen_put(g, "}");
+}
+
+static void gen_stmt(Generator* g, int depth) {
+    int kind = gen_below(g, depth < 4 ? 10 : 7);
+    switch (kind) {
+        case 0:
+            gen_put(g, "int ");
+            gen_name(g, "v", 8);
+            for (int n = gen_below(g, 3); n > 0; n--) {
+                gen_put(g, ", ");
+                gen_name(g, "v", 8);
+            }
+            gen_put(g, ";");
+            break;
+        case 1:
+        case 2:
+            gen_name(g, "v", 8);
+            gen_put(g, " = ");
+            gen_expr(g);
+            gen_put(g, ";");
+            break;
+        case 3:
+            gen_name(g, "v", 8);
+            gen_put(g, " = ");
+            gen_name(g, "f", 16);
+            gen_put(g, "(");
+            for (int n = gen_below(g, 4); n > 0; n--) {
+                gen_name(g, "v", 8);
+                if (n > 1) {
+                    gen_put(g, ", ");
+                }
+            }
+            gen_put(g, ");");
+            break;
+        case 4:
+            gen_put(g, "print ");
+            gen_expr(g);
+            gen_put(g, ";");
+            break;
+        case 5:
+            gen_put(g, gen_below(g, 2) ? "return;" : "return v0;");
+            break;
+        case 6:
+            gen_put(g, ";");
+            break;
+        case 7:
+        case 8:
+            gen_put(g, "if (");
+            gen_expr(g);
+            gen_put(g, ") ");
+            gen_braced(g, depth, 1);
+            if (gen_below(g, 2)) {
+                gen_put(g, " else ");
+                gen_braced(g, depth, 1);
+            }
+            break;
+        default:
+            gen_braced(g, depth, 1 + gen_below(g, 3));
+            break;
+    }
+}
+
+static void gen_program(Generator* g, int functions) {
+    if (gen_below(g, 10) == 0) {
+        gen_stmt(g, 0);             /* MAIN → STMT */
+        gen_put(g, g->newline);
+        return;
+    }
+    for (int f = 0; f < functions; f++) {
+        char header[64];
+        snprintf(header, sizeof(header), "def f%d(", f);
+        gen_put(g, header);
+        for (int n = gen_below(g, 4); n > 0; n--) {
+            gen_put(g, "int ");
+            gen_name(g, "p", 4);
+            if (n > 1) {
+                gen_put(g, ", ");
+            }
+        }
+        gen_put(g, ") ");
+        gen_braced(g, 0, 1 + gen_below(g, 8));
+        gen_put(g, g->newline);
+        gen_put(g, g->newline);
+    }
+}
+
+/*
+ * gen_mutate(g)
+ *
+ * Apaga, troca ou insere um byte em posição aleatória. Os bytes inseridos
+ * incluem caracteres inválidos, quebras de linha e 0xFF.
+ */
+static void gen_mutate(Generator* g) {
+    static const char inserted[] = "(){};,=<>!+-*/@#$ 0a\n\r\xff";
+    if (g->length == 0) {
+        return;
+    }
+    size_t at = gen_next(g) % g->length;
+    char c = inserted[gen_below(g, (int)sizeof(inserted) - 1)];
+    switch (gen_below(g, 3)) {
+        case 0:
+            memmove(g->data + at, g->data + at + 1, g->length - at - 1);
+            g->length--;
+            break;
+        case 1:
+            g->data[at] = c;
+            break;
+        default:
+            gen_put(g, " ");
+            memmove(g->data + at + 1, g->data + at, g->length - at - 1);
+            g->data[at] = c;
+            break;
+    }
+}
+
+/*
+ * generate(dir, files, functions, seed)
+ *
+ * Escreve files programas em dir; os de número ímpar recebem uma mutação.
+ * A mesma semente produz o mesmo corpus.
+ */
+static int generate(const char* dir, int files, int functions, uint64_t seed) {
+    static const char* const newlines[] = {"\n", "\n", "\n", "\r\n", "\r"};
+    if (mkdir(dir, 0777) != 0 && errno != EEXIST) {
+        perror(dir);
+        return 1;
+    }
+    Generator g = {0};
+    g.state = seed ? seed : 1;
+    int64_t total = 0;
+    for (int i = 0; i < files; i++) {
+        g.length = 0;
+        g.newline = newlines[gen_below(&g, 5)];
+        gen_program(&g, functions);
+        if (i % 2 == 1) {
+            gen_mutate(&g);
+        }
+
+        char path[4096];
+        snprintf(path, sizeof(path), "%s/gerado_%05d.lsi", dir, i);
+        FILE* out = fopen(path, "wb");
+        if (out == NULL || fwrite(g.data, 1, g.length, out) != g.length || fclose(out) != 0) {
+            perror(path);
+            return 1;
+        }
+        total += (int64_t)g.length;
+    }
+    free(g.data);
+    printf("%d arquivos gerados em %s (%.1f MB)\n", files, dir, total / 1e6);
+    return 0;
+}
+
+/* ============================================================================
+ * PROGRAMA PRINCIPAL
+ * ============================================================================ */
+
+static void usage(const char* program) {
+    fprintf(stderr, "Uso: %s [--repetir <n>] <arquivo.lsi|diretório>...\n"
+                    "       %s --gerar <diretório> [--arquivos <n>] [--funcoes <n>] [--semente <n>]\n",
+            program, program);
+}
+
+int main(int argc, char* argv[]) {
+    const char* generate_dir = NULL;
+    int files = 200;
+    int functions = 50;
+    uint64_t seed = 2025;
+    int repeat = 3;
+    PathList paths = {0};
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--gerar") == 0 && i + 1 < argc) {
+            generate_dir = argv[++i];
+        } else if (strcmp(argv[i], "--arquivos") == 0 && i + 1 < argc) {
+            files = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--funcoes") == 0 && i + 1 < argc) {
+            functions = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--repetir") == 0 && i + 1 < argc) {
+            repeat = atoi(argv[++i]);
+        } else if (argv[i][0] != '-') {
+            if (collect(&paths, argv[i]) != 0) {
+                return 1;
+            }
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (generate_dir != NULL) {
+        if (paths.count > 0 || files < 1 || functions < 1) {
+            usage(argv[0]);
+            return 1;
+        }
+        return generate(generate_dir, files, functions, seed);
+    }
+    if (paths.count == 0 || repeat < 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    Run runs[2][2];
+    for (int engine = ENGINE_LSI; engine <= ENGINE_REFERENCE; engine++) {
+        for (int phase = PHASE_LEX; phase <= PHASE_PARSE; phase++) {
+            if (measure((Engine)engine, (Phase)phase, paths.items, paths.count, repeat,
+                        &runs[engine][phase]) != 0) {
+                return 1;
+            }
+        }
+    }
+
+    for (int engine = ENGINE_LSI; engine <= ENGINE_REFERENCE; engine++) {
+        runs[engine][PHASE_PARSE].tokens = runs[engine][PHASE_LEX].tokens;
+        runs[engine][PHASE_LEX].bytes = paths.bytes;
+        runs[engine][PHASE_PARSE].bytes = paths.bytes;
+    }
+
+    printf("Arquivos: %d, %.1f MB, %" PRId64 " tokens (melhor de %d passadas)\n\n",
+           paths.count, paths.bytes / 1e6, runs[ENGINE_LSI][PHASE_LEX].tokens, repeat);
+    printf("%-22s %12s %9s %12s %11s\n", "", "tokens/s", "MB/s", "tempo (ms)", "memória (MB)");
+    print_run("Léxico, LSI", &runs[ENGINE_LSI][PHASE_LEX]);
+    print_run("Léxico, referência", &runs[ENGINE_REFERENCE][PHASE_LEX]);
+    print_run("Análise, LSI", &runs[ENGINE_LSI][PHASE_PARSE]);
+    print_run("Análise, referência", &runs[ENGINE_REFERENCE][PHASE_PARSE]);
+    printf("\n");
+
+    int divergent = compare(paths.items, paths.count, runs);
+
+    for (int engine = ENGINE_LSI; engine <= ENGINE_REFERENCE; engine++) {
+        for (int phase = PHASE_LEX; phase <= PHASE_PARSE; phase++) {
+            free(runs[engine][phase].results);
+        }
+    }
+    for (int i = 0; i < paths.count; i++) {
+        free(paths.items[i]);
+    }
+    free(paths.items);
+    return divergent > 0 ? 1 : 0;
+}
@@ -0,0 +1,46 @@
+/*
+ * ============================================================================
+ * HEADER DO ANALISADOR DE REFERÊNCIA LSI-2025-2 (BISON)
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * Implementação independente do lexer e da gramática, gerada pelo bison a
+ * partir de referencia.y, usada pelo lsi-refbench como linha de base de
+ * desempenho e de conformidade. Só reconhece: não monta árvore nem tabela
+ * de símbolos.
+ *
+ * */
+
+#ifndef REFERENCIA_H
+#define REFERENCIA_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/* Resultados em RefResult.status */
+#define REF_ACCEPTED 0
+#define REF_ERROR 1             /* Erro léxico ou sintático em (line, col) */
+#define REF_LIMIT 2             /* Pilha do bison esgotada */
+
+typedef struct {
+    int status;
+    int64_t line;               /* Posição do primeiro token rejeitado */
+    int64_t col;
+    int64_t tokens;             /* Tokens lidos, sem contar o EOF */
+} RefResult;
+
+/*
+ * Analisa o conteúdo de input. Linhas e colunas seguem as regras do lexer
+ * principal: colunas em bytes a partir de 1, e "\r\n" e "\r" isolado
+ * contam como uma quebra de linha cada.
+ */
+void ref_parse_file(FILE* input, RefResult* result);
+
+/*
+ * Só a tokenização, até o EOF ou o primeiro token inválido (que fica em
+ * line e col, com status REF_ERROR).
+ */
+void ref_lex_file(FILE* input, RefResult* result);
+
+#endif
@@ -0,0 +1,398 @@
+/*
+ * ============================================================================
+ * ANALISADOR DE REFERÊNCIA LSI-2025-2 (BISON)
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * A mesma linguagem de parser.c, escrita como gramática LALR(1) para o
+ * bison e sem nenhum código compartilhado com o analisador principal: serve
+ * de linha de base de desempenho e de conformidade para o lsi-refbench.
+ * Só reconhece o programa; não há árvore nem ações semânticas.
+ *
+ * As regras seguem as produções LL(1) de parser.c com as listas escritas
+ * com recursão à esquerda, que é a forma natural para o bison e mantém a
+ * pilha rasa. A única decisão que a tabela LL(1) resolve espiando um token
+ * a mais (ATRIBST_TAIL → EXPR | FCALL) é LALR(1) sem conflitos aqui.
+ *
+ * O analisador léxico fica no final do arquivo, escrito à mão no estilo
+ * de um scanner do flex: buffer de entrada de REF_BUFFER_SIZE bytes,
+ * recarregado com fread(), em que o token que atravessa o fim do buffer é
+ * movido para o início antes da próxima leitura.
+ *
+ * Para gerar: bison -o referencia.tab.c referencia.y
+ *
+ * ============================================================================
+ */
+
+%code requires {
+#include "referencia.h"
+
+typedef struct RefScanner RefScanner;
+}
+
+%code {
+#include <stdlib.h>
+#include <string.h>
+
+/* A referência aceita o que a gramática aceita, sem o limite de profundidade padrão */
+#define YYMAXDEPTH 1000000
+
+static int ref_lex(REF_STYPE* value, RefScanner* scanner);
+static void ref_error(RefScanner* scanner, const char* message);
+}
+
+%define api.pure full
+%define api.prefix {ref_}
+%param {RefScanner* scanner}
+
+%token INT IF ELSE DEF PRINT RETURN ID NUM
+%token LT LTE GT GTE EQ NEQ
+%token ERRO
+
+%%
+
+main
+    : %empty
+    | stmt
+    | flist
+    ;
+
+flist
+    : fdef
+    | flist fdef
+    ;
+
+fdef
+    : DEF ID '(' parlist ')' '{' stmtlist '}'
+    ;
+
+parlist
+    : %empty
+    | params
+    ;
+
+params
+    : INT ID
+    | params ',' INT ID
+    ;
+
+stmt
+    : INT varlist ';'
+    | atribst ';'
+    | PRINT expr ';'
+    | RETURN ';'
+    | RETURN ID ';'
+    | IF '(' expr ')' '{' stmt '}'
+    | IF '(' expr ')' '{' stmt '}' ELSE '{' stmt '}'
+    | '{' stmtlist '}'
+    | ';'
+    ;
+
+stmtlist
+    : stmt
+    | stmtlist stmt
+    ;
+
+varlist
+    : ID
+    | varlist ',' ID
+    ;
+
+atribst
+    : ID '=' expr
+    | ID '=' ID '(' ')'
+    | ID '=' ID '(' idlist ')'
+    ;
+
+idlist
+    : ID
+    | idlist ',' ID
+    ;
+
+expr
+    : numexpr
+    | numexpr relop numexpr
+    ;
+
+relop
+    : LT | LTE | GT | GTE | EQ | NEQ
+    ;
+
+numexpr
+    : term
+    | numexpr '+' term
+    | numexpr '-' term
+    ;
+
+term
+    : factor
+    | term '*' factor
+    | term '/' factor
+    ;
+
+factor
+    : NUM
+    | ID
+    | '(' numexpr ')'
+    ;
+
+%%
+
+/* ============================================================================
+ * ANALISADOR LÉXICO
+ * ============================================================================ */
+
+#define REF_BUFFER_SIZE (64 * 1024)
+
+struct RefScanner {
+    FILE* input;
+    unsigned char* buffer;
+    size_t capacity;
+    size_t length;              /* Bytes válidos em buffer */
+    size_t pos;                 /* Próximo byte a ler */
+    size_t mark;                /* Início do token em andamento, preservado pela recarga */
+    int64_t base;               /* Posição de buffer[0] na entrada */
+    int at_eof;
+    int64_t line;
+    int64_t line_break;         /* Posição da última quebra de linha, -1 na primeira linha */
+    int64_t token_offset;       /* Posição do último token lido */
+    RefResult* result;
+};
+
+/*
+ * ref_fill(scanner)
+ *
+ * Descarta o que vem antes de mark, movendo o token em andamento para o
+ * início do buffer (que dobra de tamanho se o token já o ocupa inteiro), e
+ * lê mais um bloco. Retorna 0 no fim da entrada.
+ */
+static int ref_fill(RefScanner* s) {
+    if (s->at_eof) {
+        return 0;
+    }
+    if (s->mark > 0) {
+        memmove(s->buffer, s->buffer + s->mark, s->length - s->mark);
+        s->length -= s->mark;
+        s->pos -= s->mark;
+        s->base += (int64_t)s->mark;
+        s->mark = 0;
+    }
+    if (s->length == s->capacity) {
+        s->capacity *= 2;
+        s->buffer = (unsigned char*)realloc(s->buffer, s->capacity);
+        if (s->buffer == NULL) {
+            fprintf(stderr, "Erro fatal: Memória insuficiente para o buffer de entrada.\n");
+            exit(1);
+        }
+    }
+    size_t n = fread(s->buffer + s->length, 1, s->capacity - s->length, s->input);
+    if (n == 0) {
+        s->at_eof = 1;
+        return 0;
+    }
+    s->length += n;
+    return 1;
+}
+
+static inline int ref_peek(RefScanner* s) {
+    if (s->pos < s->length || ref_fill(s)) {
+        return s->buffer[s->pos];
+    }
+    return EOF;
+}
+
+static inline int is_digit(int c) {
+    return c >= '0' && c <= '9';
+}
+
+static inline int is_identifier_start(int c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+static inline int is_identifier_char(int c) {
+    return is_identifier_start(c) || is_digit(c);
+}
+
+/*
+ * skip_spaces(scanner)
+ *
+ * Pula espaços contando as quebras de linha: um '\r' isolado conta como
+ * quebra, e em "\r\n" a quebra passa a ser a posição do '\n'.
+ */
+static void skip_spaces(RefScanner* s) {
+    int after_cr = 0;
+    for (;;) {
+        if (s->pos == s->length) {
+            s->mark = s->pos;
+            if (!ref_fill(s)) {
+                return;
+            }
+        }
+        int c = s->buffer[s->pos];
+        if (c == '\n') {
+            if (!after_cr) {
+                s->line++;
+            }
+            s->line_break = s->base + (int64_t)s->pos;
+            after_cr = 0;
+        } else if (c == '\r') {
+            s->line++;
+            s->line_break = s->base + (int64_t)s->pos;
+            after_cr = 1;
+        } else if (c == ' ' || c == '\t' || c == '\v' || c == '\f') {
+            after_cr = 0;
+        } else {
+            return;
+        }
+        s->pos++;
+    }
+}
+
+static const struct {
+    const char* text;
+    size_t length;
+    int token;
+} keywords[] = {
+    {"int", 3, INT}, {"if", 2, IF}, {"else", 4, ELSE},
+    {"def", 3, DEF}, {"print", 5, PRINT}, {"return", 6, RETURN}
+};
+
+/*
+ * scan_number(scanner)
+ *
+ * Literais fora do intervalo de int64_t são erro léxico.
+ */
+static int scan_number(RefScanner* s) {
+    uint64_t value = 0;
+    int overflow = 0;
+    int c;
+    while (is_digit(c = ref_peek(s))) {
+        uint64_t digit = (uint64_t)(c - '0');
+        if (value > ((uint64_t)INT64_MAX - digit) / 10) {
+            overflow = 1;
+        } else {
+            value = value * 10 + digit;
+        }
+        s->pos++;
+    }
+    return overflow ? ERRO : NUM;
+}
+
+static int scan_identifier(RefScanner* s) {
+    while (is_identifier_char(ref_peek(s))) {
+        s->pos++;
+    }
+    const char* text = (const char*)s->buffer + s->mark;
+    size_t length = s->pos - s->mark;
+    for (size_t i = 0; i < sizeof(keywords) / sizeof(keywords[0]); i++) {
+        if (keywords[i].length == length && memcmp(keywords[i].text, text, length) == 0) {
+            return keywords[i].token;
+        }
+    }
+    return ID;
+}
+
+/*
+ * scan_operator(scanner, single, with_equals)
+ *
+ * Operadores de um caractere que formam outro quando seguidos de '='.
+ */
+static int scan_operator(RefScanner* s, int single, int with_equals) {
+    s->pos++;
+    if (ref_peek(s) == '=') {
+        s->pos++;
+        return with_equals;
+    }
+    return single;
+}
+
+static int scan_token(RefScanner* s) {
+    skip_spaces(s);
+    s->mark = s->pos;
+    s->token_offset = s->base + (int64_t)s->pos;
+
+    int c = ref_peek(s);
+    if (c == EOF) {
+        return 0;
+    }
+    if (is_digit(c)) {
+        return scan_number(s);
+    }
+    if (is_identifier_start(c)) {
+        return scan_identifier(s);
+    }
+    switch (c) {
+        case '=': return scan_operator(s, '=', EQ);
+        case '<': return scan_operator(s, LT, LTE);
+        case '>': return scan_operator(s, GT, GTE);
+        case '!': return scan_operator(s, ERRO, NEQ);
+        case '+': case '-': case '*': case '/':
+        case '(': case ')': case '{': case '}': case ',': case ';':
+            s->pos++;
+            return c;
+    }
+    s->pos++;
+    return ERRO;
+}
+
+static int ref_lex(REF_STYPE* value, RefScanner* scanner) {
+    (void)value;
+    int token = scan_token(scanner);
+    if (token != 0) {
+        scanner->result->tokens++;
+    }
+    return token;
+}
+
+static void ref_error(RefScanner* scanner, const char* message) {
+    (void)message;
+    RefResult* result = scanner->result;
+    if (result->status == REF_ACCEPTED) {
+        result->status = REF_ERROR;
+        result->line = scanner->line;
+        result->col = scanner->token_offset - scanner->line_break;
+    }
+}
+
+/* ============================================================================
+ * INTERFACE
+ * ============================================================================ */
+
+static void scanner_open(RefScanner* s, FILE* input, RefResult* result) {
+    memset(s, 0, sizeof(*s));
+    memset(result, 0, sizeof(*result));
+    s->input = input;
+    s->capacity = REF_BUFFER_SIZE;
+    s->buffer = (unsigned char*)malloc(s->capacity);
+    if (s->buffer == NULL) {
+        fprintf(stderr, "Erro fatal: Memória insuficiente para o buffer de entrada.\n");
+        exit(1);
+    }
+    s->line = 1;
+    s->line_break = -1;
+    s->result = result;
+}
+
+void ref_parse_file(FILE* input, RefResult* result) {
+    RefScanner scanner;
+    scanner_open(&scanner, input, result);
+    if (ref_parse(&scanner) == 2) {
+        result->status = REF_LIMIT;
+    }
+    free(scanner.buffer);
+}
+
+void ref_lex_file(FILE* input, RefResult* result) {
+    RefScanner scanner;
+    scanner_open(&scanner, input, result);
+    int token;
+    while ((token = scan_token(&scanner)) != 0) {
+        if (token == ERRO) {
+            ref_error(&scanner, NULL);
+            break;
+        }
+        result->tokens++;
+    }
+    free(scanner.buffer);
+}
@@ -0,0 +1,346 @@
+/*
+ * ============================================================================
+ * CACHE DE RESULTADOS EM DISCO
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * Guarda, para cada arquivo já analisado, o resultado da análise (sucesso
+ * ou a lista completa de diagnósticos) em um diretório compartilhado:
+ *   - O nome da entrada é o SHA-256 hexadecimal da versão da gramática e
+ *     dos bytes do arquivo, de modo que arquivos iguais em caminhos
+ *     diferentes compartilham a entrada e mudanças na tabela LL(1)
+ *     invalidam todas as entradas
+ *   - A escrita vai para um arquivo temporário no mesmo diretório, que
+ *     rename() torna visível de uma só vez; leitores concorrentes veem a
+ *     entrada inteira ou nenhuma
+ *   - Um acerto custa uma passada de hash sobre o arquivo mais a leitura
+ *     de uma entrada pequena
+ *   - Após cada escrita, se o diretório passa de max_bytes, as entradas
+ *     usadas há mais tempo são removidas até 90% do limite. A data de
+ *     modificação marca o último uso e é renovada por acertos em entradas
+ *     com mais de uma hora
+ *   - Para não listar o diretório a cada escrita, o arquivo ".uso" guarda
+ *     uma estimativa do tamanho total e o número de escritas desde a
+ *     última listagem, atualizados sob flock(). O diretório só é listado
+ *     quando a estimativa passa do limite ou a cada USAGE_SCAN_INTERVAL
+ *     escritas, que corrigem o que outros processos removeram
+ *   - A listagem também remove os temporários deixados por um processo
+ *     que parou antes do rename()
+ *
+ * Formato de uma entrada:
+ *   "LSIRC002"  número de diagnósticos (uint32)
+ *   por diagnóstico: tipo (int32), linha e coluna (int64) e tamanho do
+ *   texto (int32), seguidos do texto sem terminador
+ *
+ * ============================================================================
+ */
+
+#define _GNU_SOURCE
+
+#include "result_cache.h"
+#include "parser.h"
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define ENTRY_MAGIC "LSIRC002"
+#define ENTRY_MAX_SIZE (1024 * 1024)
+#define TOUCH_INTERVAL_SECONDS 3600
+#define USAGE_FILE ".uso"
+#define USAGE_SCAN_INTERVAL 1000
+#define TEMP_PREFIX ".tmp."
+#define TEMP_GRACE_SECONDS 600     /* Temporário mais antigo: escritor que não terminou */
+
+/* ============================================================================
+ * CHAVE E CAMINHOS
+ * ============================================================================ */
+
+void result_cache_key(const char* data, size_t length, unsigned char key[SHA256_DIGEST_SIZE]) {
+    Sha256 ctx;
+    const char* version = parser_grammar_version();
+    sha256_init(&ctx);
+    sha256_update(&ctx, version, strlen(version) + 1);
+    sha256_update(&ctx, data, length);
+    sha256_final(&ctx, key);
+}
+
+/*
+ * entry_path(cache, key, path, size)
+ *
+ * Monta "<dir>/<sha256 em hexadecimal>".
+ */
+static void entry_path(const ResultCache* cache, const unsigned char key[SHA256_DIGEST_SIZE],
+                       char* path, size_t size) {
+    static const char hex[] = "0123456789abcdef";
+    char name[SHA256_DIGEST_SIZE * 2 + 1];
+    for (int i = 0; i < SHA256_DIGEST_SIZE; i++) {
+        name[i * 2] = hex[key[i] >> 4];
+        name[i * 2 + 1] = hex[key[i] & 15];
+    }
+    name[SHA256_DIGEST_SIZE * 2] = '\0';
+    snprintf(path, size, "%s/%s", cache->dir, name);
+}
+
+static int is_temp_name(const char* name) {
+    return strncmp(name, TEMP_PREFIX, strlen(TEMP_PREFIX)) == 0;
+}
+
+static int is_entry_name(const char* name) {
+    if (strlen(name) != SHA256_DIGEST_SIZE * 2) {
+        return 0;
+    }
+    return strspn(name, "0123456789abcdef") == SHA256_DIGEST_SIZE * 2;
+}
+
+int result_cache_open(ResultCache* cache, const char* dir, size_t max_bytes) {
+    cache->dir = dir;
+    cache->max_bytes = max_bytes;
+    if (mkdir(dir, 0777) != 0 && errno != EEXIST) {
+        return -1;
+    }
+    return 0;
+}
+
+/* ============================================================================
+ * LEITURA
+ * ============================================================================ */
+
+static int32_t read_i32(const unsigned char* p) {
+    int32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static int64_t read_i64(const unsigned char* p) {
+    int64_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+/*
+ * result_cache_lookup(cache, key, out)
+ *
+ * Lê a entrada com uma única chamada read() e valida seu formato; uma
+ * entrada corrompida é tratada como ausente.
+ */
+int result_cache_lookup(const ResultCache* cache, const unsigned char key[SHA256_DIGEST_SIZE],
+                        DiagnosticList* out) {
+    char path[4096];
+    static unsigned char buffer[ENTRY_MAX_SIZE];
+    entry_path(cache, key, path, sizeof(path));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    ssize_t size = read(fd, buffer, sizeof(buffer));
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && time(NULL) - st.st_mtime > TOUCH_INTERVAL_SECONDS) {
+        futimens(fd, NULL);
+    }
+    close(fd);
+
+    if (size < 12 || memcmp(buffer, ENTRY_MAGIC, 8) != 0) {
+        return 0;
+    }
+    int count = read_i32(buffer + 8);
+    int before = out->count;
+    size_t pos = 12;
+    for (int i = 0; i < count; i++) {
+        if (pos + 24 > (size_t)size) {
+            out->count = before;
+            return 0;
+        }
+        int kind = read_i32(buffer + pos);
+        int64_t line = read_i64(buffer + pos + 4);
+        int64_t col = read_i64(buffer + pos + 12);
+        int length = read_i32(buffer + pos + 20);
+        pos += 24;
+        if (length < 0 || length >= DIAGNOSTIC_TEXT_SIZE || pos + (size_t)length > (size_t)size) {
+            out->count = before;
+            return 0;
+        }
+        diagnostic_set(diagnostic_list_add(out), (DiagnosticKind)kind, line, col,
+                       "%.*s", length, (const char*)buffer + pos);
+        pos += (size_t)length;
+    }
+    return 1;
+}
+
+/* ============================================================================
+ * ESCRITA E DESCARTE
+ * ============================================================================ */
+
+typedef struct {
+    char name[SHA256_DIGEST_SIZE * 2 + 1];
+    time_t mtime;
+    off_t size;
+} EntryInfo;
+
+static int compare_entry_age(const void* a, const void* b) {
+    time_t x = ((const EntryInfo*)a)->mtime;
+    time_t y = ((const EntryInfo*)b)->mtime;
+    return (x > y) - (x < y);
+}
+
+/*
+ * evict_if_needed(cache)
+ *
+ * Soma o tamanho das entradas e, se passar do limite, remove as mais
+ * antigas até 90% dele. Entradas já removidas por outro processo são
+ * ignoradas. Temporários com mais de TEMP_GRACE_SECONDS são de um
+ * processo que parou entre write() e rename() e são removidos; os mais
+ * novos contam no tamanho. Retorna o tamanho que restou.
+ */
+static off_t evict_if_needed(const ResultCache* cache) {
+    DIR* dir = opendir(cache->dir);
+    if (dir == NULL) {
+        return 0;
+    }
+
+    EntryInfo* entries = NULL;
+    size_t count = 0, capacity = 0;
+    off_t total = 0;
+    time_t now = time(NULL);
+    struct dirent* ent;
+    while ((ent = readdir(dir)) != NULL) {
+        struct stat st;
+        int temp = is_temp_name(ent->d_name);
+        if ((!temp && !is_entry_name(ent->d_name)) ||
+            fstatat(dirfd(dir), ent->d_name, &st, 0) != 0) {
+            continue;
+        }
+        if (temp) {
+            if (now - st.st_mtime <= TEMP_GRACE_SECONDS ||
+                unlinkat(dirfd(dir), ent->d_name, 0) != 0) {
+                total += st.st_blocks * 512;
+            }
+            continue;
+        }
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 256;
+            entries = (EntryInfo*)realloc(entries, sizeof(EntryInfo) * capacity);
+            if (entries == NULL) {
+                fprintf(stderr, "Erro fatal: Memória insuficiente para listar a cache.\n");
+                exit(1);
+            }
+        }
+        strcpy(entries[count].name, ent->d_name);
+        entries[count].mtime = st.st_mtime;
+        entries[count].size = st.st_blocks * 512;
+        total += entries[count].size;
+        count++;
+    }
+
+    if ((size_t)total > cache->max_bytes) {
+        off_t target = (off_t)(cache->max_bytes / 10 * 9);
+        qsort(entries, count, sizeof(EntryInfo), compare_entry_age);
+        for (size_t i = 0; i < count && total > target; i++) {
+            if (unlinkat(dirfd(dir), entries[i].name, 0) == 0) {
+                total -= entries[i].size;
+            }
+        }
+    }
+    free(entries);
+    closedir(dir);
+    return total;
+}
+
+/*
+ * account_store(cache, entry_size)
+ *
+ * Soma a entrada recém-escrita à estimativa de ".uso" e lista o diretório
+ * só quando necessário. Uma entrada reescrita com a mesma chave é contada
+ * duas vezes, o que apenas antecipa a próxima listagem. Sem o arquivo de
+ * uso (diretório antigo, ou sem permissão), lista sempre.
+ */
+static void account_store(const ResultCache* cache, off_t entry_size) {
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/%s", cache->dir, USAGE_FILE);
+    int fd = open(path, O_RDWR | O_CREAT, 0666);
+    if (fd < 0) {
+        evict_if_needed(cache);
+        return;
+    }
+    flock(fd, LOCK_EX);
+
+    char text[64];
+    long long total = 0, stores = 0;
+    ssize_t length = pread(fd, text, sizeof(text) - 1, 0);
+    int known = length > 0;
+    if (known) {
+        text[length] = '\0';
+        known = sscanf(text, "%lld %lld", &total, &stores) == 2;
+    }
+    total += entry_size;
+    stores++;
+    if (!known || total > (long long)cache->max_bytes || stores >= USAGE_SCAN_INTERVAL) {
+        total = evict_if_needed(cache);
+        stores = 0;
+    }
+
+    length = snprintf(text, sizeof(text), "%lld %lld\n", total, stores);
+    if (ftruncate(fd, 0) != 0 || pwrite(fd, text, (size_t)length, 0) != length) {
+        unlink(path);       /* Estimativa perdida: a próxima escrita lista */
+    }
+    flock(fd, LOCK_UN);
+    close(fd);
+}
+
+static void append_i32(TextBuffer* buffer, int32_t value) {
+    text_append(buffer, (const char*)&value, sizeof(value));
+}
+
+static void append_i64(TextBuffer* buffer, int64_t value) {
+    text_append(buffer, (const char*)&value, sizeof(value));
+}
+
+/*
+ * result_cache_store(cache, key, diags)
+ *
+ * Escreve a entrada em um arquivo temporário único e a publica com rename().
+ */
+void result_cache_store(const ResultCache* cache, const unsigned char key[SHA256_DIGEST_SIZE],
+                        const DiagnosticList* diags) {
+    TextBuffer entry = {0};
+    text_append(&entry, ENTRY_MAGIC, 8);
+    append_i32(&entry, diags->count);
+    for (int i = 0; i < diags->count; i++) {
+        const Diagnostic* diag = &diags->items[i];
+        int length = (int)strlen(diag->text);
+        append_i32(&entry, diag->kind);
+        append_i64(&entry, diag->line);
+        append_i64(&entry, diag->col);
+        append_i32(&entry, length);
+        text_append(&entry, diag->text, (size_t)length);
+    }
+
+    char path[4096];
+    char temp_path[4096 + 64];
+    entry_path(cache, key, path, sizeof(path));
+    snprintf(temp_path, sizeof(temp_path), "%s/" TEMP_PREFIX "%ld.%ld", cache->dir,
+             (long)getpid(), (long)random());
+
+    int fd = open(temp_path, O_WRONLY | O_CREAT | O_EXCL, 0666);
+    if (fd >= 0) {
+        ssize_t written = write(fd, entry.data, entry.length);
+        close(fd);
+        if (written != (ssize_t)entry.length || rename(temp_path, path) != 0) {
+            unlink(temp_path);
+        } else {
+            /* Espaço em disco estimado em blocos de 4 KB */
+            account_store(cache, (off_t)((entry.length + 4095) / 4096 * 4096));
+        }
+    }
+    text_free(&entry);
+}
@@ -0,0 +1,41 @@
+/*
+ * ============================================================================
+ * HEADER DA CACHE DE RESULTADOS EM DISCO
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * */
+
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include <stddef.h>
+#include "diagnostic.h"
+#include "sha256.h"
+
+#define RESULT_CACHE_DEFAULT_MB 256
+
+typedef struct {
+    const char* dir;
+    size_t max_bytes;       /* Acima disso, as entradas mais antigas são removidas */
+} ResultCache;
+
+/* Cria o diretório, se necessário. Retorna 0 em caso de sucesso. */
+int result_cache_open(ResultCache* cache, const char* dir, size_t max_bytes);
+
+/* Chave: SHA-256 da versão da gramática seguida dos bytes do arquivo */
+void result_cache_key(const char* data, size_t length, unsigned char key[SHA256_DIGEST_SIZE]);
+
+/*
+ * Procura o resultado guardado para a chave. Retorna 1 e acrescenta a out
+ * os diagnósticos guardados (nenhum se o arquivo era válido), ou 0.
+ */
+int result_cache_lookup(const ResultCache* cache, const unsigned char key[SHA256_DIGEST_SIZE],
+                        DiagnosticList* out);
+
+/* Guarda o resultado de forma atômica; falhas de escrita são ignoradas */
+void result_cache_store(const ResultCache* cache, const unsigned char key[SHA256_DIGEST_SIZE],
+                        const DiagnosticList* diags);
+
+#endif
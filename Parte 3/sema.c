@@ -0,0 +1,286 @@
+/*
+ * ============================================================================
+ * ANÁLISE SEMÂNTICA PARA A LINGUAGEM LSI-2025-2
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * Este módulo implementa as verificações de programa inteiro, sem parar
+ * no primeiro erro:
+ *   - Funções definidas mais de uma vez
+ *   - Chamadas a funções não definidas, inclusive as definidas mais adiante
+ *   - Chamadas com número de argumentos diferente do de parâmetros
+ *   - Variáveis usadas antes de declaradas com int (ou fora do escopo da
+ *     declaração)
+ *   - Variáveis declaradas mais de uma vez no mesmo escopo
+ *
+ * A verificação é uma única passada em ordem pela árvore, depois de
+ * registrar as funções. As tabelas são indexadas pelo número do símbolo
+ * (AstNode.value) em vez do nome, de modo que cada consulta custa O(1) e
+ * o total é linear no tamanho do programa.
+ *
+ * ============================================================================
+ */
+
+#include "sema.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ============================================================================
+ * TABELAS POR NÚMERO DE SÍMBOLO
+ * ============================================================================
+ *
+ * Os escopos formam uma pilha de ligações (bindings). Para cada símbolo,
+ * binding_head aponta a ligação visível, que guarda a anterior, sombreada
+ * por ela; sair de um escopo desempilha suas ligações e restaura as
+ * anteriores. As tabelas são da thread e reaproveitadas entre programas:
+ * ao fim de cada verificação todas as posições usadas voltam a zero.
+ */
+
+typedef struct {
+    const AstNode* decl;        /* AST_ID da declaração */
+    int symbol;
+    int previous;               /* Ligação sombreada: índice + 1, ou 0 */
+} Binding;
+
+typedef struct {
+    DiagnosticList* out;
+    Binding* bindings;
+    int binding_count;
+    int binding_capacity;
+} SemaContext;
+
+static __thread int* binding_head = NULL;           /* Por símbolo: índice + 1, ou 0 */
+static __thread const AstNode** function_of = NULL; /* Por símbolo: AST_FDEF, ou NULL */
+static __thread int symbol_capacity = 0;
+
+/*
+ * ensure_symbol(symbol)
+ *
+ * Garante que as tabelas por símbolo cobrem o número symbol.
+ */
+static void ensure_symbol(int symbol) {
+    if (symbol < symbol_capacity) {
+        return;
+    }
+    int capacity = symbol_capacity ? symbol_capacity : 1024;
+    while (capacity <= symbol) {
+        capacity *= 2;
+    }
+    binding_head = (int*)realloc(binding_head, sizeof(int) * (size_t)capacity);
+    function_of = (const AstNode**)realloc(function_of, sizeof(AstNode*) * (size_t)capacity);
+    if (binding_head == NULL || function_of == NULL) {
+        fprintf(stderr, "Erro fatal: Memória insuficiente para a análise semântica.\n");
+        exit(1);
+    }
+    memset(binding_head + symbol_capacity, 0, sizeof(int) * (size_t)(capacity - symbol_capacity));
+    memset(function_of + symbol_capacity, 0,
+           sizeof(AstNode*) * (size_t)(capacity - symbol_capacity));
+    symbol_capacity = capacity;
+}
+
+/*
+ * semantic_error(ctx, node, format, ...)
+ *
+ * Acrescenta um erro semântico na posição do nó.
+ */
+static void semantic_error(SemaContext* ctx, const AstNode* node, const char* format, ...)
+    __attribute__((format(printf, 3, 4)));
+
+static void semantic_error(SemaContext* ctx, const AstNode* node, const char* format, ...) {
+    char message[DIAGNOSTIC_TEXT_SIZE];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+    diagnostic_set(diagnostic_list_add(ctx->out), DIAG_SEMANTIC, node->line, node->col,
+                   "--- Erro Semântico ---\n%s na linha %d, coluna %d",
+                   message, node->line, node->col);
+}
+
+/* ============================================================================
+ * ESCOPOS
+ * ============================================================================ */
+
+/*
+ * declare(ctx, id, scope_start)
+ *
+ * Liga o AST_ID id no escopo corrente, cujas ligações começam em
+ * scope_start. Um nome já ligado no mesmo escopo é um erro.
+ */
+static void declare(SemaContext* ctx, const AstNode* id, int scope_start) {
+    int symbol = (int)id->value;
+    ensure_symbol(symbol);
+
+    int visible = binding_head[symbol];
+    if (visible > scope_start) {
+        semantic_error(ctx, id, "Variável '%s' declarada mais de uma vez no mesmo escopo",
+                       id->name);
+        return;
+    }
+
+    if (ctx->binding_count == ctx->binding_capacity) {
+        ctx->binding_capacity = ctx->binding_capacity ? ctx->binding_capacity * 2 : 256;
+        ctx->bindings = (Binding*)realloc(ctx->bindings,
+                                          sizeof(Binding) * (size_t)ctx->binding_capacity);
+        if (ctx->bindings == NULL) {
+            fprintf(stderr, "Erro fatal: Memória insuficiente para a análise semântica.\n");
+            exit(1);
+        }
+    }
+    ctx->bindings[ctx->binding_count] = (Binding){id, symbol, visible};
+    binding_head[symbol] = ++ctx->binding_count;
+}
+
+/*
+ * close_scope(ctx, scope_start)
+ *
+ * Desfaz as ligações feitas desde scope_start, da mais recente para a
+ * mais antiga.
+ */
+static void close_scope(SemaContext* ctx, int scope_start) {
+    while (ctx->binding_count > scope_start) {
+        const Binding* binding = &ctx->bindings[--ctx->binding_count];
+        binding_head[binding->symbol] = binding->previous;
+    }
+}
+
+/*
+ * check_use(ctx, node)
+ *
+ * Verifica que o nome lido ou atribuído em node tem uma declaração visível.
+ */
+static void check_use(SemaContext* ctx, const AstNode* node) {
+    int symbol = (int)node->value;
+    if (symbol >= symbol_capacity || binding_head[symbol] == 0) {
+        semantic_error(ctx, node, "Variável '%s' usada sem declaração", node->name);
+    }
+}
+
+/* ============================================================================
+ * PERCURSO
+ * ============================================================================ */
+
+/*
+ * check_node(ctx, node, scope_start)
+ *
+ * Visita node em ordem de execução: declarações só valem para os comandos
+ * seguintes, e cada AST_BLOCK e cada ramo de AST_IF abrem um escopo (o
+ * corpo de um ramo é um único comando, sem AST_BLOCK próprio).
+ */
+static void check_node(SemaContext* ctx, const AstNode* node, int scope_start) {
+    switch (node->kind) {
+        case AST_VARDECL:
+            for (int i = 0; i < node->kid_count; i++) {
+                declare(ctx, node->kids[i], scope_start);
+            }
+            return;
+
+        case AST_BLOCK: {
+            int inner_start = ctx->binding_count;
+            for (int i = 0; i < node->kid_count; i++) {
+                check_node(ctx, node->kids[i], inner_start);
+            }
+            close_scope(ctx, inner_start);
+            return;
+        }
+
+        case AST_IF:
+            check_node(ctx, node->kids[0], scope_start);
+            for (int i = 1; i < node->kid_count; i++) {
+                int inner_start = ctx->binding_count;
+                check_node(ctx, node->kids[i], inner_start);
+                close_scope(ctx, inner_start);
+            }
+            return;
+
+        case AST_ASSIGN:
+            check_node(ctx, node->kids[0], scope_start);
+            check_use(ctx, node);
+            return;
+
+        case AST_FCALL: {
+            int symbol = (int)node->value;
+            const AstNode* callee = symbol < symbol_capacity ? function_of[symbol] : NULL;
+            if (callee == NULL) {
+                semantic_error(ctx, node, "Chamada a função não definida '%s'", node->name);
+            } else if (callee->param_count != node->kid_count) {
+                semantic_error(ctx, node,
+                               "Chamada a '%s' com %d argumento(s); a função tem %d parâmetro(s)",
+                               node->name, node->kid_count, callee->param_count);
+            }
+            break;
+        }
+
+        case AST_ID:
+            check_use(ctx, node);
+            return;
+
+        default:
+            break;
+    }
+
+    for (int i = 0; i < node->kid_count; i++) {
+        check_node(ctx, node->kids[i], scope_start);
+    }
+}
+
+/*
+ * check_function(ctx, fdef)
+ *
+ * Os parâmetros e os comandos do corpo formam um único escopo.
+ */
+static void check_function(SemaContext* ctx, const AstNode* fdef) {
+    int scope_start = ctx->binding_count;
+    for (int i = 0; i < fdef->param_count; i++) {
+        declare(ctx, fdef->params[i], scope_start);
+    }
+    for (int i = 0; i < fdef->kid_count; i++) {
+        check_node(ctx, fdef->kids[i], scope_start);
+    }
+    close_scope(ctx, scope_start);
+}
+
+/*
+ * sema_check_program(program, out)
+ *
+ * Registra todas as funções antes de verificar os corpos, para que
+ * chamadas a funções definidas mais adiante sejam resolvidas.
+ */
+int sema_check_program(const AstNode* program, DiagnosticList* out) {
+    SemaContext ctx = {out, NULL, 0, 0};
+    int before = out->count;
+
+    for (int i = 0; i < program->kid_count; i++) {
+        const AstNode* fdef = program->kids[i];
+        if (fdef->kind != AST_FDEF) {
+            continue;
+        }
+        ensure_symbol((int)fdef->value);
+        if (function_of[fdef->value] != NULL) {
+            semantic_error(&ctx, fdef, "Função '%s' definida mais de uma vez", fdef->name);
+        } else {
+            function_of[fdef->value] = fdef;
+        }
+    }
+
+    for (int i = 0; i < program->kid_count; i++) {
+        const AstNode* node = program->kids[i];
+        if (node->kind == AST_FDEF) {
+            check_function(&ctx, node);
+        } else {
+            check_node(&ctx, node, 0);      /* Programa de um único comando */
+            close_scope(&ctx, 0);
+        }
+    }
+
+    for (int i = 0; i < program->kid_count; i++) {
+        if (program->kids[i]->kind == AST_FDEF) {
+            function_of[program->kids[i]->value] = NULL;
+        }
+    }
+    free(ctx.bindings);
+    return out->count - before;
+}
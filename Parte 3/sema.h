@@ -0,0 +1,24 @@
+/*
+ * ============================================================================
+ * HEADER DA ANÁLISE SEMÂNTICA PARA A LINGUAGEM LSI-2025-2
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * */
+
+#ifndef SEMA_H
+#define SEMA_H
+
+#include "ast.h"
+#include "diagnostic.h"
+
+/*
+ * Verifica o programa já analisado sintaticamente e acrescenta a out um
+ * diagnóstico por problema encontrado. Retorna o número de diagnósticos
+ * acrescentados. Linear no tamanho do programa; threads diferentes podem
+ * verificar programas diferentes ao mesmo tempo.
+ */
+int sema_check_program(const AstNode* program, DiagnosticList* out);
+
+#endif
@@ -0,0 +1,590 @@
+/*
+ * ============================================================================
+ * SERVIDOR DE ANÁLISE (lsi-serverd) PARA A LINGUAGEM LSI-2025-2
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * Processo de longa duração que atende pedidos de análise em um socket
+ * Unix, evitando a cada validação o custo de criar um processo, montar a
+ * tabela de símbolos e a tabela LL(1) e aquecer as caches:
+ *   - Um único laço com poll() atende várias conexões
+ *   - O estado do parser (tabelas, pilhas, arena da árvore e área de
+ *     lexemas) é inicializado uma vez e reaproveitado entre pedidos
+ *   - Resultados ficam em uma cache em memória indexada pelo hash do
+ *     conteúdo, com descarte do menos usado quando excede o limite
+ *   - Orçamentos por pedido (--limite-*, ver parser.h), para que um envio
+ *     patológico não prenda o processo nem esgote a memória; um orçamento
+ *     esgotado é respondido como diagnóstico "limit" e não entra na cache
+ *
+ * Protocolo (uma linha de cabeçalho por pedido):
+ *   PARSE FILE <caminho>\n      analisa o arquivo indicado, que precisa
+ *                               estar sob a raiz (--raiz, por padrão o
+ *                               diretório de trabalho ao iniciar)
+ *   PARSE DATA <tamanho>\n...   analisa os <tamanho> bytes seguintes
+ *   LINT FILE <caminho>\n       como PARSE, mais a análise semântica e os avisos
+ *   LINT DATA <tamanho>\n...
+ *   STATS\n                     contadores do servidor
+ *
+ * Qualquer processo que consiga abrir o socket pode fazer pedidos; FILE
+ * só lê arquivos sob a raiz, resolvida com realpath() (links simbólicos
+ * para fora dela são recusados).
+ *
+ * Cada pedido recebe uma linha JSON, por exemplo:
+ *   {"status":"ok","valid":false,"cached":true,"micros":3,"diagnostics":[...]}
+ *
+ * ============================================================================
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <limits.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+#include "parser.h"
+#include "sema.h"
+#include "warnings.h"
+
+/* ============================================================================
+ * CONSTANTES
+ * ============================================================================ */
+
+#define DEFAULT_SOCKET_PATH "/tmp/lsi-serverd.sock"
+#define DEFAULT_CACHE_MB 64
+#define MAX_CLIENTS 64
+#define MAX_HEADER_SIZE 4096
+#define MAX_REQUEST_SIZE (64 * 1024 * 1024)
+#define CACHE_BUCKETS 4096
+
+/* ============================================================================
+ * CACHE DE RESULTADOS
+ * ============================================================================
+ *
+ * A chave é o hash FNV-1a de 64 bits do conteúdo e o tipo de pedido. Como
+ * o hash não é criptográfico, a entrada guarda uma cópia do conteúdo e um
+ * acerto só é aceito se os bytes coincidirem. As entradas formam uma lista
+ * duplamente encadeada em ordem de uso para o descarte.
+ */
+
+typedef struct CacheEntry {
+    uint64_t hash;
+    int lint;
+    char* content;
+    size_t length;
+    char* result;                   /* "\"valid\":...,\"diagnostics\":[...]" */
+    size_t result_length;
+    struct CacheEntry* bucket_next;
+    struct CacheEntry* newer;
+    struct CacheEntry* older;
+} CacheEntry;
+
+static CacheEntry* cache_buckets[CACHE_BUCKETS];
+static CacheEntry* cache_newest = NULL;
+static CacheEntry* cache_oldest = NULL;
+static size_t cache_bytes = 0;
+static size_t cache_limit = (size_t)DEFAULT_CACHE_MB * 1024 * 1024;
+static int cache_entries = 0;
+
+static unsigned long stat_requests = 0;
+static unsigned long stat_hits = 0;
+static unsigned long stat_misses = 0;
+
+/*
+ * hash_content(data, length)
+ *
+ * Hash FNV-1a de 64 bits sobre os bytes do conteúdo.
+ */
+static uint64_t hash_content(const char* data, size_t length) {
+    uint64_t hash_value = 14695981039346656037ull;
+    for (size_t i = 0; i < length; i++) {
+        hash_value = (hash_value ^ (unsigned char)data[i]) * 1099511628211ull;
+    }
+    return hash_value;
+}
+
+static void lru_unlink(CacheEntry* entry) {
+    if (entry->newer) entry->newer->older = entry->older; else cache_newest = entry->older;
+    if (entry->older) entry->older->newer = entry->newer; else cache_oldest = entry->newer;
+    entry->newer = entry->older = NULL;
+}
+
+static void lru_push_newest(CacheEntry* entry) {
+    entry->older = cache_newest;
+    entry->newer = NULL;
+    if (cache_newest) cache_newest->newer = entry; else cache_oldest = entry;
+    cache_newest = entry;
+}
+
+/*
+ * cache_lookup(hash, lint, content, length)
+ *
+ * Retorna a entrada com o mesmo conteúdo, marcando-a como a mais recente,
+ * ou NULL.
+ */
+static CacheEntry* cache_lookup(uint64_t hash, int lint, const char* content, size_t length) {
+    for (CacheEntry* entry = cache_buckets[hash % CACHE_BUCKETS]; entry; entry = entry->bucket_next) {
+        if (entry->hash == hash && entry->lint == lint && entry->length == length &&
+            memcmp(entry->content, content, length) == 0) {
+            lru_unlink(entry);
+            lru_push_newest(entry);
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * cache_evict_oldest()
+ *
+ * Remove a entrada usada há mais tempo.
+ */
+static void cache_evict_oldest(void) {
+    CacheEntry* entry = cache_oldest;
+    CacheEntry** link = &cache_buckets[entry->hash % CACHE_BUCKETS];
+    while (*link != entry) {
+        link = &(*link)->bucket_next;
+    }
+    *link = entry->bucket_next;
+    lru_unlink(entry);
+
+    cache_bytes -= entry->length + entry->result_length;
+    cache_entries--;
+    free(entry->content);
+    free(entry->result);
+    free(entry);
+}
+
+/*
+ * cache_store(hash, lint, content, length, result, result_length)
+ *
+ * Guarda um resultado, descartando as entradas mais antigas até caber no
+ * limite. Conteúdos maiores que o próprio limite não são guardados, e
+ * sem memória para a cópia o resultado só deixa de ir para a cache.
+ */
+static void cache_store(uint64_t hash, int lint, const char* content, size_t length,
+                        const char* result, size_t result_length) {
+    size_t size = length + result_length;
+    if (size > cache_limit) {
+        return;
+    }
+    while (cache_oldest != NULL && cache_bytes + size > cache_limit) {
+        cache_evict_oldest();
+    }
+
+    CacheEntry* entry = (CacheEntry*)calloc(1, sizeof(CacheEntry));
+    if (entry == NULL) {
+        return;
+    }
+    entry->content = (char*)malloc(length + 1);
+    entry->result = strndup(result, result_length);
+    if (entry->content == NULL || entry->result == NULL) {
+        free(entry->content);
+        free(entry->result);
+        free(entry);
+        return;
+    }
+    entry->hash = hash;
+    entry->lint = lint;
+    memcpy(entry->content, content, length);
+    entry->length = length;
+    entry->result_length = result_length;
+
+    entry->bucket_next = cache_buckets[hash % CACHE_BUCKETS];
+    cache_buckets[hash % CACHE_BUCKETS] = entry;
+    lru_push_newest(entry);
+    cache_bytes += size;
+    cache_entries++;
+}
+
+/* ============================================================================
+ * ANÁLISE DE UM PEDIDO
+ * ============================================================================ */
+
+static DiagnosticList lint_diagnostics;     /* Reaproveitada entre pedidos */
+
+/*
+ * analyze(content, length, lint, result)
+ *
+ * Analisa o conteúdo com o estado aquecido do parser e escreve em result
+ * os campos "valid" e "diagnostics" da resposta. Retorna 0 se o resultado
+ * não deve ir para a cache.
+ */
+static int analyze(const char* content, size_t length, int lint, TextBuffer* result) {
+    Diagnostic diag;
+    FILE* input = fmemopen((void*)content, length, "r");
+    if (input == NULL) {
+        text_printf(result, "\"valid\":false,\"diagnostics\":[]");
+        return 0;
+    }
+
+    AstNode* program = parse_file(input, &diag);
+    fclose(input);
+
+    diagnostic_list_clear(&lint_diagnostics);
+    if (program == NULL) {
+        *diagnostic_list_add(&lint_diagnostics) = diag;
+    } else if (lint) {
+        sema_check_program(program, &lint_diagnostics);
+    }
+    int errors = lint_diagnostics.count;    /* Avisos não invalidam o programa */
+    if (program != NULL && lint) {
+        warnings_check_program(program, &lint_diagnostics);
+    }
+    ast_reset();
+
+    text_printf(result, "\"valid\":%s,\"diagnostics\":[", errors == 0 ? "true" : "false");
+    for (int i = 0; i < lint_diagnostics.count; i++) {
+        if (i > 0) {
+            text_append(result, ",", 1);
+        }
+        diagnostic_append_json(result, &lint_diagnostics.items[i]);
+    }
+    text_append(result, "]", 1);
+    return program != NULL || diag.kind != DIAG_LIMIT;
+}
+
+static char file_root[PATH_MAX];   /* Raiz dos pedidos FILE, já resolvida */
+
+/*
+ * resolve_request_path(path, resolved)
+ *
+ * Resolve o caminho de um pedido FILE (relativo à raiz, se não for
+ * absoluto). Retorna 0 se ele existe e está sob a raiz; as duas falhas
+ * têm a mesma resposta, para que um cliente não descubra quais arquivos
+ * existem fora dela.
+ */
+static int resolve_request_path(const char* path, char resolved[PATH_MAX]) {
+    char joined[2 * PATH_MAX];
+    if (path[0] == '/') {
+        snprintf(joined, sizeof(joined), "%s", path);
+    } else {
+        snprintf(joined, sizeof(joined), "%s/%s", file_root, path);
+    }
+    if (realpath(joined, resolved) == NULL) {
+        return -1;
+    }
+    size_t root_length = strlen(file_root);
+    if (root_length > 1 &&
+        (strncmp(resolved, file_root, root_length) != 0 ||
+         (resolved[root_length] != '/' && resolved[root_length] != '\0'))) {
+        return -1;
+    }
+    return 0;
+}
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/*
+ * respond_source(response, content, length, lint, start)
+ *
+ * Responde a um pedido PARSE ou LINT, consultando a cache antes de analisar.
+ */
+static void respond_source(TextBuffer* response, const char* content, size_t length,
+                           int lint, double start) {
+    static TextBuffer result;
+    uint64_t hash = hash_content(content, length);
+    CacheEntry* entry = cache_lookup(hash, lint, content, length);
+    const char* fields;
+    size_t fields_length;
+
+    stat_requests++;
+    if (entry != NULL) {
+        stat_hits++;
+        fields = entry->result;
+        fields_length = entry->result_length;
+    } else {
+        stat_misses++;
+        result.length = 0;
+        if (analyze(content, length, lint, &result)) {
+            cache_store(hash, lint, content, length, result.data, result.length);
+        }
+        fields = result.data;
+        fields_length = result.length;
+    }
+
+    text_printf(response, "{\"status\":\"ok\",\"cached\":%s,\"micros\":%.0f,",
+                entry != NULL ? "true" : "false", now_us() - start);
+    text_append(response, fields, fields_length);
+    text_append(response, "}\n", 2);
+}
+
+static void respond_error(TextBuffer* response, const char* message) {
+    text_append(response, "{\"status\":\"error\",\"message\":", 28);
+    text_append_json_string(response, message);
+    text_append(response, "}\n", 2);
+}
+
+/* ============================================================================
+ * CONEXÕES
+ * ============================================================================ */
+
+typedef struct {
+    int fd;
+    TextBuffer input;       /* Bytes recebidos e ainda não consumidos */
+} Client;
+
+static Client clients[MAX_CLIENTS];
+static int client_count = 0;
+static volatile sig_atomic_t stop_requested = 0;
+
+static void handle_stop_signal(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
+
+/*
+ * send_all(fd, data, length)
+ *
+ * Envia a resposta inteira. Retorna -1 se o cliente desconectou.
+ */
+static int send_all(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t n = send(fd, data, length, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        data += n;
+        length -= (size_t)n;
+    }
+    return 0;
+}
+
+/*
+ * process_requests(client, response)
+ *
+ * Atende todos os pedidos completos do buffer do cliente, acumulando as
+ * respostas. Retorna -1 se o cliente enviou um pedido inválido.
+ */
+static int process_requests(Client* client, TextBuffer* response) {
+    static TextBuffer file_data;
+    size_t consumed = 0;
+
+    for (;;) {
+        char* header = client->input.data + consumed;
+        size_t available = client->input.length - consumed;
+        char* newline = memchr(header, '\n', available);
+        if (newline == NULL) {
+            if (available > MAX_HEADER_SIZE) {
+                respond_error(response, "Cabeçalho do pedido muito longo");
+                return -1;
+            }
+            break;
+        }
+        *newline = '\0';
+        size_t header_length = (size_t)(newline - header) + 1;
+        double start = now_us();
+
+        int lint = strncmp(header, "LINT ", 5) == 0;
+        if (strcmp(header, "STATS") == 0) {
+            text_printf(response,
+                        "{\"status\":\"ok\",\"requests\":%lu,\"hits\":%lu,\"misses\":%lu,"
+                        "\"cache_entries\":%d,\"cache_bytes\":%zu}\n",
+                        stat_requests, stat_hits, stat_misses, cache_entries, cache_bytes);
+        } else if (lint || strncmp(header, "PARSE ", 6) == 0) {
+            const char* args = header + (lint ? 5 : 6);
+            if (strncmp(args, "DATA ", 5) == 0) {
+                char* end;
+                unsigned long length = strtoul(args + 5, &end, 10);
+                if (*end != '\0' || length > MAX_REQUEST_SIZE) {
+                    *newline = '\n';
+                    respond_error(response, "Tamanho inválido no pedido DATA");
+                    return -1;
+                }
+                if (available - header_length < length) {
+                    *newline = '\n';    /* Corpo incompleto: espera mais bytes */
+                    break;
+                }
+                respond_source(response, newline + 1, length, lint, start);
+                header_length += length;
+            } else if (strncmp(args, "FILE ", 5) == 0) {
+                char path[PATH_MAX];
+                file_data.length = 0;
+                if (resolve_request_path(args + 5, path) != 0) {
+                    respond_error(response, "Arquivo inexistente ou fora da raiz do servidor");
+                } else if (text_read_file(&file_data, path) != 0) {
+                    respond_error(response, "Erro ao abrir arquivo");
+                } else {
+                    respond_source(response, file_data.data ? file_data.data : "",
+                                   file_data.length, lint, start);
+                }
+            } else {
+                respond_error(response, "Pedido deve usar FILE ou DATA");
+            }
+        } else {
+            respond_error(response, "Comando desconhecido");
+        }
+        consumed += header_length;
+    }
+
+    /* Move os bytes restantes para o início do buffer */
+    memmove(client->input.data, client->input.data + consumed, client->input.length - consumed);
+    client->input.length -= consumed;
+    return 0;
+}
+
+static void close_client(int index) {
+    close(clients[index].fd);
+    text_free(&clients[index].input);
+    clients[index] = clients[--client_count];
+}
+
+/*
+ * serve_client(index)
+ *
+ * Lê o que o cliente enviou e responde aos pedidos completos. Retorna 0
+ * se a conexão deve ser fechada.
+ */
+static int serve_client(int index) {
+    static TextBuffer response;
+    Client* client = &clients[index];
+    char chunk[65536];
+
+    ssize_t n = recv(client->fd, chunk, sizeof(chunk), 0);
+    if (n <= 0) {
+        return n < 0 && errno == EINTR;
+    }
+    text_append(&client->input, chunk, (size_t)n);
+
+    response.length = 0;
+    int status = process_requests(client, &response);
+    if (response.length > 0 && send_all(client->fd, response.data, response.length) != 0) {
+        return 0;
+    }
+    return status == 0;
+}
+
+/* ============================================================================
+ * FUNÇÃO PRINCIPAL
+ * ============================================================================ */
+
+/*
+ * open_listener(path)
+ *
+ * Cria o socket Unix de escuta, substituindo um socket antigo no caminho.
+ */
+static int open_listener(const char* path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Erro: caminho do socket muito longo: %s\n", path);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("Erro ao criar socket");
+        return -1;
+    }
+    unlink(path);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, 128) != 0) {
+        perror("Erro ao escutar no socket");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int main(int argc, char* argv[]) {
+    const char* socket_path = DEFAULT_SOCKET_PATH;
+    const char* root = ".";
+    ParseLimits limits = {0};
+    int limit_status;
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && (limit_status = parser_limit_option(argv[i], argv[i + 1], &limits)) > 0) {
+            i++;
+        } else if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc) {
+            socket_path = argv[++i];
+        } else if (strcmp(argv[i], "--raiz") == 0 && i + 1 < argc) {
+            root = argv[++i];
+        } else if (strcmp(argv[i], "--cache-mb") == 0 && i + 1 < argc) {
+            cache_limit = strtoul(argv[++i], NULL, 10) * 1024 * 1024;
+        } else if (strcmp(argv[i], "--tabela-pura") == 0) {
+            expr_fast_path = 0;
+        } else {
+            fprintf(stderr, "Uso: %s [--socket <caminho>] [--raiz <diretório>] [--cache-mb <n>] "
+                            "[--tabela-pura] "
+                            PARSE_LIMIT_OPTIONS "\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (realpath(root, file_root) == NULL) {
+        fprintf(stderr, "Erro: raiz inválida para os pedidos FILE: %s\n", root);
+        return 1;
+    }
+
+    int listener = open_listener(socket_path);
+    if (listener < 0) {
+        return 1;
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = handle_stop_signal;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    parser_init();
+    parser_set_limits(&limits);
+    fprintf(stderr, "lsi-serverd: escutando em %s (FILE sob %s)\n", socket_path, file_root);
+
+    struct pollfd fds[MAX_CLIENTS + 1];
+    while (!stop_requested) {
+        fds[0].fd = listener;
+        fds[0].events = client_count < MAX_CLIENTS ? POLLIN : 0;
+        for (int i = 0; i < client_count; i++) {
+            fds[i + 1].fd = clients[i].fd;
+            fds[i + 1].events = POLLIN;
+        }
+
+        if (poll(fds, (nfds_t)client_count + 1, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("Erro em poll");
+            break;
+        }
+
+        /* Percorre de trás para frente: close_client move o último cliente */
+        for (int i = client_count - 1; i >= 0; i--) {
+            if (fds[i + 1].revents != 0 && !serve_client(i)) {
+                close_client(i);
+            }
+        }
+        if (fds[0].revents & POLLIN) {
+            int fd = accept(listener, NULL, NULL);
+            if (fd >= 0) {
+                memset(&clients[client_count], 0, sizeof(Client));
+                clients[client_count++].fd = fd;
+            }
+        }
+    }
+
+    while (client_count > 0) {
+        close_client(client_count - 1);
+    }
+    close(listener);
+    unlink(socket_path);
+    fprintf(stderr, "lsi-serverd: %lu pedidos, %lu acertos na cache\n", stat_requests, stat_hits);
+    return 0;
+}
@@ -0,0 +1,29 @@
+/*
+ * ============================================================================
+ * HEADER DO SHA-256
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * */
+
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SHA256_DIGEST_SIZE 32
+
+typedef struct {
+    uint32_t state[8];
+    uint64_t length;            /* Bytes processados */
+    unsigned char block[64];
+    size_t block_used;
+} Sha256;
+
+void sha256_init(Sha256* ctx);
+void sha256_update(Sha256* ctx, const void* data, size_t length);
+void sha256_final(Sha256* ctx, unsigned char digest[SHA256_DIGEST_SIZE]);
+
+#endif
@@ -0,0 +1,126 @@
+#!/bin/sh
+#
+# ============================================================================
+# VERIFICAÇÃO DAS POSIÇÕES DO LEXER (--lexico)
+# ============================================================================
+#
+# Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+#
+# Passa entradas conhecidas por ./parser --lexico (e, nos casos de
+# estouro, pela análise completa) e compara a saída com a esperada:
+# quebras \n, \r\n e \r, um \r\n dividido entre dois blocos de leitura,
+# um identificador maior que o bloco de leitura e, com --grande, entradas
+# de 3 GB com linhas e colunas acima de 2^31 e uma de 4,5 GiB (cerca de 2
+# minutos). Nas entradas grandes, a memória máxima informada por --tempo
+# (getrusage) não pode passar de um limite fixo.
+#
+# Uso: ./verifica_lexico.sh [--grande]
+# O executável pode ser trocado com PARSER=<caminho>, e o limite de memória
+# com MEMORIA_MAX_MB=<n> (16 por padrão). Retorna 1 se algum caso falhar.
+#
+# ============================================================================
+
+cd "$(dirname "$0")" || exit 1
+PARSER=${PARSER:-./parser}
+GRANDE=0
+MEMORIA_MAX_MB=${MEMORIA_MAX_MB:-16}
+[ "$1" = "--grande" ] && GRANDE=1
+
+if [ ! -x "$PARSER" ]; then
+    echo "Executável não encontrado: $PARSER (compile o parser antes)" >&2
+    exit 1
+fi
+
+TMP=$(mktemp -d) || exit 1
+trap 'rm -rf "$TMP"' EXIT
+FALHAS=0
+
+# verifica <nome> <saída esperada> <gerador da entrada> [opções do parser]
+verifica() {
+    nome=$1
+    esperado=$2
+    gerador=$3
+    shift 3
+    obtido=$($gerador | "$PARSER" "$@" /dev/stdin 2>&1)
+    if [ "$obtido" = "$esperado" ]; then
+        printf 'ok      %s\n' "$nome"
+    else
+        printf 'FALHOU  %s\n' "$nome"
+        printf '%s\n' "$esperado" > "$TMP/esperado"
+        printf '%s\n' "$obtido" > "$TMP/obtido"
+        diff -u "$TMP/esperado" "$TMP/obtido"
+        FALHAS=$((FALHAS + 1))
+    fi
+}
+
+# verifica_memoria <nome> <saída esperada> <gerador da entrada>
+# Como verifica, com --lexico --tempo, conferindo também a memória máxima.
+verifica_memoria() {
+    nome=$1
+    esperado=$2
+    gerador=$3
+    obtido=$($gerador | "$PARSER" --lexico --tempo /dev/stdin 2>"$TMP/tempo")
+    memoria=$(sed -n 's/.*memória máxima: \([0-9]*\)\..*/\1/p' "$TMP/tempo")
+    if [ "$obtido" != "$esperado" ]; then
+        printf 'FALHOU  %s\n' "$nome"
+        printf '%s\n' "$esperado" > "$TMP/esperado"
+        printf '%s\n' "$obtido" > "$TMP/obtido"
+        diff -u "$TMP/esperado" "$TMP/obtido"
+        FALHAS=$((FALHAS + 1))
+    elif [ -z "$memoria" ] || [ "$memoria" -gt "$MEMORIA_MAX_MB" ]; then
+        printf 'FALHOU  %s: memória máxima de %s MB (limite: %s MB)\n' "$nome" \
+            "${memoria:-?}" "$MEMORIA_MAX_MB"
+        FALHAS=$((FALHAS + 1))
+    else
+        printf 'ok      %s (memória máxima: %s MB)\n' "$nome" "$memoria"
+    fi
+}
+
+arquivo_correto() { cat teste_correto_50linhas.lsi; }
+vazio() { :; }
+quebras_mistas() { printf 'x = 1;\r\ny = 2;\rz = 3;\n\n  w'; }
+crlf_entre_blocos() { head -c 65535 /dev/zero | tr '\0' ' '; printf '\r\ny'; }
+identificador_longo() { printf 'x = '; head -c 200000 /dev/zero | tr '\0' 'a'; printf ' + 1;\n'; }
+linhas_3g() { head -c 3G /dev/zero | tr '\0' '\n'; echo 'x = 1;'; }
+colunas_3g() { head -c 3G /dev/zero | tr '\0' ' '; echo 'x = 1;'; }
+expressoes_4g() { yes 'soma = soma + 12345 * (x - y);' | head -c 4608M; }
+erro_3g() { head -c 3G /dev/zero | tr '\0' ' '; echo 'x = 1 +;'; }
+erro_linhas_3g() { head -c 3G /dev/zero | tr '\0' '\n'; echo 'x = 1 +;'; }
+
+verifica "teste_correto_50linhas.lsi" "Análise Léxica concluída: 240 tokens, 65 linhas
+Último token: linha 65, coluna 1 (byte 918)" arquivo_correto --lexico
+
+verifica "entrada vazia" "Análise Léxica concluída: 0 tokens, 0 linhas" vazio --lexico
+
+verifica "quebras LF, CRLF e CR misturadas" "Análise Léxica concluída: 13 tokens, 5 linhas
+Último token: linha 5, coluna 3 (byte 25)" quebras_mistas --lexico
+
+verifica "CRLF dividido entre blocos de 64 KB" "Análise Léxica concluída: 1 tokens, 2 linhas
+Último token: linha 2, coluna 1 (byte 65537)" crlf_entre_blocos --lexico
+
+verifica "identificador de 200000 bytes" "Análise Léxica concluída: 6 tokens, 1 linhas
+Último token: linha 1, coluna 200009 (byte 200008)" identificador_longo --lexico
+
+if [ "$GRANDE" = 1 ]; then
+    verifica_memoria "3 GB de quebras de linha" "Análise Léxica concluída: 4 tokens, 3221225473 linhas
+Último token: linha 3221225473, coluna 6 (byte 3221225477)" linhas_3g
+
+    verifica_memoria "3 GB de espaços" "Análise Léxica concluída: 4 tokens, 1 linhas
+Último token: linha 1, coluna 3221225478 (byte 3221225477)" colunas_3g
+
+    # 155865748 linhas de 31 bytes e 12 tokens, e "soma = soma + 12345 " (5 tokens)
+    verifica_memoria "4,5 GiB de expressões" "Análise Léxica concluída: 1870388981 tokens, 155865749 linhas
+Último token: linha 155865749, coluna 15 (byte 4831838202)" expressoes_4g
+
+    verifica "coluna acima de 2^31 na análise completa" "
+--- Erro Sintático ---
+Token inesperado: ';' (TOKEN_SEMICOLON)
+Localização: linha 1, coluna 3221225480" erro_3g
+
+    verifica "linha acima de 2^31 na análise completa" "
+--- Erro Sintático ---
+Token inesperado: ';' (TOKEN_SEMICOLON)
+Localização: linha 3221225473, coluna 8" erro_linhas_3g
+fi
+
+[ "$FALHAS" = 0 ] || exit 1
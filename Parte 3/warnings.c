@@ -0,0 +1,280 @@
+/*
+ * ============================================================================
+ * AVISOS DE FLUXO DE DADOS PARA A LINGUAGEM LSI-2025-2
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * Dois problemas de fluxo de dados por função, resolvidos sobre o mesmo
+ * grafo (dataflow.h):
+ *
+ *   - Definições que alcançam, para frente: cada declaração int é uma
+ *     definição "sem valor" da variável, morta pela próxima atribuição.
+ *     Uma leitura alcançada por ela (em algum caminho) gera o aviso de uso
+ *     sem inicialização. Os parâmetros chegam inicializados.
+ *   - Variáveis vivas, para trás: uma atribuição cuja variável não está
+ *     viva logo depois dela é um armazenamento morto.
+ *
+ * Declarações nunca lidas são contadas diretamente nos eventos. Blocos
+ * inalcançáveis (depois de return) não geram avisos.
+ *
+ * ============================================================================
+ */
+
+#include "warnings.h"
+#include "dataflow.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * add_warning(out, node, format, ...)
+ *
+ * Acrescenta um aviso na posição do nó.
+ */
+static void add_warning(DiagnosticList* out, const AstNode* node, const char* format, ...)
+    __attribute__((format(printf, 3, 4)));
+
+static void add_warning(DiagnosticList* out, const AstNode* node, const char* format, ...) {
+    char message[DIAGNOSTIC_TEXT_SIZE];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+    diagnostic_set(diagnostic_list_add(out), DIAG_WARNING, node->line, node->col,
+                   "--- Aviso ---\n%s na linha %d, coluna %d",
+                   message, node->line, node->col);
+}
+
+static int compare_position(const void* a, const void* b) {
+    const Diagnostic* x = *(const Diagnostic* const*)a;
+    const Diagnostic* y = *(const Diagnostic* const*)b;
+    if (x->line != y->line) {
+        return x->line < y->line ? -1 : 1;
+    }
+    if (x->col != y->col) {
+        return x->col < y->col ? -1 : 1;
+    }
+    return strcmp(x->text, y->text);
+}
+
+/* ============================================================================
+ * USO SEM INICIALIZAÇÃO
+ * ============================================================================ */
+
+/*
+ * check_uninitialized(problem, warned, out)
+ *
+ * Resolve a fatia já selecionada em problem. gen = declarações não
+ * seguidas de atribuição no bloco; kill = variáveis declaradas ou
+ * atribuídas no bloco. Avisa uma vez por variável.
+ */
+static void check_uninitialized(DataflowProblem* problem, char* warned, DiagnosticList* out) {
+    const Cfg* cfg = problem->cfg;
+    int words = problem->words;
+
+    for (int pos = problem->lo; pos <= problem->hi; pos++) {
+        int b = cfg->order[pos];
+        uint64_t* gen = dataflow_set(problem, problem->gen, b);
+        uint64_t* kill = dataflow_set(problem, problem->kill, b);
+        for (int e = 0; e < cfg->blocks[b].event_count; e++) {
+            const CfgEvent* event = &cfg->blocks[b].events[e];
+            int bit = dataflow_bit(problem, event->local);
+            if (bit < 0) {
+                continue;
+            }
+            if (event->kind == CFG_DECL) {
+                bitset_add(gen, bit);
+                bitset_add(kill, bit);
+            } else if (event->kind == CFG_DEF) {
+                bitset_remove(gen, bit);
+                bitset_add(kill, bit);
+            }
+        }
+    }
+    dataflow_solve(problem);
+
+    uint64_t* current = (uint64_t*)malloc(sizeof(uint64_t) * (size_t)words);
+    for (int pos = problem->lo; pos <= problem->hi; pos++) {
+        int b = cfg->order[pos];
+        memcpy(current, dataflow_set(problem, problem->in, b), sizeof(uint64_t) * (size_t)words);
+        for (int e = 0; e < cfg->blocks[b].event_count; e++) {
+            const CfgEvent* event = &cfg->blocks[b].events[e];
+            int bit = dataflow_bit(problem, event->local);
+            if (bit < 0) {
+                continue;
+            }
+            if (event->kind == CFG_DECL) {
+                bitset_add(current, bit);
+            } else if (event->kind == CFG_DEF) {
+                bitset_remove(current, bit);
+            } else if (bitset_contains(current, bit) && !warned[event->local]) {
+                warned[event->local] = 1;
+                add_warning(out, event->node, "Variável '%s' pode ser usada sem inicialização",
+                            event->node->name);
+            }
+        }
+    }
+    free(current);
+}
+
+/* ============================================================================
+ * ARMAZENAMENTOS MORTOS E DECLARAÇÕES NÃO USADAS
+ * ============================================================================ */
+
+/*
+ * check_liveness(problem, unused, out)
+ *
+ * Resolve a fatia já selecionada em problem. gen = leituras não
+ * precedidas de atribuição no bloco; kill = variáveis atribuídas ou
+ * declaradas no bloco. As variáveis marcadas em unused (declaradas e
+ * nunca lidas) ficam de fora: o aviso de declaração não usada já as cobre.
+ */
+static void check_liveness(DataflowProblem* problem, const char* unused, DiagnosticList* out) {
+    const Cfg* cfg = problem->cfg;
+    int words = problem->words;
+
+    for (int pos = problem->lo; pos <= problem->hi; pos++) {
+        int b = cfg->order[pos];
+        uint64_t* gen = dataflow_set(problem, problem->gen, b);
+        uint64_t* kill = dataflow_set(problem, problem->kill, b);
+        for (int e = cfg->blocks[b].event_count - 1; e >= 0; e--) {
+            const CfgEvent* event = &cfg->blocks[b].events[e];
+            int bit = dataflow_bit(problem, event->local);
+            if (bit < 0) {
+                continue;
+            }
+            if (event->kind == CFG_USE) {
+                bitset_add(gen, bit);
+                bitset_remove(kill, bit);
+            } else {
+                bitset_remove(gen, bit);
+                bitset_add(kill, bit);
+            }
+        }
+    }
+    dataflow_solve(problem);
+
+    uint64_t* live = (uint64_t*)malloc(sizeof(uint64_t) * (size_t)words);
+    for (int pos = problem->lo; pos <= problem->hi; pos++) {
+        int b = cfg->order[pos];
+        memcpy(live, dataflow_set(problem, problem->out, b), sizeof(uint64_t) * (size_t)words);
+        for (int e = cfg->blocks[b].event_count - 1; e >= 0; e--) {
+            const CfgEvent* event = &cfg->blocks[b].events[e];
+            int bit = dataflow_bit(problem, event->local);
+            if (bit < 0) {
+                continue;
+            }
+            if (event->kind == CFG_USE) {
+                bitset_add(live, bit);
+                continue;
+            }
+            if (event->kind == CFG_DEF && !bitset_contains(live, bit) && !unused[event->local]) {
+                add_warning(out, event->node, "Valor atribuído a '%s' nunca é usado",
+                            event->node->name);
+            }
+            bitset_remove(live, bit);
+        }
+    }
+    free(live);
+}
+
+/*
+ * warnings_check_function(fdef, out)
+ *
+ * Executa as análises sobre uma função (ou sobre o programa de um único
+ * comando) e acrescenta os avisos, ordenados por posição.
+ */
+int warnings_check_function(const AstNode* fdef, DiagnosticList* out) {
+    int before = out->count;
+    Cfg cfg;
+    cfg_build(fdef, &cfg);
+
+    int count = cfg.locals.count;
+    int* use_count = (int*)calloc((size_t)(count ? count : 1), sizeof(int));
+    const AstNode** declaration = (const AstNode**)calloc((size_t)(count ? count : 1),
+                                                         sizeof(AstNode*));
+    char* warned = (char*)calloc((size_t)(count ? count : 1), 1);
+    char* unused = (char*)calloc((size_t)(count ? count : 1), 1);
+    if (use_count == NULL || declaration == NULL || warned == NULL || unused == NULL) {
+        fprintf(stderr, "Erro fatal: Memória insuficiente para a análise de fluxo de dados.\n");
+        exit(1);
+    }
+
+    for (int b = 0; b < cfg.block_count; b++) {
+        for (int e = 0; e < cfg.blocks[b].event_count; e++) {
+            const CfgEvent* event = &cfg.blocks[b].events[e];
+            if (event->kind == CFG_USE) {
+                use_count[event->local]++;
+            } else if (event->kind == CFG_DECL && cfg.blocks[b].reachable &&
+                       declaration[event->local] == NULL) {
+                declaration[event->local] = event->node;
+            }
+        }
+    }
+
+    DiagnosticList found = {0};
+    for (int i = 0; i < count; i++) {
+        if (declaration[i] != NULL && use_count[i] == 0) {
+            unused[i] = 1;
+            add_warning(&found, declaration[i], "Variável '%s' declarada e nunca usada",
+                        declaration[i]->name);
+        }
+    }
+    int slice = dataflow_slice_words(&cfg);
+    DataflowProblem reaching;
+    DataflowProblem liveness;
+    dataflow_problem_init(&reaching, &cfg, DATAFLOW_FORWARD, slice);
+    dataflow_problem_init(&liveness, &cfg, DATAFLOW_BACKWARD, slice);
+    for (int first = 0; first < count; first += slice * 64) {
+        if (dataflow_problem_slice(&reaching, first)) {
+            check_uninitialized(&reaching, warned, &found);
+        }
+        if (dataflow_problem_slice(&liveness, first)) {
+            check_liveness(&liveness, unused, &found);
+        }
+    }
+    dataflow_problem_free(&reaching);
+    dataflow_problem_free(&liveness);
+
+    /* Ordena ponteiros: um Diagnostic tem mais de 500 bytes */
+    const Diagnostic** sorted = (const Diagnostic**)malloc(sizeof(Diagnostic*) *
+                                                          (size_t)(found.count ? found.count : 1));
+    for (int i = 0; i < found.count; i++) {
+        sorted[i] = &found.items[i];
+    }
+    qsort(sorted, (size_t)found.count, sizeof(Diagnostic*), compare_position);
+    for (int i = 0; i < found.count; i++) {
+        *diagnostic_list_add(out) = *sorted[i];
+    }
+    free(sorted);
+
+    diagnostic_list_free(&found);
+    free(use_count);
+    free(declaration);
+    free(warned);
+    free(unused);
+    cfg_free(&cfg);
+    return out->count - before;
+}
+
+/*
+ * warnings_check_program(program, out)
+ *
+ * Cada função é analisada isoladamente: a linguagem não tem variáveis
+ * globais, e um argumento de chamada é sempre uma leitura.
+ */
+int warnings_check_program(const AstNode* program, DiagnosticList* out) {
+    int before = out->count;
+    int single_statement = program->kid_count > 0 && program->kids[0]->kind != AST_FDEF;
+
+    if (single_statement) {
+        warnings_check_function(program, out);
+    } else {
+        for (int i = 0; i < program->kid_count; i++) {
+            warnings_check_function(program->kids[i], out);
+        }
+    }
+    return out->count - before;
+}
@@ -0,0 +1,29 @@
+/*
+ * ============================================================================
+ * HEADER DOS AVISOS DE FLUXO DE DADOS PARA A LINGUAGEM LSI-2025-2
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * */
+
+#ifndef WARNINGS_H
+#define WARNINGS_H
+
+#include "ast.h"
+#include "diagnostic.h"
+
+/*
+ * Analisa cada função do programa e acrescenta a out um DIAG_WARNING por
+ * variável possivelmente lida sem inicialização, por atribuição cujo
+ * valor nunca é lido e por declaração int nunca lida. Os avisos de cada
+ * função saem em ordem de posição. Retorna o número de avisos
+ * acrescentados. Threads diferentes podem analisar programas diferentes
+ * ao mesmo tempo.
+ */
+int warnings_check_program(const AstNode* program, DiagnosticList* out);
+
+/* Como warnings_check_program(), para uma única AST_FDEF */
+int warnings_check_function(const AstNode* fdef, DiagnosticList* out);
+
+#endif
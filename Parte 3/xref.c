@@ -0,0 +1,738 @@
+/*
+ * ============================================================================
+ * ÍNDICE DE REFERÊNCIAS CRUZADAS
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * Monta e consulta o índice descrito em xref.h:
+ *   - Os nomes vêm da tabela de internação (intern.c): com
+ *     symtable_enable_interning(), AstNode.value é o número do símbolo,
+ *     igual em todos os arquivos, e as ocorrências são coletadas por
+ *     número, sem comparar textos
+ *   - Um arquivo cujo tamanho e data de modificação não mudaram desde a
+ *     última indexação não é lido: suas ocorrências são copiadas do índice
+ *     anterior, aberto com mmap, trocando os índices de nome do arquivo
+ *     antigo pelos números dos símbolos
+ *   - Os demais são analisados em paralelo, com uma fila comum como na
+ *     validação de vários arquivos
+ *   - Na escrita, os nomes são ordenados por strcmp e as ocorrências são
+ *     distribuídas por nome com uma ordenação por contagem, mantendo a
+ *     ordem de arquivo e posição de cada nome
+ *   - O índice novo vai para um arquivo temporário que rename() torna
+ *     visível de uma só vez; consultas concorrentes veem o índice antigo
+ *     ou o novo
+ *
+ * Uma consulta é uma busca binária sobre os nomes do arquivo mapeado e
+ * não depende do tamanho do corpus além do log do número de nomes.
+ *
+ * ============================================================================
+ */
+
+#define _GNU_SOURCE
+
+#include "xref.h"
+#include "intern.h"
+#include "lexer.h"
+#include "parser.h"
+#include "sha256.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* ============================================================================
+ * CONSULTA
+ * ============================================================================ */
+
+static const char* const kind_names[] = {
+    "def", "parâmetro", "int", "atribuição", "leitura", "chamada"
+};
+
+const char* xref_kind_to_string(XrefKind kind) {
+    return kind <= XREF_CALL ? kind_names[kind] : "?";
+}
+
+/*
+ * xref_open(index, path)
+ *
+ * Mapeia o arquivo e confere que as seções cabem nele e que nomes e
+ * caminhos apontam para dentro dos textos. As ocorrências não são
+ * percorridas, para que abrir o índice não custe proporcional ao corpus.
+ */
+int xref_open(XrefIndex* index, const char* path) {
+    memset(index, 0, sizeof(*index));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(XrefHeader)) {
+        close(fd);
+        return -1;
+    }
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return -1;
+    }
+    index->data = data;
+    index->size = (size_t)st.st_size;
+
+    const XrefHeader* header = (const XrefHeader*)data;
+    size_t expected = sizeof(XrefHeader) +
+                      (size_t)header->file_count * sizeof(XrefFile) +
+                      (size_t)header->name_count * sizeof(XrefName) +
+                      (size_t)header->site_count * sizeof(XrefSite) +
+                      header->string_size;
+    if (memcmp(header->magic, XREF_MAGIC, 8) != 0 || expected != index->size ||
+        (header->string_size > 0 && ((const char*)data)[index->size - 1] != '\0')) {
+        xref_close(index);
+        return -1;
+    }
+    index->header = header;
+    index->files = (const XrefFile*)(header + 1);
+    index->names = (const XrefName*)(index->files + header->file_count);
+    index->sites = (const XrefSite*)(index->names + header->name_count);
+    index->strings = (const char*)(index->sites + header->site_count);
+
+    for (uint32_t i = 0; i < header->file_count; i++) {
+        if (index->files[i].path >= header->string_size) {
+            xref_close(index);
+            return -1;
+        }
+    }
+    for (uint32_t i = 0; i < header->name_count; i++) {
+        const XrefName* name = &index->names[i];
+        if (name->text >= header->string_size || name->first_site > header->site_count ||
+            name->site_count > header->site_count - name->first_site) {
+            xref_close(index);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void xref_close(XrefIndex* index) {
+    if (index->data != NULL) {
+        munmap(index->data, index->size);
+    }
+    memset(index, 0, sizeof(*index));
+}
+
+const XrefName* xref_find(const XrefIndex* index, const char* name) {
+    uint32_t lo = 0;
+    uint32_t hi = index->header->name_count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        int cmp = strcmp(xref_text(index, index->names[mid].text), name);
+        if (cmp == 0) {
+            return &index->names[mid];
+        }
+        if (cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return NULL;
+}
+
+/* ============================================================================
+ * COLETA DAS OCORRÊNCIAS
+ * ============================================================================ */
+
+typedef struct {
+    int name;               /* Número do símbolo */
+    int function;           /* Número do símbolo da função, ou -1 */
+    int line;
+    int col;
+    XrefKind kind;
+} PendingSite;
+
+typedef struct {
+    const char* path;
+    int64_t size;
+    int64_t mtime_ns;
+    int old;                /* Índice no índice anterior, ou -1 */
+    int parse;              /* 1 se precisa ser analisado */
+    int status;             /* 0 válido, 1 erro sintático, -1 erro de leitura */
+    Diagnostic diag;
+    PendingSite* sites;
+    int site_count;
+    int site_capacity;
+} IndexedFile;
+
+static void add_site(IndexedFile* file, const AstNode* node, int function, XrefKind kind) {
+    if (file->site_count == file->site_capacity) {
+        file->site_capacity = file->site_capacity ? file->site_capacity * 2 : 64;
+        file->sites = (PendingSite*)realloc(file->sites,
+                                            sizeof(PendingSite) * (size_t)file->site_capacity);
+        if (file->sites == NULL) {
+            fprintf(stderr, "Erro fatal: Memória insuficiente para o índice.\n");
+            exit(1);
+        }
+    }
+    PendingSite* site = &file->sites[file->site_count++];
+    site->name = (int)node->value;
+    site->function = function;
+    site->line = node->line;
+    site->col = node->col;
+    site->kind = kind;
+}
+
+static void collect_expression(IndexedFile* file, const AstNode* node, int function) {
+    if (node->kind == AST_ID) {
+        add_site(file, node, function, XREF_READ);
+    } else if (node->kind == AST_BINOP) {
+        collect_expression(file, node->kids[0], function);
+        collect_expression(file, node->kids[1], function);
+    }
+}
+
+/*
+ * collect_statement(file, stmt, function)
+ *
+ * Acrescenta as ocorrências do comando. Uma chamada só aparece como
+ * expressão de uma atribuição, e seus argumentos são leituras.
+ */
+static void collect_statement(IndexedFile* file, const AstNode* stmt, int function) {
+    switch (stmt->kind) {
+        case AST_VARDECL:
+            for (int i = 0; i < stmt->kid_count; i++) {
+                add_site(file, stmt->kids[i], function, XREF_DECL);
+            }
+            break;
+        case AST_ASSIGN:
+            add_site(file, stmt, function, XREF_ASSIGN);
+            if (stmt->kids[0]->kind == AST_FCALL) {
+                const AstNode* call = stmt->kids[0];
+                add_site(file, call, function, XREF_CALL);
+                for (int i = 0; i < call->kid_count; i++) {
+                    add_site(file, call->kids[i], function, XREF_READ);
+                }
+            } else {
+                collect_expression(file, stmt->kids[0], function);
+            }
+            break;
+        case AST_PRINT:
+        case AST_RETURN:
+            if (stmt->kid_count > 0) {
+                collect_expression(file, stmt->kids[0], function);
+            }
+            break;
+        case AST_IF:
+            collect_expression(file, stmt->kids[0], function);
+            for (int i = 1; i < stmt->kid_count; i++) {
+                collect_statement(file, stmt->kids[i], function);
+            }
+            break;
+        case AST_BLOCK:
+            for (int i = 0; i < stmt->kid_count; i++) {
+                collect_statement(file, stmt->kids[i], function);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static void collect_program(IndexedFile* file, const AstNode* program) {
+    if (program->kid_count > 0 && program->kids[0]->kind != AST_FDEF) {
+        collect_statement(file, program->kids[0], -1);
+        return;
+    }
+    for (int f = 0; f < program->kid_count; f++) {
+        const AstNode* fdef = program->kids[f];
+        int function = (int)fdef->value;
+        add_site(file, fdef, function, XREF_FUNCTION);
+        for (int i = 0; i < fdef->param_count; i++) {
+            add_site(file, fdef->params[i], function, XREF_PARAM);
+        }
+        for (int i = 0; i < fdef->kid_count; i++) {
+            collect_statement(file, fdef->kids[i], function);
+        }
+    }
+}
+
+/* ============================================================================
+ * ANÁLISE EM PARALELO
+ * ============================================================================ */
+
+static IndexedFile* parse_queue;
+static int parse_queue_count;
+static int parse_queue_next;
+
+/*
+ * parse_worker(arg)
+ *
+ * Retira o próximo arquivo a analisar da fila comum até esvaziá-la.
+ */
+static void* parse_worker(void* arg) {
+    (void)arg;
+    for (;;) {
+        int i = __atomic_fetch_add(&parse_queue_next, 1, __ATOMIC_RELAXED);
+        if (i >= parse_queue_count) {
+            break;
+        }
+        IndexedFile* file = &parse_queue[i];
+        if (!file->parse) {
+            continue;
+        }
+        FILE* input = fopen(file->path, "r");
+        if (input == NULL) {
+            file->status = -1;
+            continue;
+        }
+        AstNode* program = parse_file(input, &file->diag);
+        fclose(input);
+        if (program == NULL) {
+            file->status = 1;
+        } else {
+            collect_program(file, program);
+        }
+        ast_reset();
+    }
+    return NULL;
+}
+
+static void parse_files(IndexedFile* files, int count, int thread_count) {
+    parse_queue = files;
+    parse_queue_count = count;
+    parse_queue_next = 0;
+    if (thread_count <= 1) {
+        parse_worker(NULL);
+        return;
+    }
+    pthread_t* threads = (pthread_t*)malloc(sizeof(pthread_t) * (size_t)thread_count);
+    for (int i = 0; i < thread_count; i++) {
+        if (pthread_create(&threads[i], NULL, parse_worker, NULL) != 0) {
+            fprintf(stderr, "Erro fatal: Não foi possível criar as threads de análise.\n");
+            exit(1);
+        }
+    }
+    for (int i = 0; i < thread_count; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+}
+
+/* ============================================================================
+ * LISTA DE ARQUIVOS
+ * ============================================================================ */
+
+/*
+ * Conjunto de caminhos por tabela hash aberta, para não indexar duas vezes
+ * um arquivo repetido na linha de comando ou já presente no índice.
+ */
+typedef struct {
+    IndexedFile* files;
+    int count;
+    int capacity;
+    int* slots;             /* Índice + 1, ou 0 se vazio */
+    int slot_count;
+} FileList;
+
+static uint32_t hash_path(const char* path) {
+    uint32_t h = 2166136261u;
+    for (; *path; path++) {
+        h = (h ^ (unsigned char)*path) * 16777619u;
+    }
+    return h;
+}
+
+static int* find_slot(const FileList* list, const char* path) {
+    uint32_t mask = (uint32_t)list->slot_count - 1;
+    for (uint32_t s = hash_path(path) & mask;; s = (s + 1) & mask) {
+        int entry = list->slots[s];
+        if (entry == 0 || strcmp(list->files[entry - 1].path, path) == 0) {
+            return &list->slots[s];
+        }
+    }
+}
+
+/*
+ * file_list_add(list, path)
+ *
+ * Acrescenta o arquivo, se ainda não está na lista, e retorna-o; retorna
+ * NULL se ele já estava.
+ */
+static IndexedFile* file_list_add(FileList* list, const char* path) {
+    if ((list->count + 1) * 2 > list->slot_count) {
+        int old_count = list->slot_count;
+        int* old_slots = list->slots;
+        list->slot_count = old_count ? old_count * 2 : 1024;
+        list->slots = (int*)calloc((size_t)list->slot_count, sizeof(int));
+        for (int s = 0; s < old_count; s++) {
+            if (old_slots[s] != 0) {
+                *find_slot(list, list->files[old_slots[s] - 1].path) = old_slots[s];
+            }
+        }
+        free(old_slots);
+    }
+    int* slot = find_slot(list, path);
+    if (*slot != 0) {
+        return NULL;
+    }
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : 256;
+        list->files = (IndexedFile*)realloc(list->files,
+                                            sizeof(IndexedFile) * (size_t)list->capacity);
+        if (list->files == NULL) {
+            fprintf(stderr, "Erro fatal: Memória insuficiente para o índice.\n");
+            exit(1);
+        }
+    }
+    IndexedFile* file = &list->files[list->count++];
+    memset(file, 0, sizeof(*file));
+    file->path = path;
+    file->old = -1;
+    *slot = list->count;
+    return file;
+}
+
+/* Lê tamanho e data de modificação; retorna -1 se o arquivo não existe */
+static int stat_path(const char* path, int64_t* size, int64_t* mtime_ns) {
+    struct stat st;
+    if (stat(path, &st) != 0 || !S_ISREG(st.st_mode)) {
+        return -1;
+    }
+    *size = (int64_t)st.st_size;
+    *mtime_ns = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+    return 0;
+}
+
+/*
+ * reuse_old_sites(old, files, count)
+ *
+ * Copia do índice anterior as ocorrências dos arquivos que não serão
+ * analisados, traduzindo cada nome antigo para o número do símbolo.
+ */
+static void reuse_old_sites(const XrefIndex* old, IndexedFile* files, int count) {
+    uint32_t old_files = old->header->file_count;
+    uint32_t name_count = old->header->name_count;
+    int* new_of_old = (int*)malloc(sizeof(int) * (old_files ? old_files : 1));
+    int* symbol = (int*)malloc(sizeof(int) * (name_count ? name_count : 1));
+    for (uint32_t f = 0; f < old_files; f++) {
+        new_of_old[f] = -1;
+    }
+    for (int i = 0; i < count; i++) {
+        if (files[i].old >= 0 && !files[i].parse) {
+            new_of_old[files[i].old] = i;
+        }
+    }
+    for (uint32_t n = 0; n < name_count; n++) {
+        const char* text = xref_text(old, old->names[n].text);
+        const char* stored;
+        symbol[n] = intern_symbol(text, strlen(text), &stored);
+    }
+
+    for (uint32_t n = 0; n < name_count; n++) {
+        const XrefName* name = &old->names[n];
+        for (uint32_t s = name->first_site; s < name->first_site + name->site_count; s++) {
+            const XrefSite* site = &old->sites[s];
+            if (site->file >= old_files || new_of_old[site->file] < 0) {
+                continue;
+            }
+            IndexedFile* file = &files[new_of_old[site->file]];
+            AstNode node;
+            node.value = symbol[n];
+            node.line = (int)site->line;
+            node.col = (int)site->col;
+            int function = site->function < name_count ? symbol[site->function] : -1;
+            add_site(file, &node, function, site->kind <= XREF_CALL ? (XrefKind)site->kind : XREF_READ);
+        }
+    }
+    free(new_of_old);
+    free(symbol);
+}
+
+/* ============================================================================
+ * ESCRITA
+ * ============================================================================ */
+
+static int compare_symbol_text(const void* a, const void* b) {
+    return strcmp(intern_text(*(const int*)a), intern_text(*(const int*)b));
+}
+
+static int compare_pending(const void* a, const void* b) {
+    const PendingSite* x = (const PendingSite*)a;
+    const PendingSite* y = (const PendingSite*)b;
+    if (x->line != y->line) {
+        return x->line < y->line ? -1 : 1;
+    }
+    if (x->col != y->col) {
+        return x->col < y->col ? -1 : 1;
+    }
+    return (int)x->kind - (int)y->kind;
+}
+
+static void grammar_digest(char digest[32]) {
+    Sha256 ctx;
+    const char* version = parser_grammar_version();
+    sha256_init(&ctx);
+    sha256_update(&ctx, version, strlen(version));
+    sha256_final(&ctx, (unsigned char*)digest);
+}
+
+/*
+ * write_index(path, files, count, stats)
+ *
+ * Ordena nomes e ocorrências e grava o índice em um temporário ao lado de
+ * path, renomeado no final. Retorna 0 em caso de sucesso.
+ */
+static int write_index(const char* path, IndexedFile* files, int count, XrefStats* stats) {
+    int symbol_count = intern_count();
+    int* rank = (int*)malloc(sizeof(int) * (size_t)symbol_count);
+    uint32_t* name_sites = (uint32_t*)calloc((size_t)symbol_count, sizeof(uint32_t));
+    size_t total = 0;
+    for (int i = 0; i < count; i++) {
+        if (files[i].site_count > 1) {
+            qsort(files[i].sites, (size_t)files[i].site_count, sizeof(PendingSite), compare_pending);
+        }
+        for (int s = 0; s < files[i].site_count; s++) {
+            name_sites[files[i].sites[s].name]++;
+        }
+        total += (size_t)files[i].site_count;
+    }
+    if (total >= UINT32_MAX) {
+        fprintf(stderr, "Erro: ocorrências demais para o formato do índice\n");
+        free(rank);
+        free(name_sites);
+        return -1;
+    }
+
+    /* Nomes usados em ordem de strcmp */
+    int* order = (int*)malloc(sizeof(int) * (size_t)(symbol_count ? symbol_count : 1));
+    int name_count = 0;
+    for (int sym = 0; sym < symbol_count; sym++) {
+        if (name_sites[sym] > 0) {
+            order[name_count++] = sym;
+        }
+    }
+    qsort(order, (size_t)name_count, sizeof(int), compare_symbol_text);
+
+    /* Textos: nomes, depois caminhos */
+    size_t string_size = 0;
+    for (int n = 0; n < name_count; n++) {
+        string_size += strlen(intern_text(order[n])) + 1;
+    }
+    for (int i = 0; i < count; i++) {
+        string_size += strlen(files[i].path) + 1;
+    }
+    if (string_size >= UINT32_MAX) {
+        fprintf(stderr, "Erro: textos demais para o formato do índice\n");
+        free(rank);
+        free(name_sites);
+        free(order);
+        return -1;
+    }
+    char* strings = (char*)malloc(string_size ? string_size : 1);
+    XrefName* names = (XrefName*)malloc(sizeof(XrefName) * (size_t)(name_count ? name_count : 1));
+    XrefFile* out_files = (XrefFile*)calloc((size_t)(count ? count : 1), sizeof(XrefFile));
+    XrefSite* sites = (XrefSite*)malloc(sizeof(XrefSite) * (total ? total : 1));
+    if (strings == NULL || names == NULL || out_files == NULL || sites == NULL) {
+        fprintf(stderr, "Erro fatal: Memória insuficiente para o índice.\n");
+        exit(1);
+    }
+
+    size_t offset = 0;
+    uint32_t first = 0;
+    for (int n = 0; n < name_count; n++) {
+        const char* text = intern_text(order[n]);
+        size_t length = strlen(text) + 1;
+        memcpy(strings + offset, text, length);
+        names[n].text = (uint32_t)offset;
+        names[n].first_site = first;
+        names[n].site_count = name_sites[order[n]];
+        rank[order[n]] = n;
+        offset += length;
+        first += name_sites[order[n]];
+    }
+    for (int i = 0; i < count; i++) {
+        size_t length = strlen(files[i].path) + 1;
+        memcpy(strings + offset, files[i].path, length);
+        out_files[i].path = (uint32_t)offset;
+        out_files[i].site_count = (uint32_t)files[i].site_count;
+        out_files[i].failed = files[i].status != 0;
+        out_files[i].size = files[i].size;
+        out_files[i].mtime_ns = files[i].mtime_ns;
+        offset += length;
+    }
+
+    /* Ordenação por contagem: arquivos em ordem, posições já ordenadas */
+    uint32_t* next = name_sites;
+    for (int n = 0; n < name_count; n++) {
+        next[order[n]] = names[n].first_site;
+    }
+    for (int i = 0; i < count; i++) {
+        for (int s = 0; s < files[i].site_count; s++) {
+            const PendingSite* pending = &files[i].sites[s];
+            XrefSite* site = &sites[next[pending->name]++];
+            site->file = (uint32_t)i;
+            site->line = (uint32_t)pending->line;
+            site->col = (uint32_t)pending->col;
+            site->function = pending->function >= 0 ? (uint32_t)rank[pending->function] : XREF_NONE;
+            site->kind = (uint32_t)pending->kind;
+        }
+    }
+
+    XrefHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, XREF_MAGIC, 8);
+    grammar_digest(header.grammar);
+    header.file_count = (uint32_t)count;
+    header.name_count = (uint32_t)name_count;
+    header.site_count = (uint32_t)total;
+    header.string_size = (uint32_t)string_size;
+
+    size_t tmp_size = strlen(path) + 32;
+    char* tmp = (char*)malloc(tmp_size);
+    snprintf(tmp, tmp_size, "%s.tmp.%d", path, (int)getpid());
+    FILE* out = fopen(tmp, "wb");
+    int status = -1;
+    if (out != NULL) {
+        fwrite(&header, sizeof(header), 1, out);
+        fwrite(out_files, sizeof(XrefFile), (size_t)count, out);
+        fwrite(names, sizeof(XrefName), (size_t)name_count, out);
+        fwrite(sites, sizeof(XrefSite), total, out);
+        fwrite(strings, 1, string_size, out);
+        int failed = ferror(out);
+        if (fclose(out) == 0 && !failed && rename(tmp, path) == 0) {
+            status = 0;
+        } else {
+            remove(tmp);
+        }
+    }
+    if (status != 0) {
+        fprintf(stderr, "Erro ao gravar o índice '%s': %s\n", path, strerror(errno));
+    }
+
+    stats->names = name_count;
+    stats->sites = (int)total;
+    free(tmp);
+    free(rank);
+    free(name_sites);
+    free(order);
+    free(strings);
+    free(names);
+    free(out_files);
+    free(sites);
+    return status;
+}
+
+/* ============================================================================
+ * ATUALIZAÇÃO
+ * ============================================================================ */
+
+/*
+ * xref_update(index_path, paths, count, thread_count, stats)
+ *
+ * Os erros de leitura e sintáticos são impressos em stderr, precedidos
+ * do caminho do arquivo.
+ */
+int xref_update(const char* index_path, char** paths, int count, int thread_count,
+                XrefStats* stats) {
+    memset(stats, 0, sizeof(*stats));
+    symtable_enable_interning();
+    parser_init();
+
+    XrefIndex old;
+    int have_old = xref_open(&old, index_path) == 0;
+    char grammar[32];
+    grammar_digest(grammar);
+    int same_grammar = have_old && memcmp(old.header->grammar, grammar, sizeof(grammar)) == 0;
+
+    FileList list = {0};
+    if (have_old) {
+        for (uint32_t f = 0; f < old.header->file_count; f++) {
+            const XrefFile* entry = &old.files[f];
+            int64_t size;
+            int64_t mtime_ns;
+            if (stat_path(xref_text(&old, entry->path), &size, &mtime_ns) != 0) {
+                stats->removed++;   /* Não existe mais: fica fora do novo índice */
+                continue;
+            }
+            IndexedFile* file = file_list_add(&list, xref_text(&old, entry->path));
+            if (file == NULL) {
+                continue;
+            }
+            file->size = size;
+            file->mtime_ns = mtime_ns;
+            file->old = (int)f;
+            file->parse = !same_grammar || file->size != entry->size ||
+                          file->mtime_ns != entry->mtime_ns;
+            file->status = file->parse ? 0 : (int)entry->failed;
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        int64_t size;
+        int64_t mtime_ns;
+        if (stat_path(paths[i], &size, &mtime_ns) != 0) {
+            fprintf(stderr, "%s: Erro ao abrir arquivo\n", paths[i]);
+            stats->failed++;
+            continue;
+        }
+        IndexedFile* file = file_list_add(&list, paths[i]);
+        if (file != NULL) {
+            file->size = size;
+            file->mtime_ns = mtime_ns;
+            file->parse = 1;
+        }
+    }
+
+    for (int i = 0; i < list.count; i++) {
+        if (list.files[i].parse) {
+            stats->parsed++;
+        } else {
+            stats->reused++;
+        }
+    }
+    stats->files = list.count;
+
+    /* Nada mudou: o índice atual continua válido e não é reescrito */
+    if (have_old && stats->parsed == 0 && stats->removed == 0) {
+        for (int i = 0; i < list.count; i++) {
+            stats->failed += list.files[i].status != 0;
+        }
+        stats->names = (int)old.header->name_count;
+        stats->sites = (int)old.header->site_count;
+        free(list.files);
+        free(list.slots);
+        xref_close(&old);
+        return 0;
+    }
+
+    if (have_old) {
+        reuse_old_sites(&old, list.files, list.count);
+    }
+    parse_files(list.files, list.count, thread_count);
+
+    for (int i = 0; i < list.count; i++) {
+        const IndexedFile* file = &list.files[i];
+        if (file->parse && file->status < 0) {
+            fprintf(stderr, "%s: Erro ao abrir arquivo\n", file->path);
+        } else if (file->parse && file->status > 0) {
+            fprintf(stderr, "%s:", file->path);
+            diagnostic_print(stderr, &file->diag);
+        }
+        stats->failed += file->status != 0;
+    }
+
+    int status = write_index(index_path, list.files, list.count, stats);
+
+    for (int i = 0; i < list.count; i++) {
+        free(list.files[i].sites);
+    }
+    free(list.files);
+    free(list.slots);
+    if (have_old) {
+        xref_close(&old);       /* Os caminhos do índice antigo são usados até aqui */
+    }
+    return status;
+}
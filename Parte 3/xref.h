@@ -0,0 +1,124 @@
+/*
+ * ============================================================================
+ * HEADER DO ÍNDICE DE REFERÊNCIAS CRUZADAS
+ * ============================================================================
+ *
+ * Integrantes: Eduardo Boçon, Darnley Ribeiro, Jiliard Peifer e Olavo Ançay
+ *
+ * O índice guarda, para cada identificador de um conjunto de arquivos,
+ * onde ele é definido (def, int e parâmetros) e onde é usado (atribuição,
+ * leitura e chamada). Ele fica em um único arquivo, aberto com mmap pelas
+ * consultas e reescrito por xref_update() quando arquivos mudam.
+ *
+ * Formato (inteiros de 32 bits na ordem da máquina):
+ *   XrefHeader
+ *   XrefFile[file_count]    na ordem em que os arquivos foram indexados
+ *   XrefName[name_count]    em ordem de strcmp, para busca binária
+ *   XrefSite[site_count]    agrupadas por nome, depois por arquivo e posição
+ *   textos terminados por '\0' (nomes e caminhos)
+ *
+ * */
+
+#ifndef XREF_H
+#define XREF_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define XREF_MAGIC "LSIXREF1"
+#define XREF_NONE UINT32_MAX
+
+typedef enum {
+    XREF_FUNCTION,          /* def */
+    XREF_PARAM,             /* Parâmetro de def */
+    XREF_DECL,              /* Declaração int */
+    XREF_ASSIGN,            /* Destino de atribuição */
+    XREF_READ,              /* Leitura em expressão, argumento ou return */
+    XREF_CALL               /* Chamada de função */
+} XrefKind;
+
+/* Definições vêm antes dos usos na enumeração */
+#define XREF_IS_DEFINITION(kind) ((kind) <= XREF_DECL)
+
+typedef struct {
+    char magic[8];
+    char grammar[32];       /* parser_grammar_version(); outra versão reanalisa tudo */
+    uint32_t file_count;
+    uint32_t name_count;
+    uint32_t site_count;
+    uint32_t string_size;
+} XrefHeader;
+
+typedef struct {
+    uint32_t path;          /* Deslocamento do caminho nos textos */
+    uint32_t site_count;    /* 0 também para arquivos com erro sintático */
+    uint32_t failed;        /* 1 se a última análise falhou */
+    uint32_t reserved;
+    int64_t size;           /* Tamanho e data de modificação na indexação */
+    int64_t mtime_ns;
+} XrefFile;
+
+typedef struct {
+    uint32_t text;          /* Deslocamento do nome nos textos */
+    uint32_t first_site;
+    uint32_t site_count;
+} XrefName;
+
+typedef struct {
+    uint32_t file;
+    uint32_t line;
+    uint32_t col;
+    uint32_t function;      /* Índice em names da função que contém o local, ou XREF_NONE */
+    uint32_t kind;          /* XrefKind */
+} XrefSite;
+
+typedef struct {
+    void* data;
+    size_t size;
+    const XrefHeader* header;
+    const XrefFile* files;
+    const XrefName* names;
+    const XrefSite* sites;
+    const char* strings;
+} XrefIndex;
+
+typedef struct {
+    int files;              /* Arquivos no novo índice */
+    int parsed;             /* Analisados de novo (novos ou modificados) */
+    int reused;             /* Com as ocorrências copiadas do índice anterior */
+    int removed;            /* Do índice anterior, que não existem mais */
+    int failed;             /* Com erro de leitura ou sintático */
+    int names;
+    int sites;
+} XrefStats;
+
+/*
+ * Abre o índice com mmap e confere o cabeçalho e os tamanhos. Retorna 0
+ * em caso de sucesso.
+ */
+int xref_open(XrefIndex* index, const char* path);
+void xref_close(XrefIndex* index);
+
+/* Nome no índice (busca binária), ou NULL */
+const XrefName* xref_find(const XrefIndex* index, const char* name);
+
+static inline const char* xref_text(const XrefIndex* index, uint32_t offset) {
+    return index->strings + offset;
+}
+
+const char* xref_kind_to_string(XrefKind kind);
+
+/*
+ * Atualiza o índice em index_path: os arquivos já indexados continuam
+ * nele (os que não existem mais saem) e os de paths são acrescentados.
+ * Só são analisados os arquivos novos ou com tamanho ou data de
+ * modificação diferentes; os demais têm as ocorrências copiadas do
+ * índice anterior. Analisa com thread_count threads e substitui o arquivo
+ * de forma atômica. Deve ser chamada antes de qualquer outra análise no
+ * processo (usa symtable_enable_interning()). Retorna 0 se o índice foi
+ * escrito; os arquivos com erro entram no índice sem ocorrências.
+ */
+int xref_update(const char* index_path, char** paths, int count, int thread_count,
+                XrefStats* stats);
+
+#endif